@@ -2,6 +2,7 @@
 #define AE_ASSET_LOADER_H
 
 #include "../system/memory.h"
+#include "async_loader.h"
 
 namespace ae {
 
@@ -22,6 +23,12 @@ public:
     {
         return nullptr;
     }
+
+    template<typename... Args>
+    static AssetHandle<T> loadFromFileAsync(Assets *, const std::string &, Args &&...args)
+    {
+        return {};
+    }
 };
 
 } // namespace ae
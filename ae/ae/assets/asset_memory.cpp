@@ -0,0 +1,134 @@
+#include "asset_memory.h"
+#include "../audio/sound_buffer.h"
+#include "../graphics/core/texture.h"
+#include "../graphics/scene/model.h"
+
+#include <functional>
+#include <unordered_map>
+
+namespace ae {
+
+AssetMemory AssetMemoryTraits<Texture>::get(const Texture &texture)
+{
+    if (!texture.isValid())
+        return {};
+
+    uint64_t pixel_size = texture.getFormat() == TextureFormat::DEPTH
+                              ? 4
+                              : static_cast<uint64_t>(texture.getFormat());
+    uint64_t bytes = uint64_t(texture.getSize().x) * texture.getSize().y * pixel_size;
+
+    AssetMemory memory;
+    if (texture.getType() == TextureType::CUBE_MAP)
+        memory.gpu_bytes = bytes * 6;
+    else
+        memory.gpu_bytes = bytes * 4 / 3; // с мип-уровнями
+    return memory;
+}
+
+namespace {
+
+// Части модели и число ссылок на них изнутри модели. Часть принадлежит только модели,
+// если других ссылок на нее нет
+struct ModelParts
+{
+    std::unordered_map<const Mesh *, int32_t> meshes;
+    std::unordered_map<const Material *, int32_t> materials;
+    std::unordered_map<const Texture *, int32_t> textures;
+
+    explicit ModelParts(const Model &model)
+    {
+        std::function<void(const s_ptr<MeshNode> &)> process_node =
+            [&](const s_ptr<MeshNode> &node) {
+                if (!node)
+                    return;
+
+                // Один меш может использоваться несколькими узлами
+                for (const auto &mesh : node->getMeshes()) {
+                    if (mesh)
+                        ++meshes[mesh.get()];
+                }
+
+                for (const auto &child : node->getChildren())
+                    process_node(child);
+            };
+
+        process_node(model.getRootNode());
+
+        // Каждый меш хранит одну ссылку на материал, материал - по одной на текстуру
+        for (const auto &[mesh, refs] : meshes) {
+            if (const Material *material = mesh->getMaterial().get())
+                ++materials[material];
+        }
+
+        for (const auto &[material, refs] : materials) {
+            if (material->diffuse_texture)
+                ++textures[material->diffuse_texture.get()];
+            if (material->specular_texture)
+                ++textures[material->specular_texture.get()];
+        }
+    }
+
+    template<typename T>
+    static bool isExclusive(const T *part, int32_t refs)
+    {
+        return part->getRefCount() == refs;
+    }
+};
+
+} // namespace
+
+AssetMemory AssetMemoryTraits<Model>::get(const Model &model)
+{
+    AssetMemory memory;
+    ModelParts parts{model};
+
+    for (const auto &[mesh, refs] : parts.meshes) {
+        if (!ModelParts::isExclusive(mesh, refs))
+            continue;
+
+        const auto &vertex_array = mesh->getVertexArray();
+        memory.gpu_bytes += uint64_t(vertex_array.getVertexCount()) * sizeof(Vertex)
+                            + uint64_t(vertex_array.getIndicesCount()) * sizeof(uint32_t);
+        memory.cpu_bytes += mesh->getCpuMemory();
+        memory.released_bytes += mesh->getReleasedMemory();
+    }
+
+    // Текстуры по умолчанию и зарегистрированные в Assets имеют других владельцев
+    // и учитываются отдельно
+    for (const auto &[texture, refs] : parts.textures) {
+        if (!ModelParts::isExclusive(texture, refs))
+            continue;
+
+        auto texture_memory = AssetMemoryTraits<Texture>::get(*texture);
+        memory.gpu_bytes += texture_memory.gpu_bytes;
+    }
+
+    return memory;
+}
+
+bool AssetMemoryTraits<Model>::hasOutsideOwners(const Model &model)
+{
+    ModelParts parts{model};
+
+    for (const auto &[mesh, refs] : parts.meshes) {
+        if (!ModelParts::isExclusive(mesh, refs))
+            return true;
+    }
+
+    for (const auto &[material, refs] : parts.materials) {
+        if (!ModelParts::isExclusive(material, refs))
+            return true;
+    }
+
+    return false;
+}
+
+AssetMemory AssetMemoryTraits<SoundBuffer>::get(const SoundBuffer &sound_buffer)
+{
+    AssetMemory memory;
+    memory.gpu_bytes = sound_buffer.getDataSize();
+    return memory;
+}
+
+} // namespace ae
@@ -0,0 +1,61 @@
+#ifndef AE_ASSET_MEMORY_H
+#define AE_ASSET_MEMORY_H
+
+#include <stdint.h>
+
+namespace ae {
+
+class Model;
+class SoundBuffer;
+class Texture;
+
+// Оценка памяти, занятой ресурсом
+struct AssetMemory
+{
+    uint64_t getTotal() const { return cpu_bytes + gpu_bytes; }
+
+    uint64_t cpu_bytes = 0; // данные в памяти процесса
+    uint64_t gpu_bytes = 0; // данные в объектах GL и OpenAL
+    uint64_t released_bytes = 0; // освобождено после загрузки в GL (не входит в total)
+};
+
+// Класс ресурса для учета памяти. Для типов без специализации память не учитывается.
+// get учитывает только то, что освободится вместе с ресурсом. hasOutsideOwners - части
+// ресурса используются вне его, и выгрузка ничего не освободит
+template<typename T>
+struct AssetMemoryTraits
+{
+    static constexpr const char *name = "other";
+    static AssetMemory get(const T &) { return {}; }
+    static bool hasOutsideOwners(const T &) { return false; }
+};
+
+template<>
+struct AssetMemoryTraits<Texture>
+{
+    static constexpr const char *name = "textures";
+    static AssetMemory get(const Texture &texture);
+    static bool hasOutsideOwners(const Texture &) { return false; }
+};
+
+template<>
+struct AssetMemoryTraits<Model>
+{
+    static constexpr const char *name = "models";
+    // Меши, материалы и текстуры, которыми владеет только модель
+    static AssetMemory get(const Model &model);
+    // Меши или материалы модели захвачены сценой (Drawable_C, коллайдеры) или другими моделями
+    static bool hasOutsideOwners(const Model &model);
+};
+
+template<>
+struct AssetMemoryTraits<SoundBuffer>
+{
+    static constexpr const char *name = "sounds";
+    static AssetMemory get(const SoundBuffer &sound_buffer);
+    static bool hasOutsideOwners(const SoundBuffer &) { return false; }
+};
+
+} // namespace ae
+
+#endif // AE_ASSET_MEMORY_H
@@ -0,0 +1,417 @@
+#ifndef AE_ASSET_STORAGE_H
+#define AE_ASSET_STORAGE_H
+
+#include "../system/log.h"
+#include "../system/memory.h"
+#include "../system/string_id.h"
+#include "asset_memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace ae {
+
+// Идентификатор ресурса: индекс слота и поколение. После удаления ресурса поколение
+// слота увеличивается, и старые идентификаторы перестают быть действительными.
+// Выгрузка ресурса по бюджету памяти идентификатор не меняет
+template<typename T>
+struct AssetId
+{
+    static constexpr uint32_t INVALID_INDEX = ~0u;
+
+    bool isValid() const { return index != INVALID_INDEX; }
+    explicit operator bool() const { return isValid(); }
+
+    bool operator==(const AssetId &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const AssetId &other) const { return !(*this == other); }
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+};
+
+// Порядковый номер типа ресурса для индексации хранилищ без хеширования typeid
+struct AssetTypeIndex
+{
+    template<typename T>
+    static uint32_t get()
+    {
+        static const uint32_t index = m_next++;
+        return index;
+    }
+
+private:
+    inline static std::atomic<uint32_t> m_next{0};
+};
+
+// Статистика памяти одного класса ресурсов
+struct AssetResidencyStats
+{
+    const char *name = "";
+    int32_t count = 0;    // зарегистрированные ресурсы
+    int32_t resident = 0; // загруженные в память
+    AssetMemory memory;
+    uint64_t budget = 0; // 0 - без ограничения
+    int32_t evictions = 0;
+    int32_t reloads = 0;
+};
+
+class AssetStorageBase
+{
+public:
+    virtual ~AssetStorageBase() = default;
+
+    virtual void clear() = 0;
+
+    virtual void setBudget(uint64_t budget) = 0;
+    // Выгружает давно не используемые ресурсы, пока память класса превышает бюджет
+    virtual int32_t evict(uint64_t frame) = 0;
+    virtual AssetResidencyStats getStats() const = 0;
+};
+
+// Плотный массив слотов ресурсов одного типа
+template<typename T>
+class AssetStorage : public AssetStorageBase
+{
+public:
+    struct Slot
+    {
+        s_ptr<T> asset;
+        StringId name;
+        uint32_t generation = 0;
+        int32_t ref_count = 0;
+
+        AssetMemory memory;
+        uint64_t last_access = 0;
+        // Повторная загрузка после выгрузки. Ресурсы без нее не выгружаются
+        std::function<s_ptr<T>()> reload;
+        // Запуск фоновой загрузки, false - не удалось запустить. Результат приходит через add
+        std::function<bool()> reload_async;
+        bool evicted = false;
+        bool reloading = false;
+    };
+
+    AssetStorage()
+        : m_frame{0}
+        , m_budget{0}
+        , m_evictions{0}
+        , m_reloads{0}
+    {}
+    ~AssetStorage() = default;
+
+    AssetId<T> add(StringId name, const s_ptr<T> &asset)
+    {
+        // Пустое имя возвращает StringId::intern при совпадении хешей
+        if (name.isEmpty()) {
+            l_error("Asset without name is not added: {}", AssetMemoryTraits<T>::name);
+            return {};
+        }
+
+        auto found = m_name_to_index.find(name);
+        if (found != m_name_to_index.end()) {
+            auto &slot = m_slots[found->second];
+            // Повторная загрузка выгруженного ресурса
+            if (slot.evicted && asset)
+                setResident(slot, asset);
+            return {found->second, slot.generation};
+        }
+
+        uint32_t index;
+        if (!m_free_indices.empty()) {
+            index = m_free_indices.back();
+            m_free_indices.pop_back();
+        } else {
+            index = m_slots.size();
+            m_slots.emplace_back();
+        }
+
+        auto &slot = m_slots[index];
+        slot.name = name;
+        slot.ref_count = 0;
+        slot.last_access = m_frame;
+        setResident(slot, asset);
+        m_name_to_index.emplace(name, index);
+
+        return {index, slot.generation};
+    }
+
+    void remove(AssetId<T> id)
+    {
+        if (!contains(id))
+            return;
+
+        auto &slot = m_slots[id.index];
+        m_name_to_index.erase(slot.name);
+        setEvicted(slot);
+        slot.evicted = false;
+        slot.reloading = false;
+        slot.name = StringId{};
+        slot.ref_count = 0;
+        slot.reload = nullptr;
+        slot.reload_async = nullptr;
+        ++slot.generation;
+        m_free_indices.push_back(id.index);
+    }
+
+    AssetId<T> find(StringId name) const
+    {
+        auto found = m_name_to_index.find(name);
+        if (found == m_name_to_index.end())
+            return {};
+        return {found->second, m_slots[found->second].generation};
+    }
+
+    AssetId<T> find(const s_ptr<T> &asset) const
+    {
+        for (uint32_t i = 0; i < m_slots.size(); ++i) {
+            if (m_slots[i].asset == asset)
+                return {i, m_slots[i].generation};
+        }
+        return {};
+    }
+
+    bool contains(AssetId<T> id) const
+    {
+        return id.index < m_slots.size() && m_slots[id.index].generation == id.generation
+               && (m_slots[id.index].asset || m_slots[id.index].evicted);
+    }
+
+    // Отмечает обращение к ресурсу. Для выгруженного запускает фоновую загрузку и до ее
+    // завершения возвращает пустой указатель. Без фоновой загрузки грузит синхронно
+    const s_ptr<T> &get(AssetId<T> id)
+    {
+        static const s_ptr<T> empty;
+        if (!contains(id))
+            return empty;
+
+        auto &slot = m_slots[id.index];
+        slot.last_access = m_frame;
+
+        if (!slot.evicted)
+            return slot.asset;
+
+        if (slot.reloading)
+            return empty;
+
+        // Загрузчик может сразу вызвать add и заполнить слот
+        if (slot.reload_async && slot.reload_async()) {
+            auto &reloaded = m_slots[id.index];
+            reloaded.reloading = reloaded.evicted;
+            return reloaded.asset;
+        }
+
+        return require(id);
+    }
+
+    // Как get, но выгруженный ресурс загружается синхронно
+    const s_ptr<T> &require(AssetId<T> id)
+    {
+        static const s_ptr<T> empty;
+        if (!contains(id))
+            return empty;
+
+        m_slots[id.index].last_access = m_frame;
+
+        if (m_slots[id.index].evicted && m_slots[id.index].reload) {
+            // Загрузчик может сам вызвать add и заполнить слот
+            auto asset = m_slots[id.index].reload();
+            if (asset && m_slots[id.index].evicted)
+                setResident(m_slots[id.index], asset);
+
+            if (m_slots[id.index].evicted) {
+                l_error("Failed to reload asset: {}", m_slots[id.index].name.getString());
+                return empty;
+            }
+        }
+
+        return m_slots[id.index].asset;
+    }
+
+    void setReload(AssetId<T> id,
+                   const std::function<s_ptr<T>()> &reload,
+                   const std::function<bool()> &reload_async = {})
+    {
+        if (contains(id)) {
+            m_slots[id.index].reload = reload;
+            m_slots[id.index].reload_async = reload_async;
+        }
+    }
+
+    // Фоновая загрузка завершилась ошибкой, следующий get попробует снова
+    void cancelReload(AssetId<T> id)
+    {
+        if (!contains(id) || !m_slots[id.index].reloading)
+            return;
+
+        m_slots[id.index].reloading = false;
+        l_error("Failed to reload asset: {}", m_slots[id.index].name.getString());
+    }
+
+    int32_t addRef(AssetId<T> id)
+    {
+        return contains(id) ? ++m_slots[id.index].ref_count : 0;
+    }
+
+    int32_t release(AssetId<T> id)
+    {
+        if (!contains(id) || m_slots[id.index].ref_count == 0)
+            return 0;
+        return --m_slots[id.index].ref_count;
+    }
+
+    int32_t getRefCount(AssetId<T> id) const
+    {
+        return contains(id) ? m_slots[id.index].ref_count : 0;
+    }
+
+    const std::vector<Slot> &getSlots() const { return m_slots; }
+
+    void clear() override
+    {
+        m_name_to_index.clear();
+        m_free_indices.clear();
+
+        for (uint32_t i = 0; i < m_slots.size(); ++i) {
+            auto &slot = m_slots[i];
+            if (slot.asset || slot.evicted)
+                ++slot.generation;
+            setEvicted(slot);
+            slot.evicted = false;
+            slot.reloading = false;
+            slot.name = StringId{};
+            slot.ref_count = 0;
+            slot.reload = nullptr;
+            slot.reload_async = nullptr;
+            m_free_indices.push_back(i);
+        }
+    }
+
+    void setBudget(uint64_t budget) override { m_budget = budget; }
+
+    int32_t evict(uint64_t frame) override
+    {
+        m_frame = frame;
+
+        if (m_budget == 0)
+            return 0;
+
+        // Части ресурсов захватываются и отпускаются сценой, память пересчитывается
+        // по тому, что сейчас принадлежит только слоту
+        m_memory = {};
+        for (auto &slot : m_slots) {
+            if (!slot.asset)
+                continue;
+
+            slot.memory = AssetMemoryTraits<T>::get(*slot.asset);
+            m_memory.cpu_bytes += slot.memory.cpu_bytes;
+            m_memory.gpu_bytes += slot.memory.gpu_bytes;
+            m_memory.released_bytes += slot.memory.released_bytes;
+        }
+
+        if (m_memory.getTotal() <= m_budget)
+            return 0;
+
+        // Кандидаты: есть способ загрузки, нет явных ссылок и других владельцев самого
+        // ресурса и его частей, не запрашивались с прошлого update (last_access равен
+        // кадру, на котором было последнее обращение)
+        std::vector<uint32_t> candidates;
+        for (uint32_t i = 0; i < m_slots.size(); ++i) {
+            const auto &slot = m_slots[i];
+            if (slot.asset && slot.reload && slot.ref_count == 0 && slot.asset.useCount() == 1
+                && slot.last_access + 1 < frame
+                && !AssetMemoryTraits<T>::hasOutsideOwners(*slot.asset))
+                candidates.push_back(i);
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) {
+            return m_slots[a].last_access < m_slots[b].last_access;
+        });
+
+        int32_t count = 0;
+        for (uint32_t index : candidates) {
+            if (m_memory.getTotal() <= m_budget)
+                break;
+
+            setEvicted(m_slots[index]);
+            ++m_evictions;
+            ++count;
+        }
+
+        if (count > 0)
+            l_debug("Assets: evicted {} {}, {} KiB used of {} KiB",
+                    count,
+                    AssetMemoryTraits<T>::name,
+                    m_memory.getTotal() / 1024,
+                    m_budget / 1024);
+
+        return count;
+    }
+
+    AssetResidencyStats getStats() const override
+    {
+        AssetResidencyStats stats;
+        stats.name = AssetMemoryTraits<T>::name;
+        stats.memory = m_memory;
+        stats.budget = m_budget;
+        stats.evictions = m_evictions;
+        stats.reloads = m_reloads;
+
+        for (const auto &slot : m_slots) {
+            if (slot.asset || slot.evicted)
+                ++stats.count;
+            if (slot.asset)
+                ++stats.resident;
+        }
+
+        return stats;
+    }
+
+private:
+    void setResident(Slot &slot, const s_ptr<T> &asset)
+    {
+        if (slot.evicted)
+            ++m_reloads;
+
+        slot.asset = asset;
+        slot.evicted = false;
+        slot.reloading = false;
+        slot.memory = asset ? AssetMemoryTraits<T>::get(*asset) : AssetMemory{};
+        m_memory.cpu_bytes += slot.memory.cpu_bytes;
+        m_memory.gpu_bytes += slot.memory.gpu_bytes;
+        m_memory.released_bytes += slot.memory.released_bytes;
+    }
+
+    void setEvicted(Slot &slot)
+    {
+        if (!slot.asset)
+            return;
+
+        m_memory.cpu_bytes -= slot.memory.cpu_bytes;
+        m_memory.gpu_bytes -= slot.memory.gpu_bytes;
+        m_memory.released_bytes -= slot.memory.released_bytes;
+        slot.memory = {};
+        slot.asset = nullptr;
+        slot.evicted = true;
+        slot.reloading = false;
+    }
+
+private:
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free_indices;
+    std::unordered_map<StringId, uint32_t> m_name_to_index;
+
+    uint64_t m_frame;
+    uint64_t m_budget;
+    AssetMemory m_memory;
+    int32_t m_evictions;
+    int32_t m_reloads;
+};
+
+} // namespace ae
+
+#endif // AE_ASSET_STORAGE_H
@@ -2,21 +2,23 @@
 #define AE_ASSETS_H
 
 #include "../system/memory.h"
+#include "../system/vfs.h"
 #include "asset_loader.h"
+#include "asset_storage.h"
 
-#include <typeindex>
-#include <unordered_map>
+#include <functional>
+#include <vector>
 
 namespace ae {
 
 class Assets
 {
-    using assets_map = std::unordered_map<std::string, s_ptr<void>>;
-
 public:
     Assets() = default;
     ~Assets() = default;
 
+    // Доступ по имени: строка хешируется при каждом вызове, поиск таблицу строк не трогает.
+    // В частых обращениях лучше один раз получить AssetId через getId и дальше работать с ним
     template<typename T>
     s_ptr<T> get(const std::string &asset_name);
 
@@ -29,76 +31,302 @@ public:
     template<typename T>
     bool has(const std::string &asset_name);
 
+    // Доступ по идентификатору: O(1), без хеширования. StringId имени можно посчитать заранее
+    template<typename T>
+    AssetId<T> getId(StringId asset_name) const;
+    template<typename T>
+    AssetId<T> getId(const std::string &asset_name) const;
+
+    // Выгруженный по бюджету ресурс загружается заново в фоне, до завершения
+    // загрузки get возвращает пустой указатель
+    template<typename T>
+    const s_ptr<T> &get(AssetId<T> id);
+
+    // Как get, но выгруженный ресурс загружается синхронно
+    template<typename T>
+    const s_ptr<T> &require(AssetId<T> id);
+    template<typename T>
+    s_ptr<T> require(const std::string &asset_name);
+
+    // Имя должно быть зарегистрировано через StringId::intern. Пустое имя (совпадение
+    // хешей при регистрации) не добавляется, возвращается недействительный AssetId
+    template<typename T>
+    AssetId<T> add(StringId asset_name, const s_ptr<T> &asset);
+
+    template<typename T>
+    void remove(AssetId<T> id);
+
+    template<typename T>
+    bool has(AssetId<T> id) const;
+
+    // Явный учет использования ресурсов. Счетчик не связан со счетчиком s_ptr
+    // и меняется только через addRef/release
+    template<typename T>
+    int32_t addRef(AssetId<T> id);
+    template<typename T>
+    int32_t release(AssetId<T> id);
+    template<typename T>
+    int32_t getRefCount(AssetId<T> id) const;
+
+    // Ресурсы, на которые нет ссылок
+    template<typename T>
+    std::vector<AssetId<T>> getUnused() const;
+    template<typename T>
+    int32_t removeUnused();
+
     void clear();
 
+    // Бюджет памяти класса ресурсов в байтах, 0 - без ограничения. При превышении
+    // в update выгружаются давно не используемые ресурсы без ссылок, которые
+    // можно загрузить заново (загруженные через loadFromFile/loadFromFileAsync)
+    template<typename T>
+    void setBudget(uint64_t budget);
+    template<typename T>
+    void setReload(const s_ptr<T> &asset,
+                   const std::function<s_ptr<T>()> &reload,
+                   const std::function<bool()> &reload_async = {});
+
+    std::vector<AssetResidencyStats> getResidencyStats() const;
+    void logResidencyStats() const;
+
     template<typename T, typename... Args>
     s_ptr<T> loadFromFile(const std::string &asset_name, Args &&...args);
 
     template<typename T, typename... Args>
     s_ptr<T> loadFromMemory(const std::string &asset_name, Args &&...args);
 
+    // Загрузка в фоне, ресурс добавляется после завершения загрузки
+    template<typename T, typename... Args>
+    AssetHandle<T> loadFromFileAsync(const std::string &asset_name, Args &&...args);
+
+    AsyncLoader *getAsyncLoader();
+    void update(const Time &upload_budget);
+
+    // Все загрузчики читают файлы через Vfs: из смонтированных пакетов или с диска
+    Vfs *getVfs();
+
+private:
+    template<typename T, typename... Args>
+    void setFileReload(const s_ptr<T> &asset, const std::string &asset_name, Args &&...args);
+
+    template<typename T>
+    AssetStorage<T> *getStorage() const;
+    template<typename T>
+    AssetStorage<T> &getOrCreateStorage();
+
 private:
-    std::unordered_map<std::type_index, assets_map> m_assets;
+    std::vector<u_ptr<AssetStorageBase>> m_storages;
+    u_ptr<AsyncLoader> m_async_loader;
+    Vfs m_vfs;
+    // Назначение reload ресурсам из незавершенных фоновых загрузок
+    std::vector<std::function<bool()>> m_pending_reloads;
+    uint64_t m_frame = 0;
 };
 
 template<typename T>
 inline s_ptr<T> Assets::get(const std::string &asset_name)
 {
-    auto assets_found = m_assets.find(typeid(T));
-    if (assets_found == m_assets.end())
-        return nullptr;
-
-    auto asset_found = assets_found->second.find(asset_name);
-    if (asset_found == assets_found->second.end())
-        return nullptr;
-
-    return staticPointerCast<T>(asset_found->second);
+    return get(getId<T>(asset_name));
 }
 
 template<typename T>
 inline void Assets::add(const std::string &asset_name, const s_ptr<T> &asset)
 {
-    auto assets_found = m_assets.find(typeid(T));
-    if (assets_found == m_assets.end())
-        m_assets.emplace(typeid(T), assets_map{});
-    m_assets[typeid(T)].emplace(asset_name, asset);
+    add(StringId::intern(asset_name), asset);
 }
 
 template<typename T>
 inline void Assets::remove(const std::string &asset_name)
 {
-    auto assets_found = m_assets.find(typeid(T));
-    if (assets_found == m_assets.end())
-        return;
-
-    auto asset_found = assets_found->second.find(asset_name);
-    if (asset_found != assets_found->second.end())
-        assets_found->second.erase(asset_found);
+    remove(getId<T>(asset_name));
 }
 
 template<typename T>
 inline bool Assets::has(const std::string &asset_name)
 {
-    auto assets_found = m_assets.find(typeid(T));
-    if (assets_found == m_assets.end())
-        return false;
+    return getId<T>(asset_name).isValid();
+}
+
+template<typename T>
+inline AssetId<T> Assets::getId(StringId asset_name) const
+{
+    auto storage = getStorage<T>();
+    return storage ? storage->find(asset_name) : AssetId<T>{};
+}
+
+template<typename T>
+inline AssetId<T> Assets::getId(const std::string &asset_name) const
+{
+    return getId<T>(StringId{asset_name});
+}
+
+template<typename T>
+inline const s_ptr<T> &Assets::get(AssetId<T> id)
+{
+    static const s_ptr<T> empty;
+    auto storage = getStorage<T>();
+    return storage ? storage->get(id) : empty;
+}
+
+template<typename T>
+inline const s_ptr<T> &Assets::require(AssetId<T> id)
+{
+    static const s_ptr<T> empty;
+    auto storage = getStorage<T>();
+    return storage ? storage->require(id) : empty;
+}
+
+template<typename T>
+inline s_ptr<T> Assets::require(const std::string &asset_name)
+{
+    return require(getId<T>(asset_name));
+}
+
+template<typename T>
+inline AssetId<T> Assets::add(StringId asset_name, const s_ptr<T> &asset)
+{
+    return getOrCreateStorage<T>().add(asset_name, asset);
+}
+
+template<typename T>
+inline void Assets::remove(AssetId<T> id)
+{
+    if (auto storage = getStorage<T>())
+        storage->remove(id);
+}
+
+template<typename T>
+inline bool Assets::has(AssetId<T> id) const
+{
+    auto storage = getStorage<T>();
+    return storage && storage->contains(id);
+}
+
+template<typename T>
+inline int32_t Assets::addRef(AssetId<T> id)
+{
+    auto storage = getStorage<T>();
+    return storage ? storage->addRef(id) : 0;
+}
+
+template<typename T>
+inline int32_t Assets::release(AssetId<T> id)
+{
+    auto storage = getStorage<T>();
+    return storage ? storage->release(id) : 0;
+}
+
+template<typename T>
+inline int32_t Assets::getRefCount(AssetId<T> id) const
+{
+    auto storage = getStorage<T>();
+    return storage ? storage->getRefCount(id) : 0;
+}
+
+template<typename T>
+inline std::vector<AssetId<T>> Assets::getUnused() const
+{
+    std::vector<AssetId<T>> unused;
+
+    auto storage = getStorage<T>();
+    if (!storage)
+        return unused;
 
-    auto asset_found = assets_found->second.find(asset_name);
-    if (asset_found == assets_found->second.end())
-        return false;
+    const auto &slots = storage->getSlots();
+    for (uint32_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].asset && slots[i].ref_count == 0)
+            unused.push_back({i, slots[i].generation});
+    }
 
-    return true;
+    return unused;
+}
+
+template<typename T>
+inline int32_t Assets::removeUnused()
+{
+    auto unused = getUnused<T>();
+    for (auto id : unused)
+        remove(id);
+    return unused.size();
 }
 
 inline void Assets::clear()
 {
-    m_assets.clear();
+    for (auto &storage : m_storages) {
+        if (storage)
+            storage->clear();
+    }
+}
+
+template<typename T>
+inline void Assets::setBudget(uint64_t budget)
+{
+    getOrCreateStorage<T>().setBudget(budget);
+}
+
+template<typename T>
+inline void Assets::setReload(const s_ptr<T> &asset,
+                              const std::function<s_ptr<T>()> &reload,
+                              const std::function<bool()> &reload_async)
+{
+    if (auto storage = getStorage<T>())
+        storage->setReload(storage->find(asset), reload, reload_async);
+}
+
+inline std::vector<AssetResidencyStats> Assets::getResidencyStats() const
+{
+    std::vector<AssetResidencyStats> stats;
+    for (const auto &storage : m_storages) {
+        if (storage)
+            stats.push_back(storage->getStats());
+    }
+    return stats;
+}
+
+inline void Assets::logResidencyStats() const
+{
+    for (const auto &stats : getResidencyStats()) {
+        l_info("Assets {}: {}/{} resident, cpu {} KiB, gpu {} KiB, released {} KiB, "
+               "budget {} KiB, evictions {}, reloads {}",
+               stats.name,
+               stats.resident,
+               stats.count,
+               stats.memory.cpu_bytes / 1024,
+               stats.memory.gpu_bytes / 1024,
+               stats.memory.released_bytes / 1024,
+               stats.budget / 1024,
+               stats.evictions,
+               stats.reloads);
+    }
+}
+
+template<typename T>
+inline AssetStorage<T> *Assets::getStorage() const
+{
+    uint32_t type_index = AssetTypeIndex::get<T>();
+    if (type_index >= m_storages.size() || !m_storages[type_index])
+        return nullptr;
+    return static_cast<AssetStorage<T> *>(m_storages[type_index].get());
+}
+
+template<typename T>
+inline AssetStorage<T> &Assets::getOrCreateStorage()
+{
+    uint32_t type_index = AssetTypeIndex::get<T>();
+    if (type_index >= m_storages.size())
+        m_storages.resize(type_index + 1);
+    if (!m_storages[type_index])
+        m_storages[type_index] = createUnique<AssetStorage<T>>();
+    return static_cast<AssetStorage<T> &>(*m_storages[type_index]);
 }
 
 template<typename T, typename... Args>
 inline s_ptr<T> Assets::loadFromFile(const std::string &asset_name, Args &&...args)
 {
-    return AssetLoader<T>::loadFromFile(this, asset_name, std::forward<Args>(args)...);
+    auto asset = AssetLoader<T>::loadFromFile(this, asset_name, args...);
+    if (asset)
+        setFileReload(asset, asset_name, std::forward<Args>(args)...);
+    return asset;
 }
 
 template<typename T, typename... Args>
@@ -107,6 +335,89 @@ inline s_ptr<T> Assets::loadFromMemory(const std::string &asset_name, Args &&...
     return AssetLoader<T>::loadFromMemory(this, asset_name, std::forward<Args>(args)...);
 }
 
+template<typename T, typename... Args>
+inline AssetHandle<T> Assets::loadFromFileAsync(const std::string &asset_name, Args &&...args)
+{
+    auto handle = AssetLoader<T>::loadFromFileAsync(this, asset_name, args...);
+
+    if (handle.isValid()) {
+        std::function<void(const s_ptr<T> &)> set_reload =
+            [this, asset_name, ... args = std::decay_t<Args>(args)](const s_ptr<T> &asset) {
+                setFileReload(asset, asset_name, args...);
+            };
+
+        m_pending_reloads.push_back([handle, set_reload]() {
+            if (!handle.isDone())
+                return false;
+            if (handle.isReady())
+                set_reload(handle.get());
+            return true;
+        });
+    }
+
+    return handle;
+}
+
+template<typename T, typename... Args>
+inline void Assets::setFileReload(const s_ptr<T> &asset,
+                                  const std::string &asset_name,
+                                  Args &&...args)
+{
+    std::function<s_ptr<T>()> reload = [this, asset_name, ... args = std::decay_t<Args>(args)]() {
+        return AssetLoader<T>::loadFromFile(this, asset_name, args...);
+    };
+
+    // Фоновая загрузка сама добавит ресурс в выгруженный слот. При ошибке слот снова
+    // ждет обращения
+    std::function<bool()> reload_async = [this, asset_name, ... args = std::decay_t<Args>(args)]() {
+        auto handle = AssetLoader<T>::loadFromFileAsync(this, asset_name, args...);
+        if (!handle.isValid())
+            return false;
+
+        m_pending_reloads.push_back([this, handle, asset_name]() {
+            if (!handle.isDone())
+                return false;
+            if (!handle.isReady()) {
+                if (auto storage = getStorage<T>())
+                    storage->cancelReload(storage->find(StringId{asset_name}));
+            }
+            return true;
+        });
+
+        return true;
+    };
+
+    setReload(asset, reload, reload_async);
+}
+
+inline AsyncLoader *Assets::getAsyncLoader()
+{
+    // Задачи загрузки выполняются в JobSystem движка
+    if (!m_async_loader)
+        m_async_loader = createUnique<AsyncLoader>();
+    return m_async_loader.get();
+}
+
+inline Vfs *Assets::getVfs()
+{
+    return &m_vfs;
+}
+
+inline void Assets::update(const Time &upload_budget)
+{
+    ++m_frame;
+
+    if (m_async_loader)
+        m_async_loader->update(upload_budget);
+
+    std::erase_if(m_pending_reloads, [](const auto &pending_reload) { return pending_reload(); });
+
+    for (auto &storage : m_storages) {
+        if (storage)
+            storage->evict(m_frame);
+    }
+}
+
 } // namespace ae
 
 #endif // AE_ASSETS_H
@@ -0,0 +1,111 @@
+#include "async_loader.h"
+#include "../system/clock.h"
+#include "../system/log.h"
+
+namespace ae {
+
+float AsyncLoader::Job::getProgress() const
+{
+    if (status.load() != AssetStatus::LOADING)
+        return 1.0f;
+
+    if (!cpu_done.load())
+        return 0.0f;
+
+    // Половина - CPU часть, половина - загрузка в GL
+    int32_t total = steps_total.load();
+    if (total == 0)
+        return 0.5f;
+
+    return 0.5f + 0.5f * static_cast<float>(steps_done.load()) / total;
+}
+
+AsyncLoader::AsyncLoader(JobSystem *job_system)
+    : m_job_system{job_system ? job_system : &JobSystem::getDefault()}
+    , m_stop{false}
+    , m_pending_jobs{0}
+{}
+
+AsyncLoader::~AsyncLoader()
+{
+    m_stop = true;
+    m_job_system->wait(m_work_counter);
+}
+
+int32_t AsyncLoader::getThreadsCount() const
+{
+    return m_job_system->getThreadsCount();
+}
+
+int32_t AsyncLoader::getPendingJobsCount() const
+{
+    return m_pending_jobs.load();
+}
+
+void AsyncLoader::submit(const s_ptr<Job> &job, const WorkFunc &work)
+{
+    if (!job || !work)
+        return;
+
+    ++m_pending_jobs;
+
+    m_job_system->run([this, job, work]() { runWork(job, work); }, &m_work_counter);
+}
+
+void AsyncLoader::update(const Time &budget)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_upload_mutex);
+        while (!m_ready_uploads.empty()) {
+            m_uploads.push_back(std::move(m_ready_uploads.front()));
+            m_ready_uploads.pop_front();
+        }
+    }
+
+    Clock clock;
+
+    while (!m_uploads.empty()) {
+        auto &item = m_uploads.front();
+
+        if (item.next_step < item.uploads.steps.size()) {
+            item.uploads.steps[item.next_step++]();
+            ++item.job->steps_done;
+        } else {
+            bool ok = !item.uploads.finish || item.uploads.finish();
+            item.job->status = ok ? AssetStatus::READY : AssetStatus::FAILED;
+            m_uploads.pop_front();
+            --m_pending_jobs;
+        }
+
+        if (clock.getElapsedTime() >= budget)
+            break;
+    }
+}
+
+void AsyncLoader::runWork(const s_ptr<Job> &job, const WorkFunc &work)
+{
+    UploadItem upload_item{job};
+
+    bool ok = false;
+    if (!m_stop) {
+        try {
+            ok = work(upload_item.uploads);
+        } catch (const std::exception &e) {
+            l_error("Async loader: {}", e.what());
+        }
+    }
+
+    job->steps_total = upload_item.uploads.steps.size();
+    job->cpu_done = true;
+
+    if (!ok) {
+        job->status = AssetStatus::FAILED;
+        --m_pending_jobs;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_upload_mutex);
+    m_ready_uploads.push_back(std::move(upload_item));
+}
+
+} // namespace ae
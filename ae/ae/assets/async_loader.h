@@ -0,0 +1,130 @@
+#ifndef AE_ASYNC_LOADER_H
+#define AE_ASYNC_LOADER_H
+
+#include "../system/job_system.h"
+#include "../system/memory.h"
+#include "../system/time.h"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace ae {
+
+enum class AssetStatus { LOADING, READY, FAILED };
+
+// Фоновая загрузка ресурсов. Чтение файлов, разбор и декодирование выполняются
+// задачами JobSystem, создание GL объектов - в главном потоке в update()
+// с ограничением по времени на кадр
+class AsyncLoader
+{
+public:
+    // Результат CPU части загрузки
+    struct Uploads
+    {
+        std::vector<std::function<void()>> steps; // Шаги загрузки в GL, по одному за раз
+        std::function<bool()> finish;             // Вызывается после всех шагов
+    };
+
+    struct Job
+    {
+        virtual ~Job() = default;
+
+        float getProgress() const;
+
+        std::atomic<AssetStatus> status{AssetStatus::LOADING};
+        std::atomic<bool> cpu_done{false};
+        std::atomic<int32_t> steps_total{0};
+        std::atomic<int32_t> steps_done{0};
+    };
+
+    // Выполняется в рабочем потоке, false = ошибка загрузки
+    using WorkFunc = std::function<bool(Uploads &)>;
+
+    // nullptr - JobSystem::getDefault()
+    explicit AsyncLoader(JobSystem *job_system = nullptr);
+    // Ждет задачи, которые уже выполняются. Не начатые завершаются ошибкой
+    ~AsyncLoader();
+
+    int32_t getThreadsCount() const;
+    int32_t getPendingJobsCount() const;
+
+    void submit(const s_ptr<Job> &job, const WorkFunc &work);
+
+    // Выполняет GL шаги, пока не истечет budget (минимум один шаг)
+    void update(const Time &budget);
+
+private:
+    struct UploadItem
+    {
+        s_ptr<Job> job;
+        Uploads uploads;
+        int32_t next_step = 0;
+    };
+
+    void runWork(const s_ptr<Job> &job, const WorkFunc &work);
+
+private:
+    JobSystem *m_job_system;
+    JobCounter m_work_counter;
+    std::atomic<bool> m_stop;
+
+    std::mutex m_upload_mutex;
+    std::deque<UploadItem> m_ready_uploads; // Заполняется рабочими потоками
+    std::deque<UploadItem> m_uploads;       // Только главный поток
+
+    std::atomic<int32_t> m_pending_jobs;
+};
+
+template<typename T>
+class AssetHandle
+{
+public:
+    struct State : public AsyncLoader::Job
+    {
+        s_ptr<T> asset;
+    };
+
+    AssetHandle() = default;
+    explicit AssetHandle(const s_ptr<State> &state)
+        : m_state{state}
+    {}
+
+    bool isValid() const { return m_state != nullptr; }
+
+    AssetStatus getStatus() const
+    {
+        return m_state ? m_state->status.load() : AssetStatus::FAILED;
+    }
+
+    bool isReady() const { return getStatus() == AssetStatus::READY; }
+    bool isFailed() const { return getStatus() == AssetStatus::FAILED; }
+    bool isDone() const { return getStatus() != AssetStatus::LOADING; }
+
+    float getProgress() const { return m_state ? m_state->getProgress() : 1.0f; }
+
+    // Ресурс доступен только после завершения загрузки
+    s_ptr<T> get() const { return isReady() ? m_state->asset : nullptr; }
+
+    s_ptr<AsyncLoader::Job> getJob() const { return m_state; }
+
+    // Произвольная CPU задача с результатом, без шагов в GL
+    static AssetHandle run(AsyncLoader *loader, const std::function<s_ptr<T>()> &work)
+    {
+        auto state = createShared<State>();
+        loader->submit(state, [state, work](AsyncLoader::Uploads &) {
+            state->asset = work();
+            return state->asset != nullptr;
+        });
+        return AssetHandle{state};
+    }
+
+private:
+    s_ptr<State> m_state;
+};
+
+} // namespace ae
+
+#endif // AE_ASYNC_LOADER_H
@@ -23,7 +23,8 @@ public:
             return nullptr;
 
         auto font = createShared<Font>();
-        if (!font->loadFromFile(path))
+        auto file = assets->getVfs()->open(path);
+        if (!file || !font->loadFromMemory(file->getData().data(), file->getSize()))
             return nullptr;
 
         assets->add(name, font);
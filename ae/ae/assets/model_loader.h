@@ -2,7 +2,10 @@
 #define AE_MODEL_LOADER_H
 
 #include "../graphics/scene/assimp_helper.h"
+#include "../graphics/scene/cooked_model_helper.h"
 #include "../graphics/scene/model.h"
+#include "../system/clock.h"
+#include "../system/log.h"
 #include "asset_loader.h"
 #include "assets.h"
 
@@ -23,16 +26,154 @@ public:
         if (name.empty())
             return nullptr;
 
+        Clock clock;
         auto model = createShared<Model>();
 
-        AssimpHelper assimp_helper{path, assets};
-        if (!assimp_helper.load(model.get()))
-            return nullptr;
+        if (path.extension() == cooked_model::EXTENSION) {
+            CookedModelHelper cooked_model_helper{path, assets};
+            cooked_model_helper.vfs = assets->getVfs();
+            if (!cooked_model_helper.load(model.get()))
+                return nullptr;
+        } else {
+            AssimpHelper assimp_helper{path, assets};
+            assimp_helper.vfs = assets->getVfs();
+            if (!assimp_helper.load(model.get()))
+                return nullptr;
+        }
+
+        l_debug("Model '{}' loaded in {} ms: {}",
+                name,
+                clock.getElapsedTime().asMilliseconds(),
+                path.string());
 
         assets->add(name, model);
 
         return model;
     }
+
+    static AssetHandle<Model> loadFromFileAsync(Assets *assets,
+                                                const std::string &asset_name,
+                                                const std::filesystem::path &path)
+    {
+        if (path.empty())
+            return {};
+
+        std::string name = asset_name.empty() ? path.stem().string() : asset_name;
+        if (name.empty())
+            return {};
+
+        if (path.extension() == cooked_model::EXTENSION)
+            return loadCookedAsync(assets, name, path);
+
+        // Рабочий поток не обращается к Assets, текстуры регистрируются в finish.
+        // Текстуры по умолчанию создают GL объекты, поэтому берутся в основном потоке
+        // Vfs потокобезопасен и используется рабочим потоком напрямую
+        auto assimp_helper = createShared<AssimpHelper>(path, nullptr);
+        assimp_helper->vfs = assets->getVfs();
+        assimp_helper->defer_upload = true;
+        assimp_helper->default_diffuse_texture = Texture::getDefaultDiffuseTexture();
+        assimp_helper->default_specular_texture = Texture::getDefaultSpecularTexture();
+
+        auto state = createShared<AssetHandle<Model>::State>();
+
+        assets->getAsyncLoader()->submit(state, [=](AsyncLoader::Uploads &uploads) {
+            auto model = createShared<Model>();
+            if (!assimp_helper->load(model.get()))
+                return false;
+
+            assimp_helper->importer.FreeScene();
+            assimp_helper->ai_scene = nullptr;
+
+            state->asset = model;
+
+            for (int32_t i = 0; i < assimp_helper->pending_textures.size(); ++i) {
+                uploads.steps.push_back([assimp_helper, i]() {
+                    auto &pending_texture = assimp_helper->pending_textures[i];
+                    pending_texture.texture->create(pending_texture.image);
+                    pending_texture.image.clear();
+                });
+            }
+
+            for (const auto &mesh : assimp_helper->pending_meshes)
+                uploads.steps.push_back([mesh]() { mesh->upload(); });
+
+            uploads.finish = [=]() {
+                for (const auto &pending_texture : assimp_helper->pending_textures) {
+                    if (!pending_texture.name.empty()
+                        && !assets->has<Texture>(pending_texture.name))
+                        assets->add(pending_texture.name, pending_texture.texture);
+                }
+
+                // Прозрачность зависит от формата текстур, известного только после загрузки
+                model->setRootNode(model->getRootNode());
+
+                assets->add(name, model);
+                return true;
+            };
+
+            return true;
+        });
+
+        return AssetHandle<Model>{state};
+    }
+
+private:
+    static AssetHandle<Model> loadCookedAsync(Assets *assets,
+                                              const std::string &name,
+                                              const std::filesystem::path &path)
+    {
+        auto cooked_model_helper = createShared<CookedModelHelper>(path, nullptr);
+        cooked_model_helper->vfs = assets->getVfs();
+        cooked_model_helper->defer_upload = true;
+        cooked_model_helper->default_diffuse_texture = Texture::getDefaultDiffuseTexture();
+        cooked_model_helper->default_specular_texture = Texture::getDefaultSpecularTexture();
+
+        auto state = createShared<AssetHandle<Model>::State>();
+
+        assets->getAsyncLoader()->submit(state, [=](AsyncLoader::Uploads &uploads) {
+            auto model = createShared<Model>();
+            if (!cooked_model_helper->load(model.get()))
+                return false;
+
+            state->asset = model;
+
+            for (int32_t i = 0; i < cooked_model_helper->pending_textures.size(); ++i) {
+                uploads.steps.push_back([cooked_model_helper, i]() {
+                    auto &pending_texture = cooked_model_helper->pending_textures[i];
+                    pending_texture.texture->create(pending_texture.image);
+                    pending_texture.image.clear();
+                });
+            }
+
+            // Буферы передаются в GL прямо из содержимого файла
+            for (int32_t i = 0; i < cooked_model_helper->pending_meshes.size(); ++i) {
+                uploads.steps.push_back([cooked_model_helper, i]() {
+                    const auto &pending_mesh = cooked_model_helper->pending_meshes[i];
+                    pending_mesh.mesh->upload(pending_mesh.vertices, pending_mesh.indices);
+                });
+            }
+
+            uploads.finish = [=]() {
+                for (const auto &pending_texture : cooked_model_helper->pending_textures) {
+                    if (!assets->has<Texture>(pending_texture.name))
+                        assets->add(pending_texture.name, pending_texture.texture);
+                }
+
+                model->setRootNode(model->getRootNode());
+
+                // Данные загружены, содержимое файла больше не нужно
+                cooked_model_helper->pending_meshes.clear();
+                cooked_model_helper->file.reset();
+
+                assets->add(name, model);
+                return true;
+            };
+
+            return true;
+        });
+
+        return AssetHandle<Model>{state};
+    }
 };
 
 } // namespace ae
@@ -19,11 +19,7 @@ public:
         if (asset_name.empty())
             return nullptr;
 
-        auto shader = createShared<Shader>();
-        if (shader->loadFromFile(path, type))
-            assets->add<Shader>(asset_name, shader);
-
-        return shader;
+        return loadFromMemory(assets, asset_name, readFile(assets, path), type);
     }
 
     static s_ptr<Shader> loadFromFile(Assets *assets,
@@ -34,11 +30,10 @@ public:
         if (asset_name.empty())
             return nullptr;
 
-        auto shader = createShared<Shader>();
-        if (shader->loadFromFile(vertex_path, fragment_path))
-            assets->add<Shader>(asset_name, shader);
-
-        return shader;
+        return loadFromMemory(assets,
+                              asset_name,
+                              readFile(assets, vertex_path),
+                              readFile(assets, fragment_path));
     }
 
     static s_ptr<Shader> loadFromFile(Assets *assets,
@@ -50,11 +45,11 @@ public:
         if (asset_name.empty())
             return nullptr;
 
-        auto shader = createShared<Shader>();
-        if (shader->loadFromFile(vertex_path, geometry_path, fragment_path))
-            assets->add<Shader>(asset_name, shader);
-
-        return shader;
+        return loadFromMemory(assets,
+                              asset_name,
+                              readFile(assets, vertex_path),
+                              readFile(assets, geometry_path),
+                              readFile(assets, fragment_path));
     }
 
     static s_ptr<Shader> loadFromMemory(Assets *assets,
@@ -102,6 +97,14 @@ public:
 
         return shader;
     }
+
+private:
+    // Пустая строка, если файл не найден: ошибку сообщит Shader::loadFromMemory
+    static std::string readFile(Assets *assets, const std::filesystem::path &path)
+    {
+        auto file = assets->getVfs()->open(path);
+        return file ? file->getString() : std::string{};
+    }
 };
 
 } // namespace ae
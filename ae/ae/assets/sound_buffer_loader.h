@@ -23,7 +23,8 @@ public:
             return nullptr;
 
         auto sound_buffer = createShared<SoundBuffer>();
-        if (!sound_buffer->loadFromFile(path))
+        auto file = assets->getVfs()->open(path);
+        if (!file || !sound_buffer->loadFromMemory(file->getData().data(), file->getSize()))
             return nullptr;
 
         assets->add(name, sound_buffer);
@@ -23,8 +23,12 @@ public:
         if (name.empty())
             return nullptr;
 
+        auto file = assets->getVfs()->open(path);
+        if (!file)
+            return nullptr;
+
         auto texture = createShared<Texture>();
-        if (!texture->loadFromFile(path, type))
+        if (!texture->loadFromMemory(file->getData().data(), file->getSize(), type))
             return nullptr;
 
         assets->add(name, texture);
@@ -32,6 +36,45 @@ public:
         return texture;
     }
 
+    static AssetHandle<Texture> loadFromFileAsync(Assets *assets,
+                                                  const std::string &asset_name,
+                                                  const std::filesystem::path &path,
+                                                  TextureType type = TextureType::DEFAULT)
+    {
+        if (path.empty())
+            return {};
+
+        std::string name = asset_name.empty() ? path.stem().string() : asset_name;
+        if (name.empty())
+            return {};
+
+        auto state = createShared<AssetHandle<Texture>::State>();
+        auto image = createShared<Image>();
+        auto vfs = assets->getVfs();
+
+        assets->getAsyncLoader()->submit(state, [=](AsyncLoader::Uploads &uploads) {
+            auto file = vfs->open(path);
+            if (!file || !image->loadFromMemory(file->getData().data(), file->getSize()))
+                return false;
+
+            state->asset = createShared<Texture>();
+
+            uploads.steps.push_back([=]() {
+                state->asset->create(*image, type);
+                image->clear();
+            });
+
+            uploads.finish = [=]() {
+                assets->add(name, state->asset);
+                return true;
+            };
+
+            return true;
+        });
+
+        return AssetHandle<Texture>{state};
+    }
+
     static s_ptr<Texture> loadFromMemory(Assets *assets,
                                              const std::string &asset_name,
                                              const uint8_t *data,
@@ -81,14 +81,13 @@ void Music::stop()
 
 bool Music::streamBuffer(int32_t buffer)
 {
-    std::vector<int16_t> pcm;
-    if (!m_audio_stream.read(pcm, BUFFER_SIZE_FRAMES))
+    if (!m_audio_stream.read(m_pcm, BUFFER_SIZE_FRAMES))
         return false;
 
     alBufferData(buffer,
                  audio_utils::audioFormatToAl(m_audio_stream.getAudioFormat()),
-                 pcm.data(),
-                 static_cast<ALsizei>(pcm.size() * sizeof(int16_t)),
+                 m_pcm.data(),
+                 static_cast<ALsizei>(m_pcm.size() * sizeof(int16_t)),
                  m_audio_stream.getSampleRate());
 
     return true;
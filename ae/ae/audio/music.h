@@ -5,6 +5,7 @@
 #include "sound_source.h"
 
 #include <thread>
+#include <vector>
 
 namespace ae {
 
@@ -32,6 +33,8 @@ private:
 
     AudioStream m_audio_stream;
     uint32_t m_buffers[BUFFERS_COUNT];
+    // Переиспользуется между буферами, поток стриминга живет дольше кадра
+    std::vector<int16_t> m_pcm;
 
     std::thread m_thread;
     std::atomic<bool> m_running;
@@ -12,11 +12,13 @@ namespace ae {
 SoundBuffer::SoundBuffer()
     : m_buffer{0}
     , m_audio_format{AudioFormat::UNKNOW}
+    , m_data_size{0}
 {}
 
 SoundBuffer::SoundBuffer(const std::filesystem::path &path)
     : m_buffer{0}
     , m_audio_format{AudioFormat::UNKNOW}
+    , m_data_size{0}
 {
     loadFromFile(path);
 }
@@ -24,6 +26,7 @@ SoundBuffer::SoundBuffer(const std::filesystem::path &path)
 SoundBuffer::SoundBuffer(const uint8_t *data, int32_t size)
     : m_buffer{0}
     , m_audio_format{AudioFormat::UNKNOW}
+    , m_data_size{0}
 {
     loadFromMemory(data, size);
 }
@@ -31,6 +34,9 @@ SoundBuffer::SoundBuffer(const uint8_t *data, int32_t size)
 SoundBuffer::SoundBuffer(const std::vector<int16_t> samples,
                          AudioFormat audio_format,
                          int32_t sample_rate)
+    : m_buffer{0}
+    , m_audio_format{AudioFormat::UNKNOW}
+    , m_data_size{0}
 {
     create(samples, audio_format, sample_rate);
 }
@@ -55,6 +61,11 @@ const Time &SoundBuffer::getDuration() const
     return m_duration;
 }
 
+size_t SoundBuffer::getDataSize() const
+{
+    return m_data_size;
+}
+
 bool SoundBuffer::loadFromFile(const std::filesystem::path &path)
 {
     int32_t channels = 0;
@@ -124,6 +135,7 @@ void SoundBuffer::create(const std::vector<int16_t> samples,
 
     m_audio_format = audio_format;
     m_duration = seconds(static_cast<float>(frame_count) / sample_rate);
+    m_data_size = samples.size() * sizeof(int16_t);
 }
 
 bool SoundBuffer::isValid() const
@@ -136,6 +148,7 @@ void SoundBuffer::destroy()
     if (m_buffer != 0) {
         alDeleteBuffers(1, &m_buffer);
         m_buffer = 0;
+        m_data_size = 0;
     }
 }
 
@@ -21,6 +21,8 @@ public:
     uint32_t getId() const;
     AudioFormat getAudioFormat() const;
     const Time &getDuration() const;
+    // Размер данных в буфере OpenAL в байтах
+    size_t getDataSize() const;
 
     bool loadFromFile(const std::filesystem::path &path);
     bool loadFromMemory(const uint8_t *data, int32_t size);
@@ -36,6 +38,7 @@ private:
     // std::vector<int16_t> m_samples;
     AudioFormat m_audio_format;
     Time m_duration;
+    size_t m_data_size;
 };
 
 } // namespace ae
@@ -81,6 +81,15 @@ struct MeshCollider : public Collider
         //collisions_utils::aabbFromTriangles(transformed_triangles);
     }
 
+    // Из готового дерева в локальных координатах
+    MeshCollider(const TrianglesNode &local_root, const mat4 &transform = mat4{1.0f})
+    {
+        root = geometry_utils::transformTrianglesTree(local_root, transform);
+
+        type = MESH;
+        aabb = root->aabb;
+    }
+
     u_ptr<TrianglesNode> root;
 };
 
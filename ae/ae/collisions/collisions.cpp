@@ -1,15 +1,14 @@
 #include "collisions.h"
 #include "../geometry/geometry_utils.h"
+#include "../system/frame_arena.h"
+#include "../system/job_system.h"
 #include "../system/log.h"
 
 #include <glm/gtx/compatibility.hpp>
 #include <glm/gtx/norm.hpp>
 
-#include <execution>
-
 namespace ae {
 
-std::queue<const TrianglesNode *> Collisions::m_queue;
 std::mutex Collisions::m_result_mutex;
 
 void Collisions::test(const Collider *collider1,
@@ -48,40 +47,41 @@ void Collisions::aabbVsTriangleNode(const AABB &aabb,
                                     const TrianglesNode &root,
                                     CollisionResult &result)
 {
-    m_queue = std::queue<const TrianglesNode *>();
-    m_queue.push(&root);
+    // Очередь своя у каждого вызова: поток, ждущий parallelFor, может выполнить
+    // другую проверку. Обход в ширину по вектору, чтобы память бралась из арены кадра
+    FrameArena::Scope scope;
+    FrameVector<const TrianglesNode *> queue;
+    queue.push_back(&root);
 
-    while (!m_queue.empty()) {
-        const TrianglesNode *node = m_queue.front();
-        m_queue.pop();
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const TrianglesNode *node = queue[head];
 
         if (!node->aabb.intersects(aabb))
             continue;
 
         if (node->isLeaf()) {
-            std::for_each(std::execution::par_unseq,
-                          node->triangles.begin(),
-                          node->triangles.end(),
-                          [&](const Triangle &triangle) {
-                              thread_local CollisionResult temp;
-
-                              // Сброс, т.к. 1 переменная на весь поток.
-                              // Могут быть остаточные данные.
-                              temp.reset();
-                              aabbVsTriangle(aabb, triangle, temp);
-
-                              if (temp.hit) {
-                                  std::scoped_lock lock{m_result_mutex};
-                                  if (temp.depth < result.depth)
-                                      result = temp;
-                              }
-                          });
+            JobSystem::getDefault().parallelFor(
+                node->triangles.size(), PARALLEL_GRAIN_SIZE, [&](int32_t i) {
+                    const Triangle &triangle = node->triangles[i];
+                    thread_local CollisionResult temp;
+
+                    // Сброс, т.к. 1 переменная на весь поток.
+                    // Могут быть остаточные данные.
+                    temp.reset();
+                    aabbVsTriangle(aabb, triangle, temp);
+
+                    if (temp.hit) {
+                        std::scoped_lock lock{m_result_mutex};
+                        if (temp.depth < result.depth)
+                            result = temp;
+                    }
+                });
 
         } else {
             if (node->left)
-                m_queue.push(node->left.get());
+                queue.push_back(node->left.get());
             if (node->right)
-                m_queue.push(node->right.get());
+                queue.push_back(node->right.get());
         }
     }
 }
@@ -195,40 +195,40 @@ void Collisions::sweptAABBVsTriangleNode(const AABB &aabb,
                                          const TrianglesNode &root,
                                          CollisionResult &result)
 {
-    m_queue = std::queue<const TrianglesNode *>();
-    m_queue.push(&root);
+    // Очередь в арене кадра, как в aabbVsTriangleNode
+    FrameArena::Scope scope;
+    FrameVector<const TrianglesNode *> queue;
+    queue.push_back(&root);
 
-    while (!m_queue.empty()) {
-        const TrianglesNode *node = m_queue.front();
-        m_queue.pop();
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const TrianglesNode *node = queue[head];
 
         if (!node->aabb.intersects(swept_aabb))
             continue;
 
         if (node->isLeaf()) {
-            std::for_each(std::execution::par_unseq,
-                          node->triangles.begin(),
-                          node->triangles.end(),
-                          [&](const Triangle &triangle) {
-                              thread_local CollisionResult temp;
-
-                              // Сброс, т.к. 1 переменная на весь поток.
-                              // Могут быть остаточные данные.
-                              temp.reset();
-                              sweptAABBVsTriangle(aabb, velocity, triangle, temp);
-
-                              if (temp.hit) {
-                                  std::scoped_lock lock{m_result_mutex};
-                                  if (temp.toi < result.toi)
-                                      result = temp;
-                              }
-                          });
+            JobSystem::getDefault().parallelFor(
+                node->triangles.size(), PARALLEL_GRAIN_SIZE, [&](int32_t i) {
+                    const Triangle &triangle = node->triangles[i];
+                    thread_local CollisionResult temp;
+
+                    // Сброс, т.к. 1 переменная на весь поток.
+                    // Могут быть остаточные данные.
+                    temp.reset();
+                    sweptAABBVsTriangle(aabb, velocity, triangle, temp);
+
+                    if (temp.hit) {
+                        std::scoped_lock lock{m_result_mutex};
+                        if (temp.toi < result.toi)
+                            result = temp;
+                    }
+                });
 
         } else {
             if (node->left)
-                m_queue.push(node->left.get());
+                queue.push_back(node->left.get());
             if (node->right)
-                m_queue.push(node->right.get());
+                queue.push_back(node->right.get());
         }
     }
 }
@@ -368,40 +368,40 @@ void Collisions::raycast(const Ray &ray, const Collider *collider, RaycastResult
 
 void Collisions::rayVsTriangleNode(const Ray &ray, const TrianglesNode &root, RaycastResult &result)
 {
-    m_queue = std::queue<const TrianglesNode *>();
-    m_queue.push(&root);
+    // Очередь в арене кадра, как в aabbVsTriangleNode
+    FrameArena::Scope scope;
+    FrameVector<const TrianglesNode *> queue;
+    queue.push_back(&root);
 
-    while (!m_queue.empty()) {
-        const TrianglesNode *node = m_queue.front();
-        m_queue.pop();
+    for (size_t head = 0; head < queue.size(); ++head) {
+        const TrianglesNode *node = queue[head];
 
         if (!rayVsAABB(ray, node->aabb))
             continue;
 
         if (node->isLeaf()) {
-            std::for_each(std::execution::par_unseq,
-                          node->triangles.begin(),
-                          node->triangles.end(),
-                          [&](const Triangle &triangle) {
-                              thread_local RaycastResult temp;
-
-                              // Сброс, т.к. 1 переменная на весь поток.
-                              // Могут быть остаточные данные.
-                              temp.reset();
-                              rayVsTriangle(ray, triangle, temp);
-
-                              if (temp.hit) {
-                                  std::scoped_lock lock{m_result_mutex};
-                                  if (temp.t < result.t)
-                                      result = temp;
-                              }
-                          });
+            JobSystem::getDefault().parallelFor(
+                node->triangles.size(), PARALLEL_GRAIN_SIZE, [&](int32_t i) {
+                    const Triangle &triangle = node->triangles[i];
+                    thread_local RaycastResult temp;
+
+                    // Сброс, т.к. 1 переменная на весь поток.
+                    // Могут быть остаточные данные.
+                    temp.reset();
+                    rayVsTriangle(ray, triangle, temp);
+
+                    if (temp.hit) {
+                        std::scoped_lock lock{m_result_mutex};
+                        if (temp.t < result.t)
+                            result = temp;
+                    }
+                });
 
         } else {
             if (node->left)
-                m_queue.push(node->left.get());
+                queue.push_back(node->left.get());
             if (node->right)
-                m_queue.push(node->right.get());
+                queue.push_back(node->right.get());
         }
     }
 }
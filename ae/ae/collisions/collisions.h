@@ -5,12 +5,14 @@
 #include "collision_result.h"
 
 #include <mutex>
-#include <queue>
 
 namespace ae {
 
 struct Collisions
 {
+    // Треугольники листа проверяются параллельно блоками такого размера
+    static constexpr int32_t PARALLEL_GRAIN_SIZE = 64;
+
     // Test collider vs collider
     static void test(const Collider *collider1,
                      const vec3 &collider_1_position,
@@ -54,7 +56,6 @@ struct Collisions
     static bool rayVsAABB(const Ray &ray, const AABB &aabb);
 
 private:
-    static std::queue<const TrianglesNode *> m_queue;
     static std::mutex m_result_mutex;
 };
 
@@ -21,6 +21,36 @@ std::optional<Config> Config::loadFromFile(const std::filesystem::path &path)
         //Game
         config->game_frame_rate = toml_config["game"]["frame_rate"].value_or(
             config->game_frame_rate);
+        config->game_tick_interpolation = toml_config["game"]["tick_interpolation"].value_or(
+            config->game_tick_interpolation);
+        config->game_pipelined_render = toml_config["game"]["pipelined_render"].value_or(
+            config->game_pipelined_render);
+        config->game_frame_rate_limit = toml_config["game"]["frame_rate_limit"].value_or(
+            config->game_frame_rate_limit);
+        config->game_max_catch_up_ticks = toml_config["game"]["max_catch_up_ticks"].value_or(
+            config->game_max_catch_up_ticks);
+
+        // Assets
+        config->asset_upload_budget_ms = toml_config["assets"]["upload_budget_ms"].value_or(
+            config->asset_upload_budget_ms);
+        config->asset_texture_budget_mb = toml_config["assets"]["texture_budget_mb"].value_or(
+            config->asset_texture_budget_mb);
+        config->asset_model_budget_mb = toml_config["assets"]["model_budget_mb"].value_or(
+            config->asset_model_budget_mb);
+        config->asset_sound_budget_mb = toml_config["assets"]["sound_budget_mb"].value_or(
+            config->asset_sound_budget_mb);
+        config->asset_chunk_cache_mb = toml_config["assets"]["chunk_cache_mb"].value_or(
+            config->asset_chunk_cache_mb);
+        if (auto packs = toml_config["assets"]["packs"].as_array()) {
+            for (const auto &pack : *packs) {
+                if (auto pack_path = pack.value<std::string>())
+                    config->asset_packs.push_back(*pack_path);
+            }
+        }
+
+        // Graphics
+        config->shader_cache_dir = toml_config["graphics"]["shader_cache_dir"].value_or(
+            config->shader_cache_dir);
 
         return config;
     } catch (const std::exception &e) {
@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <vector>
 
 using namespace glm;
 
@@ -22,7 +23,30 @@ struct Config
     int32_t msaa = 0;
 
     // Game
+    // Частота тиков симуляции, может быть ниже частоты кадров
     int32_t game_frame_rate = 60;
+    // Интерполяция трансформаций между тиками, иначе при редких тиках движение рывками
+    bool game_tick_interpolation = true;
+    // Ограничение кадров в секунду, 0 - без ограничения
+    int32_t game_frame_rate_limit = 144;
+    // Тик сцены выполняется в JobSystem параллельно с отрисовкой предыдущего
+    bool game_pipelined_render = false;
+    // Сколько тиков можно выполнить за кадр, догоняя отставание
+    int32_t game_max_catch_up_ticks = 5;
+
+    // Assets
+    int32_t asset_upload_budget_ms = 4; // Время на создание GL объектов за кадр
+    // Бюджеты памяти по классам ресурсов, 0 - без ограничения
+    int32_t asset_texture_budget_mb = 0;
+    int32_t asset_model_budget_mb = 0;
+    int32_t asset_sound_budget_mb = 0;
+    // Пакеты .aepack в порядке монтирования, файлы поздних перекрывают ранние
+    std::vector<std::string> asset_packs;
+    int32_t asset_chunk_cache_mb = 32;
+
+    // Graphics
+    // Каталог кэша бинарных образов шейдерных программ, пустая строка - без кэша
+    std::string shader_cache_dir = "cache/shaders";
 };
 
 } // namespace ae
@@ -2,6 +2,8 @@
 #include "animation_manager.h"
 #include "game_state_stack.h"
 #include "input_action_manager.h"
+#include "scene/scene.h"
+#include "system/signal.h"
 #include "task_manager.h"
 #include "window/input.h"
 #include "window/window.h"
@@ -33,13 +35,16 @@ int32_t Engine::exec()
 
     m_running = true;
     m_data.running_clock.restart();
-    Clock loop_clock;
-    Time accumulator;
+
+    auto &frame_pacer = *m_data.frame_pacer;
+    frame_pacer.restart();
 
     while (m_running) {
-        m_data.elapsed_time = loop_clock.getElapsedTime();
-        accumulator += m_data.elapsed_time;
-        loop_clock.restart();
+        m_data.elapsed_time = frame_pacer.beginFrame();
+        FrameArena::beginFrame();
+
+        // Тик сцены, запущенный в прошлом кадре, должен закончиться до ввода и событий
+        m_data.scene->waitTickUpdate();
 
         m_data.fps = m_data.fps * (1.0f - m_data.fps_alpha)
                      + (1.0f / m_data.elapsed_time.asSeconds()) * m_data.fps_alpha;
@@ -48,16 +53,28 @@ int32_t Engine::exec()
         m_data.window->pollEvents();
         m_data.input_action_manager->update();
 
-        while (accumulator >= m_data.tick_time) {
+        // Завершаем фоновые загрузки ресурсов
+        m_data.assets->update(m_data.asset_upload_budget);
+        m_data.job_system->executeMainThreadJobs();
+
+        while (frame_pacer.nextTick()) {
+            // Догоняющий тик начинается после предыдущего тика сцены: менеджеры и сигналы
+            // меняют сцену. С отрисовкой пересекается только последний тик кадра
+            m_data.scene->waitTickUpdate();
+
             m_data.animation_manager->update(m_data.tick_time);
             m_data.task_manager->update(m_data.tick_time);
             m_data.game_state_stack->update(m_data.tick_time);
-            accumulator -= m_data.tick_time;
+
+            // Отложенные сигналы вызываются пачкой раз в тик
+            SignalQueue::dispatch();
         }
 
         m_data.window->clear();
         m_data.game_state_stack->draw(m_data.elapsed_time);
         m_data.window->display();
+
+        frame_pacer.waitForNextFrame();
     }
 
     return 1;
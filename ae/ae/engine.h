@@ -5,6 +5,9 @@
 #include "engine_context.h"
 
 #include "system/clock.h"
+#include "system/frame_arena.h"
+#include "system/frame_pacer.h"
+#include "system/job_system.h"
 
 namespace ae {
 
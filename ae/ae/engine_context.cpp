@@ -3,20 +3,31 @@
 #include "animation_manager.h"
 #include "assets/assets.h"
 #include "audio/audio_device.h"
+#include "audio/sound_buffer.h"
 #include "game_state_stack.h"
+#include "graphics/core/shader_cache.h"
+#include "graphics/core/texture.h"
+#include "graphics/scene/model.h"
 #include "gui/gui.h"
 #include "input_action_manager.h"
 #include "scene/scene.h"
+#include "system/frame_pacer.h"
+#include "system/job_system.h"
 #include "task_manager.h"
 #include "window/input.h"
 #include "window/window.h"
 
+#include <algorithm>
+
 namespace ae {
 
 EngineContext::EngineContext()
 {
+    m_data.job_system = createUnique<JobSystem>();
+    m_data.frame_pacer = createUnique<FramePacer>();
     m_data.assets = createUnique<Assets>();
     m_data.tick_time = seconds(1.0f / 60.0f);
+    m_data.asset_upload_budget = milliseconds(4);
     m_data.fps = 0;
 }
 
@@ -70,6 +81,16 @@ AudioDevice *EngineContext::getAudioDevice() const
     return m_data.audio_device.get();
 }
 
+JobSystem *EngineContext::getJobSystem() const
+{
+    return m_data.job_system.get();
+}
+
+FramePacer *EngineContext::getFramePacer() const
+{
+    return m_data.frame_pacer.get();
+}
+
 int32_t EngineContext::getFps() const
 {
     return m_data.fps;
@@ -85,17 +106,20 @@ Time EngineContext::getElapsedTime() const
     return m_data.elapsed_time;
 }
 
+float EngineContext::getTickAlpha() const
+{
+    return m_data.tick_interpolation ? m_data.frame_pacer->getAlpha() : 1.0f;
+}
+
 void EngineContext::runLater(const std::function<void()> &callback)
 {
     m_data.task_manager->run(createShared<CallbackTask>(callback));
 }
 
-void EngineContext::runLater(const Time &delay, const std::function<void()> &callback)
+TimerWheel::Handle EngineContext::runLater(const Time &delay,
+                                           const std::function<void()> &callback)
 {
-    auto task_chain = createShared<TaskChain>();
-    task_chain->addTask(createShared<DelayTask>(delay));
-    task_chain->addTask(createShared<CallbackTask>(callback));
-    m_data.task_manager->run(task_chain);
+    return m_data.task_manager->runAfter(delay, callback);
 }
 
 void EngineContext::exit() {}
@@ -103,6 +127,25 @@ void EngineContext::exit() {}
 bool EngineContext::init(const Config &config)
 {
     m_data.tick_time = seconds(1.0f / static_cast<float>(config.game_frame_rate));
+    m_data.tick_interpolation = config.game_tick_interpolation;
+    m_data.asset_upload_budget = milliseconds(config.asset_upload_budget_ms);
+
+    m_data.frame_pacer->setTickTime(m_data.tick_time);
+    m_data.frame_pacer->setTargetFrameRate(config.game_frame_rate_limit);
+    m_data.frame_pacer->setMaxCatchUpTicks(config.game_max_catch_up_ticks);
+
+    // Assets
+    // Отрицательные значения в конфиге считаются нулем
+    auto megabytes = [](int32_t value) { return uint64_t(std::max(value, 0)) * 1024 * 1024; };
+    m_data.assets->setBudget<Texture>(megabytes(config.asset_texture_budget_mb));
+    m_data.assets->setBudget<Model>(megabytes(config.asset_model_budget_mb));
+    m_data.assets->setBudget<SoundBuffer>(megabytes(config.asset_sound_budget_mb));
+
+    m_data.assets->getVfs()->setChunkCacheCapacity(megabytes(config.asset_chunk_cache_mb));
+    for (const auto &pack : config.asset_packs) {
+        if (!m_data.assets->getVfs()->mount(pack))
+            l_warn("Failed to mount asset pack: {}", pack);
+    }
 
     // Input
     m_data.input = createUnique<Input>();
@@ -113,11 +156,15 @@ bool EngineContext::init(const Config &config)
                                config.msaa))
         return false;
 
+    // Кэш открывается после создания контекста: ключи зависят от драйвера
+    if (!config.shader_cache_dir.empty())
+        ShaderCache::getDefault().open(config.shader_cache_dir);
+
     // Audio device
     m_data.audio_device = createUnique<AudioDevice>();
 
     // Task manager
-    m_data.task_manager = createUnique<TaskManager>();
+    m_data.task_manager = createUnique<TaskManager>(m_data.tick_time);
 
     // Animation manager
     m_data.animation_manager = createUnique<AnimationManager>();
@@ -125,6 +172,7 @@ bool EngineContext::init(const Config &config)
     // Scene
     m_data.scene = createUnique<Scene>(*this);
     m_data.scene->setRenderTextureSize(ivec2{config.window_width, config.window_height});
+    m_data.scene->setPipelined(config.game_pipelined_render);
     m_data.window->sizeChanged.connect(&Scene::setRenderTextureSize, m_data.scene.get());
 
     // Gui
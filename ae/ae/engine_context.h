@@ -3,6 +3,7 @@
 
 #include "config.h"
 #include "engine_data.h"
+#include "system/timer_wheel.h"
 
 #include <functional>
 
@@ -24,14 +25,19 @@ public:
     AnimationManager *getAnimationManager() const;
     InputActionManager *getInputActionManager() const;
     AudioDevice *getAudioDevice() const;
+    JobSystem *getJobSystem() const;
+    FramePacer *getFramePacer() const;
 
     int32_t getFps() const;
     Time getRunningTime() const;
     Time getElapsedTime() const;
+    // Доля тика, прошедшая после последнего обновления, для интерполяции отрисовки
+    float getTickAlpha() const;
 
     // Создает CallbackTask и запускает
     void runLater(const std::function<void()> &callback);
-    void runLater(const Time &delay, const std::function<void()> &callback);
+    // Таймер в колесе TaskManager, через handle его можно отменить
+    TimerWheel::Handle runLater(const Time &delay, const std::function<void()> &callback);
 
     template<typename T>
     void deleteLater(const s_ptr<T> &value)
@@ -40,9 +46,9 @@ public:
     }
 
     template<typename T>
-    void deleteLater(const Time &delay, const s_ptr<T> &value)
+    TimerWheel::Handle deleteLater(const Time &delay, const s_ptr<T> &value)
     {
-        runLater(delay, [value]() {});
+        return runLater(delay, [value]() {});
     }
 
     virtual void exit();
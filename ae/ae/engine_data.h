@@ -17,9 +17,13 @@ class AnimationManager;
 class InputActionManager;
 class AudioDevice;
 class Input;
+class JobSystem;
+class FramePacer;
 
 struct EngineData
 {
+    // Первым: остальные подсистемы могут ждать задачи при удалении
+    u_ptr<JobSystem> job_system;
     u_ptr<Window> window;
     u_ptr<Input> input;
     u_ptr<Assets> assets;
@@ -30,11 +34,15 @@ struct EngineData
     u_ptr<AnimationManager> animation_manager;
     u_ptr<InputActionManager> input_action_manager;
     u_ptr<AudioDevice> audio_device;
+    u_ptr<FramePacer> frame_pacer;
 
     Time tick_time;      // Интервал одно тика
+    bool tick_interpolation = true; // Отрисовка между состояниями двух тиков
     Clock running_clock; // Время сначала запуска
     Time elapsed_time;   // Время одного кадра
 
+    Time asset_upload_budget; // Время на загрузку ресурсов в GL за кадр
+
     int32_t fps;
     const float fps_alpha = 0.3f; // Для сглаживания fps
 };
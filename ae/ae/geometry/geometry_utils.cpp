@@ -1,4 +1,6 @@
 #include "geometry_utils.h"
+#include "../common/glm_utils.h"
+#include "../system/job_system.h"
 
 #include <algorithm>
 
@@ -24,6 +26,41 @@ AABB aabbFromTriangles(const std::vector<Triangle> &triangles)
     return {min - 0.01f, max + 0.01f};
 }
 
+std::vector<Triangle> trianglesFromAABB(const AABB &aabb)
+{
+    // Вершина i: бит 0 - x, бит 1 - y, бит 2 - z (0 - min, 1 - max)
+    auto corner = [&](int32_t i) {
+        return vec3{i & 1 ? aabb.max.x : aabb.min.x,
+                    i & 2 ? aabb.max.y : aabb.min.y,
+                    i & 4 ? aabb.max.z : aabb.min.z};
+    };
+
+    static const int32_t faces[6][4] = {{0, 2, 6, 4},
+                                        {1, 5, 7, 3},
+                                        {0, 4, 5, 1},
+                                        {2, 3, 7, 6},
+                                        {0, 1, 3, 2},
+                                        {4, 6, 7, 5}};
+
+    std::vector<Triangle> triangles;
+    triangles.reserve(12);
+    for (const auto &face : faces) {
+        Triangle first;
+        first.v0 = corner(face[0]);
+        first.v1 = corner(face[1]);
+        first.v2 = corner(face[2]);
+        triangles.push_back(first);
+
+        Triangle second;
+        second.v0 = corner(face[0]);
+        second.v1 = corner(face[2]);
+        second.v2 = corner(face[3]);
+        triangles.push_back(second);
+    }
+
+    return triangles;
+}
+
 u_ptr<TrianglesNode> buildTrianglesTree(const std::vector<Triangle> &triangles, int depth)
 {
     if (triangles.empty())
@@ -50,12 +87,55 @@ u_ptr<TrianglesNode> buildTrianglesTree(const std::vector<Triangle> &triangles,
     std::vector<Triangle> left_triangles(sorted.begin(), sorted.begin() + mid);
     std::vector<Triangle> right_triangles(sorted.begin() + mid, sorted.end());
 
-    node->left = buildTrianglesTree(left_triangles, depth + 1);
-    node->right = buildTrianglesTree(right_triangles, depth + 1);
+    // Верхние уровни большого дерева строятся параллельно: левая половина уходит задачей
+    // JobSystem, правая строится в этом потоке. Пока поток ждет, он выполняет другие задачи
+    if (sorted.size() >= PARALLEL_TREE_BUILD_THRESHOLD) {
+        auto &job_system = JobSystem::getDefault();
+        JobCounter counter;
+        job_system.run([&]() { node->left = buildTrianglesTree(left_triangles, depth + 1); },
+                       &counter);
+        node->right = buildTrianglesTree(right_triangles, depth + 1);
+        job_system.wait(counter);
+    } else {
+        node->left = buildTrianglesTree(left_triangles, depth + 1);
+        node->right = buildTrianglesTree(right_triangles, depth + 1);
+    }
 
     return node;
 }
 
+u_ptr<TrianglesNode> transformTrianglesTree(const TrianglesNode &node, const mat4 &transform)
+{
+    auto new_node = createUnique<TrianglesNode>();
+
+    if (node.isLeaf()) {
+        new_node->triangles.reserve(node.triangles.size());
+        for (const auto &triangle : node.triangles) {
+            Triangle transformed_triangle;
+            transformed_triangle.v0 = glm_utils::transformVec3(triangle.v0, transform);
+            transformed_triangle.v1 = glm_utils::transformVec3(triangle.v1, transform);
+            transformed_triangle.v2 = glm_utils::transformVec3(triangle.v2, transform);
+            new_node->triangles.push_back(transformed_triangle);
+        }
+        new_node->aabb = aabbFromTriangles(new_node->triangles);
+        return new_node;
+    }
+
+    if (node.left)
+        new_node->left = transformTrianglesTree(*node.left, transform);
+    if (node.right)
+        new_node->right = transformTrianglesTree(*node.right, transform);
+
+    if (new_node->left && new_node->right)
+        new_node->aabb = new_node->left->aabb.merge(new_node->right->aabb);
+    else if (new_node->left)
+        new_node->aabb = new_node->left->aabb;
+    else if (new_node->right)
+        new_node->aabb = new_node->right->aabb;
+
+    return new_node;
+}
+
 int32_t largestAxis(const vec3 &v)
 {
     if (v.x > v.y && v.x > v.z)
@@ -15,8 +15,16 @@ namespace ae::geometry_utils {
 
 AABB aabbFromSphere(const Sphere &sphere);
 AABB aabbFromTriangles(const std::vector<Triangle> &triangles);
+// 12 треугольников граней AABB
+std::vector<Triangle> trianglesFromAABB(const AABB &aabb);
+
+// Узлы с числом треугольников от PARALLEL_TREE_BUILD_THRESHOLD строят потомков параллельно
+constexpr int32_t PARALLEL_TREE_BUILD_THRESHOLD = 8192;
 
 u_ptr<TrianglesNode> buildTrianglesTree(const std::vector<Triangle> &triangles, int depth = 0);
+// Копия дерева с преобразованными треугольниками. Структура дерева сохраняется,
+// пересчитываются только AABB, что дешевле повторного построения
+u_ptr<TrianglesNode> transformTrianglesTree(const TrianglesNode &node, const mat4 &transform);
 
 int32_t largestAxis(const vec3 &v);
 
@@ -10,6 +10,8 @@ namespace ae {
 
 struct TrianglesNode
 {
+    AE_POOL_ALLOCATED
+
     bool isLeaf() const { return triangles.size() > 0; }
 
     AABB aabb;
@@ -2,13 +2,11 @@
 #include "../common/utils.h"
 
 #include <algorithm>
+#include <limits>
 
 namespace ae {
 
-Batch2D::Batch2D()
-{
-    m_vertex_array.create(std::vector<Batch2DVertex2>());
-}
+Batch2D::Batch2D() {}
 
 void Batch2D::begin()
 {
@@ -270,58 +268,122 @@ void Batch2D::drawText(const String &text,
         return;
 
     auto *font_page = font->getFontPage(pixel_height);
+    if (!font_page)
+        return;
 
-    int32_t start = m_vertices.size();
+    drawTextLayout(*font_page->getTextLayout(text, line_spaceing), pos, fill_color, *font_page);
+}
+
+void Batch2D::drawTextLayout(const TextLayout &layout,
+                             const vec2 &pos,
+                             const Color &fill_color,
+                             const FontPage &font_page)
+{
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    drawTextLayout(layout, pos, fill_color, font_page, vec4{-inf, -inf, inf, inf});
+}
 
-    vec2 cursor = pos;
-    cursor.y += font_page->getAscent();
+void Batch2D::drawTextLayout(const TextLayout &layout,
+                             const vec2 &pos,
+                             const Color &fill_color,
+                             const FontPage &font_page,
+                             const vec4 &clip_rect)
+{
+    if (layout.quads.empty())
+        return;
 
-    for (uint32_t cp : text) {
-        if (cp == '\n') {
-            cursor.x = pos.x;
-            cursor.y += font_page->getAscent() - font_page->getDescent() + line_spaceing;
-            continue;
+    int32_t start = m_vertices.size();
+
+    vec2 clip_min{clip_rect.x, clip_rect.y};
+    vec2 clip_max{clip_rect.z, clip_rect.w};
+
+    vec4 color = fill_color.getColor();
+    for (const auto &quad : layout.quads) {
+        vec2 p0 = pos + quad.p0;
+        vec2 p1 = pos + quad.p1;
+        vec2 uv0 = quad.uv0;
+        vec2 uv1 = quad.uv1;
+
+        // Обрезанная часть прямоугольника убирается вместе с соответствующей частью uv
+        if (p0.x < clip_min.x || p0.y < clip_min.y || p1.x > clip_max.x || p1.y > clip_max.y) {
+            vec2 c0 = max(p0, clip_min);
+            vec2 c1 = min(p1, clip_max);
+            if (c0.x >= c1.x || c0.y >= c1.y)
+                continue;
+
+            vec2 uv_scale = (uv1 - uv0) / (p1 - p0);
+            uv0 = quad.uv0 + (c0 - p0) * uv_scale;
+            uv1 = quad.uv0 + (c1 - p0) * uv_scale;
+            p0 = c0;
+            p1 = c1;
         }
 
-        const Glyph *g = font_page->getGlyph(cp);
-        if (!g)
-            continue;
+        vec3 v1 = {p0.x, p0.y, 0.0f};
+        vec3 v2 = {p1.x, p0.y, 0.0f};
+        vec3 v3 = {p1.x, p1.y, 0.0f};
+        vec3 v4 = {p0.x, p1.y, 0.0f};
 
-        vec2 glyphPos = cursor + g->offset;
-        vec3 p = {glyphPos.x, glyphPos.y, 0.0f};
+        m_vertices.push_back({v1, color, uv0});
+        m_vertices.push_back({v2, color, {uv1.x, uv0.y}});
+        m_vertices.push_back({v3, color, uv1});
 
-        vec3 p1 = {p.x, p.y, 0.0f};
-        vec3 p2 = {p.x + g->size.x, p.y, 0.0f};
-        vec3 p3 = {p.x + g->size.x, p.y + g->size.y, 0.0f};
-        vec3 p4 = {p.x, p.y + g->size.y, 0.0f};
+        m_vertices.push_back({v3, color, uv1});
+        m_vertices.push_back({v4, color, {uv0.x, uv1.y}});
+        m_vertices.push_back({v1, color, uv0});
+    }
 
-        m_vertices.push_back({p1, fill_color.getColor(), g->uv0});
-        m_vertices.push_back({p2, fill_color.getColor(), {g->uv1.x, g->uv0.y}});
-        m_vertices.push_back({p3, fill_color.getColor(), g->uv1});
+    if (static_cast<int32_t>(m_vertices.size()) == start)
+        return;
 
-        m_vertices.push_back({p3, fill_color.getColor(), g->uv1});
-        m_vertices.push_back({p4, fill_color.getColor(), {g->uv0.x, g->uv1.y}});
-        m_vertices.push_back({p1, fill_color.getColor(), g->uv0});
+    addDrawCommand(font_page.getTexture(),
+                   start,
+                   m_vertices.size() - start,
+                   font_page.isSdf());
+}
 
-        cursor.x += g->advance;
-    }
+void Batch2D::drawVertices(std::span<const Batch2DVertex2> vertices,
+                           const s_ptr<Texture> &texture,
+                           bool sdf)
+{
+    if (vertices.empty())
+        return;
 
-    addDrawCommand(font_page->getTexture(), start, m_vertices.size() - start);
+    int32_t start = m_vertices.size();
+    m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+    addDrawCommand(texture, start, vertices.size(), sdf);
 }
 
 void Batch2D::end()
 {
+    if (!m_vertex_array.isValid())
+        m_vertex_array.create(std::vector<Batch2DVertex2>());
     m_vertex_array.setData(m_vertices);
 }
 
-void Batch2D::draw() const
+const std::vector<Batch2D::DrawCommand> &Batch2D::getDrawCommands() const
+{
+    return m_draw_commands;
+}
+
+const std::vector<Batch2DVertex2> &Batch2D::getVertices() const
+{
+    return m_vertices;
+}
+
+void Batch2D::draw(Shader *shader) const
 {
-    if (m_draw_commands.empty() || m_vertices.empty())
+    if (m_draw_commands.empty() || m_vertices.empty() || !m_vertex_array.isValid())
         return;
 
     VertexArray::bind(m_vertex_array);
 
+    bool sdf = false;
     for (const auto &draw_command : m_draw_commands) {
+        if (shader && draw_command.sdf != sdf) {
+            sdf = draw_command.sdf;
+            shader->uniformInt("u_sdf", sdf);
+        }
+
         if (draw_command.texture)
             Texture::bind(*draw_command.texture);
         else
@@ -334,12 +396,19 @@ void Batch2D::draw() const
         Texture::unbind();
     }
 
+    if (sdf)
+        shader->uniformInt("u_sdf", false);
+
     VertexArray::unbind();
 }
 
-void Batch2D::addDrawCommand(const s_ptr<Texture> &texture, int32_t offset, int32_t count)
+void Batch2D::addDrawCommand(const s_ptr<Texture> &texture,
+                             int32_t offset,
+                             int32_t count,
+                             bool sdf)
 {
-    if (!m_draw_commands.empty() && m_draw_commands.back().texture == texture) {
+    if (!m_draw_commands.empty() && m_draw_commands.back().texture == texture
+        && m_draw_commands.back().sdf == sdf) {
         m_draw_commands.back().count += count;
         return;
     }
@@ -348,6 +417,7 @@ void Batch2D::addDrawCommand(const s_ptr<Texture> &texture, int32_t offset, int3
     draw_command.texture = texture;
     draw_command.offset = offset;
     draw_command.count = count;
+    draw_command.sdf = sdf;
     m_draw_commands.push_back(draw_command);
 }
 
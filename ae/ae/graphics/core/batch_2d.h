@@ -4,10 +4,12 @@
 #include "../../system/string.h"
 #include "color.h"
 #include "font.h"
+#include "shader.h"
 #include "texture.h"
 #include "vertex_array.h"
 #include "vertex_attrib.h"
 
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -33,6 +35,14 @@ inline const std::vector<VertexAttrib> &VertexAttrib::get<Batch2DVertex2>()
 class Batch2D
 {
 public:
+    struct DrawCommand
+    {
+        s_ptr<Texture> texture;
+        int32_t offset;
+        int32_t count;
+        bool sdf;
+    };
+
     Batch2D();
     ~Batch2D() = default;
 
@@ -69,13 +79,38 @@ public:
                   const s_ptr<Font> &font,
                   float pixel_height = 32.0f,
                   float line_spaceing = 0.0f);
-
+    // Готовая раскладка текста страницы font_page, pos - левый верхний угол
+    void drawTextLayout(const TextLayout &layout,
+                        const vec2 &pos,
+                        const Color &fill_color,
+                        const FontPage &font_page);
+    // Глифы обрезаются по clip_rect (min x, min y, max x, max y)
+    void drawTextLayout(const TextLayout &layout,
+                        const vec2 &pos,
+                        const Color &fill_color,
+                        const FontPage &font_page,
+                        const vec4 &clip_rect);
+
+    // Готовые треугольники, например собранные из других пакетов
+    void drawVertices(std::span<const Batch2DVertex2> vertices,
+                      const s_ptr<Texture> &texture,
+                      bool sdf = false);
+
+    // Загружает вершины в буфер GPU. Пакет, который только копируется в другие,
+    // можно не завершать: буфер создается при первом вызове end
     void end();
 
-    void draw() const;
+    const std::vector<DrawCommand> &getDrawCommands() const;
+    const std::vector<Batch2DVertex2> &getVertices() const;
+
+    // Если передан шейдер, для текста со шрифтом SDF в нем выставляется u_sdf
+    void draw(Shader *shader = nullptr) const;
 
 private:
-    void addDrawCommand(const s_ptr<Texture> &texture, int32_t offset, int32_t count);
+    void addDrawCommand(const s_ptr<Texture> &texture,
+                        int32_t offset,
+                        int32_t count,
+                        bool sdf = false);
 
     void drawQuad(const vec2 &left_bottom,
                   const vec2 &right_top,
@@ -93,13 +128,6 @@ private:
     vec4 fitRectInside(const vec4 &inner, const vec4 &outer);
 
 private:
-    struct DrawCommand
-    {
-        s_ptr<Texture> texture;
-        int32_t offset;
-        int32_t count;
-    };
-
     std::vector<DrawCommand> m_draw_commands;
     std::vector<Batch2DVertex2> m_vertices;
 
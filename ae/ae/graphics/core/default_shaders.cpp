@@ -24,8 +24,9 @@ const std::unordered_map<std::string, std::string> &DefaultShaders::getShaderSou
 
 const std::string DefaultShaders::getShaderSource(const std::string &name)
 {
-    auto sources = getShaderSources();
-    return sources.contains(name) ? sources.at(name) : std::string{};
+    const auto &sources = getShaderSources();
+    auto found = sources.find(name);
+    return found != sources.end() ? found->second : std::string{};
 }
 
 s_ptr<Shader> DefaultShaders::getSkybox()
@@ -1,131 +1,60 @@
 #include "font.h"
+#include "../../system/log.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
-#include <GL/glew.h>
 #include <algorithm>
 #include <cstring>
 #include <fstream>
 
 namespace ae {
 
-FontPage::FontPage()
-    : m_pixel_height{0.0f}
+struct Font::Face
+{
+    ~Face()
+    {
+        if (face)
+            FT_Done_Face(face);
+    }
+
+    // Библиотека одна на все шрифты. Не освобождается до завершения процесса, так как
+    // шрифты в статических объектах могут пережить любой статический владелец
+    static FT_Library getLibrary()
+    {
+        static FT_Library library = []() {
+            FT_Library result = nullptr;
+            if (FT_Init_FreeType(&result))
+                return FT_Library{nullptr};
+            return result;
+        }();
+        return library;
+    }
+
+    FT_Face face = nullptr;
+    int32_t pixel_height = 0;
+};
+
+FontPage::FontPage(const Font *font, float pixel_height)
+    : m_font{font}
+    , m_pixel_height{pixel_height}
     , m_ascent{0.0f}
     , m_descent{0.0f}
     , m_line_gap{0.0f}
-{}
-
-bool FontPage::load(const uint8_t *data, int32_t size, float pixel_height)
+    , m_bmp_blocks(BMP_BLOCKS_COUNT)
 {
-    FT_Library ft;
-    if (FT_Init_FreeType(&ft))
-        return false;
-
-    FT_Face face;
-    if (FT_New_Memory_Face(ft, data, static_cast<FT_Long>(size), 0, &face))
-        return false;
-
-    FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(pixel_height));
-
-    const int32_t atlas_width = 2048;
-    const int32_t atlas_height = 2048;
-
-    std::vector<uint8_t> atlas(atlas_width * atlas_height, 0);
-
-    int32_t pen_x = 1, pen_y = 1; // Текущая позиция в атласе
-    int32_t row_height = 0;
-
-    auto insertGlyph = [&](uint32_t codepoint) {
-        if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER))
-            return;
-
-        FT_GlyphSlot g = face->glyph;
-
-        if (pen_x + g->bitmap.width + 1 >= atlas_width) {
-            pen_x = 1;
-            pen_y += row_height + 1;
-            row_height = 0;
-        }
-
-        if (pen_y + g->bitmap.rows >= atlas_height)
-            return;
-
-        // Копируем bitmap в атлас
-        for (int32_t y = 0; y < g->bitmap.rows; ++y) {
-            for (int32_t x = 0; x < g->bitmap.width; ++x) {
-                int32_t dst_x = pen_x + x;
-                int32_t dst_y = pen_y + y;
-                atlas[dst_y * atlas_width + dst_x] = g->bitmap.buffer[y * g->bitmap.pitch + x];
-            }
-        }
-
-        Glyph glyph;
-        glyph.size = vec2{g->bitmap.width, g->bitmap.rows};
-        glyph.offset = vec2{g->bitmap_left, -g->bitmap_top};
-        glyph.advance = g->advance.x / 64.0f; // 26.6 fixed point to float
-        glyph.uv0 = vec2{static_cast<float>(pen_x) / atlas_width,
-                         static_cast<float>(pen_y) / atlas_height};
-        glyph.uv1 = vec2{static_cast<float>(pen_x + g->bitmap.width) / atlas_width,
-                         static_cast<float>(pen_y + g->bitmap.rows) / atlas_height};
-
-        m_glyphs[codepoint] = glyph;
-
-        pen_x += g->bitmap.width + 1;
-        row_height = std::max(static_cast<uint32_t>(row_height), g->bitmap.rows);
-    };
-
-    // ASCII + Кириллица + Ё/ё
-    for (uint32_t c = 32; c <= 126; ++c)
-        insertGlyph(c);
-    for (uint32_t c = 0x410; c <= 0x44F; ++c)
-        insertGlyph(c);
-    insertGlyph(0x401); // Ё
-    insertGlyph(0x451); // ё
-
-    // Создаём текстуру
-    uint32_t texture_id;
-    glGenTextures(1, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexImage2D(GL_TEXTURE_2D,
-                 0,
-                 GL_RED,
-                 atlas_width,
-                 atlas_height,
-                 0,
-                 GL_RED,
-                 GL_UNSIGNED_BYTE,
-                 atlas.data());
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
-
-    m_texture = createShared<Texture>(texture_id,
-                                      ivec2{atlas_width, atlas_height},
-                                      TextureFormat::RED);
-
-    m_pixel_height = pixel_height;
-    m_ascent = face->size->metrics.ascender / 64.0f;
-    m_descent = face->size->metrics.descender / 64.0f;
-    m_line_gap = (face->size->metrics.height - face->size->metrics.ascender
-                  + abs(face->size->metrics.descender))
-                 / 64.0f;
-
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+    if (!m_font->setFaceSize(pixel_height))
+        return;
 
-    return true;
+    const auto &metrics = m_font->m_face->face->size->metrics;
+    m_ascent = metrics.ascender / 64.0f;
+    m_descent = metrics.descender / 64.0f;
+    m_line_gap = (metrics.height - metrics.ascender + abs(metrics.descender)) / 64.0f;
 }
 
 bool FontPage::isValid() const
 {
-    return m_texture && m_texture->isValid();
+    return m_font->m_face && m_font->m_atlas.isValid();
 }
 
 float FontPage::getPixelHeight() const
@@ -148,49 +77,99 @@ float FontPage::getLineGap() const
     return m_line_gap;
 }
 
+bool FontPage::isSdf() const
+{
+    return m_font->isSdf();
+}
+
 const s_ptr<Texture> &FontPage::getTexture() const
 {
-    return m_texture;
+    return m_font->m_atlas.getTexture();
 }
 
 const Glyph *FontPage::getGlyph(uint32_t codepoint) const
 {
-    auto it = m_glyphs.find(codepoint);
-    return (it != m_glyphs.end()) ? &it->second : nullptr;
+    int32_t index = GLYPH_UNKNOWN;
+    if (codepoint < 0x10000) {
+        index = getBmpSlot(codepoint);
+    } else {
+        auto found = m_other_glyphs.find(codepoint);
+        if (found != m_other_glyphs.end())
+            index = found->second;
+    }
+
+    if (index >= 0)
+        return &m_glyphs[index];
+    if (index == GLYPH_MISSING)
+        return nullptr;
+
+    return addGlyph(codepoint);
+}
+
+s_ptr<const TextLayout> FontPage::getTextLayout(const String &string, float line_spaceing) const
+{
+    return m_layout_cache.get(*this, string, line_spaceing);
 }
 
 vec2 FontPage::getTextSize(const String &string, float line_spaceing) const
 {
-    float max_line_width = 0.0f;
-    float current_line_width = 0.0f;
-    int32_t line_count = 1;
-
-    for (uint32_t codepoint : string) {
-        if (codepoint == '\n') {
-            max_line_width = std::max(max_line_width, current_line_width);
-            current_line_width = 0.0f;
-            line_count++;
-            continue;
-        }
-
-        const Glyph *glyph = getGlyph(codepoint);
-        if (glyph)
-            current_line_width += glyph->advance;
+    return getTextLayout(string, line_spaceing)->size;
+}
+
+const TextLayoutCache &FontPage::getTextLayoutCache() const
+{
+    return m_layout_cache;
+}
+
+int32_t &FontPage::getBmpSlot(uint32_t codepoint) const
+{
+    auto &block = m_bmp_blocks[codepoint / BMP_BLOCK_SIZE];
+    if (block.empty())
+        block.assign(BMP_BLOCK_SIZE, GLYPH_UNKNOWN);
+    return block[codepoint % BMP_BLOCK_SIZE];
+}
+
+const Glyph *FontPage::addGlyph(uint32_t codepoint) const
+{
+    Glyph glyph;
+    bool rasterized = m_font->rasterizeGlyph(*this, codepoint, glyph);
+
+    int32_t index = GLYPH_MISSING;
+    if (rasterized) {
+        index = m_glyphs.size();
+        m_glyphs.push_back(glyph);
+    } else {
+        ++m_font->m_missing_glyphs;
     }
 
-    max_line_width = std::max(max_line_width, current_line_width);
-    float line_height = m_ascent - m_descent + line_spaceing;
-    float total_height = line_count * line_height;
+    if (codepoint < 0x10000)
+        getBmpSlot(codepoint) = index;
+    else
+        m_other_glyphs[codepoint] = index;
 
-    return vec2{max_line_width, total_height};
+    return rasterized ? &m_glyphs.back() : nullptr;
 }
 
-Font::Font() {}
+Font::Font()
+    : m_sdf{false}
+    , m_sdf_pixel_height{DEFAULT_SDF_PIXEL_HEIGHT}
+    , m_atlas_size{DEFAULT_ATLAS_SIZE}
+    , m_rasterized_glyphs{0}
+    , m_missing_glyphs{0}
+    , m_generation{0}
+{}
+
+Font::~Font()
+{
+    // Страницы и атлас освобождаются раньше face, которым они пользуются
+    reset();
+}
 
 bool Font::loadFromFile(const std::filesystem::path &path)
 {
+    reset();
+    m_face.reset();
     m_font_data.clear();
-    m_pages.clear();
 
     std::ifstream file(path, std::ios::binary);
     if (!file)
@@ -205,14 +184,46 @@ bool Font::loadFromMemory(const uint8_t *data, int32_t size)
     if (!data || size == 0)
         return false;
 
+    reset();
+    m_face.reset();
     m_font_data.clear();
-    m_pages.clear();
 
     m_font_data.resize(size);
     std::memcpy(m_font_data.data(), data, size);
     return true;
 }
 
+void Font::setSdf(bool sdf, float sdf_pixel_height)
+{
+#if FREETYPE_MAJOR == 2 && FREETYPE_MINOR < 11
+    if (sdf) {
+        l_warn("SDF glyphs require FreeType 2.11 or newer");
+        sdf = false;
+    }
+#endif
+
+    if (m_sdf == sdf && m_sdf_pixel_height == sdf_pixel_height)
+        return;
+
+    reset();
+    m_sdf = sdf;
+    m_sdf_pixel_height = sdf_pixel_height;
+}
+
+bool Font::isSdf() const
+{
+    return m_sdf;
+}
+
+void Font::setAtlasSize(int32_t atlas_size)
+{
+    if (m_atlas_size == atlas_size)
+        return;
+
+    reset();
+    m_atlas_size = atlas_size;
+}
+
 const FontPage *Font::getFontPage(float pixel_height) const
 {
     if (m_font_data.empty())
@@ -222,11 +233,126 @@ const FontPage *Font::getFontPage(float pixel_height) const
     if (found != m_pages.end())
         return found->second.get();
 
-    auto page = createUnique<FontPage>();
-    if (!page->load(m_font_data.data(), m_font_data.size(), pixel_height))
+    if (!initFace())
+        return nullptr;
+
+    // Атлас создается вместе с первой страницей и затем общий для всех размеров
+    if (!m_atlas.isValid() && !m_atlas.create(ivec2{m_atlas_size}))
+        return nullptr;
+
+    auto page = createUnique<FontPage>(this, pixel_height);
+    if (!page->isValid())
         return nullptr;
     auto [it, inserted] = m_pages.emplace(pixel_height, std::move(page));
     return it->second.get();
 }
 
+uint32_t Font::getGeneration() const
+{
+    return m_generation;
+}
+
+Font::Stats Font::getStats() const
+{
+    Stats stats;
+    stats.pages = m_pages.size();
+    stats.rasterized_glyphs = m_rasterized_glyphs;
+    stats.missing_glyphs = m_missing_glyphs;
+    stats.atlas_size = m_atlas.getSize();
+    stats.atlas_occupancy = m_atlas.getOccupancy();
+    return stats;
+}
+
+void Font::reset()
+{
+    m_pages.clear();
+    m_atlas = GlyphAtlas{};
+    m_rasterized_glyphs = 0;
+    m_missing_glyphs = 0;
+    ++m_generation;
+}
+
+bool Font::initFace() const
+{
+    if (m_face)
+        return true;
+
+    FT_Library library = Face::getLibrary();
+    if (!library)
+        return false;
+
+    auto face = createUnique<Face>();
+    if (FT_New_Memory_Face(library,
+                           m_font_data.data(),
+                           static_cast<FT_Long>(m_font_data.size()),
+                           0,
+                           &face->face)) {
+        l_error("Failed to load font face");
+        face->face = nullptr;
+        return false;
+    }
+
+    m_face = std::move(face);
+    return true;
+}
+
+bool Font::setFaceSize(float pixel_height) const
+{
+    if (!m_face)
+        return false;
+
+    auto size = static_cast<int32_t>(pixel_height);
+    if (m_face->pixel_height == size)
+        return true;
+
+    if (FT_Set_Pixel_Sizes(m_face->face, 0, static_cast<FT_UInt>(size)))
+        return false;
+
+    m_face->pixel_height = size;
+    return true;
+}
+
+bool Font::rasterizeGlyph(const FontPage &page, uint32_t codepoint, Glyph &glyph) const
+{
+    float raster_height = m_sdf ? m_sdf_pixel_height : page.getPixelHeight();
+    if (!setFaceSize(raster_height))
+        return false;
+
+    FT_Face face = m_face->face;
+    if (FT_Load_Char(face, codepoint, m_sdf ? FT_LOAD_DEFAULT : FT_LOAD_RENDER))
+        return false;
+
+#if FREETYPE_MAJOR > 2 || FREETYPE_MINOR >= 11
+    if (m_sdf && FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF))
+        return false;
+#endif
+
+    FT_GlyphSlot g = face->glyph;
+    ivec2 size{g->bitmap.width, g->bitmap.rows};
+    ivec2 position{0};
+
+    // У пробелов нет изображения, место в атласе не нужно
+    if (size.x > 0 && size.y > 0
+        && !m_atlas.insert(size, g->bitmap.buffer, g->bitmap.pitch, position)) {
+        l_warn("Glyph atlas is full: {} glyphs, {:.0f}% occupied",
+               m_atlas.getGlyphCount(),
+               m_atlas.getOccupancy() * 100.0f);
+        return false;
+    }
+
+    // Глифы SDF растеризованы в одном размере и масштабируются под размер страницы
+    float scale = page.getPixelHeight() / raster_height;
+    vec2 atlas_size = m_atlas.getSize();
+
+    glyph.size = vec2{size} * scale;
+    glyph.offset = vec2{g->bitmap_left, -g->bitmap_top} * scale;
+    glyph.advance = g->advance.x / 64.0f * scale; // 26.6 fixed point to float
+    glyph.uv0 = vec2{position} / atlas_size;
+    glyph.uv1 = vec2{position + size} / atlas_size;
+
+    ++m_rasterized_glyphs;
+
+    return true;
+}
+
 } // namespace ae
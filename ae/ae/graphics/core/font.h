@@ -4,58 +4,132 @@
 #include "../../system/memory.h"
 #include "../../system/string.h"
 #include "glyph.h"
+#include "glyph_atlas.h"
+#include "text_layout.h"
 #include "texture.h"
 
+#include <deque>
 #include <filesystem>
 #include <unordered_map>
 #include <vector>
 
 namespace ae {
 
+class Font;
+
+// Метрики и глифы шрифта одного размера. Глифы растеризуются при первом обращении
+// и хранятся в общем для всех размеров атласе шрифта
 class FontPage
 {
 public:
-    FontPage();
+    FontPage(const Font *font, float pixel_height);
     ~FontPage() = default;
 
-    bool load(const uint8_t *data, int32_t size, float pixel_height);
-
     bool isValid() const;
 
     float getPixelHeight() const;
     float getAscent() const;
     float getDescent() const;
     float getLineGap() const;
+    bool isSdf() const;
 
     const s_ptr<Texture> &getTexture() const;
     const Glyph *getGlyph(uint32_t codepoint) const;
 
+    // Раскладка из кэша страницы
+    s_ptr<const TextLayout> getTextLayout(const String &string, float line_spaceing = 0.0f) const;
     vec2 getTextSize(const String &string, float line_spaceing = 0.0f) const;
 
+    const TextLayoutCache &getTextLayoutCache() const;
+
 private:
+    friend class Font;
+
+    // Глифы BMP ищутся по таблице из блоков по 256 символов, блоки создаются
+    // при первом обращении. Значения - индексы в m_glyphs или GLYPH_* ниже
+    static constexpr int32_t BMP_BLOCK_SIZE = 256;
+    static constexpr int32_t BMP_BLOCKS_COUNT = 0x10000 / BMP_BLOCK_SIZE;
+    static constexpr int32_t GLYPH_UNKNOWN = -1;
+    static constexpr int32_t GLYPH_MISSING = -2;
+
+    int32_t &getBmpSlot(uint32_t codepoint) const;
+    const Glyph *addGlyph(uint32_t codepoint) const;
+
+    const Font *m_font;
     float m_pixel_height;
     float m_ascent;
     float m_descent;
     float m_line_gap;
 
-    s_ptr<Texture> m_texture;
-    std::unordered_map<uint32_t, Glyph> m_glyphs;
+    // deque не перемещает элементы при добавлении, указатели на глифы остаются верными
+    mutable std::deque<Glyph> m_glyphs;
+    mutable std::vector<std::vector<int32_t>> m_bmp_blocks;
+    // Символы вне BMP
+    mutable std::unordered_map<uint32_t, int32_t> m_other_glyphs;
+
+    mutable TextLayoutCache m_layout_cache;
 };
 
 class Font
 {
 public:
+    struct Stats
+    {
+        int32_t pages = 0;
+        int32_t rasterized_glyphs = 0;
+        int32_t missing_glyphs = 0;
+        ivec2 atlas_size{0};
+        float atlas_occupancy = 0.0f;
+    };
+
+    static constexpr int32_t DEFAULT_ATLAS_SIZE = 2048;
+    static constexpr float DEFAULT_SDF_PIXEL_HEIGHT = 48.0f;
+
     Font();
-    ~Font() = default;
+    Font(const Font &) = delete;
+    Font &operator=(const Font &) = delete;
+    ~Font();
 
     bool loadFromFile(const std::filesystem::path &path);
     bool loadFromMemory(const uint8_t *data, int32_t size);
 
+    // Глифы в виде поля расстояний, растеризованные один раз в sdf_pixel_height
+    // и масштабируемые под любой размер. Сбрасывает созданные страницы и атлас
+    void setSdf(bool sdf, float sdf_pixel_height = DEFAULT_SDF_PIXEL_HEIGHT);
+    bool isSdf() const;
+
+    // Размер атласа, общего для всех страниц. Сбрасывает созданные страницы и атлас
+    void setAtlasSize(int32_t atlas_size);
+
     const FontPage *getFontPage(float pixel_height) const;
+    // Меняется, когда страницы и атлас пересоздаются: указатели на страницы
+    // и сохраненные раскладки текста становятся недействительными
+    uint32_t getGeneration() const;
+
+    Stats getStats() const;
+
+private:
+    friend class FontPage;
+
+    struct Face;
+
+    void reset();
+    bool initFace() const;
+    bool setFaceSize(float pixel_height) const;
+    bool rasterizeGlyph(const FontPage &page, uint32_t codepoint, Glyph &glyph) const;
 
 private:
     std::vector<uint8_t> m_font_data;
+    bool m_sdf;
+    float m_sdf_pixel_height;
+    int32_t m_atlas_size;
+
+    mutable u_ptr<Face> m_face;
+    mutable GlyphAtlas m_atlas;
     mutable std::unordered_map<float, u_ptr<FontPage>> m_pages;
+    mutable int32_t m_rasterized_glyphs;
+    mutable int32_t m_missing_glyphs;
+    uint32_t m_generation;
 };
 
 } // namespace ae
@@ -0,0 +1,211 @@
+#include "glyph_atlas.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace ae {
+
+SkylinePacker::SkylinePacker()
+    : m_size{0}
+    , m_used_area{0}
+{}
+
+void SkylinePacker::reset(const ivec2 &size)
+{
+    m_size = size;
+    m_used_area = 0;
+    m_skyline.clear();
+    m_skyline.push_back({0, 0, size.x});
+}
+
+bool SkylinePacker::pack(const ivec2 &size, ivec2 &position)
+{
+    if (size.x <= 0 || size.y <= 0)
+        return false;
+
+    int32_t best_index = -1;
+    int32_t best_bottom = std::numeric_limits<int32_t>::max();
+    int32_t best_width = std::numeric_limits<int32_t>::max();
+
+    for (int32_t i = 0; i < m_skyline.size(); ++i) {
+        int32_t y = fit(i, size);
+        if (y < 0)
+            continue;
+
+        // Ниже всего, при равенстве - на самом узком отрезке
+        int32_t bottom = y + size.y;
+        if (bottom < best_bottom || (bottom == best_bottom && m_skyline[i].width < best_width)) {
+            best_index = i;
+            best_bottom = bottom;
+            best_width = m_skyline[i].width;
+            position = ivec2{m_skyline[i].x, y};
+        }
+    }
+
+    if (best_index < 0)
+        return false;
+
+    m_skyline.insert(m_skyline.begin() + best_index, {position.x, best_bottom, size.x});
+
+    // Отрезки под новым прямоугольником укорачиваются или удаляются
+    for (int32_t i = best_index + 1; i < m_skyline.size();) {
+        const auto &previous = m_skyline[i - 1];
+        int32_t previous_end = previous.x + previous.width;
+        if (m_skyline[i].x >= previous_end)
+            break;
+
+        int32_t shrink = previous_end - m_skyline[i].x;
+        m_skyline[i].x += shrink;
+        m_skyline[i].width -= shrink;
+
+        if (m_skyline[i].width > 0)
+            break;
+        m_skyline.erase(m_skyline.begin() + i);
+    }
+
+    // Соседние отрезки одной высоты объединяются
+    for (int32_t i = 1; i < m_skyline.size();) {
+        if (m_skyline[i - 1].y == m_skyline[i].y) {
+            m_skyline[i - 1].width += m_skyline[i].width;
+            m_skyline.erase(m_skyline.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+
+    m_used_area += int64_t(size.x) * size.y;
+
+    return true;
+}
+
+const ivec2 &SkylinePacker::getSize() const
+{
+    return m_size;
+}
+
+int64_t SkylinePacker::getUsedArea() const
+{
+    return m_used_area;
+}
+
+int32_t SkylinePacker::fit(int32_t index, const ivec2 &size) const
+{
+    if (m_skyline[index].x + size.x > m_size.x)
+        return -1;
+
+    int32_t y = 0;
+    int32_t remaining = size.x;
+    for (int32_t i = index; remaining > 0; ++i) {
+        y = std::max(y, m_skyline[i].y);
+        if (y + size.y > m_size.y)
+            return -1;
+        remaining -= m_skyline[i].width;
+    }
+
+    return y;
+}
+
+GlyphAtlas::GlyphAtlas()
+    : m_glyph_count{0}
+{}
+
+bool GlyphAtlas::create(const ivec2 &size)
+{
+    if (size.x <= 0 || size.y <= 0)
+        return false;
+
+    // Пустой атлас заполняется нулями, чтобы отступы между глифами были прозрачными
+    std::vector<uint8_t> pixels(size_t(size.x) * size.y, 0);
+
+    uint32_t texture_id;
+    glGenTextures(1, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_RED,
+                 size.x,
+                 size.y,
+                 0,
+                 GL_RED,
+                 GL_UNSIGNED_BYTE,
+                 pixels.data());
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_ONE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_ONE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_ONE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_RED);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_texture = createShared<Texture>(texture_id, size, TextureFormat::RED);
+    m_packer.reset(size);
+    m_glyph_count = 0;
+
+    return true;
+}
+
+bool GlyphAtlas::isValid() const
+{
+    return m_texture && m_texture->isValid();
+}
+
+bool GlyphAtlas::insert(const ivec2 &size, const uint8_t *bitmap, int32_t pitch, ivec2 &position)
+{
+    if (!isValid())
+        return false;
+
+    ivec2 padded_position;
+    if (!m_packer.pack(size + 2 * PADDING, padded_position))
+        return false;
+
+    position = padded_position + PADDING;
+
+    glBindTexture(GL_TEXTURE_2D, m_texture->getId());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch);
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    0,
+                    position.x,
+                    position.y,
+                    size.x,
+                    size.y,
+                    GL_RED,
+                    GL_UNSIGNED_BYTE,
+                    bitmap);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    ++m_glyph_count;
+
+    return true;
+}
+
+const s_ptr<Texture> &GlyphAtlas::getTexture() const
+{
+    return m_texture;
+}
+
+const ivec2 &GlyphAtlas::getSize() const
+{
+    return m_packer.getSize();
+}
+
+int32_t GlyphAtlas::getGlyphCount() const
+{
+    return m_glyph_count;
+}
+
+float GlyphAtlas::getOccupancy() const
+{
+    const auto &size = m_packer.getSize();
+    if (size.x <= 0 || size.y <= 0)
+        return 0.0f;
+
+    return static_cast<float>(m_packer.getUsedArea()) / (float(size.x) * size.y);
+}
+
+} // namespace ae
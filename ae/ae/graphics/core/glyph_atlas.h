@@ -0,0 +1,82 @@
+#ifndef AE_GLYPH_ATLAS_H
+#define AE_GLYPH_ATLAS_H
+
+#include "../../system/memory.h"
+#include "texture.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+using namespace glm;
+
+namespace ae {
+
+// Упаковка прямоугольников по линии горизонта: для каждого отрезка по x хранится
+// высота занятой области, прямоугольник ставится туда, где его верх окажется ниже всего.
+// Не использует GL
+class SkylinePacker
+{
+public:
+    SkylinePacker();
+    ~SkylinePacker() = default;
+
+    void reset(const ivec2 &size);
+
+    // Левый верхний угол места под прямоугольник или false, если места нет
+    bool pack(const ivec2 &size, ivec2 &position);
+
+    const ivec2 &getSize() const;
+    int64_t getUsedArea() const;
+
+private:
+    struct Segment
+    {
+        int32_t x;
+        int32_t y;
+        int32_t width;
+    };
+
+    // Верх прямоугольника, поставленного на отрезок index, или -1, если не помещается
+    int32_t fit(int32_t index, const ivec2 &size) const;
+
+private:
+    ivec2 m_size;
+    int64_t m_used_area;
+    std::vector<Segment> m_skyline;
+};
+
+// Одноканальный атлас глифов. Глифы добавляются по одному и сразу загружаются
+// в текстуру через glTexSubImage2D. Координаты уже добавленных глифов не меняются,
+// поэтому закэшированные вершины текста остаются верными
+class GlyphAtlas
+{
+public:
+    GlyphAtlas();
+    ~GlyphAtlas() = default;
+
+    bool create(const ivec2 &size);
+    bool isValid() const;
+
+    // Копирует bitmap (строки через pitch байт) в свободное место атласа.
+    // Возвращает false, если атлас заполнен
+    bool insert(const ivec2 &size, const uint8_t *bitmap, int32_t pitch, ivec2 &position);
+
+    const s_ptr<Texture> &getTexture() const;
+    const ivec2 &getSize() const;
+    int32_t getGlyphCount() const;
+    // Доля площади атласа, занятой глифами вместе с отступами
+    float getOccupancy() const;
+
+private:
+    // Пустая полоса вокруг глифа, чтобы линейная фильтрация не захватывала соседей
+    static constexpr int32_t PADDING = 1;
+
+    s_ptr<Texture> m_texture;
+    SkylinePacker m_packer;
+    int32_t m_glyph_count;
+};
+
+} // namespace ae
+
+#endif // AE_GLYPH_ATLAS_H
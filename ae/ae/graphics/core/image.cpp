@@ -0,0 +1,93 @@
+#include "image.h"
+
+#define STB_IMAGE_STATIC
+#define STB_IMAGE_IMPLEMENTATION
+#include "../../../3rd/stb/stb_image.h"
+
+namespace ae {
+
+Image::Image()
+    : m_size{0}
+    , m_format{TextureFormat::RGB}
+{}
+
+bool Image::loadFromFile(const std::filesystem::path &path)
+{
+    clear();
+
+    if (path.empty())
+        return false;
+
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t nr_components = 0;
+
+    uint8_t *image_data = stbi_load(path.c_str(), &width, &height, &nr_components, 0);
+
+    return setPixels(image_data, width, height, nr_components);
+}
+
+bool Image::loadFromMemory(const uint8_t *data, int32_t size)
+{
+    clear();
+
+    if (data == nullptr || size <= 0)
+        return false;
+
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t nr_components = 0;
+
+    uint8_t *image_data = stbi_load_from_memory(data, size, &width, &height, &nr_components, 0);
+
+    return setPixels(image_data, width, height, nr_components);
+}
+
+const ivec2 &Image::getSize() const
+{
+    return m_size;
+}
+
+TextureFormat Image::getFormat() const
+{
+    return m_format;
+}
+
+const uint8_t *Image::getPixels() const
+{
+    return m_pixels.data();
+}
+
+bool Image::isValid() const
+{
+    return !m_pixels.empty();
+}
+
+void Image::clear()
+{
+    m_size = ivec2{0};
+    m_format = TextureFormat::RGB;
+    m_pixels.clear();
+}
+
+bool Image::setPixels(uint8_t *data, int32_t width, int32_t height, int32_t nr_components)
+{
+    if (!data)
+        return false;
+
+    // Поддерживаются только RGB и RGBA
+    if (nr_components != 3 && nr_components != 4) {
+        stbi_image_free(data);
+        return false;
+    }
+
+    m_size = ivec2{width, height};
+    m_format = nr_components == 3 ? TextureFormat::RGB : TextureFormat::RGBA;
+    m_pixels.assign(data, data + width * height * nr_components);
+
+    stbi_image_free(data);
+
+    return true;
+}
+
+} // namespace ae
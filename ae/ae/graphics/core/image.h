@@ -0,0 +1,44 @@
+#ifndef AE_IMAGE_H
+#define AE_IMAGE_H
+
+#include "../common/enums.h"
+
+#include <glm/glm.hpp>
+
+#include <filesystem>
+#include <vector>
+
+using namespace glm;
+
+namespace ae {
+
+// Декодированное изображение в памяти. Не использует GL, поэтому
+// может загружаться в рабочих потоках
+class Image
+{
+public:
+    Image();
+    ~Image() = default;
+
+    bool loadFromFile(const std::filesystem::path &path);
+    bool loadFromMemory(const uint8_t *data, int32_t size);
+
+    const ivec2 &getSize() const;
+    TextureFormat getFormat() const;
+    const uint8_t *getPixels() const;
+
+    bool isValid() const;
+    void clear();
+
+private:
+    bool setPixels(uint8_t *data, int32_t width, int32_t height, int32_t nr_components);
+
+private:
+    ivec2 m_size;
+    TextureFormat m_format;
+    std::vector<uint8_t> m_pixels;
+};
+
+} // namespace ae
+
+#endif // AE_IMAGE_H
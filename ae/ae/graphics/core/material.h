@@ -7,7 +7,7 @@
 
 namespace ae {
 
-struct Material
+struct Material : public RefCounted
 {
     Material()
         : diffuse_texture{Texture::getDefaultDiffuseTexture()}
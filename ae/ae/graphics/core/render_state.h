@@ -5,6 +5,8 @@
 
 #include <glm/glm.hpp>
 
+#include <vector>
+
 using namespace glm;
 
 namespace ae {
@@ -13,6 +15,8 @@ struct RenderState
 {
     Shader *shader = nullptr;
     mat4 transform{1.0f};
+    // Матрицы костей из снимка сцены вместо текущей позы модели
+    const std::vector<mat4> *bone_transforms = nullptr;
 };
 
 } // namespace ae
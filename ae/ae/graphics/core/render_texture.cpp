@@ -14,6 +14,7 @@ RenderTexture::RenderTexture()
     , m_depth_rbo{0}
     , m_sample_fbo{0}
     , m_sample_texture_dirty{false}
+    , m_sample_dirty_rect{0}
 {}
 
 RenderTexture::RenderTexture(const ivec2 &size)
@@ -21,6 +22,7 @@ RenderTexture::RenderTexture(const ivec2 &size)
     , m_depth_rbo{0}
     , m_sample_fbo{0}
     , m_sample_texture_dirty{false}
+    , m_sample_dirty_rect{0}
 {
     create(size);
 }
@@ -44,14 +46,15 @@ const Texture &RenderTexture::getSampledTexture() const
         glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
         glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_sample_fbo);
 
-        glBlitFramebuffer(0,
-                          0,
-                          m_texture.getSize().x,
-                          m_texture.getSize().y,
-                          0,
-                          0,
-                          m_sample_texture.getSize().x,
-                          m_sample_texture.getSize().y,
+        const auto &rect = m_sample_dirty_rect;
+        glBlitFramebuffer(rect.x,
+                          rect.y,
+                          rect.z,
+                          rect.w,
+                          rect.x,
+                          rect.y,
+                          rect.z,
+                          rect.w,
                           GL_COLOR_BUFFER_BIT,
                           GL_NEAREST);
 
@@ -155,10 +158,24 @@ void RenderTexture::clear() const
 
 void RenderTexture::display() const
 {
-    if (isValid()) {
-        m_sample_texture_dirty = true;
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    display(ivec4{ivec2{0}, m_texture.getSize()});
+}
+
+void RenderTexture::display(const ivec4 &rect) const
+{
+    if (!isValid())
+        return;
+
+    ivec2 min{rect.x, rect.y};
+    ivec2 max = min + ivec2{rect.z, rect.w};
+    if (m_sample_texture_dirty) {
+        min = glm::min(min, ivec2{m_sample_dirty_rect.x, m_sample_dirty_rect.y});
+        max = glm::max(max, ivec2{m_sample_dirty_rect.z, m_sample_dirty_rect.w});
     }
+
+    m_sample_texture_dirty = true;
+    m_sample_dirty_rect = ivec4{min, max};
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void RenderTexture::saveToFile(const std::filesystem::path &path) const
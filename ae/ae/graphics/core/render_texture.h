@@ -25,6 +25,8 @@ public:
 
     void clear() const;
     void display() const;
+    // Изменилась только часть текстуры: x, y, ширина, высота в пикселях
+    void display(const ivec4 &rect) const;
 
     void saveToFile(const std::filesystem::path &path) const;
 
@@ -36,6 +38,8 @@ private:
     Texture m_sample_texture;
     uint32_t m_sample_fbo;
     mutable bool m_sample_texture_dirty;
+    // Область, которую нужно скопировать в m_sample_texture: min x, min y, max x, max y
+    mutable ivec4 m_sample_dirty_rect;
 };
 
 } // namespace ae
@@ -3,12 +3,11 @@
 #include "../../system/log.h"
 #include "../common/utils.h"
 #include "default_shaders.h"
+#include "shader_cache.h"
 
 #include <GL/glew.h>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <regex>
-
 namespace ae {
 
 Shader::Shader()
@@ -104,64 +103,22 @@ bool Shader::loadFromFile(const std::filesystem::path &vertex_path,
 
 bool Shader::loadFromMemory(const std::string &shader, ShaderType type)
 {
-    destroy();
-
-    if (shader.empty()) {
-        l_error("Shader loading error: shader is empty");
-        return false;
-    }
-
-    auto p_shader = preprocessor(shader);
-
-    m_id = createProgramm({createShader(p_shader, type)});
-    if (m_id == 0)
-        return false;
-
-    return true;
+    return loadProgram({{shader, type}});
 }
 
 bool Shader::loadFromMemory(const std::string &vertex_shader, const std::string &fragment_shader)
 {
-    destroy();
-
-    if (vertex_shader.empty() || fragment_shader.empty()) {
-        l_error("Shader loading error: shader is empty");
-        return false;
-    }
-
-    auto p_vertex_shader = preprocessor(vertex_shader);
-    auto p_fragment_shader = preprocessor(fragment_shader);
-
-    m_id = createProgramm({createShader(p_vertex_shader, ShaderType::VERTEX),
-                           createShader(p_fragment_shader, ShaderType::FRAGMENT)});
-    if (m_id == 0)
-        return false;
-
-    return true;
+    return loadProgram({{vertex_shader, ShaderType::VERTEX},
+                        {fragment_shader, ShaderType::FRAGMENT}});
 }
 
 bool Shader::loadFromMemory(const std::string &vertex_shader,
                             const std::string &geometry_shader,
                             const std::string &fragment_shader)
 {
-    destroy();
-
-    if (vertex_shader.empty() || geometry_shader.empty() || fragment_shader.empty()) {
-        l_error("Shader loading error: shader is empty");
-        return false;
-    }
-
-    auto p_vertex_shader = preprocessor(vertex_shader);
-    auto p_geometry_shader = preprocessor(geometry_shader);
-    auto p_fragment_shader = preprocessor(fragment_shader);
-
-    m_id = createProgramm({createShader(p_vertex_shader, ShaderType::VERTEX),
-                           createShader(p_geometry_shader, ShaderType::GEOMETRY),
-                           createShader(p_fragment_shader, ShaderType::FRAGMENT)});
-    if (m_id == 0)
-        return false;
-
-    return true;
+    return loadProgram({{vertex_shader, ShaderType::VERTEX},
+                        {geometry_shader, ShaderType::GEOMETRY},
+                        {fragment_shader, ShaderType::FRAGMENT}});
 }
 
 uint32_t Shader::getId() const
@@ -176,8 +133,10 @@ bool Shader::isValid() const
 
 void Shader::destroy()
 {
-    if (m_id != 0)
+    if (m_id != 0) {
         glDeleteProgram(m_id);
+        m_id = 0;
+    }
 }
 
 void Shader::uniformMatrix(const std::string &name, const mat4 &matrix) const
@@ -224,27 +183,110 @@ void Shader::unuse()
 std::string Shader::preprocessor(const std::string &shader)
 {
     std::string result;
-    std::regex include_pattern("\\s*#include\\s\"(.*)\"");
+    result.reserve(shader.size());
 
-    auto words_begin = std::sregex_iterator(shader.begin(), shader.end(), include_pattern);
-    auto words_end = std::sregex_iterator();
+    std::unordered_set<std::string> included;
+    preprocessor(shader, included, result);
 
-    int32_t p = 0;
+    return result;
+}
+
+void Shader::preprocessor(const std::string &shader,
+                          std::unordered_set<std::string> &included,
+                          std::string &result)
+{
+    auto skip_spaces = [&](size_t position, size_t end) {
+        while (position < end && (shader[position] == ' ' || shader[position] == '\t'))
+            ++position;
+        return position;
+    };
+
+    auto starts_with = [&](size_t position, size_t end, std::string_view word) {
+        return end - position >= word.size() && shader.compare(position, word.size(), word) == 0;
+    };
+
+    size_t line_begin = 0;
+    while (line_begin < shader.size()) {
+        size_t line_end = shader.find('\n', line_begin);
+        if (line_end == std::string::npos)
+            line_end = shader.size();
+
+        size_t position = skip_spaces(line_begin, line_end);
+
+        if (starts_with(position, line_end, "#")) {
+            position = skip_spaces(position + 1, line_end);
+
+            if (starts_with(position, line_end, "include")) {
+                size_t name_begin = shader.find('"', position) + 1;
+                size_t name_end = name_begin > 0 ? shader.find('"', name_begin) : line_end;
+
+                if (name_begin > 0 && name_begin <= line_end && name_end < line_end) {
+                    std::string name = shader.substr(name_begin, name_end - name_begin);
+
+                    if (included.insert(name).second) {
+                        std::string source = DefaultShaders::getShaderSource(name);
+                        if (source.empty())
+                            l_error("Shader include not found: {}", name);
+
+                        preprocessor(source, included, result);
+                        if (!result.empty() && result.back() != '\n')
+                            result += '\n';
+                    }
+
+                    line_begin = line_end + 1;
+                    continue;
+                }
+            } else if (starts_with(position, line_end, "pragma")) {
+                position = skip_spaces(position + 6, line_end);
+                if (starts_with(position, line_end, "once")) {
+                    line_begin = line_end + 1;
+                    continue;
+                }
+            }
+        }
+
+        result.append(shader, line_begin, line_end - line_begin);
+        if (line_end < shader.size())
+            result += '\n';
 
-    for (std::sregex_iterator it = words_begin; it != words_end; ++it) {
-        std::smatch match = *it;
+        line_begin = line_end + 1;
+    }
+}
 
-        result += shader.substr(p, match.position() - p) + "\n";
+bool Shader::loadProgram(const std::vector<std::pair<std::string, ShaderType>> &shaders)
+{
+    destroy();
 
-        std::string included_file = match[1].str();
-        result += DefaultShaders::getShaderSource(included_file) + "\n";
+    std::vector<std::string> sources;
+    for (const auto &[shader, type] : shaders) {
+        if (shader.empty()) {
+            l_error("Shader loading error: shader is empty");
+            return false;
+        }
 
-        p = match.position() + match.length(); // Правильно
+        // Тип стадии входит в ключ кэша вместе с исходником
+        sources.push_back(std::to_string(static_cast<int32_t>(type)));
+        sources.push_back(preprocessor(shader));
     }
 
-    result += shader.substr(p);
+    auto &cache = ShaderCache::getDefault();
+    uint64_t key = cache.getKey(sources);
 
-    return result;
+    m_id = cache.load(key);
+    if (m_id != 0)
+        return true;
+
+    std::vector<uint32_t> shader_ids;
+    for (int32_t i = 0; i < shaders.size(); ++i)
+        shader_ids.push_back(createShader(sources[i * 2 + 1], shaders[i].second));
+
+    m_id = createProgramm(shader_ids);
+    if (m_id == 0)
+        return false;
+
+    cache.store(key, m_id);
+
+    return true;
 }
 
 uint32_t Shader::getUniformLocation(const std::string &name) const
@@ -292,6 +334,7 @@ uint32_t Shader::createProgramm(const std::vector<uint32_t> &shaders) const
     }
 
     GLuint programm_id = glCreateProgram();
+    ShaderCache::getDefault().setRetrievable(programm_id);
 
     for (uint32_t shader : shaders)
         glAttachShader(programm_id, shader);
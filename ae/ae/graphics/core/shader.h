@@ -7,6 +7,7 @@
 
 #include <filesystem>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 using namespace glm;
@@ -56,8 +57,17 @@ public:
     static void use(const Shader &shader);
     static void unuse();
 
+    // Подставляет #include "name" из DefaultShaders за один проход по строкам.
+    // Каждый файл подставляется один раз (повторные и циклические включения пропускаются),
+    // строки #pragma once удаляются
+    static std::string preprocessor(const std::string &shader);
+
 private:
-    std::string preprocessor(const std::string &shader);
+    static void preprocessor(const std::string &shader,
+                             std::unordered_set<std::string> &included,
+                             std::string &result);
+
+    bool loadProgram(const std::vector<std::pair<std::string, ShaderType>> &shaders);
 
     uint32_t getUniformLocation(const std::string &name) const;
     uint32_t createShader(const std::string &shader, ShaderType type) const;
@@ -0,0 +1,256 @@
+#include "shader_cache.h"
+#include "../../system/log.h"
+
+#include <GL/glew.h>
+
+#include <cstring>
+#include <fstream>
+
+namespace ae {
+
+class GlShaderCacheBackend : public ShaderCache::Backend
+{
+public:
+    bool isSupported() const override
+    {
+        if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+            return false;
+
+        GLint formats_count = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_count);
+        return formats_count > 0;
+    }
+
+    std::string getDriverInfo() const override
+    {
+        auto get_string = [](GLenum name) {
+            auto value = reinterpret_cast<const char *>(glGetString(name));
+            return std::string{value ? value : ""};
+        };
+
+        return get_string(GL_VENDOR) + "|" + get_string(GL_RENDERER) + "|"
+               + get_string(GL_VERSION);
+    }
+
+    void setRetrievable(uint32_t program) const override
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    bool getProgramBinary(uint32_t program,
+                          uint32_t &format,
+                          std::vector<uint8_t> &binary) const override
+    {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return false;
+
+        binary.resize(length);
+        GLenum binary_format = 0;
+        glGetProgramBinary(program, length, &length, &binary_format, binary.data());
+        binary.resize(length);
+        format = binary_format;
+
+        return length > 0;
+    }
+
+    uint32_t createProgram(uint32_t format, std::span<const uint8_t> binary) const override
+    {
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, format, binary.data(), binary.size());
+
+        GLint success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glDeleteProgram(program);
+            return 0;
+        }
+
+        return program;
+    }
+};
+
+ShaderCache::ShaderCache(u_ptr<Backend> &&backend)
+    : m_backend{std::move(backend)}
+    , m_driver_hash{0}
+    , m_open{false}
+{
+    if (!m_backend)
+        m_backend = createUnique<GlShaderCacheBackend>();
+}
+
+bool ShaderCache::open(const std::filesystem::path &directory)
+{
+    close();
+
+    if (!m_backend->isSupported()) {
+        l_info("Shader cache disabled: program binaries are not supported");
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        l_warn("Failed to create shader cache directory {}: {}",
+               directory.string(),
+               error.message());
+        return false;
+    }
+
+    std::string driver_info = m_backend->getDriverInfo();
+    m_driver_hash = hash(driver_info);
+    m_directory = directory;
+    m_open = true;
+
+    l_debug("Shader cache {}: {}", directory.string(), driver_info);
+
+    return true;
+}
+
+void ShaderCache::close()
+{
+    m_open = false;
+    m_directory.clear();
+    m_driver_hash = 0;
+}
+
+bool ShaderCache::isOpen() const
+{
+    return m_open;
+}
+
+const std::filesystem::path &ShaderCache::getDirectory() const
+{
+    return m_directory;
+}
+
+uint64_t ShaderCache::getKey(std::span<const std::string> sources) const
+{
+    uint64_t key = m_driver_hash;
+    for (const auto &source : sources) {
+        // Длина отделяет стадии друг от друга: "ab" + "c" и "a" + "bc" дают разные ключи
+        uint64_t size = source.size();
+        key = hash({reinterpret_cast<const char *>(&size), sizeof(size)}, key);
+        key = hash(source, key);
+    }
+    return key;
+}
+
+uint32_t ShaderCache::load(uint64_t key)
+{
+    if (!m_open)
+        return 0;
+
+    auto path = getFilePath(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        ++m_stats.misses;
+        return 0;
+    }
+
+    FileHeader header{};
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+    std::vector<uint8_t> binary;
+    bool valid = in && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+                 && header.version == VERSION && header.key == key && header.size > 0;
+    if (valid) {
+        binary.resize(header.size);
+        in.read(reinterpret_cast<char *>(binary.data()), binary.size());
+        valid = in.gcount() == static_cast<std::streamsize>(binary.size());
+    }
+    in.close();
+
+    uint32_t program = valid ? m_backend->createProgram(header.format, binary) : 0;
+    if (program == 0) {
+        // Поврежденный или устаревший образ будет перезаписан после сборки из исходников
+        l_debug("Shader cache rejected {}", path.string());
+        ++m_stats.rejected;
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        return 0;
+    }
+
+    ++m_stats.hits;
+    return program;
+}
+
+void ShaderCache::setRetrievable(uint32_t program) const
+{
+    if (m_open)
+        m_backend->setRetrievable(program);
+}
+
+bool ShaderCache::store(uint64_t key, uint32_t program)
+{
+    if (!m_open || program == 0)
+        return false;
+
+    uint32_t format = 0;
+    std::vector<uint8_t> binary;
+    if (!m_backend->getProgramBinary(program, format, binary))
+        return false;
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.key = key;
+    header.format = format;
+    header.size = binary.size();
+
+    // Запись во временный файл и переименование: оборванная запись не оставит
+    // частичный образ под рабочим именем
+    auto path = getFilePath(key);
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(binary.data()), binary.size());
+        if (!out) {
+            l_warn("Failed to write shader cache: {}", temp_path.string());
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        l_warn("Failed to write shader cache {}: {}", path.string(), error.message());
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+    ++m_stats.stored;
+    return true;
+}
+
+const ShaderCache::Stats &ShaderCache::getStats() const
+{
+    return m_stats;
+}
+
+uint64_t ShaderCache::hash(std::string_view data, uint64_t seed)
+{
+    uint64_t result = seed;
+    for (char c : data) {
+        result ^= static_cast<uint8_t>(c);
+        result *= FNV_PRIME;
+    }
+    return result;
+}
+
+ShaderCache &ShaderCache::getDefault()
+{
+    static ShaderCache shader_cache;
+    return shader_cache;
+}
+
+std::filesystem::path ShaderCache::getFilePath(uint64_t key) const
+{
+    return m_directory / fmt::format("{:016x}.bin", key);
+}
+
+} // namespace ae
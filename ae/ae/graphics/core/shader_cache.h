@@ -0,0 +1,101 @@
+#ifndef AE_SHADER_CACHE_H
+#define AE_SHADER_CACHE_H
+
+#include "../../system/memory.h"
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ae {
+
+// Дисковый кэш бинарных образов шейдерных программ (glGetProgramBinary/glProgramBinary).
+// Ключ - хеш препроцессированных исходников всех стадий и строки драйвера, поэтому
+// при обновлении драйвера или шейдеров старые файлы просто перестают находиться.
+// Если образ не загрузился, файл удаляется и программа собирается из исходников
+class ShaderCache
+{
+public:
+    // Обращения к GL. Реализация по умолчанию работает с текущим контекстом,
+    // для проверки логики кэша без GL ее можно заменить
+    class Backend
+    {
+    public:
+        virtual ~Backend() = default;
+
+        virtual bool isSupported() const = 0;
+        // Производитель, рендерер и версия драйвера
+        virtual std::string getDriverInfo() const = 0;
+        // Вызывается до линковки программы, которую затем нужно будет сохранить
+        virtual void setRetrievable(uint32_t program) const = 0;
+        virtual bool getProgramBinary(uint32_t program,
+                                      uint32_t &format,
+                                      std::vector<uint8_t> &binary) const = 0;
+        // Программа из образа или 0, если драйвер его не принял
+        virtual uint32_t createProgram(uint32_t format, std::span<const uint8_t> binary) const = 0;
+    };
+
+    struct Stats
+    {
+        int32_t hits = 0;
+        int32_t misses = 0;
+        int32_t rejected = 0; // образ найден, но драйвер его не принял
+        int32_t stored = 0;
+    };
+
+    explicit ShaderCache(u_ptr<Backend> &&backend = nullptr);
+    ShaderCache(const ShaderCache &) = delete;
+    ShaderCache &operator=(const ShaderCache &) = delete;
+    ~ShaderCache() = default;
+
+    // Нужен текущий GL контекст. Без open кэш выключен и load/store ничего не делают
+    bool open(const std::filesystem::path &directory);
+    void close();
+    bool isOpen() const;
+
+    const std::filesystem::path &getDirectory() const;
+
+    // Ключ программы из исходников стадий в порядке их подключения
+    uint64_t getKey(std::span<const std::string> sources) const;
+
+    uint32_t load(uint64_t key);
+    void setRetrievable(uint32_t program) const;
+    bool store(uint64_t key, uint32_t program);
+
+    const Stats &getStats() const;
+
+    // FNV-1a, результат не зависит от платформы и сборки
+    static uint64_t hash(std::string_view data, uint64_t seed = FNV_OFFSET_BASIS);
+
+    static ShaderCache &getDefault();
+
+private:
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t size;
+    };
+
+    static constexpr char MAGIC[4] = {'A', 'E', 'S', 'C'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    std::filesystem::path getFilePath(uint64_t key) const;
+
+private:
+    u_ptr<Backend> m_backend;
+    std::filesystem::path m_directory;
+    uint64_t m_driver_hash;
+    bool m_open;
+    Stats m_stats;
+};
+
+} // namespace ae
+
+#endif // AE_SHADER_CACHE_H
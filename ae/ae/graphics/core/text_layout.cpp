@@ -0,0 +1,147 @@
+#include "text_layout.h"
+#include "font.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ae {
+
+void TextLayout::clear()
+{
+    quads.clear();
+    size = vec2{0.0f};
+    cursor = vec2{0.0f};
+    line_width = 0.0f;
+    line_count = 0;
+}
+
+void TextLayout::append(const FontPage &font_page, const String &string, float line_spacing)
+{
+    float line_height = font_page.getAscent() - font_page.getDescent() + line_spacing;
+
+    if (line_count == 0) {
+        cursor = vec2{0.0f, font_page.getAscent()};
+        line_count = 1;
+    }
+
+    for (uint32_t codepoint : string) {
+        if (codepoint == '\n') {
+            cursor.x = 0.0f;
+            cursor.y += line_height;
+            line_width = 0.0f;
+            ++line_count;
+            continue;
+        }
+
+        const Glyph *glyph = font_page.getGlyph(codepoint);
+        if (!glyph)
+            continue;
+
+        // Пробелы не рисуются, но двигают курсор
+        if (glyph->size.x > 0.0f && glyph->size.y > 0.0f) {
+            vec2 p0 = cursor + glyph->offset;
+            quads.push_back({p0, p0 + glyph->size, glyph->uv0, glyph->uv1});
+        }
+
+        cursor.x += glyph->advance;
+        line_width += glyph->advance;
+        size.x = std::max(size.x, line_width);
+    }
+
+    size.y = line_count * line_height;
+}
+
+TextLayoutCache::TextLayoutCache()
+    : m_capacity{DEFAULT_CAPACITY}
+{}
+
+s_ptr<const TextLayout> TextLayoutCache::get(const FontPage &font_page,
+                                             const String &string,
+                                             float line_spacing)
+{
+    if (string.getSize() > MAX_CACHED_LENGTH) {
+        auto layout = createShared<TextLayout>();
+        layout->append(font_page, string, line_spacing);
+        return layout;
+    }
+
+    uint64_t key = hash(string, line_spacing);
+
+    auto found = m_index.find(key);
+    if (found != m_index.end()) {
+        auto entry = found->second;
+        if (entry->line_spacing == line_spacing && entry->string == string) {
+            ++m_stats.hits;
+            m_lru.splice(m_lru.begin(), m_lru, entry);
+            return entry->layout;
+        }
+
+        // Коллизия хешей: старая запись заменяется новой
+        m_lru.erase(entry);
+        m_index.erase(found);
+    }
+
+    ++m_stats.misses;
+
+    auto layout = createShared<TextLayout>();
+    layout->append(font_page, string, line_spacing);
+
+    m_lru.push_front({key, string, line_spacing, layout});
+    m_index.emplace(key, m_lru.begin());
+    trim();
+
+    return layout;
+}
+
+void TextLayoutCache::setCapacity(int32_t capacity)
+{
+    m_capacity = capacity;
+    trim();
+}
+
+void TextLayoutCache::clear()
+{
+    m_lru.clear();
+    m_index.clear();
+}
+
+int32_t TextLayoutCache::getSize() const
+{
+    return m_lru.size();
+}
+
+const TextLayoutCache::Stats &TextLayoutCache::getStats() const
+{
+    return m_stats;
+}
+
+uint64_t TextLayoutCache::hash(const String &string, float line_spacing)
+{
+    // FNV-1a по кодам символов и интервалу
+    uint64_t result = 14695981039346656037ull;
+    auto add = [&](uint32_t value) {
+        for (int32_t i = 0; i < 4; ++i) {
+            result ^= (value >> (i * 8)) & 0xff;
+            result *= 1099511628211ull;
+        }
+    };
+
+    uint32_t spacing_bits;
+    std::memcpy(&spacing_bits, &line_spacing, sizeof(spacing_bits));
+    add(spacing_bits);
+
+    for (uint32_t codepoint : string)
+        add(codepoint);
+
+    return result;
+}
+
+void TextLayoutCache::trim()
+{
+    while (m_lru.size() > std::max(m_capacity, 0)) {
+        m_index.erase(m_lru.back().key);
+        m_lru.pop_back();
+    }
+}
+
+} // namespace ae
@@ -0,0 +1,92 @@
+#ifndef AE_TEXT_LAYOUT_H
+#define AE_TEXT_LAYOUT_H
+
+#include "../../system/memory.h"
+#include "../../system/string.h"
+
+#include <glm/glm.hpp>
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+using namespace glm;
+
+namespace ae {
+
+class FontPage;
+
+// Разложенный текст: прямоугольники глифов относительно левого верхнего угла текста
+// и его размер. Строится один раз и переиспользуется при каждой перерисовке
+struct TextLayout
+{
+    struct Quad
+    {
+        vec2 p0;
+        vec2 p1;
+        vec2 uv0;
+        vec2 uv1;
+    };
+
+    void clear();
+    // Продолжает раскладку с места, где закончилась предыдущая строка
+    void append(const FontPage &font_page, const String &string, float line_spacing);
+
+    std::vector<Quad> quads;
+    vec2 size{0.0f};
+    vec2 cursor{0.0f}; // начало следующего глифа на базовой линии
+    float line_width = 0.0f;
+    int32_t line_count = 0;
+};
+
+// Кэш раскладок одной страницы шрифта по содержимому строки и межстрочному интервалу.
+// Вытесняются давно не использованные раскладки. Не потокобезопасен
+class TextLayoutCache
+{
+public:
+    static constexpr int32_t DEFAULT_CAPACITY = 256;
+    // Более длинные строки раскладываются без кэширования
+    static constexpr int32_t MAX_CACHED_LENGTH = 1024;
+
+    struct Stats
+    {
+        int32_t hits = 0;
+        int32_t misses = 0;
+    };
+
+    TextLayoutCache();
+    ~TextLayoutCache() = default;
+
+    s_ptr<const TextLayout> get(const FontPage &font_page,
+                                const String &string,
+                                float line_spacing);
+
+    void setCapacity(int32_t capacity);
+    void clear();
+
+    int32_t getSize() const;
+    const Stats &getStats() const;
+
+    static uint64_t hash(const String &string, float line_spacing);
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        String string;
+        float line_spacing;
+        s_ptr<const TextLayout> layout;
+    };
+
+    void trim();
+
+private:
+    int32_t m_capacity;
+    std::list<Entry> m_lru;
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+    Stats m_stats;
+};
+
+} // namespace ae
+
+#endif // AE_TEXT_LAYOUT_H
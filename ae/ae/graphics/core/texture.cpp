@@ -1,10 +1,6 @@
 #include "texture.h"
 #include "../common/utils.h"
 
-#define STB_IMAGE_STATIC
-#define STB_IMAGE_IMPLEMENTATION
-#include "../../../3rd/stb/stb_image.h"
-
 #include <GL/glew.h>
 
 #include <vector>
@@ -19,6 +15,7 @@ std::stack<std::pair<TextureType, uint32_t>> Texture::m_binded_textures;
 Texture::Texture()
     : m_id{0}
     , m_size{0}
+    , m_format{TextureFormat::RGB}
     , m_type{TextureType::DEFAULT}
 {}
 
@@ -64,82 +61,21 @@ Texture::~Texture()
 
 bool Texture::loadFromFile(const std::filesystem::path &path, TextureType type)
 {
-    if (path.empty())
-        return false;
-
-    int32_t width = 0;
-    int32_t height = 0;
-    int32_t nr_components = 0;
-
-    uint8_t *image_data = stbi_load(path.c_str(), &width, &height, &nr_components, 0);
-
-    if (!image_data)
+    Image image;
+    if (!image.loadFromFile(path))
         return false;
 
-    TextureFormat format;
-    if (nr_components == 1) {
-        stbi_image_free(image_data);
-        return false;
-    } else if (nr_components == 2) {
-        stbi_image_free(image_data);
-        return false;
-    } else if (nr_components == 3)
-        format = TextureFormat::RGB;
-    else if (nr_components == 4)
-        format = TextureFormat::RGBA;
-
-    switch (type) {
-    case TextureType::DEFAULT:
-        create2D({width, height}, format, image_data);
-        break;
-    case TextureType::CUBE_MAP:
-        createCubemap({width, height}, format, image_data);
-        break;
-    }
-
-    stbi_image_free(image_data);
-
+    create(image, type);
     return true;
 }
 
 bool Texture::loadFromMemory(const uint8_t *data, int32_t size, TextureType type)
 {
-    if (data == nullptr || size <= 0)
+    Image image;
+    if (!image.loadFromMemory(data, size))
         return false;
 
-    uint8_t *image_data = nullptr;
-    int32_t width = 0;
-    int32_t height = 0;
-    int32_t nr_components = 0;
-
-    image_data = stbi_load_from_memory(data, size, &width, &height, &nr_components, 0);
-
-    if (!image_data)
-        return false;
-
-    TextureFormat format;
-    if (nr_components == 1) {
-        stbi_image_free(image_data);
-        return false;
-    } else if (nr_components == 2) {
-        stbi_image_free(image_data);
-        return false;
-    } else if (nr_components == 3)
-        format = TextureFormat::RGB;
-    else if (nr_components == 4)
-        format = TextureFormat::RGBA;
-
-    switch (type) {
-    case TextureType::DEFAULT:
-        create2D({width, height}, format, image_data);
-        break;
-    case TextureType::CUBE_MAP:
-        createCubemap({width, height}, format, image_data);
-        break;
-    }
-
-    stbi_image_free(image_data);
-
+    create(image, type);
     return true;
 }
 
@@ -158,6 +94,11 @@ TextureFormat Texture::getFormat() const
     return m_format;
 }
 
+TextureType Texture::getType() const
+{
+    return m_type;
+}
+
 vec4 Texture::getUVRect(const ivec4 &rect) const
 {
     if (m_id == 0 || m_size.x == 0 || m_size.y == 0 || rect.z == 0 || rect.w == 0)
@@ -173,6 +114,18 @@ vec4 Texture::getUVRect(const ivec4 &rect) const
     return uv;
 }
 
+void Texture::create(const Image &image, TextureType type)
+{
+    switch (type) {
+    case TextureType::DEFAULT:
+        create2D(image.getSize(), image.getFormat(), image.getPixels());
+        break;
+    case TextureType::CUBE_MAP:
+        createCubemap(image.getSize(), image.getFormat(), image.getPixels());
+        break;
+    }
+}
+
 void Texture::create2D(const ivec2 &size, TextureFormat format, const uint8_t *data)
 {
     destroy();
@@ -3,6 +3,7 @@
 
 #include "../../system/memory.h"
 #include "../common/enums.h"
+#include "image.h"
 
 #include <glm/glm.hpp>
 
@@ -13,7 +14,7 @@ using namespace glm;
 
 namespace ae {
 
-class Texture
+class Texture : public RefCounted
 {
 public:    
     Texture();
@@ -35,9 +36,11 @@ public:
     uint32_t getId() const;
     const ivec2 &getSize() const;
     TextureFormat getFormat() const;
+    TextureType getType() const;
 
     vec4 getUVRect(const ivec4 &rect) const;
 
+    void create(const Image &image, TextureType type = TextureType::DEFAULT);
     void create2D(const ivec2 &size, TextureFormat format, const uint8_t *data);
     void createCubemap(const ivec2 &size, TextureFormat format, const uint8_t *data);
     bool isValid() const;
@@ -0,0 +1,202 @@
+#include "texture_atlas.h"
+#include "../../system/log.h"
+
+#include <GL/glew.h>
+
+#include <vector>
+
+namespace ae {
+
+TextureAtlas::TextureAtlas()
+    : m_framebuffer{0}
+    , m_white_rect{0.0f}
+    , m_texture_count{0}
+{}
+
+TextureAtlas::~TextureAtlas()
+{
+    destroy();
+}
+
+bool TextureAtlas::create(const ivec2 &size)
+{
+    destroy();
+
+    if (size.x <= 0 || size.y <= 0)
+        return false;
+
+    std::vector<uint8_t> pixels(size_t(size.x) * size.y * 4, 0);
+
+    uint32_t texture_id;
+    glGenTextures(1, &texture_id);
+    glBindTexture(GL_TEXTURE_2D, texture_id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_RGBA,
+                 size.x,
+                 size.y,
+                 0,
+                 GL_RGBA,
+                 GL_UNSIGNED_BYTE,
+                 pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    m_texture = createShared<Texture>(texture_id, size, TextureFormat::RGBA);
+    m_packer.reset(size);
+
+    ivec2 position;
+    if (!m_packer.pack(ivec2{WHITE_SIZE}, position)) {
+        destroy();
+        return false;
+    }
+
+    std::vector<uint8_t> white(WHITE_SIZE * WHITE_SIZE * 4, 255);
+    glTexSubImage2D(GL_TEXTURE_2D,
+                    0,
+                    position.x,
+                    position.y,
+                    WHITE_SIZE,
+                    WHITE_SIZE,
+                    GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    white.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_white_rect = getUVRect(position, ivec2{WHITE_SIZE});
+
+    glGenFramebuffers(1, &m_framebuffer);
+
+    return true;
+}
+
+bool TextureAtlas::isValid() const
+{
+    return m_texture && m_texture->isValid();
+}
+
+void TextureAtlas::destroy()
+{
+    if (m_framebuffer != 0) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        m_framebuffer = 0;
+    }
+
+    m_texture.reset();
+    m_entries.clear();
+    m_texture_count = 0;
+}
+
+const vec4 *TextureAtlas::getRect(const s_ptr<Texture> &texture)
+{
+    if (!texture || !isValid())
+        return nullptr;
+
+    auto found = m_entries.find(texture.get());
+    if (found != m_entries.end()) {
+        // Адрес мог достаться новой текстуре после удаления старой
+        if (found->second.texture.lock() == texture)
+            return found->second.packed ? &found->second.rect : nullptr;
+        m_entries.erase(found);
+    }
+
+    Entry entry;
+    entry.texture = texture;
+    entry.rect = vec4{0.0f};
+    entry.packed = insert(*texture, entry.rect);
+
+    auto &inserted = m_entries.emplace(texture.get(), entry).first->second;
+    return inserted.packed ? &inserted.rect : nullptr;
+}
+
+const vec4 &TextureAtlas::getWhiteRect() const
+{
+    return m_white_rect;
+}
+
+const s_ptr<Texture> &TextureAtlas::getTexture() const
+{
+    return m_texture;
+}
+
+int32_t TextureAtlas::getTextureCount() const
+{
+    return m_texture_count;
+}
+
+float TextureAtlas::getOccupancy() const
+{
+    const auto &size = m_packer.getSize();
+    if (!isValid() || size.x <= 0 || size.y <= 0)
+        return 0.0f;
+
+    return static_cast<float>(m_packer.getUsedArea()) / (float(size.x) * size.y);
+}
+
+bool TextureAtlas::insert(const Texture &texture, vec4 &rect)
+{
+    const auto &size = texture.getSize();
+    if (!texture.isValid() || texture.getType() != TextureType::DEFAULT)
+        return false;
+    if (texture.getFormat() != TextureFormat::RGB && texture.getFormat() != TextureFormat::RGBA)
+        return false;
+    if (size.x <= 0 || size.y <= 0 || size.x > MAX_TEXTURE_SIZE || size.y > MAX_TEXTURE_SIZE)
+        return false;
+
+    ivec2 padded_position;
+    if (!m_packer.pack(size + 2 * PADDING, padded_position)) {
+        l_debug("Texture atlas is full, texture {} is drawn separately", texture.getId());
+        return false;
+    }
+
+    ivec2 position = padded_position + PADDING;
+    if (!copyTexture(texture, position))
+        return false;
+
+    rect = getUVRect(position, size);
+    ++m_texture_count;
+
+    return true;
+}
+
+bool TextureAtlas::copyTexture(const Texture &texture, const ivec2 &position)
+{
+    // Копирование через кадровый буфер чтения доступно в GL 3.3, в отличие от glCopyImageSubData
+    GLint previous_framebuffer = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER,
+                           GL_COLOR_ATTACHMENT0,
+                           GL_TEXTURE_2D,
+                           texture.getId(),
+                           0);
+
+    bool complete = glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete) {
+        const auto &size = texture.getSize();
+        glBindTexture(GL_TEXTURE_2D, m_texture->getId());
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, position.x, position.y, 0, 0, size.x, size.y);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    } else {
+        l_warn("Failed to copy texture {} to atlas", texture.getId());
+    }
+
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, previous_framebuffer);
+
+    return complete;
+}
+
+vec4 TextureAtlas::getUVRect(const ivec2 &position, const ivec2 &size) const
+{
+    vec2 atlas_size = vec2{m_packer.getSize()};
+    vec2 uv0 = (vec2{position} + 0.5f) / atlas_size;
+    vec2 uv1 = (vec2{position + size} - 0.5f) / atlas_size;
+    return vec4{uv0, uv1};
+}
+
+} // namespace ae
@@ -0,0 +1,73 @@
+#ifndef AE_TEXTURE_ATLAS_H
+#define AE_TEXTURE_ATLAS_H
+
+#include "../../system/memory.h"
+#include "glyph_atlas.h"
+#include "texture.h"
+
+#include <glm/glm.hpp>
+
+#include <unordered_map>
+
+using namespace glm;
+
+namespace ae {
+
+// RGBA атлас для небольших текстур интерфейса. Текстура копируется в атлас на GPU
+// при первом обращении, дальше вместо нее используется участок атласа.
+// Содержит белый участок для геометрии без текстуры
+class TextureAtlas
+{
+public:
+    static constexpr int32_t DEFAULT_SIZE = 2048;
+    // Более крупные текстуры рисуются отдельно
+    static constexpr int32_t MAX_TEXTURE_SIZE = 512;
+
+    TextureAtlas();
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+    bool create(const ivec2 &size = ivec2{DEFAULT_SIZE});
+    bool isValid() const;
+    void destroy();
+
+    // Участок текстуры в атласе (u0, v0, u1, v1) или nullptr, если текстура не помещается,
+    // не подходит по формату или не может быть скопирована
+    const vec4 *getRect(const s_ptr<Texture> &texture);
+    const vec4 &getWhiteRect() const;
+
+    const s_ptr<Texture> &getTexture() const;
+    int32_t getTextureCount() const;
+    float getOccupancy() const;
+
+private:
+    static constexpr int32_t PADDING = 1;
+    static constexpr int32_t WHITE_SIZE = 4;
+
+    struct Entry
+    {
+        WeakPtr<Texture> texture;
+        vec4 rect;
+        bool packed;
+    };
+
+    bool insert(const Texture &texture, vec4 &rect);
+    bool copyTexture(const Texture &texture, const ivec2 &position);
+    // Координаты центров крайних пикселей, чтобы фильтрация не захватывала соседей
+    vec4 getUVRect(const ivec2 &position, const ivec2 &size) const;
+
+private:
+    s_ptr<Texture> m_texture;
+    SkylinePacker m_packer;
+    uint32_t m_framebuffer;
+    vec4 m_white_rect;
+    int32_t m_texture_count;
+
+    std::unordered_map<const Texture *, Entry> m_entries;
+};
+
+} // namespace ae
+
+#endif // AE_TEXTURE_ATLAS_H
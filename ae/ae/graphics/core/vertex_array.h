@@ -4,6 +4,7 @@
 #include "buffer.h"
 #include "vertex_attrib.h"
 
+#include <span>
 #include <vector>
 
 namespace ae {
@@ -21,6 +22,13 @@ public:
 
     template<typename V>
     void create(const std::vector<V> &vertices, const std::vector<uint32_t> &indices = {})
+    {
+        create(std::span<const V>{vertices}, std::span<const uint32_t>{indices});
+    }
+
+    // Данные передаются в GL напрямую, без промежуточных копий
+    template<typename V>
+    void create(std::span<const V> vertices, std::span<const uint32_t> indices = {})
     {
         create(sizeof(V), VertexAttrib::get<V>(), !indices.empty());
 
@@ -32,6 +40,12 @@ public:
 
     template<typename V>
     void setData(const std::vector<V> &vertices, const std::vector<uint32_t> &indices = {})
+    {
+        setData(std::span<const V>{vertices}, std::span<const uint32_t>{indices});
+    }
+
+    template<typename V>
+    void setData(std::span<const V> vertices, std::span<const uint32_t> indices = {})
     {
         if (!isValid())
             return;
@@ -1,16 +1,110 @@
 #include "assimp_helper.h"
 #include "../../assets/assets.h"
 #include "../../system/log.h"
+#include "../../system/job_system.h"
 
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <cstring>
+
 namespace ae {
 
+class VfsIOStream : public Assimp::IOStream
+{
+public:
+    explicit VfsIOStream(const s_ptr<VfsFile> &file)
+        : m_file{file}
+        , m_position{0}
+    {}
+
+    size_t Read(void *buffer, size_t size, size_t count) override
+    {
+        if (size == 0)
+            return 0;
+
+        count = std::min(count, (m_file->getSize() - m_position) / size);
+        std::memcpy(buffer, m_file->getData().data() + m_position, count * size);
+        m_position += count * size;
+
+        return count;
+    }
+
+    size_t Write(const void *, size_t, size_t) override { return 0; }
+
+    aiReturn Seek(size_t offset, aiOrigin origin) override
+    {
+        size_t position;
+        switch (origin) {
+        case aiOrigin_SET:
+            position = offset;
+            break;
+        case aiOrigin_CUR:
+            position = m_position + offset;
+            break;
+        case aiOrigin_END:
+            position = m_file->getSize() - offset;
+            break;
+        default:
+            return aiReturn_FAILURE;
+        }
+
+        if (position > m_file->getSize())
+            return aiReturn_FAILURE;
+
+        m_position = position;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t Tell() const override { return m_position; }
+    size_t FileSize() const override { return m_file->getSize(); }
+    void Flush() override {}
+
+private:
+    s_ptr<VfsFile> m_file;
+    size_t m_position;
+};
+
+// Файлы, на которые ссылается модель (буферы glTF, материалы OBJ), тоже читаются через Vfs
+class VfsIOSystem : public Assimp::IOSystem
+{
+public:
+    explicit VfsIOSystem(Vfs *vfs)
+        : m_vfs{vfs}
+    {}
+
+    bool Exists(const char *file) const override { return m_vfs->exists(file); }
+
+    char getOsSeparator() const override { return '/'; }
+
+    Assimp::IOStream *Open(const char *file, const char *mode) override
+    {
+        if (std::string_view{mode}.find_first_of("wa+") != std::string_view::npos)
+            return nullptr;
+
+        auto vfs_file = m_vfs->open(file);
+        if (!vfs_file)
+            return nullptr;
+
+        return new VfsIOStream{vfs_file};
+    }
+
+    void Close(Assimp::IOStream *stream) override { delete stream; }
+
+private:
+    Vfs *m_vfs;
+};
+
 bool AssimpHelper::load(Model *model)
 {
     if (path.empty())
         return false;
 
+    // Importer владеет обработчиком и удаляет его сам
+    if (vfs)
+        importer.SetIOHandler(new VfsIOSystem{vfs});
+
     ai_scene = importer.ReadFile(path.string(),
                                  aiProcess_Triangulate | aiProcess_GenSmoothNormals
                                      | aiProcess_FlipUVs | aiProcess_CalcTangentSpace
@@ -23,19 +117,76 @@ bool AssimpHelper::load(Model *model)
         return false;
     }
 
+    if (!default_diffuse_texture)
+        default_diffuse_texture = Texture::getDefaultDiffuseTexture();
+    if (!default_specular_texture)
+        default_specular_texture = Texture::getDefaultSpecularTexture();
+
     if (model) {
+        // Скелет нужен для весов вершин, материалы используют общий кэш текстур и Assets,
+        // поэтому они строятся до параллельной части
         auto skeleton = buildSkeleton();
-        auto root_node = processRootNode();
-        model->setRootNode(root_node);
+
+        std::vector<s_ptr<Material>> materials(ai_scene->mNumMaterials);
+        for (int32_t i = 0; i < ai_scene->mNumMaterials; ++i)
+            materials[i] = processMaterial(ai_scene->mMaterials[i]);
+
+        // Меши и анимации независимы друг от друга и не используют GL
+        int32_t meshes_count = ai_scene->mNumMeshes;
+        std::vector<mesh_optimizer::Stats> mesh_stats(meshes_count);
+        std::vector<s_ptr<PoseAnimation>> animations(ai_scene->mNumAnimations);
+        meshes.assign(meshes_count, nullptr);
+
+        int32_t jobs_count = meshes_count + animations.size();
+        JobSystem::getDefault().parallelFor(jobs_count, [&](int32_t i) {
+            if (i < meshes_count) {
+                const aiMesh *ai_mesh = ai_scene->mMeshes[i];
+                meshes[i] = processMesh(ai_mesh, materials[ai_mesh->mMaterialIndex], mesh_stats[i]);
+            } else {
+                int32_t animation_index = i - meshes_count;
+                animations[animation_index] = processAnimation(
+                    ai_scene->mAnimations[animation_index]);
+            }
+        });
+
+        for (int32_t i = 0; i < meshes_count; ++i) {
+            // Индексы освобождаются при загрузке в GL, поэтому статистика считается до нее
+            if (optimize_meshes) {
+                int32_t triangles = meshes[i]->getIndices().size() / 3;
+                optimization_stats.vertices_before += mesh_stats[i].vertices_before;
+                optimization_stats.vertices_after += mesh_stats[i].vertices_after;
+                optimization_stats.acmr_before += mesh_stats[i].acmr_before * triangles;
+                optimization_stats.acmr_after += mesh_stats[i].acmr_after * triangles;
+                optimized_triangles += triangles;
+            }
+
+            meshes[i]->setResidency(mesh_residency);
+
+            // В GL загружается только в потоке с контекстом
+            if (defer_upload)
+                pending_meshes.push_back(meshes[i]);
+            else
+                meshes[i]->upload();
+        }
+
+        model->setRootNode(processRootNode());
         if (skeleton->getBoneCount() != 0)
             model->setSkeleton(skeleton);
-
-        std::vector<s_ptr<PoseAnimation>> animations;
-        for (int32_t i = 0; i < ai_scene->mNumAnimations; ++i)
-            animations.push_back(processAnimation(ai_scene->mAnimations[i]));
         model->setAnimations(animations);
     }
 
+    if (optimized_triangles > 0) {
+        optimization_stats.acmr_before /= optimized_triangles;
+        optimization_stats.acmr_after /= optimized_triangles;
+
+        l_debug("Mesh optimization {}: vertices {} -> {}, ACMR {:.3f} -> {:.3f}",
+                path.string(),
+                optimization_stats.vertices_before,
+                optimization_stats.vertices_after,
+                optimization_stats.acmr_before,
+                optimization_stats.acmr_after);
+    }
+
     return true;
 }
 
@@ -45,16 +196,16 @@ s_ptr<MeshNode> AssimpHelper::processNode(const aiNode *ai_node)
         return nullptr;
 
     std::vector<s_ptr<MeshNode>> child_nodes;
-    std::vector<s_ptr<Mesh>> meshes;
+    std::vector<s_ptr<Mesh>> node_meshes;
 
     // std::string node_name = ai_node->mName.C_Str();
     // spdlog::debug("Node: {}", node_name);
 
     // Meshes
     for (int32_t i = 0; i < ai_node->mNumMeshes; ++i) {
-        auto mesh = processMesh(ai_scene->mMeshes[ai_node->mMeshes[i]]);
+        const auto &mesh = meshes[ai_node->mMeshes[i]];
         if (mesh)
-            meshes.push_back(mesh);
+            node_meshes.push_back(mesh);
     }
 
     // Child nodes
@@ -66,13 +217,15 @@ s_ptr<MeshNode> AssimpHelper::processNode(const aiNode *ai_node)
 
     auto mesh_node = createShared<MeshNode>();
     mesh_node->setChildren(child_nodes);
-    mesh_node->setMeshes(meshes);
+    mesh_node->setMeshes(node_meshes);
     mesh_node->setTransform(сonvertMatrixToGLM(ai_node->mTransformation));
 
     return mesh_node;
 }
 
-s_ptr<Mesh> AssimpHelper::processMesh(const aiMesh *ai_mesh)
+s_ptr<Mesh> AssimpHelper::processMesh(const aiMesh *ai_mesh,
+                                      const s_ptr<Material> &material,
+                                      mesh_optimizer::Stats &stats)
 {
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
@@ -127,27 +280,23 @@ s_ptr<Mesh> AssimpHelper::processMesh(const aiMesh *ai_mesh)
     // Extract bones
     extractBoneWeightForVertices(ai_mesh, vertices);
 
-    auto mesh = createShared<Mesh>();
+    // Optimize
+    if (optimize_meshes)
+        stats = mesh_optimizer::optimize(vertices, indices);
 
-    aiMaterial *ai_material = ai_scene->mMaterials[ai_mesh->mMaterialIndex];
-    auto material = processMaterial(ai_material);
-
-    mesh->create(vertices, indices, material);
+    // Треугольники и AABB считаются здесь же, в GL меш загружается позже
+    auto mesh = createShared<Mesh>();
+    mesh->setData(vertices, indices, material);
 
     return mesh;
 }
 
 s_ptr<Material> AssimpHelper::processMaterial(const aiMaterial *ai_material)
 {
-    auto material = createShared<Material>();
-    material->diffuse_texture = loadMaterialTexture(ai_material,
-                                                    aiTextureType_DIFFUSE,
-                                                    Texture::getDefaultDiffuseTexture());
-    material->specular_texture = loadMaterialTexture(ai_material,
-                                                     aiTextureType_SPECULAR,
-                                                     Texture::getDefaultSpecularTexture());
-    material->color = loadMaterialColor(ai_material, AI_MATKEY_COLOR_DIFFUSE);
-    return material;
+    return createShared<Material>(
+        loadMaterialTexture(ai_material, aiTextureType_DIFFUSE, default_diffuse_texture),
+        loadMaterialTexture(ai_material, aiTextureType_SPECULAR, default_specular_texture),
+        loadMaterialColor(ai_material, AI_MATKEY_COLOR_DIFFUSE));
 }
 
 s_ptr<Texture> AssimpHelper::loadMaterialTexture(const aiMaterial *ai_material,
@@ -159,19 +308,17 @@ s_ptr<Texture> AssimpHelper::loadMaterialTexture(const aiMaterial *ai_material,
         ai_material->GetTexture(type, i, &str);
         std::string texture_name{str.data, str.length};
 
-        s_ptr<Texture> texture;
-
         if (texture_name.starts_with('*')) {
             const aiTexture *ai_texture = ai_scene->GetEmbeddedTexture(texture_name.data());
 
             if (ai_texture) {
-                texture = createShared<Texture>();
-                texture->loadFromMemory(reinterpret_cast<uint8_t *>(ai_texture->pcData),
-                                        ai_texture->mHeight == 0
-                                            ? ai_texture->mWidth
-                                            : ai_texture->mWidth * ai_texture->mHeight);
+                Image image;
+                image.loadFromMemory(reinterpret_cast<uint8_t *>(ai_texture->pcData),
+                                     ai_texture->mHeight == 0
+                                         ? ai_texture->mWidth
+                                         : ai_texture->mWidth * ai_texture->mHeight);
 
-                return texture;
+                return createTexture(std::move(image), {});
             }
         }
 
@@ -180,12 +327,15 @@ s_ptr<Texture> AssimpHelper::loadMaterialTexture(const aiMaterial *ai_material,
         std::filesystem::path texture_path{path.parent_path().string() + "/" + texture_name};
 
         if (assets) {
-            if (assets->has<Texture>(texture_asset_name))
-                return assets->get<Texture>(texture_asset_name);
+            StringId texture_asset_id{texture_asset_name};
+            if (auto texture_id = assets->getId<Texture>(texture_asset_id))
+                return assets->get(texture_id);
 
-            texture = createShared<Texture>();
-            if (texture->loadFromFile(texture_path))
-                assets->add(texture_asset_name, texture);
+            Image image;
+            bool loaded = loadImage(image, texture_path);
+            auto texture = createTexture(std::move(image), texture_asset_name);
+            if (loaded)
+                assets->add(StringId::intern(texture_asset_name), texture);
 
             return texture;
         } else {
@@ -193,8 +343,10 @@ s_ptr<Texture> AssimpHelper::loadMaterialTexture(const aiMaterial *ai_material,
             if (found_texture != loaded_textures.end())
                 return found_texture->second;
 
-            texture = createShared<Texture>();
-            if (texture->loadFromFile(texture_path))
+            Image image;
+            bool loaded = loadImage(image, texture_path);
+            auto texture = createTexture(std::move(image), texture_asset_name);
+            if (loaded)
                 loaded_textures.emplace(texture_asset_name, texture);
 
             return texture;
@@ -204,6 +356,29 @@ s_ptr<Texture> AssimpHelper::loadMaterialTexture(const aiMaterial *ai_material,
     return default_texture;
 }
 
+s_ptr<Texture> AssimpHelper::createTexture(Image &&image, const std::string &name)
+{
+    auto texture = createShared<Texture>();
+    if (!image.isValid())
+        return texture;
+
+    if (defer_upload)
+        pending_textures.push_back({texture, std::move(image), name});
+    else
+        texture->create(image);
+
+    return texture;
+}
+
+bool AssimpHelper::loadImage(Image &image, const std::filesystem::path &image_path) const
+{
+    if (!vfs)
+        return image.loadFromFile(image_path);
+
+    auto file = vfs->open(image_path);
+    return file && image.loadFromMemory(file->getData().data(), file->getSize());
+}
+
 Color AssimpHelper::loadMaterialColor(const aiMaterial *ai_material,
                                       const char *p_key,
                                       unsigned int type,
@@ -232,10 +407,12 @@ void AssimpHelper::extractBoneWeightForVertices(const aiMesh *mesh, std::vector<
         int32_t bone_id = -1;
         std::string bone_name = mesh->mBones[bone_index]->mName.C_Str();
 
-        if (!bone_map.contains(bone_name))
+        // Вызывается из нескольких потоков, bone_map только читается
+        auto found = bone_map.find(bone_name);
+        if (found == bone_map.end())
             continue;
 
-        bone_id = bone_map[bone_name];
+        bone_id = found->second;
 
         auto weights = mesh->mBones[bone_index]->mWeights;
         int32_t num_weights = mesh->mBones[bone_index]->mNumWeights;
@@ -2,7 +2,9 @@
 #define AE_ASSIMP_HELPER_H
 
 #include "../../system/memory.h"
+#include "../../system/vfs.h"
 #include "../core/texture.h"
+#include "mesh_optimizer.h"
 #include "model.h"
 #include "pose_animation.h"
 #include "skeleton.h"
@@ -20,10 +22,23 @@ class Assets;
 
 struct AssimpHelper
 {
+    // Текстура, ожидающая загрузки в GL (при defer_upload)
+    struct PendingTexture
+    {
+        s_ptr<Texture> texture;
+        Image image;
+        std::string name;
+    };
+
     AssimpHelper(const std::filesystem::path &path, Assets *assets = nullptr)
         : ai_scene{nullptr}
         , path{path}
         , assets{assets}
+        , vfs{nullptr}
+        , defer_upload{false}
+        , optimize_meshes{true}
+        , optimized_triangles{0}
+        , mesh_residency{MeshResidency::COLLISION_ONLY}
     {}
     ~AssimpHelper() = default;
 
@@ -31,11 +46,16 @@ struct AssimpHelper
 
     s_ptr<MeshNode> processRootNode() { return processNode(ai_scene->mRootNode); }
     s_ptr<MeshNode> processNode(const aiNode *ai_node);
-    s_ptr<Mesh> processMesh(const aiMesh *ai_mesh);
+    // Не использует GL и общие данные, кроме bone_map, и выполняется параллельно
+    s_ptr<Mesh> processMesh(const aiMesh *ai_mesh,
+                            const s_ptr<Material> &material,
+                            mesh_optimizer::Stats &stats);
     s_ptr<Material> processMaterial(const aiMaterial *ai_material);
     s_ptr<Texture> loadMaterialTexture(const aiMaterial *ai_material,
                                            aiTextureType type,
                                            const s_ptr<Texture> &default_texture);
+    s_ptr<Texture> createTexture(Image &&image, const std::string &name);
+    bool loadImage(Image &image, const std::filesystem::path &image_path) const;
     Color loadMaterialColor(const aiMaterial *ai_material,
                             const char *p_key,
                             unsigned int type,
@@ -57,8 +77,33 @@ struct AssimpHelper
     std::filesystem::path path;
     std::unordered_map<std::string, s_ptr<Texture>> loaded_textures;
     Assets *assets;
+    // Модель, ее внешние файлы и текстуры читаются через vfs, если он задан
+    Vfs *vfs;
 
     std::unordered_map<std::string, int32_t> bone_map;
+    // Меши сцены по индексам aiScene::mMeshes, узлы с одним мешем используют общий объект
+    std::vector<s_ptr<Mesh>> meshes;
+
+    // Если true, GL объекты не создаются: меши и текстуры складываются в pending_*
+    // и загружаются позже в потоке с GL контекстом
+    bool defer_upload;
+    std::vector<PendingTexture> pending_textures;
+    std::vector<s_ptr<Mesh>> pending_meshes;
+
+    // Текстуры для материалов без своих текстур. Если не заданы, используются
+    // Texture::getDefault*Texture(), которые создают GL объекты при первом обращении
+    s_ptr<Texture> default_diffuse_texture;
+    s_ptr<Texture> default_specular_texture;
+
+    // Сварка вершин и перестановка индексов после processMesh (см. mesh_optimizer).
+    // Статистика суммируется по всем мешам, ACMR усредняется по треугольникам
+    bool optimize_meshes;
+    mesh_optimizer::Stats optimization_stats;
+    int32_t optimized_triangles;
+
+    // Данные мешей в памяти процесса после загрузки в GL. Политика общая для всех мешей
+    // модели: по любому из них может строиться коллайдер, GPU_ONLY оставляет ему только AABB
+    MeshResidency mesh_residency;
 };
 
 } // namespace ae
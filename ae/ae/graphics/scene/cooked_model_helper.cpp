@@ -0,0 +1,584 @@
+#include "cooked_model_helper.h"
+#include "../../assets/assets.h"
+#include "../../geometry/geometry_utils.h"
+#include "../../system/log.h"
+#include "../../system/job_system.h"
+#include "assimp_helper.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+
+namespace ae {
+
+using namespace cooked_model;
+
+static_assert(std::is_trivially_copyable_v<Vertex>);
+static_assert(std::is_trivially_copyable_v<Triangle>);
+static_assert(std::is_trivially_copyable_v<PoseAnimation::KeyPosition>);
+static_assert(std::is_trivially_copyable_v<PoseAnimation::KeyRotation>);
+static_assert(std::is_trivially_copyable_v<PoseAnimation::KeyScale>);
+
+bool CookedModelHelper::load(Model *model)
+{
+    if (path.empty() || !model)
+        return false;
+
+    file = vfs ? vfs->open(path) : VfsFile::openFile(path);
+    if (!file)
+        return false;
+
+    auto headers = file->getSpan<Header>(0, 1);
+    if (headers.empty() || std::memcmp(headers[0].magic, MAGIC, sizeof(MAGIC)) != 0) {
+        l_error("Not a cooked model: {}", path.string());
+        return false;
+    }
+
+    header = headers.data();
+
+    if (header->version != VERSION || header->vertex_size != sizeof(Vertex)) {
+        l_error("Unsupported cooked model version {}: {}", header->version, path.string());
+        return false;
+    }
+
+    for (const auto &section : header->sections) {
+        if (section.size != 0 && file->getSpan<uint8_t>(section.offset, section.size).empty()) {
+            l_error("Corrupted cooked model: {}", path.string());
+            return false;
+        }
+    }
+
+    if (!default_diffuse_texture)
+        default_diffuse_texture = Texture::getDefaultDiffuseTexture();
+    if (!default_specular_texture)
+        default_specular_texture = Texture::getDefaultSpecularTexture();
+
+    auto nodes = getSection<NodeRecord>(NODES);
+    auto meshes = getSection<MeshRecord>(MESHES);
+    auto vertices = getSection<Vertex>(VERTICES);
+    auto indices = getSection<uint32_t>(INDICES);
+    auto materials = getSection<MaterialRecord>(MATERIALS);
+
+    if (nodes.empty()) {
+        l_error("Cooked model has no nodes: {}", path.string());
+        return false;
+    }
+
+    // Materials
+    std::vector<s_ptr<Material>> material_objects;
+    for (const auto &record : materials) {
+        auto diffuse_texture = loadTexture(record.diffuse_texture);
+        auto specular_texture = loadTexture(record.specular_texture);
+        material_objects.push_back(
+            createShared<Material>(diffuse_texture ? diffuse_texture : default_diffuse_texture,
+                                   specular_texture ? specular_texture : default_specular_texture,
+                                   Color{record.color},
+                                   record.shininess));
+    }
+
+    // Meshes
+    std::vector<s_ptr<Mesh>> mesh_objects;
+    for (const auto &record : meshes) {
+        if (uint64_t(record.first_vertex) + record.vertex_count > vertices.size()
+            || uint64_t(record.first_index) + record.index_count > indices.size()
+            || record.material >= material_objects.size()) {
+            l_error("Corrupted cooked model mesh: {}", path.string());
+            return false;
+        }
+
+        auto mesh = createShared<Mesh>();
+        mesh->setMaterial(material_objects[record.material]);
+        mesh->setAABB(AABB{record.aabb_min, record.aabb_max});
+
+        auto mesh_vertices = vertices.subspan(record.first_vertex, record.vertex_count);
+        auto mesh_indices = indices.subspan(record.first_index, record.index_count);
+
+        mesh->setResidency(mesh_residency);
+
+        if (defer_upload)
+            pending_meshes.push_back({mesh, mesh_vertices, mesh_indices});
+        else
+            mesh->upload(mesh_vertices, mesh_indices);
+
+        mesh_objects.push_back(mesh);
+    }
+
+    // Деревья треугольников мешей восстанавливаются параллельно
+    JobSystem::getDefault().parallelFor(meshes.size(), [&](int32_t i) {
+        if (meshes[i].bvh_node_count > 0
+            && mesh_objects[i]->getResidency() != MeshResidency::GPU_ONLY)
+            mesh_objects[i]->setTrianglesTree(buildTrianglesNode(meshes[i], 0));
+    });
+
+    // Nodes
+    std::vector<s_ptr<MeshNode>> node_objects;
+    std::vector<std::vector<s_ptr<MeshNode>>> node_children(nodes.size());
+    for (int32_t i = 0; i < nodes.size(); ++i) {
+        const auto &record = nodes[i];
+        if ((i == 0) != (record.parent == NONE) || (i != 0 && record.parent >= i)
+            || uint64_t(record.first_mesh) + record.mesh_count > mesh_objects.size()) {
+            l_error("Corrupted cooked model node: {}", path.string());
+            return false;
+        }
+
+        auto mesh_node = createShared<MeshNode>();
+        mesh_node->setTransform(record.transform);
+        mesh_node->setMeshes({mesh_objects.begin() + record.first_mesh,
+                              mesh_objects.begin() + record.first_mesh + record.mesh_count});
+
+        if (i != 0)
+            node_children[record.parent].push_back(mesh_node);
+        node_objects.push_back(mesh_node);
+    }
+
+    for (int32_t i = 0; i < node_objects.size(); ++i)
+        node_objects[i]->setChildren(node_children[i]);
+
+    model->setRootNode(node_objects[0]);
+
+    // Skeleton
+    auto skeleton_nodes = getSection<SkeletonNodeRecord>(SKELETON_NODES);
+    auto bones = getSection<BoneRecord>(BONES);
+
+    if (!bones.empty()) {
+        auto skeleton = createShared<Skeleton>();
+
+        for (const auto &record : skeleton_nodes)
+            skeleton->addNode(getString(record.name), record.transform);
+
+        for (int32_t i = 0; i < skeleton_nodes.size(); ++i) {
+            int32_t parent = skeleton_nodes[i].parent;
+            if (parent >= 0 && parent < skeleton_nodes.size())
+                skeleton->setParent(i, parent);
+        }
+
+        if (header->skeleton_root >= 0 && header->skeleton_root < skeleton_nodes.size())
+            skeleton->setRootIndex(header->skeleton_root);
+
+        for (const auto &record : bones) {
+            if (record.node_index < 0 || record.node_index >= skeleton_nodes.size()) {
+                l_error("Corrupted cooked model skeleton: {}", path.string());
+                return false;
+            }
+            skeleton->setBone(record.node_index, record.offset_transform);
+        }
+
+        model->setSkeleton(skeleton);
+    }
+
+    // Animations
+    auto animations = getSection<AnimationRecord>(ANIMATIONS);
+    auto channels = getSection<AnimationChannelRecord>(ANIMATION_CHANNELS);
+    auto position_keys = getSection<PoseAnimation::KeyPosition>(POSITION_KEYS);
+    auto rotation_keys = getSection<PoseAnimation::KeyRotation>(ROTATION_KEYS);
+    auto scale_keys = getSection<PoseAnimation::KeyScale>(SCALE_KEYS);
+
+    std::vector<s_ptr<PoseAnimation>> animation_objects;
+    for (const auto &record : animations) {
+        if (uint64_t(record.first_channel) + record.channel_count > channels.size()) {
+            l_error("Corrupted cooked model animation: {}", path.string());
+            return false;
+        }
+
+        auto animation = createShared<PoseAnimation>();
+        animation->setName(getString(record.name));
+        animation->setDuration(record.duration);
+        animation->setTicksPerSecond(record.ticks_per_second);
+
+        for (const auto &channel : channels.subspan(record.first_channel, record.channel_count)) {
+            if (uint64_t(channel.first_position) + channel.position_count > position_keys.size()
+                || uint64_t(channel.first_rotation) + channel.rotation_count > rotation_keys.size()
+                || uint64_t(channel.first_scale) + channel.scale_count > scale_keys.size()) {
+                l_error("Corrupted cooked model animation: {}", path.string());
+                return false;
+            }
+
+            auto positions = position_keys.subspan(channel.first_position, channel.position_count);
+            auto rotations = rotation_keys.subspan(channel.first_rotation, channel.rotation_count);
+            auto scales = scale_keys.subspan(channel.first_scale, channel.scale_count);
+
+            PoseAnimation::Bone bone;
+            bone.positions.assign(positions.begin(), positions.end());
+            bone.rotations.assign(rotations.begin(), rotations.end());
+            bone.scales.assign(scales.begin(), scales.end());
+            animation->addBone(getString(channel.name), bone);
+        }
+
+        animation_objects.push_back(animation);
+    }
+    model->setAnimations(animation_objects);
+
+    // Файл больше не нужен, если данные уже переданы в GL
+    if (!defer_upload) {
+        header = nullptr;
+        file.reset();
+    }
+
+    return true;
+}
+
+s_ptr<Texture> CookedModelHelper::loadTexture(uint32_t name)
+{
+    if (name == NONE)
+        return nullptr;
+
+    std::string texture_asset_name{(path.parent_path() / getString(name)).string()};
+
+    StringId texture_asset_id{texture_asset_name};
+    if (assets) {
+        if (auto texture_id = assets->getId<Texture>(texture_asset_id))
+            return assets->get(texture_id);
+    }
+
+    auto found_texture = loaded_textures.find(texture_asset_name);
+    if (found_texture != loaded_textures.end())
+        return found_texture->second;
+
+    auto texture = createShared<Texture>();
+
+    auto texture_file = vfs ? vfs->open(texture_asset_name) : VfsFile::openFile(texture_asset_name);
+
+    Image image;
+    if (!texture_file
+        || !image.loadFromMemory(texture_file->getData().data(), texture_file->getSize()))
+        return texture;
+
+    if (defer_upload) {
+        pending_textures.push_back({texture, std::move(image), texture_asset_name});
+    } else {
+        texture->create(image);
+        if (assets)
+            assets->add(StringId::intern(texture_asset_name), texture);
+    }
+
+    loaded_textures.emplace(texture_asset_name, texture);
+
+    return texture;
+}
+
+u_ptr<TrianglesNode> CookedModelHelper::buildTrianglesNode(const MeshRecord &mesh_record,
+                                                           uint32_t index,
+                                                           int32_t depth) const
+{
+    auto bvh_nodes = getSection<BvhNodeRecord>(BVH_NODES);
+    auto bvh_triangles = getSection<Triangle>(BVH_TRIANGLES);
+
+    // Глубина ограничена, чтобы поврежденный файл не приводил к бесконечной рекурсии
+    if (index >= mesh_record.bvh_node_count || depth > 64
+        || uint64_t(mesh_record.first_bvh_node) + index >= bvh_nodes.size())
+        return nullptr;
+
+    const auto &record = bvh_nodes[mesh_record.first_bvh_node + index];
+
+    auto node = createUnique<TrianglesNode>();
+    node->aabb = AABB{record.aabb_min, record.aabb_max};
+
+    if (record.triangle_count > 0) {
+        if (uint64_t(record.first_triangle) + record.triangle_count > bvh_triangles.size())
+            return nullptr;
+
+        auto triangles = bvh_triangles.subspan(record.first_triangle, record.triangle_count);
+        node->triangles.assign(triangles.begin(), triangles.end());
+        return node;
+    }
+
+    if (record.left != NONE)
+        node->left = buildTrianglesNode(mesh_record, record.left, depth + 1);
+    if (record.right != NONE)
+        node->right = buildTrianglesNode(mesh_record, record.right, depth + 1);
+
+    return node;
+}
+
+std::string CookedModelHelper::getString(uint32_t offset) const
+{
+    auto strings = getSection<char>(STRINGS);
+    if (offset >= strings.size())
+        return {};
+
+    const char *begin = strings.data() + offset;
+    const void *end = std::memchr(begin, '\0', strings.size() - offset);
+    if (!end)
+        return {};
+
+    return std::string{begin, static_cast<const char *>(end)};
+}
+
+bool CookedModelHelper::cook(const std::filesystem::path &source,
+                             const std::filesystem::path &destination)
+{
+    // Заглушки вместо текстур по умолчанию: импорт не должен создавать GL объекты
+    auto default_diffuse_texture = createShared<Texture>();
+    auto default_specular_texture = createShared<Texture>();
+
+    AssimpHelper assimp_helper{source};
+    assimp_helper.defer_upload = true;
+    assimp_helper.mesh_residency = MeshResidency::FULL;
+    assimp_helper.default_diffuse_texture = default_diffuse_texture;
+    assimp_helper.default_specular_texture = default_specular_texture;
+
+    Model model;
+    if (!assimp_helper.load(&model))
+        return false;
+
+    std::string strings;
+    std::vector<NodeRecord> nodes;
+    std::vector<MeshRecord> meshes;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<MaterialRecord> materials;
+    std::vector<SkeletonNodeRecord> skeleton_nodes;
+    std::vector<BoneRecord> bones;
+    std::vector<AnimationRecord> animations;
+    std::vector<AnimationChannelRecord> channels;
+    std::vector<PoseAnimation::KeyPosition> position_keys;
+    std::vector<PoseAnimation::KeyRotation> rotation_keys;
+    std::vector<PoseAnimation::KeyScale> scale_keys;
+    std::vector<BvhNodeRecord> bvh_nodes;
+    std::vector<Triangle> bvh_triangles;
+
+    auto add_string = [&](const std::string &str) {
+        uint32_t offset = strings.size();
+        strings += str;
+        strings.push_back('\0');
+        return offset;
+    };
+
+    // Texture references
+    std::unordered_map<const Texture *, std::string> texture_names;
+    for (const auto &pending_texture : assimp_helper.pending_textures) {
+        if (!pending_texture.name.empty())
+            texture_names.emplace(pending_texture.texture.get(), pending_texture.name);
+    }
+
+    auto base_path = std::filesystem::absolute(destination).parent_path();
+
+    auto add_texture = [&](const s_ptr<Texture> &texture) {
+        if (!texture || texture == default_diffuse_texture || texture == default_specular_texture)
+            return NONE;
+
+        auto found_name = texture_names.find(texture.get());
+        if (found_name == texture_names.end()) {
+            l_warn("Cook: texture is embedded or missing and will be replaced by default");
+            return NONE;
+        }
+
+        auto texture_path = std::filesystem::absolute(found_name->second);
+        return add_string(texture_path.lexically_proximate(base_path).generic_string());
+    };
+
+    // Materials
+    std::unordered_map<const Material *, uint32_t> material_indices;
+    auto add_material = [&](const s_ptr<Material> &material) {
+        auto found_material = material_indices.find(material.get());
+        if (found_material != material_indices.end())
+            return found_material->second;
+
+        MaterialRecord record{};
+        record.color = material->color.getColor();
+        record.shininess = material->shininess;
+        record.diffuse_texture = add_texture(material->diffuse_texture);
+        record.specular_texture = add_texture(material->specular_texture);
+
+        uint32_t index = materials.size();
+        materials.push_back(record);
+        material_indices.emplace(material.get(), index);
+        return index;
+    };
+
+    // Triangles tree
+    std::function<uint32_t(const TrianglesNode &, uint32_t)> add_bvh_node =
+        [&](const TrianglesNode &node, uint32_t first_bvh_node) {
+            uint32_t index = bvh_nodes.size() - first_bvh_node;
+
+            BvhNodeRecord record{};
+            record.aabb_min = node.aabb.min;
+            record.aabb_max = node.aabb.max;
+            record.left = NONE;
+            record.right = NONE;
+            record.first_triangle = bvh_triangles.size();
+            record.triangle_count = node.triangles.size();
+            bvh_nodes.push_back(record);
+
+            bvh_triangles.insert(bvh_triangles.end(), node.triangles.begin(), node.triangles.end());
+
+            if (node.left)
+                bvh_nodes[first_bvh_node + index].left = add_bvh_node(*node.left, first_bvh_node);
+            if (node.right)
+                bvh_nodes[first_bvh_node + index].right = add_bvh_node(*node.right, first_bvh_node);
+
+            return index;
+        };
+
+    // Nodes and meshes
+    std::function<void(const s_ptr<MeshNode> &, uint32_t)> add_node =
+        [&](const s_ptr<MeshNode> &mesh_node, uint32_t parent) {
+            uint32_t index = nodes.size();
+
+            NodeRecord record{};
+            record.transform = mesh_node->getTransform();
+            record.parent = parent;
+            record.first_mesh = meshes.size();
+            record.mesh_count = mesh_node->getMeshes().size();
+            nodes.push_back(record);
+
+            for (const auto &mesh : mesh_node->getMeshes()) {
+                MeshRecord mesh_record{};
+                mesh_record.aabb_min = mesh->getAABB().min;
+                mesh_record.aabb_max = mesh->getAABB().max;
+                mesh_record.material = add_material(mesh->getMaterial());
+                mesh_record.first_vertex = vertices.size();
+                mesh_record.vertex_count = mesh->getVertices().size();
+                mesh_record.first_index = indices.size();
+                mesh_record.index_count = mesh->getIndices().size();
+
+                vertices.insert(vertices.end(), mesh->getVertices().begin(), mesh->getVertices().end());
+                indices.insert(indices.end(), mesh->getIndices().begin(), mesh->getIndices().end());
+
+                mesh_record.first_bvh_node = bvh_nodes.size();
+                auto triangles_tree = geometry_utils::buildTrianglesTree(mesh->getTriangles());
+                if (triangles_tree)
+                    add_bvh_node(*triangles_tree, mesh_record.first_bvh_node);
+                mesh_record.bvh_node_count = bvh_nodes.size() - mesh_record.first_bvh_node;
+
+                meshes.push_back(mesh_record);
+            }
+
+            for (const auto &child : mesh_node->getChildren())
+                add_node(child, index);
+        };
+
+    if (!model.getRootNode()) {
+        l_error("Cook: model has no nodes: {}", source.string());
+        return false;
+    }
+
+    add_node(model.getRootNode(), NONE);
+
+    // Skeleton
+    int32_t skeleton_root = -1;
+    if (const auto &skeleton = model.getSkeleton()) {
+        skeleton_root = skeleton->getRootIndex();
+
+        for (int32_t i = 0; i < skeleton->getNodeCount(); ++i) {
+            const auto &node = skeleton->getNode(i);
+            SkeletonNodeRecord record{};
+            record.transform = node.transform;
+            record.name = add_string(node.name);
+            record.parent = node.parent;
+            skeleton_nodes.push_back(record);
+        }
+
+        for (int32_t i = 0; i < skeleton->getBoneCount(); ++i) {
+            const auto &bone = skeleton->getBone(i);
+            BoneRecord record{};
+            record.offset_transform = bone.offset_transform;
+            record.node_index = bone.node_index;
+            bones.push_back(record);
+        }
+    }
+
+    // Animations
+    for (const auto &animation : model.getAnimations()) {
+        AnimationRecord record{};
+        record.name = add_string(animation->getName());
+        record.duration = animation->getDuration();
+        record.ticks_per_second = animation->getTicksPerSecond();
+        record.first_channel = channels.size();
+        record.channel_count = animation->getBoneCount();
+
+        for (int32_t i = 0; i < animation->getBoneCount(); ++i) {
+            const auto &bone = animation->getBone(i);
+
+            AnimationChannelRecord channel{};
+            channel.name = add_string(animation->getBoneName(i));
+            channel.first_position = position_keys.size();
+            channel.position_count = bone.positions.size();
+            channel.first_rotation = rotation_keys.size();
+            channel.rotation_count = bone.rotations.size();
+            channel.first_scale = scale_keys.size();
+            channel.scale_count = bone.scales.size();
+            channels.push_back(channel);
+
+            position_keys.insert(position_keys.end(), bone.positions.begin(), bone.positions.end());
+            rotation_keys.insert(rotation_keys.end(), bone.rotations.begin(), bone.rotations.end());
+            scale_keys.insert(scale_keys.end(), bone.scales.begin(), bone.scales.end());
+        }
+
+        animations.push_back(record);
+    }
+
+    // Write
+    auto bytes = [](const auto &data) {
+        return std::span<const char>{reinterpret_cast<const char *>(data.data()),
+                                     data.size() * sizeof(data[0])};
+    };
+
+    std::span<const char> sections[SECTIONS_COUNT];
+    sections[STRINGS] = bytes(strings);
+    sections[NODES] = bytes(nodes);
+    sections[MESHES] = bytes(meshes);
+    sections[VERTICES] = bytes(vertices);
+    sections[INDICES] = bytes(indices);
+    sections[MATERIALS] = bytes(materials);
+    sections[SKELETON_NODES] = bytes(skeleton_nodes);
+    sections[BONES] = bytes(bones);
+    sections[ANIMATIONS] = bytes(animations);
+    sections[ANIMATION_CHANNELS] = bytes(channels);
+    sections[POSITION_KEYS] = bytes(position_keys);
+    sections[ROTATION_KEYS] = bytes(rotation_keys);
+    sections[SCALE_KEYS] = bytes(scale_keys);
+    sections[BVH_NODES] = bytes(bvh_nodes);
+    sections[BVH_TRIANGLES] = bytes(bvh_triangles);
+
+    auto align = [](uint64_t offset) {
+        return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+    };
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertex_size = sizeof(Vertex);
+    header.skeleton_root = skeleton_root;
+
+    uint64_t offset = align(sizeof(Header));
+    for (int32_t i = 0; i < SECTIONS_COUNT; ++i) {
+        header.sections[i] = {offset, sections[i].size()};
+        offset = align(offset + sections[i].size());
+    }
+
+    std::ofstream stream{destination, std::ios::binary | std::ios::trunc};
+    if (!stream) {
+        l_error("Cook: failed to open file for writing: {}", destination.string());
+        return false;
+    }
+
+    const char zeros[SECTION_ALIGNMENT] = {};
+    stream.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    uint64_t position = sizeof(Header);
+
+    for (int32_t i = 0; i < SECTIONS_COUNT; ++i) {
+        stream.write(zeros, header.sections[i].offset - position);
+        stream.write(sections[i].data(), sections[i].size());
+        position = header.sections[i].offset + sections[i].size();
+    }
+
+    if (!stream) {
+        l_error("Cook: failed to write file: {}", destination.string());
+        return false;
+    }
+
+    l_info("Cooked {} -> {}: {} nodes, {} meshes, {} vertices, {} bvh nodes, {} bytes",
+           source.string(),
+           destination.string(),
+           nodes.size(),
+           meshes.size(),
+           vertices.size(),
+           bvh_nodes.size(),
+           position);
+
+    return true;
+}
+
+} // namespace ae
@@ -0,0 +1,219 @@
+#ifndef AE_COOKED_MODEL_HELPER_H
+#define AE_COOKED_MODEL_HELPER_H
+
+#include "../../system/memory.h"
+#include "../../system/vfs.h"
+#include "../core/texture.h"
+#include "model.h"
+
+#include <filesystem>
+#include <unordered_map>
+
+namespace ae {
+
+class Assets;
+
+// Формат .aemodel: заголовок с таблицей секций, далее секции с плоскими массивами записей.
+// Все ссылки - индексы в массивах или смещения от начала файла, поэтому файл можно
+// отображать в память по любому адресу. Порядок байт - little-endian
+namespace cooked_model {
+
+constexpr const char *EXTENSION = ".aemodel";
+constexpr char MAGIC[4] = {'A', 'E', 'M', 'D'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t NONE = ~0u;
+constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+enum Section : uint32_t {
+    STRINGS,
+    NODES,
+    MESHES,
+    VERTICES,
+    INDICES,
+    MATERIALS,
+    SKELETON_NODES,
+    BONES,
+    ANIMATIONS,
+    ANIMATION_CHANNELS,
+    POSITION_KEYS,
+    ROTATION_KEYS,
+    SCALE_KEYS,
+    BVH_NODES,
+    BVH_TRIANGLES,
+    SECTIONS_COUNT
+};
+
+struct SectionRecord
+{
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t vertex_size;
+    int32_t skeleton_root;
+    SectionRecord sections[SECTIONS_COUNT];
+};
+
+// Узлы в порядке обхода в глубину, родитель всегда раньше потомков
+struct NodeRecord
+{
+    mat4 transform;
+    uint32_t parent;
+    uint32_t first_mesh;
+    uint32_t mesh_count;
+    uint32_t padding;
+};
+
+struct MeshRecord
+{
+    vec3 aabb_min;
+    vec3 aabb_max;
+    uint32_t material;
+    uint32_t first_vertex;
+    uint32_t vertex_count;
+    uint32_t first_index;
+    uint32_t index_count;
+    uint32_t first_bvh_node;
+    uint32_t bvh_node_count;
+    uint32_t padding;
+};
+
+// Текстуры хранятся ссылками: путь относительно файла модели в секции STRINGS
+struct MaterialRecord
+{
+    vec4 color;
+    float shininess;
+    uint32_t diffuse_texture;
+    uint32_t specular_texture;
+    uint32_t padding;
+};
+
+struct SkeletonNodeRecord
+{
+    mat4 transform;
+    uint32_t name;
+    int32_t parent;
+    uint32_t padding[2];
+};
+
+struct BoneRecord
+{
+    mat4 offset_transform;
+    int32_t node_index;
+    uint32_t padding[3];
+};
+
+struct AnimationRecord
+{
+    uint32_t name;
+    float duration;
+    int32_t ticks_per_second;
+    uint32_t first_channel;
+    uint32_t channel_count;
+    uint32_t padding[3];
+};
+
+struct AnimationChannelRecord
+{
+    uint32_t name;
+    uint32_t first_position;
+    uint32_t position_count;
+    uint32_t first_rotation;
+    uint32_t rotation_count;
+    uint32_t first_scale;
+    uint32_t scale_count;
+    uint32_t padding;
+};
+
+// Узлы дерева треугольников меша в локальных координатах, индексы потомков
+// относительно first_bvh_node меша
+struct BvhNodeRecord
+{
+    vec3 aabb_min;
+    vec3 aabb_max;
+    uint32_t left;
+    uint32_t right;
+    uint32_t first_triangle;
+    uint32_t triangle_count;
+};
+
+} // namespace cooked_model
+
+struct CookedModelHelper
+{
+    // Текстура, ожидающая загрузки в GL (при defer_upload)
+    struct PendingTexture
+    {
+        s_ptr<Texture> texture;
+        Image image;
+        std::string name;
+    };
+
+    // Меш, ожидающий загрузки в GL. Данные указывают в содержимое file
+    struct PendingMesh
+    {
+        s_ptr<Mesh> mesh;
+        std::span<const Vertex> vertices;
+        std::span<const uint32_t> indices;
+    };
+
+    CookedModelHelper(const std::filesystem::path &path, Assets *assets = nullptr)
+        : path{path}
+        , assets{assets}
+        , vfs{nullptr}
+        , header{nullptr}
+        , defer_upload{false}
+        , mesh_residency{MeshResidency::COLLISION_ONLY}
+    {}
+    ~CookedModelHelper() = default;
+
+    bool load(Model *model);
+
+    s_ptr<Texture> loadTexture(uint32_t name);
+    u_ptr<TrianglesNode> buildTrianglesNode(const cooked_model::MeshRecord &mesh_record,
+                                            uint32_t index,
+                                            int32_t depth = 0) const;
+    std::string getString(uint32_t offset) const;
+
+    template<typename T>
+    std::span<const T> getSection(cooked_model::Section section) const
+    {
+        const auto &record = header->sections[section];
+        if (record.size % sizeof(T) != 0)
+            return {};
+        return file->getSpan<T>(record.offset, record.size / sizeof(T));
+    }
+
+    // Импорт исходной модели через assimp и запись в .aemodel. Не использует GL
+    static bool cook(const std::filesystem::path &source, const std::filesystem::path &destination);
+
+    std::filesystem::path path;
+    Assets *assets;
+    // Файлы модели и текстур читаются через vfs, если он задан, иначе с диска
+    Vfs *vfs;
+    s_ptr<VfsFile> file;
+    const cooked_model::Header *header;
+    std::unordered_map<std::string, s_ptr<Texture>> loaded_textures;
+
+    // Если true, GL объекты не создаются: меши и текстуры складываются в pending_*
+    // и загружаются позже в потоке с GL контекстом. Данные мешей действительны,
+    // пока жив file
+    bool defer_upload;
+    std::vector<PendingTexture> pending_textures;
+    std::vector<PendingMesh> pending_meshes;
+
+    s_ptr<Texture> default_diffuse_texture;
+    s_ptr<Texture> default_specular_texture;
+
+    // Вершины и индексы загружаются в GL напрямую из file и в памяти процесса не хранятся.
+    // При политике GPU_ONLY не восстанавливается дерево треугольников
+    MeshResidency mesh_residency;
+};
+
+} // namespace ae
+
+#endif // AE_COOKED_MODEL_HELPER_H
@@ -1,12 +1,19 @@
 #include "mesh.h"
 
+#include <functional>
+
 namespace ae {
 
-Mesh::Mesh() {}
+Mesh::Mesh()
+    : m_residency{MeshResidency::FULL}
+    , m_released_memory{0}
+{}
 
 Mesh::Mesh(const std::vector<Vertex> &vertices,
            const std::vector<uint32_t> &indices,
            const s_ptr<Material> &material)
+    : m_residency{MeshResidency::FULL}
+    , m_released_memory{0}
 {
     create(vertices, indices, material);
 }
@@ -39,14 +46,22 @@ void Mesh::setMaterial(const s_ptr<Material> &material, const ivec4 &texture_rec
 void Mesh::create(const std::vector<Vertex> &vertices,
                   const std::vector<uint32_t> &indices,
                   const s_ptr<Material> &material)
+{
+    setData(vertices, indices, material);
+    upload();
+}
+
+void Mesh::setData(const std::vector<Vertex> &vertices,
+                   const std::vector<uint32_t> &indices,
+                   const s_ptr<Material> &material)
 {
     destroy();
-    m_vertex_array.create(vertices, indices);
     m_vertices = vertices;
     m_indices = indices;
     m_material = material;
 
     // Calculate triangles
+    m_triangles.reserve(indices.size() / 3);
     for (int32_t i = 0; i < indices.size(); i += 3) {
         Triangle triangle;
         triangle.v0 = vertices[indices[i]].position;
@@ -65,6 +80,18 @@ void Mesh::create(const std::vector<Vertex> &vertices,
     }
 }
 
+void Mesh::upload()
+{
+    m_vertex_array.create(m_vertices, m_indices);
+    releaseCpuData();
+}
+
+void Mesh::upload(std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+{
+    m_vertex_array.create(vertices, indices);
+    releaseCpuData();
+}
+
 bool Mesh::isValid() const
 {
     return m_vertex_array.isValid();
@@ -77,6 +104,13 @@ void Mesh::destroy()
     m_vertices.clear();
     m_indices.clear();
     m_triangles.clear();
+    m_triangles_tree.reset();
+    m_released_memory = 0;
+}
+
+const VertexArray &Mesh::getVertexArray() const
+{
+    return m_vertex_array;
 }
 
 const AABB &Mesh::getAABB() const
@@ -84,6 +118,77 @@ const AABB &Mesh::getAABB() const
     return m_aabb;
 }
 
+void Mesh::setAABB(const AABB &aabb)
+{
+    m_aabb = aabb;
+}
+
+const u_ptr<TrianglesNode> &Mesh::getTrianglesTree() const
+{
+    return m_triangles_tree;
+}
+
+void Mesh::setTrianglesTree(u_ptr<TrianglesNode> &&triangles_tree)
+{
+    m_triangles_tree = std::move(triangles_tree);
+}
+
+MeshResidency Mesh::getResidency() const
+{
+    return m_residency;
+}
+
+void Mesh::setResidency(MeshResidency residency)
+{
+    m_residency = residency;
+    if (m_vertex_array.isValid())
+        releaseCpuData();
+}
+
+uint64_t Mesh::getCpuMemory() const
+{
+    uint64_t memory = m_vertices.capacity() * sizeof(Vertex)
+                      + m_indices.capacity() * sizeof(uint32_t)
+                      + m_triangles.capacity() * sizeof(Triangle);
+
+    std::function<void(const TrianglesNode *)> process_node = [&](const TrianglesNode *node) {
+        if (!node)
+            return;
+        memory += sizeof(TrianglesNode) + node->triangles.capacity() * sizeof(Triangle);
+        process_node(node->left.get());
+        process_node(node->right.get());
+    };
+    process_node(m_triangles_tree.get());
+
+    return memory;
+}
+
+uint64_t Mesh::getReleasedMemory() const
+{
+    return m_released_memory;
+}
+
+void Mesh::releaseCpuData()
+{
+    if (m_residency == MeshResidency::FULL)
+        return;
+
+    uint64_t memory = getCpuMemory();
+
+    // clear не освобождает память вектора
+    std::vector<Vertex>().swap(m_vertices);
+    std::vector<uint32_t>().swap(m_indices);
+
+    // Дерево содержит все треугольники меша, отдельный список не нужен
+    if (m_residency == MeshResidency::GPU_ONLY || m_triangles_tree)
+        std::vector<Triangle>().swap(m_triangles);
+
+    if (m_residency == MeshResidency::GPU_ONLY)
+        m_triangles_tree.reset();
+
+    m_released_memory += memory - getCpuMemory();
+}
+
 bool Mesh::isTransparent() const
 {
     return m_material && m_material->isTransparent();
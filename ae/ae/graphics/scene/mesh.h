@@ -2,6 +2,7 @@
 #define AE_MESH_H
 
 #include "../../geometry/primitives.h"
+#include "../../geometry/triangles_node.h"
 #include "../../system/memory.h"
 #include "../core/material.h"
 #include "../core/vertex.h"
@@ -10,7 +11,14 @@
 
 namespace ae {
 
-class Mesh : public Drawable
+// Данные меша, которые остаются в памяти процесса после загрузки в GL
+enum class MeshResidency {
+    FULL,           // вершины, индексы и треугольники
+    COLLISION_ONLY, // только треугольники (или дерево треугольников) для коллайдеров
+    GPU_ONLY        // только AABB
+};
+
+class Mesh : public Drawable, public RefCounted
 {
 public:
     Mesh();
@@ -32,17 +40,50 @@ public:
     bool isValid() const;
     void destroy();
 
+    // Раздельная загрузка: setData не трогает GL и может выполняться в рабочем потоке,
+    // upload создает VertexArray и должен вызываться в потоке с GL контекстом
+    void setData(const std::vector<Vertex> &vertices,
+                 const std::vector<uint32_t> &indices,
+                 const s_ptr<Material> &material);
+    void upload();
+    // Загрузка готовых буферов (например, отображенных в память) без копирования
+    // в m_vertices/m_indices. AABB и дерево треугольников задаются отдельно
+    void upload(std::span<const Vertex> vertices, std::span<const uint32_t> indices);
+
+    const VertexArray &getVertexArray() const;
+
     const AABB &getAABB() const;
+    void setAABB(const AABB &aabb);
+
+    // Предрассчитанное дерево треугольников в локальных координатах меша
+    const u_ptr<TrianglesNode> &getTrianglesTree() const;
+    void setTrianglesTree(u_ptr<TrianglesNode> &&triangles_tree);
+
+    // Политика применяется при загрузке в GL, а для уже загруженного меша - сразу.
+    // Освобожденные данные не восстанавливаются при возврате к FULL
+    MeshResidency getResidency() const;
+    void setResidency(MeshResidency residency);
+
+    // Память процесса, занятая данными меша, и освобожденная политикой хранения
+    uint64_t getCpuMemory() const;
+    uint64_t getReleasedMemory() const;
+
     bool isTransparent() const;
     void draw(const RenderState &render_state) const;
 
+private:
+    void releaseCpuData();
+
 private:
     std::vector<Vertex> m_vertices;
     std::vector<uint32_t> m_indices;
     std::vector<Triangle> m_triangles;
+    u_ptr<TrianglesNode> m_triangles_tree;
     s_ptr<Material> m_material;
     VertexArray m_vertex_array;
     AABB m_aabb;
+    MeshResidency m_residency;
+    uint64_t m_released_memory;
 };
 
 } // namespace ae
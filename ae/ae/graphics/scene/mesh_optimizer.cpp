@@ -0,0 +1,383 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace ae::mesh_optimizer {
+
+constexpr uint32_t NONE = ~0u;
+
+using VertexKey = std::array<int32_t, 20>;
+
+VertexKey makeVertexKey(const Vertex &vertex, float epsilon)
+{
+    VertexKey key;
+    int32_t i = 0;
+
+    auto add_float = [&](float value) {
+        if (epsilon > 0.0f) {
+            double cell = std::floor(static_cast<double>(value) / epsilon + 0.5);
+            key[i++] = static_cast<int32_t>(
+                std::clamp(cell,
+                           static_cast<double>(std::numeric_limits<int32_t>::min()),
+                           static_cast<double>(std::numeric_limits<int32_t>::max())));
+        } else {
+            key[i++] = std::bit_cast<int32_t>(value);
+        }
+    };
+
+    for (int32_t j = 0; j < 3; ++j)
+        add_float(vertex.position[j]);
+    for (int32_t j = 0; j < 3; ++j)
+        add_float(vertex.normal[j]);
+    for (int32_t j = 0; j < 4; ++j)
+        add_float(vertex.color[j]);
+    for (int32_t j = 0; j < 2; ++j)
+        add_float(vertex.tex_coords[j]);
+    for (int32_t j = 0; j < MAX_BONE_INFLUENCE; ++j)
+        key[i++] = vertex.bone_ids[j];
+    for (int32_t j = 0; j < MAX_BONE_INFLUENCE; ++j)
+        add_float(vertex.weights[j]);
+
+    return key;
+}
+
+int32_t weldVertices(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, float epsilon)
+{
+    int32_t vertex_count = vertices.size();
+    if (vertex_count == 0)
+        return 0;
+
+    std::vector<VertexKey> keys(vertex_count);
+    for (int32_t i = 0; i < vertex_count; ++i)
+        keys[i] = makeVertexKey(vertices[i], epsilon);
+
+    // При равных ключах первым идет меньший индекс, он и становится общей вершиной
+    std::vector<uint32_t> order(vertex_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return keys[a] != keys[b] ? keys[a] < keys[b] : a < b;
+    });
+
+    std::vector<uint32_t> representative(vertex_count);
+    for (int32_t i = 0; i < vertex_count;) {
+        int32_t j = i;
+        while (j < vertex_count && keys[order[j]] == keys[order[i]])
+            representative[order[j++]] = order[i];
+        i = j;
+    }
+
+    std::vector<uint32_t> remap(vertex_count, NONE);
+    std::vector<Vertex> welded;
+    for (int32_t i = 0; i < vertex_count; ++i) {
+        if (representative[i] == i) {
+            remap[i] = welded.size();
+            welded.push_back(vertices[i]);
+        }
+    }
+
+    for (auto &index : indices)
+        index = remap[representative[index]];
+
+    vertices = std::move(welded);
+
+    return vertices.size();
+}
+
+void optimizeVertexCache(std::vector<uint32_t> &indices,
+                         int32_t vertex_count,
+                         int32_t cache_size,
+                         std::vector<uint32_t> *clusters)
+{
+    if (clusters)
+        clusters->clear();
+
+    int32_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0 || vertex_count == 0)
+        return;
+
+    // Треугольники каждой вершины
+    std::vector<int32_t> live(vertex_count, 0);
+    for (uint32_t index : indices)
+        ++live[index];
+
+    std::vector<uint32_t> offsets(vertex_count + 1, 0);
+    for (int32_t i = 0; i < vertex_count; ++i)
+        offsets[i + 1] = offsets[i] + live[i];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (int32_t t = 0; t < triangle_count; ++t) {
+        for (int32_t k = 0; k < 3; ++k) {
+            uint32_t v = indices[t * 3 + k];
+            adjacency[fill[v]++] = t;
+        }
+    }
+
+    std::vector<int32_t> cache_time(vertex_count, 0);
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<uint32_t> dead_end;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+
+    int32_t time = cache_size + 1;
+    int32_t cursor = 0;
+    int32_t fanning = 0;
+    bool new_cluster = true;
+
+    while (fanning >= 0) {
+        candidates.clear();
+
+        for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; ++a) {
+            uint32_t t = adjacency[a];
+            if (emitted[t])
+                continue;
+
+            if (new_cluster) {
+                if (clusters)
+                    clusters->push_back(result.size() / 3);
+                new_cluster = false;
+            }
+
+            for (int32_t k = 0; k < 3; ++k) {
+                uint32_t v = indices[t * 3 + k];
+                result.push_back(v);
+                dead_end.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+
+                if (time - cache_time[v] > cache_size)
+                    cache_time[v] = time++;
+            }
+
+            emitted[t] = true;
+        }
+
+        // Следующая вершина: из соседей, которая останется в кэше дольше всех
+        fanning = -1;
+        int32_t best_priority = -1;
+        for (uint32_t v : candidates) {
+            if (live[v] <= 0)
+                continue;
+
+            int32_t priority = 0;
+            if (time - cache_time[v] + 2 * live[v] <= cache_size)
+                priority = time - cache_time[v];
+
+            if (priority > best_priority) {
+                best_priority = priority;
+                fanning = v;
+            }
+        }
+
+        // Тупик: недавно выведенные вершины, затем первая вершина с треугольниками
+        if (fanning == -1) {
+            while (!dead_end.empty()) {
+                uint32_t v = dead_end.back();
+                dead_end.pop_back();
+                if (live[v] > 0) {
+                    fanning = v;
+                    break;
+                }
+            }
+        }
+
+        if (fanning == -1) {
+            while (cursor < vertex_count && live[cursor] <= 0)
+                ++cursor;
+            if (cursor < vertex_count) {
+                fanning = cursor;
+                new_cluster = true;
+            }
+        }
+    }
+
+    indices = std::move(result);
+}
+
+void optimizeOverdraw(std::vector<uint32_t> &indices,
+                      const std::vector<Vertex> &vertices,
+                      const std::vector<uint32_t> &clusters,
+                      float threshold,
+                      int32_t cache_size)
+{
+    int32_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0 || vertices.empty())
+        return;
+
+    std::vector<uint32_t> hard_boundaries = clusters;
+    if (hard_boundaries.empty() || hard_boundaries.front() != 0)
+        hard_boundaries.insert(hard_boundaries.begin(), 0);
+    hard_boundaries.push_back(triangle_count);
+
+    std::vector<int32_t> cache_time(vertices.size(), 0);
+    int32_t time = cache_size + 1;
+
+    auto reset_cache = [&]() { time += cache_size + 1; };
+    auto count_misses = [&](int32_t t) {
+        int32_t misses = 0;
+        for (int32_t k = 0; k < 3; ++k) {
+            uint32_t v = indices[t * 3 + k];
+            if (time - cache_time[v] > cache_size) {
+                cache_time[v] = time++;
+                ++misses;
+            }
+        }
+        return misses;
+    };
+
+    // Дробление кластеров в местах, где ACMR с пустого кэша не хуже исходного
+    std::vector<uint32_t> boundaries;
+    for (int32_t c = 0; c + 1 < hard_boundaries.size(); ++c) {
+        int32_t begin = hard_boundaries[c];
+        int32_t end = hard_boundaries[c + 1];
+        if (begin >= end)
+            continue;
+
+        reset_cache();
+        int32_t cluster_misses = 0;
+        for (int32_t t = begin; t < end; ++t)
+            cluster_misses += count_misses(t);
+        float cluster_acmr = static_cast<float>(cluster_misses) / (end - begin);
+
+        reset_cache();
+        int32_t start = begin;
+        int32_t misses = 0;
+        boundaries.push_back(begin);
+
+        for (int32_t t = begin; t < end - 1; ++t) {
+            misses += count_misses(t);
+            if (static_cast<float>(misses) / (t + 1 - start) <= threshold * cluster_acmr) {
+                start = t + 1;
+                misses = 0;
+                boundaries.push_back(start);
+                reset_cache();
+            }
+        }
+    }
+    boundaries.push_back(triangle_count);
+
+    int32_t cluster_count = boundaries.size() - 1;
+
+    // Центр меша
+    vec3 mesh_center{0.0f};
+    for (uint32_t index : indices)
+        mesh_center += vertices[index].position;
+    mesh_center /= static_cast<float>(indices.size());
+
+    // Кластеры, обращенные наружу, рисуются первыми
+    std::vector<float> sort_keys(cluster_count, 0.0f);
+    for (int32_t c = 0; c < cluster_count; ++c) {
+        vec3 center{0.0f};
+        vec3 normal{0.0f};
+        float area = 0.0f;
+
+        for (int32_t t = boundaries[c]; t < boundaries[c + 1]; ++t) {
+            const vec3 &p0 = vertices[indices[t * 3]].position;
+            const vec3 &p1 = vertices[indices[t * 3 + 1]].position;
+            const vec3 &p2 = vertices[indices[t * 3 + 2]].position;
+
+            vec3 triangle_normal = glm::cross(p1 - p0, p2 - p0);
+            float triangle_area = glm::length(triangle_normal);
+
+            center += (p0 + p1 + p2) * (triangle_area / 3.0f);
+            normal += triangle_normal;
+            area += triangle_area;
+        }
+
+        float normal_length = glm::length(normal);
+        if (area > 0.0f && normal_length > 0.0f)
+            sort_keys[c] = glm::dot(center / area - mesh_center, normal / normal_length);
+    }
+
+    std::vector<uint32_t> order(cluster_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return sort_keys[a] > sort_keys[b];
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (uint32_t c : order) {
+        result.insert(result.end(),
+                      indices.begin() + boundaries[c] * 3,
+                      indices.begin() + boundaries[c + 1] * 3);
+    }
+
+    indices = std::move(result);
+}
+
+int32_t optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    std::vector<uint32_t> remap(vertices.size(), NONE);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (auto &index : indices) {
+        if (remap[index] == NONE) {
+            remap[index] = result.size();
+            result.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices = std::move(result);
+
+    return vertices.size();
+}
+
+float calculateACMR(const std::vector<uint32_t> &indices, int32_t vertex_count, int32_t cache_size)
+{
+    int32_t triangle_count = indices.size() / 3;
+    if (triangle_count == 0)
+        return 0.0f;
+
+    std::vector<int32_t> cache_time(vertex_count, 0);
+    int32_t time = cache_size + 1;
+    int32_t misses = 0;
+
+    for (uint32_t index : indices) {
+        if (time - cache_time[index] > cache_size) {
+            cache_time[index] = time++;
+            ++misses;
+        }
+    }
+
+    return static_cast<float>(misses) / triangle_count;
+}
+
+Stats optimize(std::vector<Vertex> &vertices,
+               std::vector<uint32_t> &indices,
+               float weld_epsilon,
+               float overdraw_threshold)
+{
+    Stats stats;
+    stats.vertices_before = vertices.size();
+    stats.acmr_before = calculateACMR(indices, vertices.size());
+
+    // Оптимизации рассчитаны только на списки треугольников
+    if (indices.empty() || indices.size() % 3 != 0) {
+        stats.vertices_after = stats.vertices_before;
+        stats.acmr_after = stats.acmr_before;
+        return stats;
+    }
+
+    std::vector<uint32_t> clusters;
+
+    weldVertices(vertices, indices, weld_epsilon);
+    optimizeVertexCache(indices, vertices.size(), DEFAULT_CACHE_SIZE, &clusters);
+    optimizeOverdraw(indices, vertices, clusters, overdraw_threshold);
+    optimizeVertexFetch(vertices, indices);
+
+    stats.vertices_after = vertices.size();
+    stats.acmr_after = calculateACMR(indices, vertices.size());
+
+    return stats;
+}
+
+} // namespace ae::mesh_optimizer
@@ -0,0 +1,63 @@
+#ifndef AE_MESH_OPTIMIZER_H
+#define AE_MESH_OPTIMIZER_H
+
+#include "../core/vertex.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ae::mesh_optimizer {
+
+// Оптимизация индексированных треугольных мешей при импорте. Все функции работают
+// только с данными в памяти, не используют GL и дают одинаковый результат
+// для одинаковых входных данных
+
+struct Stats
+{
+    int32_t vertices_before = 0;
+    int32_t vertices_after = 0;
+    float acmr_before = 0.0f;
+    float acmr_after = 0.0f;
+};
+
+constexpr int32_t DEFAULT_CACHE_SIZE = 16;
+
+// Объединяет одинаковые вершины. При epsilon == 0 сравнение побитовое, иначе атрибуты
+// квантуются с шагом epsilon. Порядок вершин - порядок первого появления
+int32_t weldVertices(std::vector<Vertex> &vertices,
+                     std::vector<uint32_t> &indices,
+                     float epsilon = 0.0f);
+
+// Tipsify: порядок треугольников под кэш вершин после трансформации.
+// В clusters записываются индексы первых треугольников кластеров, между которыми
+// алгоритм переходил в новую область меша
+void optimizeVertexCache(std::vector<uint32_t> &indices,
+                         int32_t vertex_count,
+                         int32_t cache_size = DEFAULT_CACHE_SIZE,
+                         std::vector<uint32_t> *clusters = nullptr);
+
+// Сортировка кластеров от внешних к внутренним для уменьшения перерисовки.
+// Кластеры дробятся, пока ACMR не превышает исходный больше чем в threshold раз
+void optimizeOverdraw(std::vector<uint32_t> &indices,
+                      const std::vector<Vertex> &vertices,
+                      const std::vector<uint32_t> &clusters,
+                      float threshold = 1.05f,
+                      int32_t cache_size = DEFAULT_CACHE_SIZE);
+
+// Порядок вершин по первому обращению из индексов, неиспользуемые вершины удаляются
+int32_t optimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
+
+// Среднее число промахов FIFO кэша вершин на треугольник
+float calculateACMR(const std::vector<uint32_t> &indices,
+                    int32_t vertex_count,
+                    int32_t cache_size = DEFAULT_CACHE_SIZE);
+
+// Все этапы по порядку
+Stats optimize(std::vector<Vertex> &vertices,
+               std::vector<uint32_t> &indices,
+               float weld_epsilon = 0.0f,
+               float overdraw_threshold = 1.05f);
+
+} // namespace ae::mesh_optimizer
+
+#endif // AE_MESH_OPTIMIZER_H
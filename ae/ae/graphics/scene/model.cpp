@@ -1,5 +1,6 @@
 #include "model.h"
 #include "assimp_helper.h"
+#include "cooked_model_helper.h"
 
 namespace ae {
 
@@ -39,6 +40,11 @@ Model::Model()
 
 bool Model::loadFromFile(const std::filesystem::path &path)
 {
+    if (path.extension() == cooked_model::EXTENSION) {
+        CookedModelHelper cooked_model_helper{path, nullptr};
+        return cooked_model_helper.load(this);
+    }
+
     AssimpHelper assimp_helper{path, nullptr};
     if (!assimp_helper.load(this))
         return false;
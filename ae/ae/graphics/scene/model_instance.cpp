@@ -42,10 +42,14 @@ bool ModelInstance::isTransparent() const
 
 void ModelInstance::draw(const RenderState &render_state) const
 {
-    if (m_pose && !m_pose->getFinalTransforms().empty()) {
+    const std::vector<mat4> *bone_transforms = render_state.bone_transforms;
+    if (!bone_transforms && m_pose)
+        bone_transforms = &m_pose->getFinalTransforms();
+
+    if (bone_transforms && !bone_transforms->empty()) {
         render_state.shader->uniformInt("u_skeleton", true);
 
-        auto transforms = m_pose->getFinalTransforms();
+        const auto &transforms = *bone_transforms;
         for (int32_t i = 0; i < transforms.size(); ++i)
             render_state.shader->uniformMatrix("u_finalBonesMats[" + std::to_string(i) + "]",
                                                transforms[i]);
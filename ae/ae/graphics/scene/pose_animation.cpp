@@ -26,6 +26,7 @@ void PoseAnimation::addBone(const std::string &name, const Bone &bone)
 {
     int32_t index = static_cast<int32_t>(m_bones.size());
     m_bones.push_back(bone);
+    m_bone_names.push_back(name);
     m_name_to_index[name] = index;
 }
 
@@ -39,6 +40,21 @@ const PoseAnimation::Bone &PoseAnimation::getBone(const std::string &name) const
     return m_bones.at(m_name_to_index.at(name));
 }
 
+int32_t PoseAnimation::getBoneCount() const
+{
+    return m_bones.size();
+}
+
+const std::string &PoseAnimation::getBoneName(int32_t index) const
+{
+    return m_bone_names[index];
+}
+
+const PoseAnimation::Bone &PoseAnimation::getBone(int32_t index) const
+{
+    return m_bones[index];
+}
+
 vec3 PoseAnimation::interpolatePosition(const std::string &name, float animation_time) const
 {
     if (!m_name_to_index.contains(name))
@@ -56,6 +56,10 @@ public:
     bool contains(const std::string &name) const;
     const Bone &getBone(const std::string &name) const;
 
+    int32_t getBoneCount() const;
+    const std::string &getBoneName(int32_t index) const;
+    const Bone &getBone(int32_t index) const;
+
     vec3 interpolatePosition(const std::string &name, float animation_time) const;
     quat interpolateRotation(const std::string &name, float animation_time) const;
     vec3 interpolateScaling(const std::string &name, float animation_time) const;
@@ -81,6 +85,7 @@ private:
     float m_duration;
     int32_t m_ticks_per_second;
     std::vector<Bone> m_bones;
+    std::vector<std::string> m_bone_names;
     std::unordered_map<std::string, int32_t> m_name_to_index;
 };
 
@@ -41,7 +41,7 @@ const String &ButtonBase::getString() const
 void ButtonBase::setString(const String &string)
 {
     m_string = string;
-    updateImplicitSize();
+    invalidateImplicitSize();
     repaint();
 }
 
@@ -53,7 +53,7 @@ float ButtonBase::getLineSpacing() const
 void ButtonBase::setLineSpacing(float line_spacing)
 {
     m_line_spacing = line_spacing;
-    updateImplicitSize();
+    invalidateImplicitSize();
     repaint();
 }
 
@@ -71,8 +71,11 @@ void ButtonBase::onButtonReleased(ButtonCode button)
 
 void ButtonBase::updateImplicitSize()
 {
-    vec2 text_size
-        = getFont()->getFontPage(getFontPixelHeight())->getTextSize(m_string, m_line_spacing);
+    auto *font_page = getFont() ? getFont()->getFontPage(getFontPixelHeight()) : nullptr;
+    if (!font_page)
+        return;
+
+    vec2 text_size = font_page->getTextSize(m_string, m_line_spacing);
 
     const auto &padding = getPadding();
     text_size.x += padding.x + padding.z;
@@ -16,12 +16,18 @@ Control::Control(EngineContext &engine_context)
     , m_visible{true}
     , m_padding{0.0f}
     , m_implicit_size{32.0f}
+    , m_implicit_size_dirty{true}
+    , m_layout_dirty{true}
+    , m_child_layout_dirty{false}
+    , m_children_affect_layout{false}
     , m_size{32.0f}
     , m_position{0.0f}
     , m_transform{1.0f}
     , m_transform_dirty{true}
     , m_font_pixel_height{28.0f}
     , m_draw_dirty{true}
+    , m_drawn_bounds{0.0f}
+    , m_damaged{true}
     , m_destroyed{false}
 {
     m_font = Gui::getDefaultFont();
@@ -43,10 +49,15 @@ void Control::setParent(const s_ptr<Control> &parent)
 {
     auto p = m_parent.lock();
     if (p) {
+        damageDrawnBounds();
         p->m_children.erase(std::remove(p->m_children.begin(),
                                         p->m_children.end(),
                                         sharedFromThis()),
                             p->m_children.end());
+        if (p->m_children_affect_layout) {
+            p->invalidateImplicitSize();
+            p->invalidateLayout();
+        }
     }
 
     m_parent = parent;
@@ -55,6 +66,14 @@ void Control::setParent(const s_ptr<Control> &parent)
         auto ptr = sharedFromThis();
         p->m_children.push_back(ptr);
         updateGui(p->m_gui);
+        markDamaged();
+
+        if (m_implicit_size_dirty || m_layout_dirty || m_child_layout_dirty)
+            markLayoutPath();
+        if (p->m_children_affect_layout) {
+            p->invalidateImplicitSize();
+            p->invalidateLayout();
+        }
     } else
         updateGui(nullptr);
 }
@@ -93,7 +112,11 @@ bool Control::isVisible() const
 
 void Control::setVisible(bool visible)
 {
-    m_visible = true;
+    if (m_visible == visible)
+        return;
+
+    m_visible = visible;
+    markDamaged();
 }
 
 const vec4 &Control::getPadding() const
@@ -104,16 +127,48 @@ const vec4 &Control::getPadding() const
 void Control::setPadding(const vec4 &padding)
 {
     m_padding = padding;
+    invalidateImplicitSize();
+    invalidateLayout();
+    repaint();
 }
 
 const vec2 &Control::getImplicitSize() const
 {
+    if (m_implicit_size_dirty)
+        measure();
     return m_implicit_size;
 }
 
 void Control::setImplicitSize(const vec2 &implicit_size)
 {
+    if (m_implicit_size == implicit_size)
+        return;
+
     m_implicit_size = implicit_size;
+
+    auto p = m_parent.lock();
+    if (p && p->m_children_affect_layout) {
+        p->invalidateImplicitSize();
+        p->invalidateLayout();
+    }
+}
+
+void Control::invalidateImplicitSize()
+{
+    if (m_implicit_size_dirty)
+        return;
+
+    m_implicit_size_dirty = true;
+    markLayoutPath();
+}
+
+void Control::invalidateLayout()
+{
+    if (m_layout_dirty)
+        return;
+
+    m_layout_dirty = true;
+    markLayoutPath();
 }
 
 const vec2 &Control::getSize() const
@@ -123,8 +178,12 @@ const vec2 &Control::getSize() const
 
 void Control::setSize(const vec2 &size)
 {
+    if (m_size == size)
+        return;
+
     m_size = size;
     repaint();
+    invalidateLayout();
     onSizeChanged(size);
 }
 
@@ -137,6 +196,7 @@ void Control::setPosition(const vec2 &position)
 {
     m_position = position;
     m_transform_dirty = true;
+    markDamaged();
 }
 
 const mat4 &Control::getTransform() const
@@ -179,7 +239,8 @@ void Control::setFontPixelHeight(float pixel_size)
 {
     m_font_pixel_height = pixel_size;
     repaint();
-    updateImplicitSize();
+    invalidateImplicitSize();
+    invalidateLayout();
 }
 
 const s_ptr<Font> &Control::getFont() const
@@ -191,33 +252,28 @@ void Control::setFont(const s_ptr<Font> &font)
 {
     m_font = font;
     repaint();
-    updateImplicitSize();
+    invalidateImplicitSize();
+    invalidateLayout();
 }
 
 void Control::repaint()
 {
     m_draw_dirty = true;
+    markDamaged();
 }
 
-void Control::draw(Shader *shader, const mat4 &transform) const
+const Batch2D &Control::getBatch() const
 {
-    if (!m_visible)
-        return;
-
-    mat4 t = transform * getTransform();
+    if (m_implicit_size_dirty)
+        measure();
 
     if (m_draw_dirty) {
         m_draw_dirty = false;
         m_batch_2d.begin();
         const_cast<Control *>(this)->drawControl(m_batch_2d);
-        m_batch_2d.end();
     }
 
-    shader->uniformMatrix("u_model", t);
-    m_batch_2d.draw();
-
-    for (const auto &child : m_children)
-        child->draw(shader, t);
+    return m_batch_2d;
 }
 
 void Control::onCreated() {}
@@ -248,6 +304,18 @@ void Control::drawControl(Batch2D &batch_2d) {}
 
 void Control::updateImplicitSize() {}
 
+void Control::arrange() {}
+
+bool Control::isImplicitSizeDirty() const
+{
+    return m_implicit_size_dirty;
+}
+
+void Control::setChildrenAffectLayout(bool affect)
+{
+    m_children_affect_layout = affect;
+}
+
 void Control::updateGui(Gui *gui)
 {
     m_gui = gui;
@@ -255,4 +323,57 @@ void Control::updateGui(Gui *gui)
         child->updateGui(gui);
 }
 
+void Control::updateLayout()
+{
+    if (m_implicit_size_dirty)
+        measure();
+
+    if (m_layout_dirty) {
+        // Флаг снимается после arrange: собственный setSize внутри него не повторяет проход
+        arrange();
+        m_layout_dirty = false;
+        if (m_gui)
+            ++m_gui->m_layout_counters.arranged_controls;
+    }
+
+    if (m_child_layout_dirty) {
+        m_child_layout_dirty = false;
+        // arrange потомка может менять список детей
+        auto children = m_children;
+        for (auto &child : children)
+            child->updateLayout();
+    }
+}
+
+void Control::measure() const
+{
+    m_implicit_size_dirty = false;
+    const_cast<Control *>(this)->updateImplicitSize();
+    if (m_gui)
+        ++m_gui->m_layout_counters.measured_controls;
+}
+
+void Control::markLayoutPath()
+{
+    for (auto p = m_parent.lock(); p && !p->m_child_layout_dirty; p = p->m_parent.lock())
+        p->m_child_layout_dirty = true;
+
+    if (m_gui)
+        m_gui->m_layout_requested = true;
+}
+
+void Control::markDamaged()
+{
+    m_damaged = true;
+    if (m_gui)
+        m_gui->m_damaged = true;
+}
+
+void Control::damageDrawnBounds()
+{
+    if (m_gui)
+        m_gui->addDamage(m_drawn_bounds);
+    m_drawn_bounds = vec4{0.0f};
+}
+
 } // namespace ae::gui
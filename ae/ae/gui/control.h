@@ -23,8 +23,12 @@ namespace ae::gui {
 class Control : public EngineContextObject, public EnableSharedFromThis<Control>
 {
     friend class ::ae::Gui;
+    friend class GuiRenderer;
 
 public:
+    AE_POOL_ALLOCATED
+    AE_SINGLE_THREAD_REF_COUNT
+
     enum State {
         DISABLED = 0x0001,
         DEFAULT = 0x0002,
@@ -42,6 +46,7 @@ public:
             // Удаляем из потомков родителя, если он установлен
             auto p = ptr->m_parent.lock();
             if (p && !p->m_destroyed) {
+                ptr->damageDrawnBounds();
                 p->m_children.erase(std::remove(p->m_children.begin(),
                                                 p->m_children.end(),
                                                 ptr->sharedFromThis()),
@@ -82,9 +87,16 @@ public:
     const vec4 &getPadding() const;
     void setPadding(const vec4 &padding);
 
+    // Размер по содержимому. Если он помечен устаревшим, пересчитывается при чтении
     const vec2 &getImplicitSize() const;
     void setImplicitSize(const vec2 &implicit_size);
 
+    // Разметка выполняется в два прохода при Gui::updateLayout: измерение (updateImplicitSize)
+    // и расстановка потомков (arrange). Изменения свойств только помечают элемент,
+    // поэтому несколько изменений за кадр приводят к одному пересчету
+    void invalidateImplicitSize();
+    void invalidateLayout();
+
     const vec2 &getSize() const;
     void setSize(const vec2 &size);
 
@@ -103,7 +115,9 @@ public:
     void setFont(const s_ptr<Font> &font);
 
     void repaint();
-    virtual void draw(Shader *shader, const mat4 &transform = mat4{1.0f}) const;
+    // Геометрия элемента в его собственных координатах. Перестраивается только после repaint,
+    // на GPU ее вместе с остальными элементами загружает GuiRenderer
+    const Batch2D &getBatch() const;
 
     // Events
     virtual void onCreated();
@@ -125,10 +139,26 @@ public:
 
 protected:
     virtual void drawControl(Batch2D &batch_2d);
+    // Измерение: вычисляет размер по содержимому и передает его в setImplicitSize
     virtual void updateImplicitSize();
+    // Расстановка: размещает потомков внутри getSize()
+    virtual void arrange();
+
+    bool isImplicitSizeDirty() const;
+    // Если включено, изменение размера по содержимому у потомка заново измеряет
+    // и расставляет этот элемент. Иначе изменение дальше потомка не распространяется
+    void setChildrenAffectLayout(bool affect);
 
 private:
     void updateGui(Gui *gui);
+    void updateLayout();
+    void measure() const;
+    // Помечает путь к корню, чтобы проход разметки дошел до элемента
+    void markLayoutPath();
+    // Область элемента нужно перерисовать в следующем кадре
+    void markDamaged();
+    // Перерисовать место, где элемент с потомками был нарисован в прошлый раз
+    void damageDrawnBounds();
 
 private:
     Gui *m_gui;
@@ -144,6 +174,10 @@ private:
     // left, top, right, bottom
     vec4 m_padding;
     vec2 m_implicit_size;
+    mutable bool m_implicit_size_dirty;
+    bool m_layout_dirty;
+    bool m_child_layout_dirty;
+    bool m_children_affect_layout;
     vec2 m_size;
     vec2 m_position;
     mutable mat4 m_transform;
@@ -155,6 +189,11 @@ private:
     mutable Batch2D m_batch_2d;
     mutable bool m_draw_dirty;
 
+    // Заполняются GuiRenderer: границы элемента с потомками на экране в прошлом кадре
+    // (min x, min y, max x, max y) и признак того, что их нужно перерисовать
+    mutable vec4 m_drawn_bounds;
+    mutable bool m_damaged;
+
     bool m_destroyed;
 };
 
@@ -2,6 +2,8 @@
 #include "../engine.h"
 #include "../graphics/core/default_shaders.h"
 #include "../graphics/core/shader.h"
+#include "../system/clock.h"
+#include "../system/log.h"
 
 #include "battery/embed.hpp"
 
@@ -13,6 +15,9 @@ s_ptr<Font> Gui::m_default_font;
 
 Gui::Gui(EngineContext &engine_context)
     : EngineContextObject{engine_context}
+    , m_damaged{true}
+    , m_full_damage{true}
+    , m_layout_requested{true}
 {
     m_render_texture.setClearColor(Color::transparent);
     m_fps_label = gui::Control::create<Label>(engine_context);
@@ -37,6 +42,8 @@ void Gui::setRenderTextureSize(const ivec2 &size)
 
     for (auto &control : m_controls_stack)
         control->setSize(vec2{size.x, size.y});
+
+    invalidate();
 }
 
 s_ptr<Control> Gui::top() const
@@ -51,6 +58,8 @@ void Gui::push(const s_ptr<Control> &control)
     m_controls_stack.push_back(control);
     control->setSize(m_render_texture.getSize());
     control->updateGui(this);
+    m_layout_requested = true;
+    invalidate();
 }
 
 void Gui::pop()
@@ -58,37 +67,141 @@ void Gui::pop()
     if (!m_controls_stack.empty()) {
         m_controls_stack.back()->updateGui(nullptr);
         m_controls_stack.pop_back();
+        invalidate();
     }
 }
 
 void Gui::clear()
 {
     m_controls_stack.clear();
+    invalidate();
 }
 
-void Gui::update(const Time &dt) {}
+void Gui::update(const Time &dt)
+{
+    updateLayout();
+}
 
 void Gui::draw() const
 {
-    m_render_texture.clear();
+    // Fps label
+    m_fps_label->setString(String("FPS: " + std::to_string(getEngineContext().getFps())));
+
+    // Изменения после update, например из обработчиков ввода
+    updateLayout();
+
+    if (!m_damaged) {
+        m_draw_stats.redrawn_pixels = 0;
+        m_draw_stats.damage_rects = 0;
+        ++m_draw_stats.skipped_frames;
+        return;
+    }
+    m_damaged = false;
+
+    m_renderer.begin();
+    for (const auto &control : m_controls_stack)
+        m_renderer.addControl(*control);
+    m_renderer.addControl(*m_fps_label);
+    m_renderer.end();
+
+    // Поврежденные области в координатах текстуры: x, y, ширина, высота, y снизу вверх
+    const ivec2 &size = m_render_texture.getSize();
+    std::vector<ivec4> rects;
+    if (m_full_damage) {
+        rects.push_back(ivec4{0, 0, size.x, size.y});
+    } else {
+        for (const auto &damage : m_renderer.getDamage()) {
+            ivec2 min = clamp(ivec2{damage.x, damage.y}, ivec2{0}, size);
+            ivec2 max = clamp(ivec2{damage.z, damage.w}, ivec2{0}, size);
+            if (min.x < max.x && min.y < max.y)
+                rects.push_back(ivec4{min.x, size.y - max.y, max.x - min.x, max.y - min.y});
+        }
+    }
+    m_full_damage = false;
+    m_renderer.clearDamage();
+
+    m_draw_stats.redrawn_pixels = 0;
+    m_draw_stats.damage_rects = rects.size();
+    ++m_draw_stats.drawn_frames;
+
+    if (rects.empty())
+        return;
+
     glDisable(GL_CULL_FACE);
     glDisable(GL_DEPTH_TEST);
+    glEnable(GL_SCISSOR_TEST);
 
     Shader::use(*DefaultShaders::getGui());
     DefaultShaders::getGui()->uniformMatrix("u_projMat", m_proj_mat);
 
-    for (const auto &control : m_controls_stack)
-        control->draw(DefaultShaders::getGui().get(), mat4{1.0f});
+    ivec4 display_rect = rects.front();
+    for (const auto &rect : rects) {
+        glScissor(rect.x, rect.y, rect.z, rect.w);
+        m_render_texture.clear();
+        m_renderer.draw(DefaultShaders::getGui().get());
 
-    // Fps label
-    m_fps_label->setString(String("FPS: " + std::to_string(getEngineContext().getFps())));
-    m_fps_label->draw(DefaultShaders::getGui().get(), mat4{1.0f});
+        m_draw_stats.redrawn_pixels += int64_t(rect.z) * rect.w;
+
+        ivec2 min = glm::min(ivec2{display_rect}, ivec2{rect});
+        ivec2 max = glm::max(ivec2{display_rect} + ivec2{display_rect.z, display_rect.w},
+                             ivec2{rect} + ivec2{rect.z, rect.w});
+        display_rect = ivec4{min, max - min};
+    }
 
     Shader::unuse();
 
+    glDisable(GL_SCISSOR_TEST);
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
-    m_render_texture.display();
+    m_render_texture.display(display_rect);
+}
+
+const GuiRenderer &Gui::getRenderer() const
+{
+    return m_renderer;
+}
+
+const Gui::DrawStats &Gui::getDrawStats() const
+{
+    return m_draw_stats;
+}
+
+void Gui::updateLayout() const
+{
+    if (!m_layout_requested)
+        return;
+
+    Clock clock;
+    m_layout_counters = LayoutStats{};
+
+    while (m_layout_requested && m_layout_counters.passes < MAX_LAYOUT_PASSES) {
+        m_layout_requested = false;
+        // arrange может менять стек, например закрывать диалог
+        auto controls = m_controls_stack;
+        for (auto &control : controls)
+            control->updateLayout();
+        m_fps_label->updateLayout();
+        ++m_layout_counters.passes;
+    }
+
+    if (m_layout_requested) {
+        l_warn("GUI layout did not settle after {} passes", MAX_LAYOUT_PASSES);
+        m_layout_requested = false;
+    }
+
+    m_layout_counters.time_us = clock.getElapsedTime().asMicroseconds();
+    m_layout_stats = m_layout_counters;
+}
+
+const Gui::LayoutStats &Gui::getLayoutStats() const
+{
+    return m_layout_stats;
+}
+
+void Gui::invalidate()
+{
+    m_damaged = true;
+    m_full_damage = true;
 }
 
 void Gui::onButtonPressed(ButtonCode button)
@@ -191,6 +304,12 @@ void Gui::setDefaultFont(const s_ptr<Font> &font)
     m_default_font = font;
 }
 
+void Gui::addDamage(const vec4 &rect)
+{
+    m_renderer.addDamage(rect);
+    m_damaged = true;
+}
+
 s_ptr<Control> Gui::getHoveredContol(const vec2 &pos, vec2 *control_global_position) const
 {
     if (!m_controls_stack.empty() && m_controls_stack.back()->contains(pos)) {
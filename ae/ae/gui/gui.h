@@ -8,6 +8,7 @@
 #include "../system/time.h"
 #include "../window/input.h"
 #include "control.h"
+#include "gui_renderer.h"
 #include "label.h"
 
 #include <glm/glm.hpp>
@@ -22,6 +23,28 @@ class Gui : public EngineContextObject
     friend class gui::Control;
 
 public:
+    struct DrawStats
+    {
+        // Последний кадр
+        int64_t redrawn_pixels = 0;
+        int32_t damage_rects = 0;
+        // Кадры, в которых текстура интерфейса перерисовывалась или осталась прежней
+        int32_t drawn_frames = 0;
+        int32_t skipped_frames = 0;
+    };
+
+    struct LayoutStats
+    {
+        // Последний проход разметки
+        int64_t time_us = 0;
+        int32_t measured_controls = 0;
+        int32_t arranged_controls = 0;
+        int32_t passes = 0;
+    };
+
+    // Расстановка может снова изменить размеры, но не бесконечно
+    static constexpr int32_t MAX_LAYOUT_PASSES = 4;
+
     Gui(EngineContext &engine_context);
     ~Gui() = default;
 
@@ -37,6 +60,16 @@ public:
     void update(const Time &dt);
     void draw() const;
 
+    // Пересчитывает разметку помеченных элементов. Вызывается из update и draw,
+    // при отсутствии изменений ничего не делает
+    void updateLayout() const;
+    const LayoutStats &getLayoutStats() const;
+
+    const GuiRenderer &getRenderer() const;
+    const DrawStats &getDrawStats() const;
+    // Следующий кадр перерисует всю текстуру интерфейса
+    void invalidate();
+
     // Input events
     void onButtonPressed(ButtonCode button);
     void onButtonReleased(ButtonCode button);
@@ -51,6 +84,8 @@ public:
     static void setDefaultFont(const s_ptr<Font> &font);
 
 private:
+    void addDamage(const vec4 &rect);
+
     s_ptr<Control> getHoveredContol(const vec2 &pos,
                                         vec2 *control_global_position = nullptr) const;
 
@@ -66,6 +101,17 @@ private:
     WeakPtr<Control> m_focused_control;
 
     s_ptr<Label> m_fps_label;
+
+    mutable GuiRenderer m_renderer;
+    // Текстура интерфейса перерисовывается, только если что-то изменилось
+    mutable bool m_damaged;
+    mutable bool m_full_damage;
+    mutable DrawStats m_draw_stats;
+
+    mutable bool m_layout_requested;
+    mutable LayoutStats m_layout_stats;
+    // Счетчики текущего прохода, заполняются элементами
+    mutable LayoutStats m_layout_counters;
 };
 
 } // namespace ae
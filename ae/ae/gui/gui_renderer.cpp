@@ -0,0 +1,226 @@
+#include "gui_renderer.h"
+#include "control.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ae::gui {
+
+GuiRenderer::GuiRenderer()
+    : m_atlas_failed{false}
+    , m_batches_count{0}
+{}
+
+void GuiRenderer::begin()
+{
+    // Атлас создается при первом кадре, когда контекст GL уже есть
+    if (!m_atlas.isValid() && !m_atlas_failed)
+        m_atlas_failed = !m_atlas.create();
+
+    for (int32_t i = 0; i < m_batches_count; ++i) {
+        m_batches[i].texture.reset();
+        m_batches[i].vertices.clear();
+    }
+
+    m_batches_count = 0;
+    m_stats = Stats{};
+}
+
+vec4 GuiRenderer::addControl(const Control &control, const vec2 &offset)
+{
+    bool damaged = control.m_damaged;
+    control.m_damaged = false;
+
+    if (!control.isVisible()) {
+        if (damaged)
+            addDamage(control.m_drawn_bounds);
+        control.m_drawn_bounds = vec4{0.0f};
+        return vec4{0.0f};
+    }
+
+    vec2 position = offset + control.getPosition();
+    vec4 bounds{0.0f};
+
+    const auto &batch_2d = control.getBatch();
+    for (const auto &command : batch_2d.getDrawCommands())
+        bounds = unite(bounds, addCommand(batch_2d, command, position));
+
+    ++m_stats.controls;
+
+    for (const auto &child : control.getChildren())
+        bounds = unite(bounds, addControl(*child, position));
+
+    if (damaged) {
+        addDamage(control.m_drawn_bounds);
+        addDamage(bounds);
+    }
+    control.m_drawn_bounds = bounds;
+
+    return bounds;
+}
+
+void GuiRenderer::end()
+{
+    m_batch_2d.begin();
+    for (int32_t i = 0; i < m_batches_count; ++i) {
+        const auto &batch = m_batches[i];
+        m_batch_2d.drawVertices(batch.vertices, batch.texture, batch.sdf);
+    }
+    m_batch_2d.end();
+
+    m_stats.vertices = m_batch_2d.getVertices().size();
+    m_stats.draw_calls = m_batch_2d.getDrawCommands().size();
+}
+
+void GuiRenderer::draw(Shader *shader) const
+{
+    // Вершины уже в координатах экрана
+    shader->uniformMatrix("u_model", mat4{1.0f});
+    m_batch_2d.draw(shader);
+}
+
+void GuiRenderer::addDamage(const vec4 &rect)
+{
+    if (isEmpty(rect))
+        return;
+
+    // Запас в пиксель на сглаживание краев, границы по целым пикселям
+    vec4 damage{floor(rect.x) - 1.0f,
+                floor(rect.y) - 1.0f,
+                ceil(rect.z) + 1.0f,
+                ceil(rect.w) + 1.0f};
+
+    // Пересекающиеся области объединяются, пока это возможно
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (auto it = m_damage.begin(); it != m_damage.end(); ++it) {
+            if (intersects(*it, damage)) {
+                damage = unite(*it, damage);
+                m_damage.erase(it);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    m_damage.push_back(damage);
+
+    if (m_damage.size() > MAX_DAMAGE_RECTS) {
+        for (const auto &other : m_damage)
+            damage = unite(damage, other);
+        m_damage.assign(1, damage);
+    }
+}
+
+const std::vector<vec4> &GuiRenderer::getDamage() const
+{
+    return m_damage;
+}
+
+void GuiRenderer::clearDamage()
+{
+    m_damage.clear();
+}
+
+const GuiRenderer::Stats &GuiRenderer::getStats() const
+{
+    return m_stats;
+}
+
+const TextureAtlas &GuiRenderer::getAtlas() const
+{
+    return m_atlas;
+}
+
+vec4 GuiRenderer::addCommand(const Batch2D &batch_2d,
+                             const Batch2D::DrawCommand &command,
+                             const vec2 &offset)
+{
+    if (command.count <= 0)
+        return vec4{0.0f};
+
+    std::span<const Batch2DVertex2> vertices{batch_2d.getVertices().data() + command.offset,
+                                             static_cast<size_t>(command.count)};
+
+    // Геометрия без текстуры рисуется белым участком атласа
+    s_ptr<Texture> texture = command.texture;
+    const vec4 *uv_rect = nullptr;
+    if (m_atlas.isValid() && !command.sdf) {
+        uv_rect = texture ? m_atlas.getRect(texture) : &m_atlas.getWhiteRect();
+        if (uv_rect)
+            texture = m_atlas.getTexture();
+    }
+
+    vec4 bounds{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest()};
+    for (const auto &vertex : vertices) {
+        bounds.x = std::min(bounds.x, vertex.position.x);
+        bounds.y = std::min(bounds.y, vertex.position.y);
+        bounds.z = std::max(bounds.z, vertex.position.x);
+        bounds.w = std::max(bounds.w, vertex.position.y);
+    }
+    bounds += vec4{offset, offset};
+
+    auto &batch = getBatch(texture, command.sdf, bounds);
+    for (const auto &vertex : vertices) {
+        Batch2DVertex2 v = vertex;
+        v.position += vec3{offset, 0.0f};
+        if (uv_rect) {
+            v.tex_coords = vec2{uv_rect->x, uv_rect->y}
+                           + v.tex_coords * vec2{uv_rect->z - uv_rect->x, uv_rect->w - uv_rect->y};
+        }
+        batch.vertices.push_back(v);
+    }
+
+    return bounds;
+}
+
+GuiRenderer::Batch &GuiRenderer::getBatch(const s_ptr<Texture> &texture,
+                                          bool sdf,
+                                          const vec4 &bounds)
+{
+    // Перенос в более ранний пакет не меняет результат, только если команда не пересекается
+    // ни с одним из пакетов, нарисованных после него
+    int32_t last = std::max(m_batches_count - MAX_BATCH_LOOKBACK, 0);
+    for (int32_t i = m_batches_count - 1; i >= last; --i) {
+        auto &batch = m_batches[i];
+        if (batch.texture == texture && batch.sdf == sdf) {
+            batch.bounds = unite(batch.bounds, bounds);
+            return batch;
+        }
+
+        if (intersects(batch.bounds, bounds))
+            break;
+    }
+
+    if (m_batches_count == static_cast<int32_t>(m_batches.size()))
+        m_batches.emplace_back();
+
+    auto &batch = m_batches[m_batches_count++];
+    batch.texture = texture;
+    batch.sdf = sdf;
+    batch.bounds = bounds;
+    return batch;
+}
+
+bool GuiRenderer::isEmpty(const vec4 &rect)
+{
+    return !(rect.x < rect.z && rect.y < rect.w);
+}
+
+bool GuiRenderer::intersects(const vec4 &a, const vec4 &b)
+{
+    return a.x < b.z && b.x < a.z && a.y < b.w && b.y < a.w;
+}
+
+vec4 GuiRenderer::unite(const vec4 &a, const vec4 &b)
+{
+    if (isEmpty(a))
+        return b;
+    if (isEmpty(b))
+        return a;
+
+    return vec4{std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.z, b.z), std::max(a.w, b.w)};
+}
+
+} // namespace ae::gui
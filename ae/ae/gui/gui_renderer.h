@@ -0,0 +1,93 @@
+#ifndef AE_GUI_RENDERER_H
+#define AE_GUI_RENDERER_H
+
+#include "../graphics/core/batch_2d.h"
+#include "../graphics/core/shader.h"
+#include "../graphics/core/texture_atlas.h"
+#include "../system/memory.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+using namespace glm;
+
+namespace ae::gui {
+
+class Control;
+
+// Собирает геометрию всего дерева элементов в один буфер вершин. Вершины сдвигаются
+// на позиции элементов, небольшие текстуры заменяются участками общего атласа.
+// Команда рисования переносится в более ранний пакет с той же текстурой, если не
+// пересекается с пакетами после него, поэтому экран обычно рисуется за 1-3 вызова
+class GuiRenderer
+{
+public:
+    // Сколько последних пакетов просматривается в поисках пакета с той же текстурой
+    static constexpr int32_t MAX_BATCH_LOOKBACK = 16;
+    // При большем количестве поврежденные области объединяются в одну
+    static constexpr int32_t MAX_DAMAGE_RECTS = 4;
+
+    struct Stats
+    {
+        int32_t controls = 0;
+        int32_t vertices = 0;
+        int32_t draw_calls = 0;
+    };
+
+    GuiRenderer();
+    ~GuiRenderer() = default;
+
+    void begin();
+    // Возвращает границы элемента с потомками на экране. Для элементов, измененных
+    // с прошлого кадра, старые и новые границы добавляются к поврежденным областям
+    vec4 addControl(const Control &control, const vec2 &offset = vec2{0.0f});
+    void end();
+
+    void draw(Shader *shader) const;
+
+    // Области (min x, min y, max x, max y), которые нужно перерисовать.
+    // Накапливаются до вызова clearDamage
+    void addDamage(const vec4 &rect);
+    const std::vector<vec4> &getDamage() const;
+    void clearDamage();
+
+    const Stats &getStats() const;
+    const TextureAtlas &getAtlas() const;
+
+private:
+    struct Batch
+    {
+        s_ptr<Texture> texture;
+        bool sdf = false;
+        // min x, min y, max x, max y
+        vec4 bounds{0.0f};
+        std::vector<Batch2DVertex2> vertices;
+    };
+
+    vec4 addCommand(const Batch2D &batch_2d,
+                    const Batch2D::DrawCommand &command,
+                    const vec2 &offset);
+    Batch &getBatch(const s_ptr<Texture> &texture, bool sdf, const vec4 &bounds);
+
+    static bool isEmpty(const vec4 &rect);
+    static bool intersects(const vec4 &a, const vec4 &b);
+    static vec4 unite(const vec4 &a, const vec4 &b);
+
+private:
+    TextureAtlas m_atlas;
+    bool m_atlas_failed;
+
+    // Пакеты не удаляются между кадрами, чтобы не терять выделенную память
+    std::vector<Batch> m_batches;
+    int32_t m_batches_count;
+
+    Batch2D m_batch_2d;
+    Stats m_stats;
+
+    std::vector<vec4> m_damage;
+};
+
+} // namespace ae::gui
+
+#endif // AE_GUI_RENDERER_H
@@ -60,7 +60,7 @@ void Image::drawControl(Batch2D &batch_2d)
     batch_2d.drawTextureFrameRect({0.0f, 0.0f},
                                   getSize(),
                                   vec4{12.0f, 12.0f, 64.0f, 12.0f},
-                                  getEngineContext().getAssets()->get<Texture>("frame"));
+                                  getEngineContext().getAssets()->require<Texture>("frame"));
 
     // batch_2d.drawTextureRect({0.0f, 0.0f},
     //                          {32.0f, 32.0f},
@@ -6,6 +6,8 @@ Label::Label(EngineContext &engine_context)
     : Control{engine_context}
     , m_line_spacing{0.0f}
     , m_color{Color::white}
+    , m_layout_font_page{nullptr}
+    , m_layout_font_generation{0}
 {}
 
 const String &Label::getString() const
@@ -15,15 +17,29 @@ const String &Label::getString() const
 
 void Label::setString(const String &string)
 {
+    if (m_string == string)
+        return;
+
     m_string = string;
-    updateImplicitSize();
+    invalidateImplicitSize();
     repaint();
 }
 
 void Label::appendString(const String &string)
 {
+    if (string.isEmpty())
+        return;
+
     m_string += string;
-    updateImplicitSize();
+
+    // Пока измерение не отложено, раскладка дополняется без пересчета всей строки
+    if (!isImplicitSizeDirty() && m_layout_font_page && isLayoutValid()) {
+        m_layout.append(*m_layout_font_page, string, m_line_spacing);
+        setTextSize(m_layout.size);
+    } else {
+        invalidateImplicitSize();
+    }
+
     repaint();
 }
 
@@ -34,8 +50,11 @@ float Label::getLineSpacing() const
 
 void Label::setLineSpacing(float line_spacing)
 {
+    if (m_line_spacing == line_spacing)
+        return;
+
     m_line_spacing = line_spacing;
-    updateImplicitSize();
+    invalidateImplicitSize();
     repaint();
 }
 
@@ -52,18 +71,35 @@ void Label::setColor(const Color &color)
 
 void Label::drawControl(Batch2D &batch_2d)
 {
-    batch_2d.drawText(m_string,
-                      vec2{0.0f, 0.0f},
-                      m_color,
-                      getFont(),
-                      getFontPixelHeight(),
-                      m_line_spacing);
+    // Страницы шрифта пересоздаются после Font::setSdf и Font::setAtlasSize
+    if (!isLayoutValid())
+        updateImplicitSize();
+
+    if (m_layout_font_page)
+        batch_2d.drawTextLayout(m_layout, vec2{0.0f, 0.0f}, m_color, *m_layout_font_page);
 }
 
 void Label::updateImplicitSize()
 {
-    vec2 text_size
-        = getFont()->getFontPage(getFontPixelHeight())->getTextSize(m_string, m_line_spacing);
+    m_layout.clear();
+    m_layout_font_page = getFont() ? getFont()->getFontPage(getFontPixelHeight()) : nullptr;
+    m_layout_font_generation = getFont() ? getFont()->getGeneration() : 0;
+    if (!m_layout_font_page)
+        return;
+
+    m_layout = *m_layout_font_page->getTextLayout(m_string, m_line_spacing);
+    setTextSize(m_layout.size);
+}
+
+bool Label::isLayoutValid() const
+{
+    return getFont() && getFont()->getGeneration() == m_layout_font_generation
+           && getFont()->getFontPage(getFontPixelHeight()) == m_layout_font_page;
+}
+
+void Label::setTextSize(const vec2 &size)
+{
+    vec2 text_size = size;
 
     const auto &padding = getPadding();
     text_size.x += padding.x + padding.z;
@@ -1,6 +1,7 @@
 #ifndef AE_GUI_LABEL_H
 #define AE_GUI_LABEL_H
 
+#include "../graphics/core/text_layout.h"
 #include "../system/string.h"
 #include "control.h"
 
@@ -26,10 +27,19 @@ protected:
     void drawControl(Batch2D &batch_2d);
     void updateImplicitSize();
 
+private:
+    bool isLayoutValid() const;
+    void setTextSize(const vec2 &text_size);
+
 private:
     String m_string;
     float m_line_spacing;
     Color m_color;
+
+    // Раскладка всего текста. appendString дополняет ее, не раскладывая текст заново
+    TextLayout m_layout;
+    const FontPage *m_layout_font_page;
+    uint32_t m_layout_font_generation;
 };
 
 } // namespace ae::gui
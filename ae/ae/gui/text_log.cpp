@@ -0,0 +1,312 @@
+#include "text_log.h"
+#include "../animation_manager.h"
+#include "../engine_context.h"
+#include "../graphics/core/text_layout.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ae::gui {
+
+TextLog::TextLog(EngineContext &engine_context)
+    : Control{engine_context}
+    , m_first_line{0}
+    , m_line_count{0}
+    , m_max_lines{DEFAULT_MAX_LINES}
+    , m_max_line_width{0.0f}
+    , m_line_spacing{0.0f}
+    , m_color{Color::white}
+    , m_scroll{0.0f}
+    , m_follow_end{true}
+{}
+
+TextLog::~TextLog()
+{
+    stopScrollAnimation();
+}
+
+void TextLog::append(const String &string)
+{
+    String line;
+    for (uint32_t codepoint : string) {
+        if (codepoint == '\n') {
+            appendLine(line);
+            line.clear();
+        } else {
+            line += codepoint;
+        }
+    }
+    appendLine(line);
+
+    const auto &padding = getPadding();
+    setImplicitSize(vec2{m_max_line_width + padding.x + padding.z,
+                         getContentHeight() + padding.y + padding.w});
+
+    if (m_follow_end) {
+        stopScrollAnimation();
+        setScrollValue(getMaxScroll());
+    }
+
+    repaint();
+}
+
+void TextLog::clear()
+{
+    stopScrollAnimation();
+
+    m_lines.clear();
+    m_first_line = 0;
+    m_line_count = 0;
+    m_max_line_width = 0.0f;
+    m_scroll = 0.0f;
+    m_follow_end = true;
+
+    invalidateImplicitSize();
+    repaint();
+}
+
+int32_t TextLog::getLineCount() const
+{
+    return m_line_count;
+}
+
+const String &TextLog::getLine(int32_t index) const
+{
+    return getRingLine(index).string;
+}
+
+String TextLog::getString() const
+{
+    String result;
+    for (int32_t i = 0; i < m_line_count; ++i) {
+        if (i > 0)
+            result += '\n';
+        result += getRingLine(i).string;
+    }
+    return result;
+}
+
+int32_t TextLog::getMaxLines() const
+{
+    return m_max_lines;
+}
+
+void TextLog::setMaxLines(int32_t max_lines)
+{
+    max_lines = std::max(max_lines, 1);
+    if (max_lines == m_max_lines)
+        return;
+
+    // Буфер перестраивается по порядку, остаются самые новые строки
+    int32_t count = std::min(m_line_count, max_lines);
+    std::vector<Line> lines;
+    lines.reserve(count);
+    for (int32_t i = m_line_count - count; i < m_line_count; ++i)
+        lines.push_back(getRingLine(i));
+
+    m_lines = std::move(lines);
+    m_first_line = 0;
+    m_line_count = count;
+    m_max_lines = max_lines;
+
+    invalidateImplicitSize();
+    repaint();
+}
+
+float TextLog::getLineSpacing() const
+{
+    return m_line_spacing;
+}
+
+void TextLog::setLineSpacing(float line_spacing)
+{
+    if (m_line_spacing == line_spacing)
+        return;
+
+    m_line_spacing = line_spacing;
+    invalidateImplicitSize();
+    repaint();
+}
+
+const Color &TextLog::getColor() const
+{
+    return m_color;
+}
+
+void TextLog::setColor(const Color &color)
+{
+    m_color = color;
+    repaint();
+}
+
+float TextLog::getLineHeight() const
+{
+    auto *font_page = getFont() ? getFont()->getFontPage(getFontPixelHeight()) : nullptr;
+    if (!font_page)
+        return 0.0f;
+
+    return font_page->getAscent() - font_page->getDescent() + m_line_spacing;
+}
+
+float TextLog::getContentHeight() const
+{
+    return m_line_count * getLineHeight();
+}
+
+float TextLog::getScroll() const
+{
+    return m_scroll;
+}
+
+float TextLog::getMaxScroll() const
+{
+    const auto &padding = getPadding();
+    float viewport_height = getSize().y - padding.y - padding.w;
+    return std::max(getContentHeight() - viewport_height, 0.0f);
+}
+
+void TextLog::setScroll(float scroll, bool animated)
+{
+    float max_scroll = getMaxScroll();
+    float target = std::clamp(scroll, 0.0f, max_scroll);
+    m_follow_end = target >= max_scroll;
+
+    stopScrollAnimation();
+
+    if (!animated || target == m_scroll) {
+        setScrollValue(target);
+        return;
+    }
+
+    m_scroll_animation = createShared<FloatAnimation>(
+        m_scroll,
+        target,
+        seconds(0.15f),
+        [this](float value) { setScrollValue(value); },
+        Easing::easeOutQuad);
+    getEngineContext().getAnimationManager()->run(m_scroll_animation);
+}
+
+void TextLog::scrollBy(float delta, bool animated)
+{
+    // Повторная прокрутка во время анимации продолжается от ее цели
+    float from = m_scroll;
+    if (m_scroll_animation && !m_scroll_animation->isFinished())
+        from = m_scroll_animation->getTo();
+
+    setScroll(from + delta, animated);
+}
+
+void TextLog::scrollToEnd(bool animated)
+{
+    setScroll(getMaxScroll(), animated);
+}
+
+bool TextLog::isFollowingEnd() const
+{
+    return m_follow_end;
+}
+
+void TextLog::onSizeChanged(const vec2 &size)
+{
+    setScrollValue(m_follow_end ? getMaxScroll() : m_scroll);
+}
+
+void TextLog::drawControl(Batch2D &batch_2d)
+{
+    auto *font_page = getFont() ? getFont()->getFontPage(getFontPixelHeight()) : nullptr;
+    float line_height = getLineHeight();
+    if (!font_page || line_height <= 0.0f || m_line_count == 0)
+        return;
+
+    const auto &padding = getPadding();
+    const auto &size = getSize();
+    vec4 clip_rect{padding.x, padding.y, size.x - padding.z, size.y - padding.w};
+
+    int32_t first = std::max(static_cast<int32_t>(m_scroll / line_height), 0);
+    int32_t last = std::min(static_cast<int32_t>(
+                                std::ceil((m_scroll + clip_rect.w - clip_rect.y) / line_height)),
+                            m_line_count);
+
+    for (int32_t i = first; i < last; ++i) {
+        vec2 pos{padding.x, padding.y + i * line_height - m_scroll};
+        batch_2d.drawTextLayout(*font_page->getTextLayout(getRingLine(i).string),
+                                pos,
+                                m_color,
+                                *font_page,
+                                clip_rect);
+    }
+}
+
+void TextLog::updateImplicitSize()
+{
+    // Шрифт или интервал поменялись: ширины всех строк пересчитываются
+    m_max_line_width = 0.0f;
+    for (auto &line : m_lines) {
+        line.width = measure(line.string);
+        m_max_line_width = std::max(m_max_line_width, line.width);
+    }
+
+    const auto &padding = getPadding();
+    setImplicitSize(vec2{m_max_line_width + padding.x + padding.z,
+                         getContentHeight() + padding.y + padding.w});
+
+    setScrollValue(m_follow_end ? getMaxScroll() : m_scroll);
+}
+
+void TextLog::appendLine(const String &string)
+{
+    Line line{string, measure(string)};
+    m_max_line_width = std::max(m_max_line_width, line.width);
+
+    if (m_line_count < m_max_lines) {
+        m_lines.push_back(line);
+        ++m_line_count;
+        return;
+    }
+
+    m_lines[m_first_line] = line;
+    m_first_line = (m_first_line + 1) % m_max_lines;
+
+    // Вытеснение сдвигает текст вверх, видимые строки остаются на месте
+    if (!m_follow_end)
+        m_scroll = std::max(m_scroll - getLineHeight(), 0.0f);
+}
+
+const TextLog::Line &TextLog::getRingLine(int32_t index) const
+{
+    return m_lines[(m_first_line + index) % m_lines.size()];
+}
+
+float TextLog::measure(const String &string) const
+{
+    auto *font_page = getFont() ? getFont()->getFontPage(getFontPixelHeight()) : nullptr;
+    if (!font_page || string.isEmpty())
+        return 0.0f;
+
+    // Мимо кэша страницы: строки журнала почти не повторяются и вытеснили бы из него
+    // раскладки других элементов
+    TextLayout layout;
+    layout.append(*font_page, string, 0.0f);
+    return layout.size.x;
+}
+
+void TextLog::setScrollValue(float scroll)
+{
+    scroll = std::clamp(scroll, 0.0f, getMaxScroll());
+    if (scroll == m_scroll)
+        return;
+
+    m_scroll = scroll;
+    repaint();
+}
+
+void TextLog::stopScrollAnimation()
+{
+    if (m_scroll_animation) {
+        m_scroll_animation->stop();
+        m_scroll_animation.reset();
+    }
+}
+
+} // namespace ae::gui
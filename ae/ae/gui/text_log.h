@@ -0,0 +1,91 @@
+#ifndef AE_GUI_TEXT_LOG_H
+#define AE_GUI_TEXT_LOG_H
+
+#include "../animation.h"
+#include "../system/string.h"
+#include "control.h"
+
+#include <vector>
+
+namespace ae::gui {
+
+// Прокручиваемый журнал строк. Строки хранятся в кольцевом буфере, самые старые
+// вытесняются. Раскладываются и рисуются только строки, попавшие в область элемента,
+// поэтому добавление строки не зависит от длины журнала
+class TextLog : public Control
+{
+public:
+    static constexpr int32_t DEFAULT_MAX_LINES = 1000;
+
+    TextLog(EngineContext &engine_context);
+    ~TextLog();
+
+    // Каждый вызов начинает новую строку, '\n' внутри тоже разделяет строки
+    void append(const String &string);
+    void clear();
+
+    int32_t getLineCount() const;
+    // 0 - самая старая из сохраненных строк
+    const String &getLine(int32_t index) const;
+    // Все строки через '\n'
+    String getString() const;
+
+    int32_t getMaxLines() const;
+    void setMaxLines(int32_t max_lines);
+
+    float getLineSpacing() const;
+    void setLineSpacing(float line_spacing);
+
+    const Color &getColor() const;
+    void setColor(const Color &color);
+
+    float getLineHeight() const;
+    float getContentHeight() const;
+
+    // Прокрутка в пикселях от начала первой строки
+    float getScroll() const;
+    float getMaxScroll() const;
+    void setScroll(float scroll, bool animated = false);
+    void scrollBy(float delta, bool animated = true);
+    void scrollToEnd(bool animated = false);
+    // Пока журнал прокручен до конца, новые строки прокручивают его дальше
+    bool isFollowingEnd() const;
+
+    void onSizeChanged(const vec2 &size);
+
+protected:
+    void drawControl(Batch2D &batch_2d);
+    void updateImplicitSize();
+
+private:
+    struct Line
+    {
+        String string;
+        float width = 0.0f;
+    };
+
+    void appendLine(const String &string);
+    const Line &getRingLine(int32_t index) const;
+    float measure(const String &string) const;
+    void setScrollValue(float scroll);
+    void stopScrollAnimation();
+
+private:
+    std::vector<Line> m_lines;
+    int32_t m_first_line;
+    int32_t m_line_count;
+    int32_t m_max_lines;
+    // Не уменьшается при вытеснении строк, пересчитывается при смене шрифта
+    float m_max_line_width;
+
+    float m_line_spacing;
+    Color m_color;
+
+    float m_scroll;
+    bool m_follow_end;
+    s_ptr<FloatAnimation> m_scroll_animation;
+};
+
+} // namespace ae::gui
+
+#endif // AE_GUI_TEXT_LOG_H
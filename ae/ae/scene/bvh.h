@@ -15,6 +15,8 @@ class BVH
 public:
     struct Node
     {
+        AE_POOL_ALLOCATED
+
         AABB aabb;
         T value = invalid_value;
         u_ptr<Node> left;
@@ -36,7 +38,8 @@ public:
 
     void clear() { m_root.reset(); }
 
-    void query(const AABB &aabb, std::vector<T> &results) const
+    template<typename Allocator>
+    void query(const AABB &aabb, std::vector<T, Allocator> &results) const
     {
         queryRecursive(m_root, aabb, results);
     }
@@ -47,7 +50,8 @@ public:
         queryRecursive(m_root, aabb, std::forward<Callback>(callback));
     }
 
-    void query(const Frustum &frustum, std::vector<T> &results) const
+    template<typename Allocator>
+    void query(const Frustum &frustum, std::vector<T, Allocator> &results) const
     {
         queryRecursive(m_root, frustum, results);
     }
@@ -128,7 +132,10 @@ private:
         return removed_left || removed_right;
     }
 
-    void queryRecursive(const u_ptr<Node> &node, const AABB &aabb, std::vector<T> &results) const
+    template<typename Allocator>
+    void queryRecursive(const u_ptr<Node> &node,
+                        const AABB &aabb,
+                        std::vector<T, Allocator> &results) const
     {
         if (!node || !node->aabb.intersects(aabb))
             return;
@@ -155,9 +162,10 @@ private:
         }
     }
 
+    template<typename Allocator>
     void queryRecursive(const u_ptr<Node> &node,
                         const Frustum &frustum,
-                        std::vector<T> &results) const
+                        std::vector<T, Allocator> &results) const
     {
         if (!node || !frustum.intersectWithAABB(node->aabb))
             return;
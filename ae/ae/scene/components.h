@@ -100,6 +100,16 @@ struct GlobalTransform_C
     bool dirty = true;
 };
 
+// Глобальная трансформация на начало тика для интерполяции отрисовки.
+// Есть у Dynamic_C сущностей, их потомков и камер
+struct RenderTransform_C
+{
+    vec3 previous_position{0.f};
+    quat previous_rotation{1.f, 0.f, 0.f, 0.f};
+    vec3 previous_scale{1.f};
+    bool has_previous = false;
+};
+
 struct TransformInheritance_C
 {
     enum Mode {
@@ -1,8 +1,10 @@
 #include "draw_s.h"
 #include "../engine.h"
+#include "../graphics/scene/model_instance.h"
+#include "../system/frame_arena.h"
 #include "scene.h"
 
-#include <execution>
+#include <algorithm>
 
 namespace ae {
 
@@ -42,21 +44,36 @@ void Draw_S::update()
                   m_visible_entities,
                   m_visible_transparent_entities);
 
-        std::sort(std::execution::par_unseq,
-                  m_visible_transparent_entities.begin(),
+        // Прозрачных объектов немного, параллельная сортировка только занимала потоки
+        std::sort(m_visible_transparent_entities.begin(),
                   m_visible_transparent_entities.end(),
                   [](const auto &a, const auto &b) { return a.first > b.first; });
     }
 }
 
-void Draw_S::drawEntities(RenderState &render_state) const
+void Draw_S::extract(RenderSnapshot &snapshot) const
 {
-    auto &registry = getRegistry();
+    extractEntities(m_visible_entities, snapshot);
+    extractEntities(m_visible_transparent_entities, snapshot);
+}
+
+void Draw_S::drawEntities(const RenderSnapshot &snapshot,
+                          float alpha,
+                          RenderState &render_state) const
+{
+    // debugDraw(getRegistry(), render_state);
 
-    // debugDraw(registry, render_state);
+    for (const auto &item : snapshot.items) {
+        render_state.transform = item.transform.getTransform(alpha);
+        render_state.bone_transforms = item.bone_transforms.empty() ? nullptr
+                                                                    : &item.bone_transforms;
+        render_state.shader->uniformInt("u_skeleton", false);
+        render_state.shader->uniformInt("u_enableLight", true);
+
+        item.drawable->draw(render_state);
+    }
 
-    drawEntities(registry, m_visible_entities, render_state);
-    drawEntities(registry, m_visible_transparent_entities, render_state);
+    render_state.bone_transforms = nullptr;
 }
 
 void Draw_S::clear()
@@ -70,21 +87,26 @@ void Draw_S::clear()
     m_draw_dirty = true;
 }
 
-void Draw_S::drawEntities(const entt::registry &registry,
-                          const std::vector<std::pair<float, entt::entity> > &entities,
-                          RenderState &render_state) const
+void Draw_S::extractEntities(const std::vector<std::pair<float, entt::entity> > &entities,
+                             RenderSnapshot &snapshot) const
 {
+    const auto &registry = getRegistry();
+
     for (const auto &[_, entity] : entities) {
         if (!registry.valid(entity))
             continue;
 
-        render_state.transform = getGlobalTransform(entity);
-        render_state.shader->uniformInt("u_skeleton", false);
-        render_state.shader->uniformInt("u_enableLight", true);
+        const auto &drawable_c = registry.get<Drawable_C>(entity);
+        if (!drawable_c)
+            continue;
 
-        auto &drawable_c = registry.get<Drawable_C>(entity);
-        if (drawable_c)
-            drawable_c->draw(render_state);
+        auto &item = snapshot.items.emplace_back();
+        item.drawable = drawable_c;
+        item.transform = getSnapshotTransform(entity);
+
+        auto model_instance = dynamic_cast<const ModelInstance *>(drawable_c.get());
+        if (model_instance && model_instance->getPose())
+            item.bone_transforms = model_instance->getPose()->getFinalTransforms();
     }
 }
 
@@ -157,7 +179,7 @@ void Draw_S::drawDrawableAABB(const AABB &aabb,
     const vec3 &min = aabb.min;
     const vec3 &max = aabb.max;
 
-    std::vector<vec3> corners = {
+    const vec3 corners[] = {
         {min.x, min.y, min.z},
         {max.x, min.y, min.z},
         {max.x, max.y, min.z},
@@ -168,15 +190,17 @@ void Draw_S::drawDrawableAABB(const AABB &aabb,
         {min.x, max.y, max.z},
     };
 
-    std::vector<uint32_t> indices = {0, 1, 1, 2, 2, 3, 3, 0, 4, 5, 5, 6,
-                                     6, 7, 7, 4, 0, 4, 1, 5, 2, 6, 3, 7};
+    const uint32_t indices[] = {0, 1, 1, 2, 2, 3, 3, 0, 4, 5, 5, 6,
+                                6, 7, 7, 4, 0, 4, 1, 5, 2, 6, 3, 7};
 
-    std::vector<Vertex> line_vertices;
+    FrameArena::Scope scope;
+    FrameVector<Vertex> line_vertices;
+    line_vertices.reserve(std::size(corners));
     for (const auto &corner : corners)
         line_vertices.push_back({corner, vec3{0.0f}, color.getColor(), vec2{0.0f}});
 
     VertexArray line_array;
-    line_array.create(line_vertices, indices);
+    line_array.create(std::span<const Vertex>{line_vertices}, std::span<const uint32_t>{indices});
 
     glLineWidth(3.0f);
 
@@ -196,16 +220,17 @@ void Draw_S::drawLine(const vec3 &p1,
                       const Color &color,
                       const RenderState &render_state) const
 {
-    std::vector<Vertex> vertices;
+    FrameArena::Scope scope;
+    FrameVector<Vertex> vertices;
     vertices.push_back({p1, glm::vec3(0.0f), color.getColor(), glm::vec2(0.0f)});
     vertices.push_back({p2, glm::vec3(0.0f), color.getColor(), glm::vec2(0.0f)});
 
-    std::vector<uint32_t> indices(vertices.size());
+    FrameVector<uint32_t> indices(vertices.size());
     for (uint32_t i = 0; i < indices.size(); ++i)
         indices[i] = i;
 
     VertexArray line_array;
-    line_array.create(vertices, indices);
+    line_array.create(std::span<const Vertex>{vertices}, std::span<const uint32_t>{indices});
 
     glLineWidth(3.0f);
 
@@ -226,15 +251,16 @@ void Draw_S::drawTriangle(const vec3 &v0,
                           const Color &color,
                           const RenderState &render_state) const
 {
-    std::vector<Vertex> vertices;
+    FrameArena::Scope scope;
+    FrameVector<Vertex> vertices;
     vertices.push_back({v0, glm::vec3(0.0f), color.getColor(), glm::vec2(0.0f)});
     vertices.push_back({v1, glm::vec3(0.0f), color.getColor(), glm::vec2(0.0f)});
     vertices.push_back({v2, glm::vec3(0.0f), color.getColor(), glm::vec2(0.0f)});
 
-    std::vector<uint32_t> indices = {2, 1, 0};
+    const uint32_t indices[] = {2, 1, 0};
 
     VertexArray vertex_array;
-    vertex_array.create(vertices, indices);
+    vertex_array.create(std::span<const Vertex>{vertices}, std::span<const uint32_t>{indices});
 
     glLineWidth(3.0f);
 
@@ -5,6 +5,7 @@
 #include "bvh.h"
 #include "multi_component_watcher.h"
 #include "components.h"
+#include "render_snapshot.h"
 #include "system.h"
 
 #include <entt/entt.hpp>
@@ -18,14 +19,17 @@ public:
     ~Draw_S() = default;
 
     void update();
-    void drawEntities(RenderState &render_state) const;
+    // Копирует видимые объекты в снимок, вызывается в конце тика
+    void extract(RenderSnapshot &snapshot) const;
+    void drawEntities(const RenderSnapshot &snapshot,
+                      float alpha,
+                      RenderState &render_state) const;
 
     void clear();
 
 private:
-    void drawEntities(const entt::registry &registry,
-                      const std::vector<std::pair<float, entt::entity>> &entities,
-                      RenderState &render_state) const;
+    void extractEntities(const std::vector<std::pair<float, entt::entity>> &entities,
+                         RenderSnapshot &snapshot) const;
 
     void debugDraw(const entt::registry &registry, RenderState &render_state) const;
     void debugDrawEntities(const entt::registry &registry,
@@ -8,6 +8,7 @@ Lights_S::Lights_S(Scene *scene)
     , m_visible_lights_ssbo{BufferType::SHADER_STORAGE_BUFFER}
     , m_visible_lights_count{0}
     , m_lights_dirty{true}
+    , m_uploaded_snapshot_id{-1}
 {
     auto &registry = getRegistry();
 
@@ -48,24 +49,39 @@ void Lights_S::update()
                   m_visible_lights.end(),
                   [](const auto &a, const auto &b) { return a.first < b.first; });
 
+        // Загрузка в SSBO при отрисовке, поэтому обновление не требует GL
         for (int32_t i = 0; i < m_visible_lights_count; ++i)
             updateGpuLight(m_gpu_lights[i], m_visible_lights[i].second);
-
-        m_visible_lights_ssbo.setData(m_gpu_lights.data(),
-                                      m_visible_lights_count * sizeof(GpuLight));
     }
 }
 
-void Lights_S::draw(RenderState &render_state) const
+void Lights_S::extract(RenderSnapshot &snapshot) const
 {
-    auto &direct_light_c = get<DirectLight_C>(getScene()->getActiveDirectLight());
+    auto direct_light = getScene()->getActiveDirectLight();
+    if (isValid(direct_light))
+        snapshot.direct_light = get<DirectLight_C>(direct_light);
+
+    snapshot.lights.assign(m_gpu_lights.begin(), m_gpu_lights.begin() + m_visible_lights_count);
+}
+
+void Lights_S::draw(const RenderSnapshot &snapshot, RenderState &render_state)
+{
+    if (m_uploaded_snapshot_id != snapshot.id) {
+        m_uploaded_snapshot_id = snapshot.id;
+        if (!snapshot.lights.empty())
+            m_visible_lights_ssbo.setData(snapshot.lights.data(),
+                                          snapshot.lights.size() * sizeof(GpuLight));
+    }
+
+    const auto &direct_light_c = snapshot.direct_light;
 
     render_state.shader->uniformVec3("m_directLight.direction", direct_light_c.direction);
     render_state.shader->uniformVec4("m_directLight.ambient", direct_light_c.ambient.getColor());
     render_state.shader->uniformVec4("m_directLight.diffuse", direct_light_c.diffuse.getColor());
     render_state.shader->uniformVec4("m_directLight.specular", direct_light_c.specular.getColor());
 
-    render_state.shader->uniformInt("u_lightsCount", m_visible_lights_count);
+    int32_t lights_count = snapshot.lights.size();
+    render_state.shader->uniformInt("u_lightsCount", lights_count);
     Buffer::bindBase(m_visible_lights_ssbo, 1);
 }
 
@@ -74,9 +90,10 @@ void Lights_S::clear()
     m_static_lights_tree.clear();
     m_dynamic_lights_tree.clear();
     m_visible_lights.clear();
-    m_gpu_lights.clear();
+    m_gpu_lights.assign(MAX_VISIBLE_LIGHTS, GpuLight{});
     m_visible_lights_count = 0;
     m_lights_dirty = true;
+    m_uploaded_snapshot_id = -1;
 }
 
 float Lights_S::calculateLightRadius(entt::entity entity)
@@ -6,6 +6,7 @@
 #include "bvh.h"
 #include "components.h"
 #include "multi_component_watcher.h"
+#include "render_snapshot.h"
 #include "system.h"
 
 #include <entt/entt.hpp>
@@ -22,21 +23,14 @@ public:
 
     void update();
 
-    void draw(RenderState &render_state) const;
+    // Копирует видимые источники в снимок, вызывается в конце тика
+    void extract(RenderSnapshot &snapshot) const;
+    // Загружает источники снимка в SSBO, если снимок сменился
+    void draw(const RenderSnapshot &snapshot, RenderState &render_state);
 
     void clear();
 
 private:
-    struct GpuLight
-    {
-        vec4 position;  // .w = type (0 = point, 1 = spot)
-        vec4 direction; // .w = cutOff (in radians or cos value)
-        vec4 ambient;
-        vec4 diffuse;
-        vec4 specular;
-        vec4 attenuation; // x = constant, y = linear, z = quadratic, w = radius or padding
-    };
-
     float calculateLightRadius(entt::entity entity);
     AABB calculateLightAABB(entt::entity entity) const;
     void updateGpuLight(GpuLight &gpu_light, entt::entity entity);
@@ -56,6 +50,7 @@ private:
     std::vector<GpuLight> m_gpu_lights;
     int32_t m_visible_lights_count;
     bool m_lights_dirty;
+    int64_t m_uploaded_snapshot_id;
 };
 
 } // namespace ae
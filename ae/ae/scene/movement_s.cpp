@@ -1,4 +1,5 @@
 #include "movement_s.h"
+#include "../system/frame_arena.h"
 #include "../system/log.h"
 #include "components.h"
 #include "scene.h"
@@ -330,7 +331,8 @@ bool Movement_S::raycastGroundCheck(const AABB &aabb,
     best_hit.t = max_distance;
 
     bool hit = false;
-    std::vector<entt::entity> candidates;
+    FrameArena::Scope scope;
+    FrameVector<entt::entity> candidates;
     m_static_colliders_tree.query(cast_aabb.extend({0.0f, max_distance, 0.0f}), candidates);
 
     for (auto entity : candidates) {
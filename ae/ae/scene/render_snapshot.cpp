@@ -0,0 +1,39 @@
+#include "render_snapshot.h"
+
+namespace ae {
+
+vec3 SnapshotTransform::getPosition(float alpha) const
+{
+    if (!interpolate || alpha >= 1.0f)
+        return position;
+
+    return glm::mix(previous_position, position, alpha);
+}
+
+quat SnapshotTransform::getRotation(float alpha) const
+{
+    if (!interpolate || alpha >= 1.0f)
+        return rotation;
+
+    return glm::slerp(previous_rotation, rotation, alpha);
+}
+
+mat4 SnapshotTransform::getTransform(float alpha) const
+{
+    if (!interpolate || alpha >= 1.0f)
+        return transform;
+
+    return glm::translate(mat4{1.0f}, getPosition(alpha)) * glm::toMat4(getRotation(alpha))
+           * glm::scale(mat4{1.0f}, glm::mix(previous_scale, scale, alpha));
+}
+
+void RenderSnapshot::clear()
+{
+    has_camera = false;
+    skybox = nullptr;
+    direct_light = DirectLight_C{};
+    lights.clear();
+    items.clear();
+}
+
+} // namespace ae
@@ -0,0 +1,82 @@
+#ifndef AE_RENDER_SNAPSHOT_H
+#define AE_RENDER_SNAPSHOT_H
+
+#include "../graphics/scene/drawable.h"
+#include "../graphics/scene/skybox.h"
+#include "../system/memory.h"
+#include "../system/time.h"
+#include "components.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include <vector>
+
+using namespace glm;
+
+namespace ae {
+
+// Трансформация на начало и конец тика, отрисовка интерполирует между ними
+struct SnapshotTransform
+{
+    vec3 previous_position{0.f};
+    quat previous_rotation{1.f, 0.f, 0.f, 0.f};
+    vec3 previous_scale{1.f};
+
+    vec3 position{0.f};
+    quat rotation{1.f, 0.f, 0.f, 0.f};
+    vec3 scale{1.f};
+    mat4 transform{1.f};
+
+    bool interpolate = false;
+
+    vec3 getPosition(float alpha) const;
+    quat getRotation(float alpha) const;
+    mat4 getTransform(float alpha) const;
+};
+
+struct GpuLight
+{
+    vec4 position;  // .w = type (0 = point, 1 = spot)
+    vec4 direction; // .w = cutOff (in radians or cos value)
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation; // x = constant, y = linear, z = quadratic, w = radius or padding
+};
+
+// Все, что нужно для отрисовки сцены после тика. Отрисовка читает только снимок,
+// поэтому следующий тик может выполняться параллельно с ней
+struct RenderSnapshot
+{
+    struct Item
+    {
+        s_ptr<Drawable> drawable;
+        SnapshotTransform transform;
+        // Копия матриц костей, поза меняется следующим тиком
+        std::vector<mat4> bone_transforms;
+    };
+
+    // Номер снимка, по нему отрисовка понимает, что данные обновились
+    int64_t id = 0;
+    // Начало тика, для измерения задержки до вывода кадра
+    Time tick_start;
+
+    bool has_camera = false;
+    SnapshotTransform camera_transform;
+    mat4 camera_proj_transform{1.f};
+
+    s_ptr<Skybox> skybox;
+
+    DirectLight_C direct_light;
+    std::vector<GpuLight> lights;
+
+    // Непрозрачные, затем прозрачные от дальних к ближним
+    std::vector<Item> items;
+
+    void clear();
+};
+
+} // namespace ae
+
+#endif // AE_RENDER_SNAPSHOT_H
@@ -1,7 +1,10 @@
 #include "scene.h"
+#include "../engine_context.h"
 #include "../graphics/core/default_shaders.h"
 #include "../graphics/scene/model_instance.h"
 #include "../graphics/scene/shape.h"
+#include "../system/clock.h"
+#include "../system/job_system.h"
 #include "../system/log.h"
 #include "draw_s.h"
 #include "lights_s.h"
@@ -19,6 +22,7 @@ Scene::Scene(EngineContext &engine_context)
     m_data.lights_s = createUnique<Lights_S>(this);
     m_data.movement_s = createUnique<Movement_S>(this);
     m_data.draw_s = createUnique<Draw_S>(this);
+    addSystems();
 
     // Camera
     m_data.registry.on_update<Camera_C>().connect<&Scene::onCameraUpdated>(this);
@@ -32,6 +36,9 @@ Scene::Scene(EngineContext &engine_context)
     // Movement
     m_data.registry.on_construct<Movement_C>().connect<&Scene::onMovementConstructed>(this);
     m_data.registry.on_update<Movement_C>().connect<&Scene::onMovementUpdated>(this);
+    // Render transform
+    m_data.registry.on_construct<Dynamic_C>().connect<&Scene::onDynamicConstructed>(this);
+    m_data.registry.on_destroy<Dynamic_C>().connect<&Scene::onDynamicDestroyed>(this);
 
     for (int32_t i = 0; i < 10; ++i) {
         auto entity = createLight();
@@ -57,6 +64,7 @@ Scene::Scene(EngineContext &engine_context)
 
 Scene::~Scene()
 {
+    waitTickUpdate();
     // m_data.render_target->sizeChanged.disconnect(this);
 }
 
@@ -67,26 +75,98 @@ entt::registry &Scene::getRegistry()
 
 void Scene::tickUpdate(const Time &elapsed_time)
 {
-    m_data.player_s->update();
-    m_data.movement_s->update(elapsed_time);
-    m_data.player_s->updateCameraPosition(elapsed_time);
-    m_data.lights_s->update();
-    m_data.draw_s->update();
+    // Несколько тиков за кадр выполняются друг за другом
+    waitTickUpdate();
 
-    tickUpdated.emit();
+    m_data.tick_time = elapsed_time;
 
-    m_data.camera_dirty = false;
-    m_data.scene_dirty = false;
+    if (!m_data.pipelined) {
+        runTick();
+        m_data.front_snapshot = 1 - m_data.front_snapshot;
+        tickUpdated.emit();
+        return;
+    }
+
+    m_data.tick_in_flight = true;
+    getEngineContext().getJobSystem()->run([this]() { runTick(); }, &m_data.tick_counter);
+}
+
+const SystemScheduler &Scene::getScheduler() const
+{
+    return m_data.scheduler;
 }
 
 void Scene::draw() const
 {
+    const auto &snapshot = m_data.snapshots[m_data.front_snapshot];
+
     m_data.render_texture.clear();
-    drawSkybox();
-    drawScene();
+
+    if (snapshot.has_camera) {
+        // Снимок хранит положения на начало и конец своего тика. Пока следующий тик
+        // выполняется, рисуется предыдущий снимок с той же долей тика: картинка та же,
+        // что без конвейера, но на тик позже, и движение остается плавным
+        float alpha = getEngineContext().getTickAlpha();
+
+        // Как в updateCameraTransforms, но по интерполированному положению
+        vec3 position = snapshot.camera_transform.getPosition(alpha);
+        quat rotation = snapshot.camera_transform.getRotation(alpha);
+        mat4 view_transform = glm::lookAt(position,
+                                          position + rotation * vec3{0.0f, 0.0f, -1.0f},
+                                          rotation * vec3{0.0f, 1.0f, 0.0f});
+
+        drawSkybox(snapshot, view_transform);
+        drawScene(snapshot, view_transform, alpha);
+
+        Time latency = Clock::getCurrentTime() - snapshot.tick_start;
+        m_data.latency_us = latency.asMicroseconds();
+    }
+
     m_data.render_texture.display();
 }
 
+bool Scene::isPipelined() const
+{
+    return m_data.pipelined;
+}
+
+void Scene::setPipelined(bool pipelined)
+{
+    waitTickUpdate();
+    m_data.pipelined = pipelined;
+}
+
+void Scene::waitTickUpdate()
+{
+    if (!m_data.tick_in_flight)
+        return;
+
+    getEngineContext().getJobSystem()->wait(m_data.tick_counter);
+    m_data.tick_in_flight = false;
+    m_data.front_snapshot = 1 - m_data.front_snapshot;
+
+    tickUpdated.emit();
+}
+
+void Scene::clear()
+{
+    waitTickUpdate();
+    SceneContext::clear();
+
+    // Снимки держат drawable, иначе ресурсы уровня не освободятся
+    m_data.snapshots[0].clear();
+    m_data.snapshots[1].clear();
+}
+
+Scene::RenderStats Scene::getRenderStats() const
+{
+    RenderStats stats;
+    stats.extract_time_us = m_data.extract_time_us;
+    stats.latency_us = m_data.latency_us;
+    stats.items = m_data.snapshots[m_data.front_snapshot].items.size();
+    return stats;
+}
+
 void Scene::createPlayer(const s_ptr<Model> &model,
                          const mat4 &player_transform,
                          const mat4 &model_transform)
@@ -175,9 +255,77 @@ void Scene::createPlayer(const s_ptr<Model> &model,
     l_debug("Player: {}", static_cast<uint32_t>(player_c.model_entity));
 }
 
-void Scene::drawSkybox() const
+void Scene::addSystems()
+{
+    auto &scheduler = m_data.scheduler;
+
+    // patch<Transform_C> помечает глобальные трансформации, поэтому их пишут все,
+    // кто двигает сущности
+    scheduler.add("player", [this]() { m_data.player_s->update(); })
+        .reads<Player_C, Camera_C>()
+        .writes<Movement_C, InMotion_C, Transform_C, GlobalTransform_C>();
+
+    scheduler.add("movement", [this]() { m_data.movement_s->update(m_data.tick_time); })
+        .reads<Collider_C, Dynamic_C>()
+        .writes<Movement_C, InMotion_C, Transform_C, GlobalTransform_C>();
+
+    scheduler.add("player_camera",
+                  [this]() { m_data.player_s->updateCameraPosition(m_data.tick_time); })
+        .reads<Player_C, Movement_C, Animator_C, Drawable_C>()
+        .writes<Transform_C, GlobalTransform_C>();
+
+    scheduler.add("transforms", [this]() { updateDirtyTransforms(); })
+        .reads<Transform_C, Parent_C, TransformInheritance_C, LocalAABB_C>()
+        .writes<GlobalTransform_C, GlobalAABB_C, Camera_C>();
+
+    // Отсечение источников света и объектов только читает и выполняется параллельно.
+    // SSBO света загружается при отрисовке из снимка, поэтому GL здесь не нужен
+    scheduler.add("lights", [this]() { m_data.lights_s->update(); })
+        .reads<Light_C, DirectLight_C, GlobalTransform_C, GlobalAABB_C, Camera_C>();
+
+    scheduler.add("draw", [this]() { m_data.draw_s->update(); })
+        .reads<Drawable_C, Dynamic_C, GlobalTransform_C, GlobalAABB_C, Camera_C>();
+}
+
+void Scene::runTick()
+{
+    Time tick_start = Clock::getCurrentTime();
+
+    saveTickTransforms();
+    m_data.scheduler.run(*getEngineContext().getJobSystem());
+
+    Clock extract_clock;
+    auto &snapshot = m_data.snapshots[1 - m_data.front_snapshot];
+    extractSnapshot(snapshot);
+    snapshot.tick_start = tick_start;
+    m_data.extract_time_us = extract_clock.getElapsedTime().asMicroseconds();
+
+    m_data.camera_dirty = false;
+    m_data.scene_dirty = false;
+}
+
+void Scene::extractSnapshot(RenderSnapshot &snapshot)
 {
-    if (m_data.registry.valid(m_data.active_skybox)) {
+    snapshot.clear();
+    snapshot.id = ++m_data.snapshot_id;
+
+    auto camera = getActiveCamera();
+    if (isValid(camera) && has<Camera_C>(camera)) {
+        snapshot.has_camera = true;
+        snapshot.camera_transform = getSnapshotTransform(camera);
+        snapshot.camera_proj_transform = getCameraProjTransform(camera);
+    }
+
+    if (isValid(m_data.active_skybox))
+        snapshot.skybox = get<Skybox_C>(m_data.active_skybox);
+
+    m_data.lights_s->extract(snapshot);
+    m_data.draw_s->extract(snapshot);
+}
+
+void Scene::drawSkybox(const RenderSnapshot &snapshot, const mat4 &view_transform) const
+{
+    if (snapshot.skybox) {
         glDepthFunc(GL_LEQUAL);
         glDepthMask(GL_FALSE);
         glCullFace(GL_FRONT);
@@ -185,17 +333,12 @@ void Scene::drawSkybox() const
         Shader::use(*DefaultShaders::getSkybox());
         Shader *shader = DefaultShaders::getSkybox().get();
 
-        shader->uniformMatrix("u_projMat",
-                              const_cast<Scene *>(this)->getCameraProjTransform(getActiveCamera()));
-        shader->uniformMatrix("u_viewMat",
-                              mat4(mat3(const_cast<Scene *>(this)->getCameraViewTransform(
-                                  getActiveCamera()))));
+        shader->uniformMatrix("u_projMat", snapshot.camera_proj_transform);
+        shader->uniformMatrix("u_viewMat", mat4(mat3(view_transform)));
 
-        const auto &skybox_c = m_data.registry.get<Skybox_C>(m_data.active_skybox);
+        Texture::bind(*snapshot.skybox->getTexture());
 
-        Texture::bind(*skybox_c->getTexture());
-
-        skybox_c->draw();
+        snapshot.skybox->draw();
 
         Texture::unbind();
         Shader::unuse();
@@ -208,29 +351,23 @@ void Scene::drawSkybox() const
 
 void Scene::drawShadow() const {}
 
-void Scene::drawScene() const
+void Scene::drawScene(const RenderSnapshot &snapshot,
+                      const mat4 &view_transform,
+                      float alpha) const
 {
-    if (m_data.registry.valid(m_data.active_camera)) {
-        Shader::use(*DefaultShaders::getMain());
+    Shader::use(*DefaultShaders::getMain());
 
-        RenderState render_state;
-        render_state.shader = DefaultShaders::getMain().get();
+    RenderState render_state;
+    render_state.shader = DefaultShaders::getMain().get();
 
-        render_state.shader->uniformMatrix("u_projMat",
-                                           const_cast<Scene *>(this)->getCameraProjTransform(
-                                               getActiveCamera()));
-        render_state.shader->uniformMatrix("u_viewMat",
-                                           const_cast<Scene *>(this)->getCameraViewTransform(
-                                               getActiveCamera()));
-        render_state.shader->uniformVec3("u_viewPos",
-                                         const_cast<Scene *>(this)->getGlobalPosition(
-                                             getActiveCamera()));
+    render_state.shader->uniformMatrix("u_projMat", snapshot.camera_proj_transform);
+    render_state.shader->uniformMatrix("u_viewMat", view_transform);
+    render_state.shader->uniformVec3("u_viewPos", snapshot.camera_transform.getPosition(alpha));
 
-        m_data.lights_s->draw(render_state);
-        m_data.draw_s->drawEntities(render_state);
+    m_data.lights_s->draw(snapshot, render_state);
+    m_data.draw_s->drawEntities(snapshot, alpha, render_state);
 
-        Shader::unuse();
-    }
+    Shader::unuse();
 }
 
 void Scene::onCameraUpdated(entt::registry &registry, entt::entity entity)
@@ -271,4 +408,25 @@ void Scene::onMovementUpdated(entt::registry &registry, entt::entity entity)
         registry.remove<InMotion_C>(entity);
 }
 
+void Scene::onDynamicConstructed(entt::registry &registry, entt::entity entity)
+{
+    // Потомки могли быть добавлены до того, как сущность стала динамической
+    propagateRenderTransform(entity);
+}
+
+void Scene::onDynamicDestroyed(entt::registry &registry, entt::entity entity)
+{
+    // Камеры и потомки интерполируемых сущностей интерполируются сами по себе
+    if (registry.any_of<Camera_C>(entity))
+        return;
+
+    if (registry.any_of<Parent_C>(entity)) {
+        auto parent = registry.get<Parent_C>(entity).parent;
+        if (registry.valid(parent) && registry.any_of<RenderTransform_C>(parent))
+            return;
+    }
+
+    registry.remove<RenderTransform_C>(entity);
+}
+
 } // namespace ae
@@ -20,9 +20,32 @@ public:
 
     entt::registry &getRegistry();
 
+    struct RenderStats
+    {
+        // Заполнение снимка в конце тика
+        int64_t extract_time_us = 0;
+        // От начала тика до отрисовки его снимка
+        int64_t latency_us = 0;
+        int32_t items = 0;
+    };
+
     void tickUpdate(const Time &elapsed_time);
     void draw() const;
 
+    // В конвейерном режиме tickUpdate запускает тик в JobSystem и сразу возвращается.
+    // Отрисовка в это время рисует снимок предыдущего тика, задержка вывода +1 тик
+    bool isPipelined() const;
+    void setPipelined(bool pipelined);
+    // Дожидается запущенного тика. До этого нельзя менять сцену из главного потока
+    void waitTickUpdate();
+
+    void clear();
+
+    RenderStats getRenderStats() const;
+
+    // Порядок и время систем последнего тика
+    const SystemScheduler &getScheduler() const;
+
     Signal<> tickUpdated;
 
     void createPlayer(const s_ptr<Model> &model,
@@ -30,9 +53,13 @@ public:
                       const mat4 &model_transform = mat4{1.0f});
 
 private:
-    void drawSkybox() const;
+    void addSystems();
+    void runTick();
+    void extractSnapshot(RenderSnapshot &snapshot);
+
+    void drawSkybox(const RenderSnapshot &snapshot, const mat4 &view_transform) const;
     void drawShadow() const;
-    void drawScene() const;
+    void drawScene(const RenderSnapshot &snapshot, const mat4 &view_transform, float alpha) const;
 
     // On camera patched
     void onCameraUpdated(entt::registry &registry, entt::entity entity);
@@ -43,6 +70,8 @@ private:
     // On movement patched
     void onMovementConstructed(entt::registry &registry, entt::entity entity);
     void onMovementUpdated(entt::registry &registry, entt::entity entity);
+    void onDynamicConstructed(entt::registry &registry, entt::entity entity);
+    void onDynamicDestroyed(entt::registry &registry, entt::entity entity);
 
 private:
     SceneData m_data;
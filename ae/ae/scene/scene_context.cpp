@@ -2,6 +2,8 @@
 #include "../common/consts.h"
 #include "../common/glm_utils.h"
 #include "../graphics/scene/model_instance.h"
+#include "../system/log.h"
+#include "../system/job_system.h"
 #include "components.h"
 #include "draw_s.h"
 #include "lights_s.h"
@@ -112,20 +114,30 @@ entt::entity SceneContext::createModelEntity(const s_ptr<Model> &model,
 void SceneContext::createMeshNodeEntities(const s_ptr<MeshNode> &mesh_node,
                                           const mat4 &transform)
 {
-    if (!mesh_node)
-        return;
+    createMeshNodeEntities(mesh_node, transform, buildMeshColliders(mesh_node, transform));
+}
 
-    auto new_transform = transform * mesh_node->getTransform();
+void SceneContext::createMeshNodeEntities(const s_ptr<MeshNode> &mesh_node,
+                                          const mat4 &transform,
+                                          const std::vector<s_ptr<MeshCollider>> &colliders)
+{
+    int32_t collider_index = 0;
+    createMeshNodeEntities(mesh_node, transform, colliders, collider_index);
+}
 
-    for (const auto &mesh : mesh_node->getMeshes()) {
-        auto entity = createDrawableEntity(mesh, new_transform);
+std::vector<s_ptr<MeshCollider>> SceneContext::buildMeshColliders(const s_ptr<MeshNode> &mesh_node,
+                                                                  const mat4 &transform)
+{
+    // Сначала собираются меши с трансформациями, затем коллайдеры строятся параллельно
+    std::vector<std::pair<s_ptr<Mesh>, mat4>> meshes;
+    collectMeshes(mesh_node, transform, meshes);
 
-        auto &collider_c = m_data->registry.emplace<Collider_C>(entity);
-        collider_c = createShared<MeshCollider>(mesh->getTriangles(), new_transform);
-    }
+    std::vector<s_ptr<MeshCollider>> colliders(meshes.size());
+    JobSystem::getDefault().parallelFor(meshes.size(), [&](int32_t i) {
+        colliders[i] = createMeshCollider(meshes[i].first, meshes[i].second);
+    });
 
-    for (const auto &child_mesh_node : mesh_node->getChildren())
-        createMeshNodeEntities(child_mesh_node, new_transform);
+    return colliders;
 }
 
 void SceneContext::destroyEntity(entt::entity entity)
@@ -203,6 +215,8 @@ void SceneContext::addChild(entt::entity entity, entt::entity child)
 
     if (has<Dynamic_C>(entity) && !has<Dynamic_C>(child))
         propagateDynamic(child);
+    if (has<RenderTransform_C>(entity))
+        propagateRenderTransform(child);
 
     markGlobalTransformDirty(child);
 }
@@ -353,6 +367,12 @@ void SceneContext::lookAt(entt::entity entity, const vec3 &target)
     });
 }
 
+void SceneContext::resetInterpolation(entt::entity entity)
+{
+    if (isValid(entity) && has<RenderTransform_C>(entity))
+        get<RenderTransform_C>(entity).has_previous = false;
+}
+
 const AABB &SceneContext::getLocalAABB(entt::entity entity) const
 {
     if (has<LocalAABB_C>(entity))
@@ -383,6 +403,9 @@ entt::entity SceneContext::createCamera()
     transform_inheritance_c.mode = TransformInheritance_C::POSITION
                                    | TransformInheritance_C::ROTATION;
 
+    // Камера может быть потомком сущности без Dynamic_C и все равно двигаться каждый тик
+    m_data->registry.emplace<RenderTransform_C>(entity);
+
     auto &camera_c = m_data->registry.emplace<Camera_C>(entity);
     camera_c.ratio = static_cast<float>(getRenderTexture().getSize().x)
                      / getRenderTexture().getSize().y;
@@ -398,6 +421,9 @@ entt::entity SceneContext::createCamera(float fov, float near, float far, const
     transform_inheritance_c.mode = TransformInheritance_C::POSITION
                                    | TransformInheritance_C::ROTATION;
 
+    // Камера может быть потомком сущности без Dynamic_C и все равно двигаться каждый тик
+    m_data->registry.emplace<RenderTransform_C>(entity);
+
     auto &camera_c = m_data->registry.emplace<Camera_C>(entity);
     camera_c.fov = fov;
     camera_c.near = near;
@@ -575,6 +601,115 @@ void SceneContext::clear()
     m_data->draw_s->clear();
 }
 
+void SceneContext::createMeshNodeEntities(const s_ptr<MeshNode> &mesh_node,
+                                          const mat4 &transform,
+                                          const std::vector<s_ptr<MeshCollider>> &colliders,
+                                          int32_t &collider_index)
+{
+    if (!mesh_node)
+        return;
+
+    auto new_transform = transform * mesh_node->getTransform();
+
+    for (const auto &mesh : mesh_node->getMeshes()) {
+        auto entity = createDrawableEntity(mesh, new_transform);
+
+        auto &collider_c = m_data->registry.emplace<Collider_C>(entity);
+        if (collider_index < colliders.size())
+            collider_c = colliders[collider_index++];
+        else
+            collider_c = createMeshCollider(mesh, new_transform);
+    }
+
+    for (const auto &child_mesh_node : mesh_node->getChildren())
+        createMeshNodeEntities(child_mesh_node, new_transform, colliders, collider_index);
+}
+
+s_ptr<MeshCollider> SceneContext::createMeshCollider(const s_ptr<Mesh> &mesh,
+                                                    const mat4 &transform)
+{
+    if (mesh->getTrianglesTree())
+        return createShared<MeshCollider>(*mesh->getTrianglesTree(), transform);
+
+    if (mesh->getTriangles().empty() && mesh->getResidency() == MeshResidency::GPU_ONLY) {
+        l_warn("Mesh collider from AABB: mesh residency is GPU_ONLY, {} triangles dropped",
+               mesh->getVertexArray().getIndicesCount() / 3);
+        return createShared<MeshCollider>(geometry_utils::trianglesFromAABB(mesh->getAABB()),
+                                          transform);
+    }
+
+    return createShared<MeshCollider>(mesh->getTriangles(), transform);
+}
+
+void SceneContext::collectMeshes(const s_ptr<MeshNode> &mesh_node,
+                                 const mat4 &transform,
+                                 std::vector<std::pair<s_ptr<Mesh>, mat4>> &meshes)
+{
+    if (!mesh_node)
+        return;
+
+    auto new_transform = transform * mesh_node->getTransform();
+
+    for (const auto &mesh : mesh_node->getMeshes())
+        meshes.emplace_back(mesh, new_transform);
+
+    for (const auto &child_mesh_node : mesh_node->getChildren())
+        collectMeshes(child_mesh_node, new_transform, meshes);
+}
+
+void SceneContext::updateDirtyTransforms()
+{
+    for (auto [entity, global_transform_c] : m_data->registry.view<GlobalTransform_C>().each()) {
+        if (global_transform_c.dirty)
+            getGlobalTransform(entity);
+    }
+
+    for (auto [entity, global_aabb_c] : m_data->registry.view<GlobalAABB_C>().each()) {
+        if (global_aabb_c.dirty)
+            getGlobalAABB(entity);
+    }
+
+    getCameraFrustum(getActiveCamera());
+}
+
+void SceneContext::saveTickTransforms()
+{
+    auto view = m_data->registry.view<RenderTransform_C, GlobalTransform_C>();
+    for (auto [entity, render_transform_c, global_transform_c] : view.each()) {
+        if (global_transform_c.dirty)
+            getGlobalTransform(entity);
+
+        render_transform_c.previous_position = global_transform_c.position;
+        render_transform_c.previous_rotation = glm::quat(global_transform_c.rotation);
+        render_transform_c.previous_scale = global_transform_c.scale;
+        render_transform_c.has_previous = true;
+    }
+}
+
+SnapshotTransform SceneContext::getSnapshotTransform(entt::entity entity) const
+{
+    SnapshotTransform snapshot_transform;
+    snapshot_transform.transform = getGlobalTransform(entity);
+
+    if (!has<GlobalTransform_C>(entity))
+        return snapshot_transform;
+
+    const auto &global_transform_c = get<GlobalTransform_C>(entity);
+    snapshot_transform.position = global_transform_c.position;
+    snapshot_transform.rotation = glm::quat(global_transform_c.rotation);
+    snapshot_transform.scale = global_transform_c.scale;
+
+    if (has<RenderTransform_C>(entity)) {
+        const auto &render_transform_c = get<RenderTransform_C>(entity);
+        snapshot_transform.previous_position = render_transform_c.previous_position;
+        snapshot_transform.previous_rotation = render_transform_c.previous_rotation;
+        snapshot_transform.previous_scale = render_transform_c.previous_scale;
+        snapshot_transform.interpolate = render_transform_c.has_previous;
+    }
+
+    return snapshot_transform;
+}
+
 void SceneContext::updateCameraTransforms(entt::entity entity)
 {
     auto &camera_c = get<Camera_C>(entity);
@@ -612,6 +747,21 @@ void SceneContext::propagateDynamic(entt::entity entity)
         propagateDynamic(child);
 }
 
+void SceneContext::propagateRenderTransform(entt::entity entity)
+{
+    if (!isValid(entity))
+        return;
+
+    if (!has<RenderTransform_C>(entity))
+        m_data->registry.emplace<RenderTransform_C>(entity);
+
+    if (!has<Children_C>(entity))
+        return;
+
+    for (auto child : get<Children_C>(entity).children)
+        propagateRenderTransform(child);
+}
+
 void SceneContext::markGlobalTransformDirty(entt::entity entity)
 {
     if (has<GlobalTransform_C>(entity)) {
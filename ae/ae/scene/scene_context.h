@@ -1,12 +1,14 @@
 #ifndef AE_SCENE_CONTEXT_H
 #define AE_SCENE_CONTEXT_H
 
+#include "../collisions/colliders.h"
 #include "../engine_context_object.h"
 #include "../geometry/frustum.h"
 #include "../geometry/primitives.h"
 #include "../graphics/scene/drawable.h"
 #include "../graphics/scene/model.h"
 #include "../graphics/scene/skybox.h"
+#include "render_snapshot.h"
 #include "scene_data.h"
 
 #include <glm/glm.hpp>
@@ -44,6 +46,15 @@ public:
 
     void createMeshNodeEntities(const s_ptr<MeshNode> &mesh_node,
                                 const mat4 &transform = mat4{1.0f});
+    // С заранее построенными коллайдерами (см. buildMeshColliders)
+    void createMeshNodeEntities(const s_ptr<MeshNode> &mesh_node,
+                                const mat4 &transform,
+                                const std::vector<s_ptr<MeshCollider>> &colliders);
+
+    // Коллайдеры мешей в порядке обхода createMeshNodeEntities, строятся параллельно
+    // в JobSystem. Не обращается к реестру и GL, поэтому может выполняться в рабочем потоке
+    static std::vector<s_ptr<MeshCollider>> buildMeshColliders(const s_ptr<MeshNode> &mesh_node,
+                                                               const mat4 &transform = mat4{1.0f});
 
     // Entities management
     void destroyEntity(entt::entity entity);
@@ -65,6 +76,9 @@ public:
 
     void lookAt(entt::entity entity, const vec3 &target);
 
+    // Сбрасывает интерполяцию, чтобы телепортированная сущность не пролетала путь
+    void resetInterpolation(entt::entity entity);
+
     // Entity AABB
     const AABB &getLocalAABB(entt::entity entity) const;
     const AABB &getGlobalAABB(entt::entity entity) const;
@@ -126,9 +140,27 @@ public:
     }
 
 protected:
+    // Вычисляет отложенные глобальные трансформации, AABB и матрицы активной камеры.
+    // После этого их чтение ничего не меняет и безопасно из нескольких потоков
+    void updateDirtyTransforms();
     void updateCameraTransforms(entt::entity entity);
+    // Запоминает состояние сущностей с RenderTransform_C перед тиком
+    void saveTickTransforms();
+    // Глобальная трансформация вместе с состоянием на начало тика
+    SnapshotTransform getSnapshotTransform(entt::entity entity) const;
     void propagateDynamic(entt::entity entity);
+    // Глобальная трансформация потомков меняется вместе с родителем, интерполируется все поддерево
+    void propagateRenderTransform(entt::entity entity);
     void markGlobalTransformDirty(entt::entity entity);
+    void createMeshNodeEntities(const s_ptr<MeshNode> &mesh_node,
+                                const mat4 &transform,
+                                const std::vector<s_ptr<MeshCollider>> &colliders,
+                                int32_t &collider_index);
+    // Для мешей без треугольников (MeshResidency::GPU_ONLY) коллайдер строится по AABB
+    static s_ptr<MeshCollider> createMeshCollider(const s_ptr<Mesh> &mesh, const mat4 &transform);
+    static void collectMeshes(const s_ptr<MeshNode> &mesh_node,
+                              const mat4 &transform,
+                              std::vector<std::pair<s_ptr<Mesh>, mat4>> &meshes);
     mat4 buildInheritedTransform(const mat4 &transform, int32_t flags) const;
 
 private:
@@ -3,7 +3,11 @@
 
 #include "../graphics/core/render_texture.h"
 #include "../system/memory.h"
+#include "../system/time.h"
+#include "../system/job_system.h"
 #include "bvh.h"
+#include "render_snapshot.h"
+#include "system_scheduler.h"
 
 #include <entt/entt.hpp>
 
@@ -32,6 +36,23 @@ struct SceneData
     u_ptr<Player_S> player_s;
     u_ptr<Movement_S> movement_s;
 
+    SystemScheduler scheduler;
+    Time tick_time;
+
+    // Конвейерный режим: тик выполняется в JobSystem, пока кадр рисует предыдущий снимок
+    bool pipelined = false;
+    bool tick_in_flight = false;
+    JobCounter tick_counter;
+
+    // Отрисовка читает front, тик пишет в другой
+    RenderSnapshot snapshots[2];
+    int32_t front_snapshot = 0;
+    int64_t snapshot_id = 0;
+
+    int64_t extract_time_us = 0;
+    // Пишется при отрисовке
+    mutable int64_t latency_us = 0;
+
     bool camera_dirty = true;
     bool scene_dirty = true;
 };
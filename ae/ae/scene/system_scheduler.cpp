@@ -0,0 +1,192 @@
+#include "system_scheduler.h"
+#include "../system/clock.h"
+#include "../system/job_system.h"
+#include "../system/log.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace ae {
+
+SystemScheduler::Entry &SystemScheduler::Entry::after(const std::string &name)
+{
+    m_after.push_back(name);
+    return *this;
+}
+
+SystemScheduler::Entry &SystemScheduler::Entry::onMainThread()
+{
+    m_main_thread = true;
+    return *this;
+}
+
+SystemScheduler::SystemScheduler()
+    : m_graph_dirty{true}
+    , m_total_time_us{0}
+{}
+
+SystemScheduler::Entry &SystemScheduler::add(const std::string &name, std::function<void()> func)
+{
+    auto entry = createUnique<Entry>();
+    entry->m_name = name;
+    entry->m_func = std::move(func);
+
+    m_entries.push_back(std::move(entry));
+    m_graph_dirty = true;
+
+    return *m_entries.back();
+}
+
+void SystemScheduler::setEnabled(const std::string &name, bool enabled)
+{
+    for (auto &entry : m_entries) {
+        if (entry->m_name == name && entry->m_enabled != enabled) {
+            entry->m_enabled = enabled;
+            m_graph_dirty = true;
+        }
+    }
+}
+
+void SystemScheduler::run(JobSystem &job_system)
+{
+    if (m_graph_dirty)
+        buildGraph();
+
+    int32_t count = m_active.size();
+    if (count == 0)
+        return;
+
+    Clock total_clock;
+
+    std::vector<std::atomic<int32_t>> remaining(count);
+    for (int32_t i = 0; i < count; ++i)
+        remaining[i] = m_predecessors_count[i];
+
+    // Система запускается, когда завершились все ее предшественники
+    JobCounter counter;
+    std::function<void(int32_t)> launch = [&](int32_t i) {
+        const auto &entry = *m_entries[m_active[i]];
+
+        auto job = [&, i]() {
+            Clock clock;
+            m_entries[m_active[i]]->m_func();
+            m_timings[i].time_us = clock.getElapsedTime().asMicroseconds();
+
+            for (int32_t successor : m_successors[i]) {
+                if (remaining[successor].fetch_sub(1) == 1)
+                    launch(successor);
+            }
+        };
+
+        if (entry.m_main_thread)
+            job_system.runOnMainThread(job, &counter);
+        else
+            job_system.run(job, &counter);
+    };
+
+    for (int32_t i = 0; i < count; ++i) {
+        if (m_predecessors_count[i] == 0)
+            launch(i);
+    }
+
+    job_system.wait(counter);
+
+    m_total_time_us = total_clock.getElapsedTime().asMicroseconds();
+}
+
+const std::vector<SystemScheduler::Timing> &SystemScheduler::getTimings() const
+{
+    return m_timings;
+}
+
+int64_t SystemScheduler::getTotalTime() const
+{
+    return m_total_time_us;
+}
+
+std::string SystemScheduler::exportGraph() const
+{
+    std::string result = "digraph systems {\n";
+
+    for (int32_t i = 0; i < static_cast<int32_t>(m_active.size()); ++i) {
+        const auto &timing = i < static_cast<int32_t>(m_timings.size()) ? m_timings[i] : Timing{};
+        result += fmt::format("    \"{}\" [label=\"{}\\n{} us\"{}];\n",
+                              timing.name,
+                              timing.name,
+                              timing.time_us,
+                              timing.main_thread ? ", shape=box" : "");
+    }
+
+    for (int32_t i = 0; i < static_cast<int32_t>(m_successors.size()); ++i) {
+        for (int32_t successor : m_successors[i]) {
+            result += fmt::format("    \"{}\" -> \"{}\";\n",
+                                  m_entries[m_active[i]]->m_name,
+                                  m_entries[m_active[successor]]->m_name);
+        }
+    }
+
+    result += "}\n";
+    return result;
+}
+
+void SystemScheduler::buildGraph()
+{
+    m_graph_dirty = false;
+
+    m_active.clear();
+    for (int32_t i = 0; i < static_cast<int32_t>(m_entries.size()); ++i) {
+        if (m_entries[i]->m_enabled)
+            m_active.push_back(i);
+    }
+
+    int32_t count = m_active.size();
+    m_successors.assign(count, {});
+    m_predecessors_count.assign(count, 0);
+
+    m_timings.assign(count, Timing{});
+    for (int32_t i = 0; i < count; ++i) {
+        m_timings[i].name = m_entries[m_active[i]]->m_name;
+        m_timings[i].main_thread = m_entries[m_active[i]]->m_main_thread;
+    }
+
+    // Ребра идут только от добавленных раньше систем, поэтому граф без циклов
+    for (int32_t i = 0; i < count; ++i) {
+        const auto &entry = *m_entries[m_active[i]];
+
+        for (int32_t j = 0; j < i; ++j) {
+            if (dependsOn(entry, *m_entries[m_active[j]])) {
+                m_successors[j].push_back(i);
+                ++m_predecessors_count[i];
+            }
+        }
+
+        for (const auto &name : entry.m_after) {
+            auto found = std::find_if(m_entries.begin(),
+                                      m_entries.begin() + m_active[i],
+                                      [&](const auto &other) { return other->m_name == name; });
+            if (found == m_entries.begin() + m_active[i])
+                l_warn("System '{}' must be added after '{}'", entry.m_name, name);
+        }
+    }
+}
+
+bool SystemScheduler::dependsOn(const Entry &entry, const Entry &other) const
+{
+    if (std::find(entry.m_after.begin(), entry.m_after.end(), other.m_name) != entry.m_after.end())
+        return true;
+
+    return intersects(other.m_writes, entry.m_reads) || intersects(other.m_writes, entry.m_writes)
+           || intersects(other.m_reads, entry.m_writes);
+}
+
+bool SystemScheduler::intersects(const std::vector<entt::id_type> &a,
+                                 const std::vector<entt::id_type> &b)
+{
+    for (auto id : a) {
+        if (std::find(b.begin(), b.end(), id) != b.end())
+            return true;
+    }
+    return false;
+}
+
+} // namespace ae
@@ -0,0 +1,102 @@
+#ifndef AE_SYSTEM_SCHEDULER_H
+#define AE_SYSTEM_SCHEDULER_H
+
+#include "../system/memory.h"
+
+#include <entt/entt.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ae {
+
+class JobSystem;
+
+// Запускает обновления систем по графу зависимостей. Каждая система объявляет, какие
+// компоненты читает и пишет. Система зависит от добавленных раньше, если пишет то, что
+// они читают или пишут, или читает то, что они пишут. Независимые системы выполняются
+// параллельно, конфликтующие - в порядке добавления, поэтому результат не зависит от
+// распределения по потокам
+class SystemScheduler
+{
+public:
+    class Entry
+    {
+        friend class SystemScheduler;
+
+    public:
+        template<typename... Components>
+        Entry &reads()
+        {
+            (m_reads.push_back(entt::type_hash<Components>::value()), ...);
+            return *this;
+        }
+
+        template<typename... Components>
+        Entry &writes()
+        {
+            (m_writes.push_back(entt::type_hash<Components>::value()), ...);
+            return *this;
+        }
+
+        // Порядок, который не следует из компонентов. Система должна быть добавлена раньше
+        Entry &after(const std::string &name);
+        // Для систем, работающих с GL
+        Entry &onMainThread();
+
+    private:
+        std::string m_name;
+        std::function<void()> m_func;
+        std::vector<entt::id_type> m_reads;
+        std::vector<entt::id_type> m_writes;
+        std::vector<std::string> m_after;
+        bool m_main_thread = false;
+        bool m_enabled = true;
+    };
+
+    struct Timing
+    {
+        std::string name;
+        int64_t time_us = 0;
+        bool main_thread = false;
+    };
+
+    SystemScheduler();
+    ~SystemScheduler() = default;
+
+    Entry &add(const std::string &name, std::function<void()> func);
+    void setEnabled(const std::string &name, bool enabled);
+
+    // Системы onMainThread выполняются, когда главный поток ждет задачи JobSystem
+    void run(JobSystem &job_system);
+
+    // Время систем последнего запуска в порядке добавления
+    const std::vector<Timing> &getTimings() const;
+    int64_t getTotalTime() const;
+
+    // Граф в формате Graphviz dot
+    std::string exportGraph() const;
+
+private:
+    void buildGraph();
+    bool dependsOn(const Entry &entry, const Entry &other) const;
+    static bool intersects(const std::vector<entt::id_type> &a,
+                           const std::vector<entt::id_type> &b);
+
+private:
+    std::vector<u_ptr<Entry>> m_entries;
+
+    // Граф строится по включенным системам и перестраивается при их изменении
+    bool m_graph_dirty;
+    std::vector<int32_t> m_active;
+    std::vector<std::vector<int32_t>> m_successors;
+    std::vector<int32_t> m_predecessors_count;
+
+    std::vector<Timing> m_timings;
+    int64_t m_total_time_us;
+};
+
+} // namespace ae
+
+#endif // AE_SYSTEM_SCHEDULER_H
@@ -0,0 +1,140 @@
+#ifndef AE_DELEGATE_H
+#define AE_DELEGATE_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace ae {
+
+template<typename Signature>
+class Delegate;
+
+// Замена std::function для слотов: функтор до INLINE_SIZE байт хранится внутри объекта,
+// больший выделяется в куче. Только перемещение
+template<typename R, typename... Args>
+class Delegate<R(Args...)>
+{
+public:
+    static constexpr size_t INLINE_SIZE = 4 * sizeof(void *);
+
+    Delegate() noexcept
+        : m_ops{nullptr}
+    {}
+
+    Delegate(std::nullptr_t) noexcept
+        : m_ops{nullptr}
+    {}
+
+    template<typename F>
+        requires(!std::is_same_v<std::decay_t<F>, Delegate>
+                 && std::is_invocable_r_v<R, std::decay_t<F> &, Args...>)
+    Delegate(F &&func)
+        : m_ops{nullptr}
+    {
+        using Func = std::decay_t<F>;
+
+        // Пустой std::function или нулевой указатель на функцию дают пустой делегат
+        if constexpr (std::is_constructible_v<bool, const Func &>) {
+            if (!static_cast<bool>(func))
+                return;
+        }
+
+        if constexpr (isInline<Func>()) {
+            ::new (m_storage) Func(std::forward<F>(func));
+            m_ops = &INLINE_OPS<Func>;
+        } else {
+            *reinterpret_cast<Func **>(m_storage) = new Func(std::forward<F>(func));
+            m_ops = &HEAP_OPS<Func>;
+        }
+    }
+
+    Delegate(Delegate &&other) noexcept
+        : m_ops{other.m_ops}
+    {
+        if (m_ops) {
+            m_ops->move(m_storage, other.m_storage);
+            other.m_ops = nullptr;
+        }
+    }
+
+    Delegate(const Delegate &) = delete;
+
+    ~Delegate() { reset(); }
+
+    Delegate &operator=(Delegate &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            m_ops = other.m_ops;
+            if (m_ops) {
+                m_ops->move(m_storage, other.m_storage);
+                other.m_ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Delegate &operator=(const Delegate &) = delete;
+
+    R operator()(Args... args) const
+    {
+        return m_ops->invoke(const_cast<std::byte *>(m_storage), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+    void reset() noexcept
+    {
+        if (m_ops) {
+            m_ops->destroy(m_storage);
+            m_ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops
+    {
+        R (*invoke)(void *, Args &&...);
+        // Перемещает функтор из src в dst, src после этого не используется
+        void (*move)(void *dst, void *src) noexcept;
+        void (*destroy)(void *) noexcept;
+    };
+
+    template<typename Func>
+    static constexpr bool isInline()
+    {
+        return sizeof(Func) <= INLINE_SIZE && alignof(Func) <= alignof(std::max_align_t)
+               && std::is_nothrow_move_constructible_v<Func>;
+    }
+
+    template<typename Func>
+    static constexpr Ops INLINE_OPS{
+        [](void *storage, Args &&...args) -> R {
+            return (*static_cast<Func *>(storage))(std::forward<Args>(args)...);
+        },
+        [](void *dst, void *src) noexcept {
+            ::new (dst) Func(std::move(*static_cast<Func *>(src)));
+            static_cast<Func *>(src)->~Func();
+        },
+        [](void *storage) noexcept { static_cast<Func *>(storage)->~Func(); }};
+
+    template<typename Func>
+    static constexpr Ops HEAP_OPS{
+        [](void *storage, Args &&...args) -> R {
+            return (**static_cast<Func **>(storage))(std::forward<Args>(args)...);
+        },
+        [](void *dst, void *src) noexcept {
+            *static_cast<Func **>(dst) = *static_cast<Func **>(src);
+        },
+        [](void *storage) noexcept { delete *static_cast<Func **>(storage); }};
+
+private:
+    const Ops *m_ops;
+    alignas(std::max_align_t) std::byte m_storage[INLINE_SIZE];
+};
+
+} // namespace ae
+
+#endif // AE_DELEGATE_H
@@ -0,0 +1,138 @@
+#include "frame_arena.h"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+
+namespace ae {
+
+std::atomic<uint64_t> FrameArena::m_frame_index{0};
+std::atomic<size_t> FrameArena::m_high_water{0};
+std::atomic<int64_t> FrameArena::m_fallback_allocations{0};
+std::atomic<size_t> FrameArena::m_total_fallback_bytes{0};
+
+FrameArena::Scope::Scope()
+    : m_arena{FrameArena::getThreadArena()}
+{
+    m_arena.resetIfNewFrame();
+    m_offset = m_arena.m_offset;
+    m_fallbacks_count = m_arena.m_fallbacks.size();
+    ++m_arena.m_scopes;
+}
+
+FrameArena::Scope::~Scope()
+{
+    m_arena.m_offset = m_offset;
+    m_arena.releaseFallbacks(m_fallbacks_count);
+    --m_arena.m_scopes;
+}
+
+FrameArena::FrameArena(size_t capacity)
+    : m_memory(capacity)
+    , m_offset{0}
+    , m_fallback_bytes{0}
+    , m_peak{0}
+    , m_scopes{0}
+    , m_frame{m_frame_index.load()}
+{}
+
+FrameArena::~FrameArena()
+{
+    releaseFallbacks(0);
+}
+
+void *FrameArena::allocate(size_t size, size_t alignment)
+{
+    resetIfNewFrame();
+
+    auto base = reinterpret_cast<uintptr_t>(m_memory.data());
+    size_t offset = ((base + m_offset + alignment - 1) & ~(alignment - 1)) - base;
+
+    if (offset + size <= m_memory.size()) {
+        m_offset = offset + size;
+        m_peak = std::max(m_peak, m_offset + m_fallback_bytes);
+        return m_memory.data() + offset;
+    }
+
+    // Блок закончился, до конца кадра память берется из кучи
+    void *ptr = ::operator new(size, std::align_val_t{alignment});
+    m_fallbacks.push_back({ptr, size, alignment});
+    m_fallback_bytes += size;
+    m_peak = std::max(m_peak, m_offset + m_fallback_bytes);
+
+    m_fallback_allocations.fetch_add(1, std::memory_order_relaxed);
+    m_total_fallback_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    return ptr;
+}
+
+size_t FrameArena::getCapacity() const
+{
+    return m_memory.size();
+}
+
+size_t FrameArena::getUsed() const
+{
+    return m_offset + m_fallback_bytes;
+}
+
+FrameArena &FrameArena::getThreadArena()
+{
+    thread_local FrameArena arena;
+    return arena;
+}
+
+void FrameArena::beginFrame()
+{
+    m_frame_index.fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameArena::Stats FrameArena::getStats()
+{
+    Stats stats;
+    stats.high_water = m_high_water.load();
+    stats.fallback_allocations = m_fallback_allocations.load();
+    stats.fallback_bytes = m_total_fallback_bytes.load();
+    return stats;
+}
+
+void FrameArena::resetStats()
+{
+    m_high_water = 0;
+    m_fallback_allocations = 0;
+    m_total_fallback_bytes = 0;
+}
+
+void FrameArena::resetIfNewFrame()
+{
+    // Внутри Scope сброс откладывается, выделенная в ней память еще используется
+    if (m_scopes == 0 && m_frame != m_frame_index.load(std::memory_order_relaxed))
+        reset();
+}
+
+void FrameArena::reset()
+{
+    size_t high_water = m_high_water.load(std::memory_order_relaxed);
+    while (m_peak > high_water && !m_high_water.compare_exchange_weak(high_water, m_peak)) {}
+
+    releaseFallbacks(0);
+
+    // Блок пуст, поэтому его можно увеличить без перемещения живых данных
+    if (m_peak > m_memory.size())
+        m_memory = std::vector<std::byte>(std::bit_ceil(m_peak));
+
+    m_offset = 0;
+    m_peak = 0;
+    m_frame = m_frame_index.load(std::memory_order_relaxed);
+}
+
+void FrameArena::releaseFallbacks(size_t from)
+{
+    for (size_t i = from; i < m_fallbacks.size(); ++i) {
+        ::operator delete(m_fallbacks[i].ptr, std::align_val_t{m_fallbacks[i].alignment});
+        m_fallback_bytes -= m_fallbacks[i].size;
+    }
+    m_fallbacks.resize(std::min(from, m_fallbacks.size()));
+}
+
+} // namespace ae
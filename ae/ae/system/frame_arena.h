@@ -0,0 +1,131 @@
+#ifndef AE_FRAME_ARENA_H
+#define AE_FRAME_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ae {
+
+// Линейный аллокатор временных данных, свой у каждого потока. Память не освобождается
+// по одной аллокации, а сбрасывается целиком: в начале следующего кадра (при первом
+// обращении потока) или при выходе из Scope. Если блока не хватает, память берется из кучи,
+// а при сбросе блок увеличивается до пикового использования кадра
+class FrameArena
+{
+public:
+    struct Stats
+    {
+        // Наибольшее использование за кадр одним потоком, байт
+        size_t high_water = 0;
+        int64_t fallback_allocations = 0;
+        size_t fallback_bytes = 0;
+    };
+
+    // Все выделенное внутри области освобождается при выходе из нее. Контейнеры с
+    // FrameAllocator должны быть объявлены после Scope
+    class Scope
+    {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        FrameArena &m_arena;
+        size_t m_offset;
+        size_t m_fallbacks_count;
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 256 * 1024;
+
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *allocate(size_t size, size_t alignment);
+
+    size_t getCapacity() const;
+    size_t getUsed() const;
+
+    static FrameArena &getThreadArena();
+
+    // Начинает новый кадр для арен всех потоков, вызывается движком
+    static void beginFrame();
+
+    static Stats getStats();
+    static void resetStats();
+
+private:
+    struct Fallback
+    {
+        void *ptr;
+        size_t size;
+        size_t alignment;
+    };
+
+    void resetIfNewFrame();
+    void reset();
+    void releaseFallbacks(size_t from);
+
+private:
+    std::vector<std::byte> m_memory;
+    size_t m_offset;
+    std::vector<Fallback> m_fallbacks;
+    size_t m_fallback_bytes;
+    size_t m_peak;
+    int32_t m_scopes;
+    uint64_t m_frame;
+
+    static std::atomic<uint64_t> m_frame_index;
+    static std::atomic<size_t> m_high_water;
+    static std::atomic<int64_t> m_fallback_allocations;
+    static std::atomic<size_t> m_total_fallback_bytes;
+};
+
+// Аллокатор для STL контейнеров. Освобождение ничего не делает, контейнер не должен
+// переживать кадр или Scope и передаваться в другой поток
+template<typename T>
+class FrameAllocator
+{
+public:
+    using value_type = T;
+
+    FrameAllocator() = default;
+
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U> &)
+    {}
+
+    T *allocate(size_t count)
+    {
+        return static_cast<T *>(
+            FrameArena::getThreadArena().allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) {}
+
+    template<typename U>
+    bool operator==(const FrameAllocator<U> &) const
+    {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const FrameAllocator<U> &) const
+    {
+        return false;
+    }
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+} // namespace ae
+
+#endif // AE_FRAME_ARENA_H
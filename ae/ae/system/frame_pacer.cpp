@@ -0,0 +1,170 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace ae {
+
+FramePacer::FramePacer()
+    : m_target_frame_rate{0}
+    , m_tick_time{seconds(1.0f / 60.0f)}
+    , m_max_catch_up_ticks{DEFAULT_MAX_CATCH_UP_TICKS}
+    , m_next_frame_us{0}
+    , m_sleep_overshoot{0.0f}
+{
+    resetStats();
+}
+
+int32_t FramePacer::getTargetFrameRate() const
+{
+    return m_target_frame_rate;
+}
+
+void FramePacer::setTargetFrameRate(int32_t frame_rate)
+{
+    m_target_frame_rate = std::max(frame_rate, 0);
+    m_next_frame_us = 0;
+}
+
+const Time &FramePacer::getTickTime() const
+{
+    return m_tick_time;
+}
+
+void FramePacer::setTickTime(const Time &tick_time)
+{
+    m_tick_time = tick_time;
+}
+
+int32_t FramePacer::getMaxCatchUpTicks() const
+{
+    return m_max_catch_up_ticks;
+}
+
+void FramePacer::setMaxCatchUpTicks(int32_t max_ticks)
+{
+    m_max_catch_up_ticks = std::max(max_ticks, 1);
+}
+
+void FramePacer::restart()
+{
+    m_frame_clock.restart();
+    m_accumulator = Time{};
+    m_next_frame_us = 0;
+}
+
+Time FramePacer::beginFrame()
+{
+    Time elapsed = m_frame_clock.restart();
+
+    int64_t frame_time = elapsed.asMicroseconds();
+    ++m_frames;
+    m_frame_time_sum += frame_time;
+    m_frame_time_square_sum += double(frame_time) * frame_time;
+    m_max_frame_time = std::max(m_max_frame_time, frame_time);
+
+    // Лишнее время отбрасывается: игра замедляется, но не уходит в догоняющие тики
+    m_accumulator += elapsed;
+    Time max_accumulator = m_tick_time * static_cast<int64_t>(m_max_catch_up_ticks);
+    if (m_accumulator > max_accumulator && m_tick_time > Time{}) {
+        m_dropped_ticks += (m_accumulator - max_accumulator).asMicroseconds()
+                           / m_tick_time.asMicroseconds();
+        m_accumulator = max_accumulator;
+    }
+
+    return elapsed;
+}
+
+bool FramePacer::nextTick()
+{
+    if (m_tick_time <= Time{} || m_accumulator < m_tick_time)
+        return false;
+
+    m_accumulator -= m_tick_time;
+    return true;
+}
+
+float FramePacer::getAlpha() const
+{
+    if (m_tick_time <= Time{})
+        return 1.0f;
+
+    return std::clamp(m_accumulator.asSeconds() / m_tick_time.asSeconds(), 0.0f, 1.0f);
+}
+
+void FramePacer::waitForNextFrame()
+{
+    if (m_target_frame_rate <= 0)
+        return;
+
+    int64_t frame_period = 1000000 / m_target_frame_rate;
+    int64_t now = Clock::getCurrentTime().asMicroseconds();
+
+    // После долгого кадра отсчет начинается заново, иначе следующие кадры шли бы без пауз
+    if (m_next_frame_us == 0 || now - m_next_frame_us > frame_period)
+        m_next_frame_us = now;
+    m_next_frame_us += frame_period;
+
+    int64_t spin_margin = std::clamp(static_cast<int64_t>(m_sleep_overshoot * 2.0f),
+                                     MIN_SPIN_MARGIN,
+                                     MAX_SPIN_MARGIN);
+
+    int64_t sleep_time = m_next_frame_us - now - spin_margin;
+    if (sleep_time > 0) {
+        sleepFor(sleep_time);
+        now = Clock::getCurrentTime().asMicroseconds();
+    }
+
+    int64_t spin_start = now;
+    while (now < m_next_frame_us) {
+        std::this_thread::yield();
+        now = Clock::getCurrentTime().asMicroseconds();
+    }
+    m_spin_time += now - spin_start;
+}
+
+FramePacer::Stats FramePacer::getStats() const
+{
+    Stats stats;
+    stats.frames = m_frames;
+    stats.max_frame_time = microseconds(m_max_frame_time);
+    stats.dropped_ticks = m_dropped_ticks;
+    stats.sleep_time = microseconds(m_sleep_time);
+    stats.spin_time = microseconds(m_spin_time);
+
+    if (m_frames > 0) {
+        double average = double(m_frame_time_sum) / m_frames;
+        double variance = std::max(m_frame_time_square_sum / m_frames - average * average, 0.0);
+        stats.average_frame_time = microseconds(static_cast<int64_t>(average));
+        stats.jitter = microseconds(static_cast<int64_t>(std::sqrt(variance)));
+    }
+
+    return stats;
+}
+
+void FramePacer::resetStats()
+{
+    m_frames = 0;
+    m_frame_time_sum = 0;
+    m_frame_time_square_sum = 0.0;
+    m_max_frame_time = 0;
+    m_dropped_ticks = 0;
+    m_sleep_time = 0;
+    m_spin_time = 0;
+}
+
+void FramePacer::sleepFor(int64_t duration)
+{
+    int64_t start = Clock::getCurrentTime().asMicroseconds();
+    std::this_thread::sleep_for(std::chrono::microseconds(duration));
+    int64_t slept = Clock::getCurrentTime().asMicroseconds() - start;
+
+    m_sleep_time += slept;
+    // Сглаживание, чтобы единичный промах планировщика не увеличивал запас надолго
+    float overshoot = static_cast<float>(std::max<int64_t>(slept - duration, 0));
+    m_sleep_overshoot = m_sleep_overshoot * 0.9f + overshoot * 0.1f;
+}
+
+} // namespace ae
@@ -0,0 +1,90 @@
+#ifndef AE_FRAME_PACER_H
+#define AE_FRAME_PACER_H
+
+#include "clock.h"
+#include "time.h"
+
+namespace ae {
+
+// Ограничивает частоту кадров и раздает фиксированные тики. Ожидание следующего кадра
+// спит средствами ОС и досыпает вращением только последние сотни микросекунд, поэтому
+// процессор не загружается на 100%. Запас на вращение подстраивается под фактическую
+// точность sleep. Время, накопленное для тиков, ограничено, поэтому после долгого кадра
+// (загрузки ресурсов) не выполняется лавина догоняющих тиков
+class FramePacer
+{
+public:
+    struct Stats
+    {
+        int64_t frames = 0;
+        Time average_frame_time;
+        // Среднеквадратичное отклонение длительности кадра
+        Time jitter;
+        Time max_frame_time;
+        // Тики, отброшенные из-за ограничения догоняющих тиков
+        int64_t dropped_ticks = 0;
+        // Суммарно по кадрам
+        Time sleep_time;
+        Time spin_time;
+    };
+
+    static constexpr int32_t DEFAULT_MAX_CATCH_UP_TICKS = 5;
+    // Границы запаса на вращение, мкс
+    static constexpr int64_t MIN_SPIN_MARGIN = 200;
+    static constexpr int64_t MAX_SPIN_MARGIN = 4000;
+
+    FramePacer();
+    ~FramePacer() = default;
+
+    // 0 - без ограничения
+    int32_t getTargetFrameRate() const;
+    void setTargetFrameRate(int32_t frame_rate);
+
+    const Time &getTickTime() const;
+    void setTickTime(const Time &tick_time);
+
+    int32_t getMaxCatchUpTicks() const;
+    void setMaxCatchUpTicks(int32_t max_ticks);
+
+    // Начинает отсчет кадров заново, не записывая кадр в статистику. Вызывается
+    // перед первым кадром, чтобы время запуска не попало в тики и среднее
+    void restart();
+    // Начинает кадр и возвращает длительность предыдущего
+    Time beginFrame();
+    // Забирает из накопленного времени один тик: while (pacer.nextTick()) update(tick)
+    bool nextTick();
+    // Доля следующего тика в накопленном времени, от 0 до 1
+    float getAlpha() const;
+    // Ждет начала следующего кадра по целевой частоте
+    void waitForNextFrame();
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    void sleepFor(int64_t duration);
+
+private:
+    int32_t m_target_frame_rate;
+    Time m_tick_time;
+    int32_t m_max_catch_up_ticks;
+
+    Clock m_frame_clock;
+    Time m_accumulator;
+    // Время начала следующего кадра, отсчитывается от предыдущего, чтобы не копить ошибку
+    int64_t m_next_frame_us;
+    // Среднее превышение запрошенного времени сна, мкс
+    float m_sleep_overshoot;
+
+    int64_t m_frames;
+    int64_t m_frame_time_sum;
+    double m_frame_time_square_sum;
+    int64_t m_max_frame_time;
+    int64_t m_dropped_ticks;
+    int64_t m_sleep_time;
+    int64_t m_spin_time;
+};
+
+} // namespace ae
+
+#endif // AE_FRAME_PACER_H
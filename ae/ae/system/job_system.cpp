@@ -0,0 +1,396 @@
+#include "job_system.h"
+#include "clock.h"
+
+#include <algorithm>
+
+namespace ae {
+
+JobSystem *JobSystem::m_default = nullptr;
+thread_local const JobSystem *JobSystem::m_thread_system = nullptr;
+thread_local int32_t JobSystem::m_thread_index = -1;
+
+bool JobCounter::isDone() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_value == 0;
+}
+
+void JobCounter::add()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_value;
+}
+
+bool JobCounter::defer(Job &job)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_value == 0)
+        return false;
+
+    m_continuations.push_back(std::move(job));
+    return true;
+}
+
+bool JobCounter::finish(std::vector<Job> &continuations)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_value > 0)
+        return false;
+
+    continuations.swap(m_continuations);
+    return true;
+}
+
+JobSystem::JobSystem(int32_t threads_count)
+    : m_main_thread_id{std::this_thread::get_id()}
+    , m_pending{0}
+    , m_main_pending{0}
+    , m_sleeping{0}
+    , m_stop{false}
+    , m_external_jobs_run{0}
+    , m_external_steals{0}
+{
+    if (threads_count <= 0)
+        threads_count = std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()) - 1);
+
+    m_workers.reserve(threads_count);
+    for (int32_t i = 0; i < threads_count; ++i)
+        m_workers.push_back(createUnique<Worker>());
+
+    m_threads.reserve(threads_count);
+    for (int32_t i = 0; i < threads_count; ++i)
+        m_threads.emplace_back(&JobSystem::workerLoop, this, i);
+
+    if (!m_default)
+        m_default = this;
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+
+    for (auto &thread : m_threads)
+        thread.join();
+
+    if (m_default == this)
+        m_default = nullptr;
+}
+
+int32_t JobSystem::getThreadsCount() const
+{
+    return m_threads.size();
+}
+
+bool JobSystem::isMainThread() const
+{
+    return std::this_thread::get_id() == m_main_thread_id;
+}
+
+void JobSystem::run(std::function<void()> func, JobCounter *counter, JobCounter *dependency)
+{
+    if (counter)
+        counter->add();
+
+    Job job{std::move(func), counter, false};
+    if (dependency && dependency->defer(job))
+        return;
+
+    schedule(std::move(job));
+}
+
+void JobSystem::runOnMainThread(std::function<void()> func,
+                                JobCounter *counter,
+                                JobCounter *dependency)
+{
+    if (counter)
+        counter->add();
+
+    Job job{std::move(func), counter, true};
+    if (dependency && dependency->defer(job))
+        return;
+
+    schedule(std::move(job));
+}
+
+void JobSystem::executeMainThreadJobs()
+{
+    if (m_main_pending.load() == 0 || !isMainThread())
+        return;
+
+    // Задачи, добавленные во время выполнения, ждут следующего вызова
+    std::deque<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_main_mutex);
+        jobs.swap(m_main_jobs);
+    }
+    m_main_pending -= jobs.size();
+
+    for (auto &job : jobs)
+        runJob(job);
+}
+
+void JobSystem::wait(const JobCounter &counter)
+{
+    bool main_thread = isMainThread();
+
+    while (!counter.isDone()) {
+        if (tryRunJob())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        ++m_sleeping;
+        m_cv.wait(lock, [&]() {
+            return counter.isDone() || m_pending.load() > 0
+                   || (main_thread && m_main_pending.load() > 0);
+        });
+        --m_sleeping;
+    }
+}
+
+void JobSystem::parallelFor(int32_t count, const std::function<void(int32_t)> &func)
+{
+    parallelFor(count, 1, func);
+}
+
+void JobSystem::parallelFor(int32_t count,
+                            int32_t grain_size,
+                            const std::function<void(int32_t)> &func)
+{
+    if (count <= 0)
+        return;
+
+    grain_size = std::max(grain_size, 1);
+    int32_t chunks = (count + grain_size - 1) / grain_size;
+
+    if (chunks == 1 || m_threads.empty()) {
+        for (int32_t i = 0; i < count; ++i)
+            func(i);
+        return;
+    }
+
+    // Блоки раздаются по одному, помощник без блоков сразу завершается
+    std::atomic<int32_t> next{0};
+    auto run_chunks = [&]() {
+        int32_t chunk;
+        while ((chunk = next.fetch_add(1)) < chunks) {
+            int32_t end = std::min((chunk + 1) * grain_size, count);
+            for (int32_t i = chunk * grain_size; i < end; ++i)
+                func(i);
+        }
+    };
+
+    JobCounter counter;
+    int32_t helpers = std::min<int32_t>(m_threads.size(), chunks - 1);
+    for (int32_t i = 0; i < helpers; ++i)
+        run(run_chunks, &counter);
+
+    run_chunks();
+    wait(counter);
+}
+
+JobSystem::Stats JobSystem::getStats() const
+{
+    Stats stats;
+    stats.jobs_run = m_external_jobs_run.load();
+    stats.steals = m_external_steals.load();
+
+    for (const auto &worker : m_workers) {
+        stats.jobs_run += worker->jobs_run.load();
+        stats.steals += worker->steals.load();
+        stats.idle_time_us += worker->idle_time_us.load();
+    }
+
+    return stats;
+}
+
+void JobSystem::resetStats()
+{
+    m_external_jobs_run = 0;
+    m_external_steals = 0;
+
+    for (auto &worker : m_workers) {
+        worker->jobs_run = 0;
+        worker->steals = 0;
+        worker->idle_time_us = 0;
+    }
+}
+
+JobSystem &JobSystem::getDefault()
+{
+    if (m_default)
+        return *m_default;
+
+    static JobSystem job_system;
+    return job_system;
+}
+
+void JobSystem::schedule(Job &&job)
+{
+    if (job.main_thread) {
+        {
+            std::lock_guard<std::mutex> lock(m_main_mutex);
+            m_main_jobs.push_back(std::move(job));
+        }
+        ++m_main_pending;
+        wakeWaiting(true);
+        return;
+    }
+
+    if (m_thread_system == this) {
+        auto &worker = *m_workers[m_thread_index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.jobs.push_back(std::move(job));
+    } else {
+        std::lock_guard<std::mutex> lock(m_global_mutex);
+        m_global_jobs.push_back(std::move(job));
+    }
+    ++m_pending;
+    wakeWaiting(false);
+}
+
+bool JobSystem::tryRunJob()
+{
+    Job job;
+    if (!popJob(job))
+        return false;
+
+    runJob(job);
+    return true;
+}
+
+bool JobSystem::popJob(Job &job)
+{
+    if (m_main_pending.load() > 0 && isMainThread()) {
+        std::lock_guard<std::mutex> lock(m_main_mutex);
+        if (!m_main_jobs.empty()) {
+            job = std::move(m_main_jobs.front());
+            m_main_jobs.pop_front();
+            --m_main_pending;
+            return true;
+        }
+    }
+
+    if (m_pending.load() == 0)
+        return false;
+
+    int32_t index = m_thread_system == this ? m_thread_index : -1;
+
+    // Своя очередь с конца: последние задачи еще в кэше
+    if (index >= 0) {
+        auto &worker = *m_workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.jobs.empty()) {
+            job = std::move(worker.jobs.back());
+            worker.jobs.pop_back();
+            --m_pending;
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_global_mutex);
+        if (!m_global_jobs.empty()) {
+            job = std::move(m_global_jobs.front());
+            m_global_jobs.pop_front();
+            --m_pending;
+            return true;
+        }
+    }
+
+    // Перехват с начала чужих очередей, начиная с соседа, чтобы потоки не толпились у одной
+    int32_t workers_count = m_workers.size();
+    for (int32_t i = 1; i <= workers_count; ++i) {
+        int32_t victim = (index + i + workers_count) % workers_count;
+        if (victim == index)
+            continue;
+
+        auto &worker = *m_workers[victim];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.jobs.empty()) {
+            job = std::move(worker.jobs.front());
+            worker.jobs.pop_front();
+            --m_pending;
+
+            if (index >= 0)
+                ++m_workers[index]->steals;
+            else
+                ++m_external_steals;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::runJob(Job &job)
+{
+    job.func();
+
+    if (m_thread_system == this)
+        m_workers[m_thread_index]->jobs_run.fetch_add(1, std::memory_order_relaxed);
+    else
+        m_external_jobs_run.fetch_add(1, std::memory_order_relaxed);
+
+    finishJob(job.counter);
+}
+
+void JobSystem::finishJob(JobCounter *counter)
+{
+    if (!counter)
+        return;
+
+    // После finish счетчик может быть уже удален ожидающим потоком
+    std::vector<Job> continuations;
+    if (!counter->finish(continuations))
+        return;
+
+    for (auto &job : continuations)
+        schedule(std::move(job));
+
+    wakeWaiting(true);
+}
+
+void JobSystem::wakeWaiting(bool all)
+{
+    if (m_sleeping.load() == 0)
+        return;
+
+    // Блокировка гарантирует, что поток, проверивший условие, уже ждет
+    { std::lock_guard<std::mutex> lock(m_mutex); }
+
+    if (all)
+        m_cv.notify_all();
+    else
+        m_cv.notify_one();
+}
+
+void JobSystem::workerLoop(int32_t index)
+{
+    m_thread_system = this;
+    m_thread_index = index;
+
+    auto &worker = *m_workers[index];
+
+    while (true) {
+        if (tryRunJob())
+            continue;
+
+        Clock clock;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_stop && m_pending.load() == 0)
+                return;
+
+            ++m_sleeping;
+            m_cv.wait(lock, [this]() { return m_stop || m_pending.load() > 0; });
+            --m_sleeping;
+        }
+        worker.idle_time_us += clock.getElapsedTime().asMicroseconds();
+    }
+}
+
+} // namespace ae
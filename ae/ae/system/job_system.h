@@ -0,0 +1,157 @@
+#ifndef AE_JOB_SYSTEM_H
+#define AE_JOB_SYSTEM_H
+
+#include "memory.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ae {
+
+class JobCounter;
+
+struct Job
+{
+    std::function<void()> func;
+    JobCounter *counter = nullptr;
+    // Выполняется только в главном потоке, например работа с GL
+    bool main_thread = false;
+};
+
+// Счетчик незавершенных задач. Задача, запущенная с зависимостью от счетчика,
+// ставится в очередь, когда он обнулится. Счетчик должен жить, пока его ждут
+class JobCounter
+{
+    friend class JobSystem;
+
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter &) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+    ~JobCounter() = default;
+
+    bool isDone() const;
+
+private:
+    void add();
+    // Возвращает true, если задача отложена до обнуления счетчика
+    bool defer(Job &job);
+    // Возвращает true и отложенные задачи, если счетчик обнулился
+    bool finish(std::vector<Job> &continuations);
+
+private:
+    // Обнуление и чтение под одной блокировкой: ожидающий поток может удалить
+    // счетчик сразу после isDone
+    mutable std::mutex m_mutex;
+    int32_t m_value = 0;
+    std::vector<Job> m_continuations;
+};
+
+// Система задач с перехватом работы. У каждого рабочего потока своя очередь: владелец
+// берет задачи с конца, остальные перехватывают с начала. Задачи из других потоков
+// попадают в общую очередь. Ожидающий поток не блокируется, а выполняет чужие задачи,
+// поэтому вложенный parallelFor не создает лишних потоков и не взаимоблокируется
+class JobSystem
+{
+public:
+    struct Stats
+    {
+        uint64_t jobs_run = 0;
+        uint64_t steals = 0;
+        // Суммарно по потокам, без ожидания главного потока
+        int64_t idle_time_us = 0;
+    };
+
+    // threads_count <= 0 - все ядра, кроме одного. Создавший поток считается главным
+    explicit JobSystem(int32_t threads_count = 0);
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+    ~JobSystem();
+
+    int32_t getThreadsCount() const;
+    bool isMainThread() const;
+
+    void run(std::function<void()> func,
+             JobCounter *counter = nullptr,
+             JobCounter *dependency = nullptr);
+    // Выполняется в executeMainThreadJobs или пока главный поток ждет в wait
+    void runOnMainThread(std::function<void()> func,
+                         JobCounter *counter = nullptr,
+                         JobCounter *dependency = nullptr);
+    void executeMainThreadJobs();
+
+    // Выполняет задачи, пока счетчик не обнулится
+    void wait(const JobCounter &counter);
+
+    // Вызывает func(i) для всех i из [0, count) и возвращается после завершения.
+    // Итерации раздаются блоками по grain_size, для коротких итераций блок стоит
+    // увеличить. Можно вызывать из любых потоков, в том числе из задач
+    void parallelFor(int32_t count, const std::function<void(int32_t)> &func);
+    void parallelFor(int32_t count,
+                     int32_t grain_size,
+                     const std::function<void(int32_t)> &func);
+
+    Stats getStats() const;
+    void resetStats();
+
+    // Система, которой владеет EngineContext. Без движка создается при первом обращении
+    static JobSystem &getDefault();
+
+private:
+    struct Worker
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+
+        std::atomic<uint64_t> jobs_run{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<int64_t> idle_time_us{0};
+    };
+
+    void schedule(Job &&job);
+    bool tryRunJob();
+    bool popJob(Job &job);
+    void runJob(Job &job);
+    void finishJob(JobCounter *counter);
+    void wakeWaiting(bool all);
+    void workerLoop(int32_t index);
+
+private:
+    static JobSystem *m_default;
+    // Индекс рабочего потока этой системы, -1 для остальных потоков
+    static thread_local const JobSystem *m_thread_system;
+    static thread_local int32_t m_thread_index;
+
+    std::thread::id m_main_thread_id;
+
+    std::vector<u_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_global_mutex;
+    std::deque<Job> m_global_jobs;
+
+    std::mutex m_main_mutex;
+    std::deque<Job> m_main_jobs;
+
+    // Задачи, доступные рабочим потокам, и задачи главного потока
+    std::atomic<int32_t> m_pending;
+    std::atomic<int32_t> m_main_pending;
+    std::atomic<int32_t> m_sleeping;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop;
+
+    // Задачи, выполненные не рабочими потоками
+    std::atomic<uint64_t> m_external_jobs_run;
+    std::atomic<uint64_t> m_external_steals;
+};
+
+} // namespace ae
+
+#endif // AE_JOB_SYSTEM_H
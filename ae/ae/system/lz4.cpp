@@ -0,0 +1,216 @@
+#include "lz4.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace ae::lz4 {
+
+namespace {
+
+constexpr int32_t MIN_MATCH = 4;
+constexpr int32_t LAST_LITERALS = 5;     // Последние байты блока всегда литералы
+constexpr int32_t MATCH_FIND_LIMIT = 12; // Совпадение начинается не ближе к концу блока
+constexpr int32_t MAX_OFFSET = 65535;
+constexpr int32_t HASH_BITS = 12;
+constexpr int32_t SKIP_TRIGGER = 6; // Ускорение поиска на несжимаемых данных
+
+uint32_t read32(const uint8_t *data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint32_t hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+bool writeLength(uint8_t *&output, const uint8_t *output_end, int32_t length)
+{
+    while (length >= 255) {
+        if (output >= output_end)
+            return false;
+        *output++ = 255;
+        length -= 255;
+    }
+
+    if (output >= output_end)
+        return false;
+    *output++ = static_cast<uint8_t>(length);
+    return true;
+}
+
+// match_length == 0 - последняя последовательность, только литералы
+bool writeSequence(uint8_t *&output,
+                   const uint8_t *output_end,
+                   const uint8_t *literals,
+                   int32_t literal_count,
+                   int32_t offset,
+                   int32_t match_length)
+{
+    if (output >= output_end)
+        return false;
+
+    uint8_t *token = output++;
+    *token = static_cast<uint8_t>(std::min(literal_count, 15) << 4);
+
+    if (literal_count >= 15 && !writeLength(output, output_end, literal_count - 15))
+        return false;
+
+    if (output_end - output < literal_count)
+        return false;
+    std::memcpy(output, literals, literal_count);
+    output += literal_count;
+
+    if (match_length == 0)
+        return true;
+
+    if (output_end - output < 2)
+        return false;
+    *output++ = static_cast<uint8_t>(offset & 0xFF);
+    *output++ = static_cast<uint8_t>(offset >> 8);
+
+    int32_t length = match_length - MIN_MATCH;
+    *token |= static_cast<uint8_t>(std::min(length, 15));
+
+    return length < 15 || writeLength(output, output_end, length - 15);
+}
+
+bool readLength(const uint8_t *&input, const uint8_t *input_end, size_t &length)
+{
+    uint8_t value;
+    do {
+        if (input >= input_end || length > INT32_MAX)
+            return false;
+        value = *input++;
+        length += value;
+    } while (value == 255);
+
+    return true;
+}
+
+} // namespace
+
+int32_t getCompressBound(int32_t size)
+{
+    return size + size / 255 + 16;
+}
+
+int32_t compress(const uint8_t *source, int32_t size, uint8_t *destination, int32_t capacity)
+{
+    if (size < 0 || (size > 0 && !source) || !destination)
+        return 0;
+
+    const uint8_t *input = source;
+    const uint8_t *input_end = source + size;
+    const uint8_t *anchor = source;
+    uint8_t *output = destination;
+    const uint8_t *output_end = destination + capacity;
+
+    if (size > MATCH_FIND_LIMIT) {
+        std::array<int32_t, 1 << HASH_BITS> table;
+        table.fill(-1);
+
+        const uint8_t *match_find_end = input_end - MATCH_FIND_LIMIT;
+        const uint8_t *match_end = input_end - LAST_LITERALS;
+        int32_t attempts = 1 << SKIP_TRIGGER;
+
+        while (input <= match_find_end) {
+            uint32_t sequence = read32(input);
+            uint32_t h = hash(sequence);
+            int32_t position = static_cast<int32_t>(input - source);
+            int32_t reference = table[h];
+            table[h] = position;
+
+            if (reference < 0 || position - reference > MAX_OFFSET
+                || read32(source + reference) != sequence) {
+                input += attempts++ >> SKIP_TRIGGER;
+                continue;
+            }
+
+            const uint8_t *match = source + reference;
+            int32_t length = MIN_MATCH;
+            while (input + length < match_end && match[length] == input[length])
+                ++length;
+
+            if (!writeSequence(output,
+                               output_end,
+                               anchor,
+                               static_cast<int32_t>(input - anchor),
+                               position - reference,
+                               length))
+                return 0;
+
+            input += length;
+            anchor = input;
+            attempts = 1 << SKIP_TRIGGER;
+        }
+    }
+
+    if (!writeSequence(output, output_end, anchor, static_cast<int32_t>(input_end - anchor), 0, 0))
+        return 0;
+
+    return static_cast<int32_t>(output - destination);
+}
+
+int32_t decompress(const uint8_t *source, int32_t size, uint8_t *destination, int32_t capacity)
+{
+    if (!source || size <= 0 || (capacity > 0 && !destination))
+        return -1;
+
+    const uint8_t *input = source;
+    const uint8_t *input_end = source + size;
+    uint8_t *output = destination;
+    uint8_t *output_end = destination + capacity;
+
+    while (input < input_end) {
+        uint32_t token = *input++;
+
+        size_t literal_count = token >> 4;
+        if (literal_count == 15 && !readLength(input, input_end, literal_count))
+            return -1;
+
+        if (literal_count > static_cast<size_t>(input_end - input)
+            || literal_count > static_cast<size_t>(output_end - output))
+            return -1;
+
+        std::memcpy(output, input, literal_count);
+        input += literal_count;
+        output += literal_count;
+
+        if (input == input_end)
+            break;
+
+        if (input_end - input < 2)
+            return -1;
+        size_t offset = input[0] | (input[1] << 8);
+        input += 2;
+
+        if (offset == 0 || offset > static_cast<size_t>(output - destination))
+            return -1;
+
+        size_t match_length = token & 15;
+        if (match_length == 15 && !readLength(input, input_end, match_length))
+            return -1;
+        match_length += MIN_MATCH;
+
+        if (match_length > static_cast<size_t>(output_end - output))
+            return -1;
+
+        // Совпадение может перекрывать записываемые данные
+        const uint8_t *match = output - offset;
+        if (offset >= match_length) {
+            std::memcpy(output, match, match_length);
+        } else {
+            for (size_t i = 0; i < match_length; ++i)
+                output[i] = match[i];
+        }
+        output += match_length;
+    }
+
+    return static_cast<int32_t>(output - destination);
+}
+
+} // namespace ae::lz4
@@ -0,0 +1,24 @@
+#ifndef AE_LZ4_H
+#define AE_LZ4_H
+
+#include <cstdint>
+
+namespace ae::lz4 {
+
+// Сжатие в блочном формате LZ4: последовательности из токена, литералов, смещения
+// и длины совпадения. Совместимо с LZ4_decompress_safe, но компрессор проще
+// оригинального (одна хеш-таблица, жадный поиск)
+
+// Максимальный размер сжатых данных для size байт
+int32_t getCompressBound(int32_t size);
+
+// Возвращает размер сжатых данных или 0, если результат не помещается в capacity
+int32_t compress(const uint8_t *source, int32_t size, uint8_t *destination, int32_t capacity);
+
+// Возвращает размер распакованных данных или -1 при повреждении данных
+// или нехватке места в destination
+int32_t decompress(const uint8_t *source, int32_t size, uint8_t *destination, int32_t capacity);
+
+} // namespace ae::lz4
+
+#endif // AE_LZ4_H
@@ -0,0 +1,77 @@
+#include "mapped_file.h"
+#include "log.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ae {
+
+MappedFile::MappedFile()
+    : m_data{nullptr}
+    , m_size{0}
+{}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::filesystem::path &path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        l_error("Failed to open file: {}", path.string());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        l_error("Failed to map empty file: {}", path.string());
+        ::close(fd);
+        return false;
+    }
+
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Отображение остается действительным после закрытия дескриптора
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        l_error("Failed to map file: {}", path.string());
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t *>(data);
+    m_size = static_cast<size_t>(st.st_size);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data) {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+bool MappedFile::isOpen() const
+{
+    return m_data != nullptr;
+}
+
+const uint8_t *MappedFile::getData() const
+{
+    return m_data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return m_size;
+}
+
+} // namespace ae
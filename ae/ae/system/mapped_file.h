@@ -0,0 +1,45 @@
+#ifndef AE_MAPPED_FILE_H
+#define AE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace ae {
+
+// Файл, отображенный в память только для чтения
+class MappedFile
+{
+public:
+    MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    bool open(const std::filesystem::path &path);
+    void close();
+    bool isOpen() const;
+
+    const uint8_t *getData() const;
+    size_t getSize() const;
+
+    // Массив из count элементов T по смещению offset от начала файла.
+    // Если диапазон выходит за пределы файла, возвращается пустой span
+    template<typename T>
+    std::span<const T> getSpan(uint64_t offset, uint64_t count) const
+    {
+        if (!m_data || offset > m_size || count > (m_size - offset) / sizeof(T)
+            || offset % alignof(T) != 0)
+            return {};
+        return {reinterpret_cast<const T *>(m_data + offset), static_cast<size_t>(count)};
+    }
+
+private:
+    const uint8_t *m_data;
+    size_t m_size;
+};
+
+} // namespace ae
+
+#endif // AE_MAPPED_FILE_H
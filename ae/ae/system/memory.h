@@ -2,6 +2,12 @@
 #define AE_MEMORY_H
 
 #include <atomic>
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "pool_allocator.h"
 
 namespace ae {
 
@@ -29,34 +35,108 @@ struct ControlBlockBase
 
     virtual void destroyValue() noexcept = 0;
     virtual void *getValue() const noexcept = 0;
+    virtual void destroyBlock() noexcept { delete this; }
 
-    void addShared() noexcept { shared_count.fetch_add(1, std::memory_order_acq_rel); }
+    void addShared() noexcept
+    {
+        if (single_thread)
+            increment(shared_count);
+        else
+            shared_count.fetch_add(1, std::memory_order_acq_rel);
+    }
     void releaseShared() noexcept
     {
-        if (shared_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        size_t count = single_thread ? decrement(shared_count)
+                                     : shared_count.fetch_sub(1, std::memory_order_acq_rel);
+        if (count == 1) {
             destroyValue();
             releaseWeak();
         }
     }
-    void addWeak() noexcept { weak_count.fetch_add(1, std::memory_order_acq_rel); }
+    void addWeak() noexcept
+    {
+        if (single_thread)
+            increment(weak_count);
+        else
+            weak_count.fetch_add(1, std::memory_order_acq_rel);
+    }
     bool releaseWeak() noexcept
     {
+        size_t count = single_thread ? decrement(weak_count)
+                                     : weak_count.fetch_sub(1, std::memory_order_acq_rel);
+
         // Если блок был улален возвращаем true
-        if (weak_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
-            delete this;
+        if (count == 1) {
+            destroyBlock();
             return true;
         }
 
         return false;
     }
 
+    // Увеличивает счетчик, если объект еще жив, и возвращает блок, счетчик которого
+    // увеличен. Для WeakPtr::lock
+    virtual ControlBlockBase *lockShared() noexcept
+    {
+        if (single_thread) {
+            if (shared_count.load(std::memory_order_relaxed) == 0)
+                return nullptr;
+            increment(shared_count);
+            return this;
+        }
+
+        size_t count = shared_count.load(std::memory_order_acquire);
+        while (count != 0) {
+            if (shared_count.compare_exchange_weak(count,
+                                                   count + 1,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed))
+                return this;
+        }
+        return nullptr;
+    }
+
+    // Блок, на который ссылается WeakPtr. У RefCounted он отдельный
+    virtual ControlBlockBase *getWeakBlock() noexcept { return this; }
+
+    // Однопоточный режим: relaxed load/store без lock-префикса, возвращает прежнее значение
+    size_t increment(std::atomic<size_t> &count) noexcept
+    {
+        checkThread();
+        size_t value = count.load(std::memory_order_relaxed);
+        count.store(value + 1, std::memory_order_relaxed);
+        return value;
+    }
+    size_t decrement(std::atomic<size_t> &count) noexcept
+    {
+        checkThread();
+        size_t value = count.load(std::memory_order_relaxed);
+        count.store(value - 1, std::memory_order_relaxed);
+        return value;
+    }
+
+    void checkThread() const noexcept
+    {
+        // Однопоточные счетчики меняет только поток, создавший блок
+        assert(owner_thread == std::this_thread::get_id()
+               && "SharedPtr with single-thread ref count is used from another thread");
+    }
+
     std::atomic<size_t> shared_count{0};
     std::atomic<size_t> weak_count{1};
+
+    // Задается при создании блока по типу объекта, см. AE_SINGLE_THREAD_REF_COUNT
+    bool single_thread = false;
+#ifndef NDEBUG
+    std::thread::id owner_thread = std::this_thread::get_id();
+#endif
 };
 
 template<typename T, typename Deleter = DefaultDeleter<T>>
 struct ControlBlockRawPtr : public ControlBlockBase
 {
+    AE_POOL_ALLOCATED
+
     ControlBlockRawPtr(T *n_value) noexcept
         : value(n_value)
     {}
@@ -81,7 +161,7 @@ struct ControlBlockInplace : public ControlBlockBase
     ControlBlockInplace(Args &&...args) noexcept
         : constructed{false}
     {
-        new (storage) T(std::forward<Args>(args)...);
+        ::new (storage) T(std::forward<Args>(args)...);
         constructed = true;
     }
 
@@ -101,6 +181,88 @@ struct ControlBlockInplace : public ControlBlockBase
     bool constructed;
 };
 
+// Блок и объект в одной аллокации, освобождается тем же аллокатором
+template<typename T, typename Alloc, typename Deleter = InplaceDeleter<T>>
+struct ControlBlockAllocated : public ControlBlockInplace<T, Deleter>
+{
+    using BlockAllocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<ControlBlockAllocated>;
+
+    template<typename... Args>
+    ControlBlockAllocated(const Alloc &n_allocator, Args &&...args) noexcept
+        : ControlBlockInplace<T, Deleter>(std::forward<Args>(args)...)
+        , allocator{n_allocator}
+    {}
+
+    void destroyBlock() noexcept override
+    {
+        BlockAllocator block_allocator{allocator};
+        this->~ControlBlockAllocated();
+        block_allocator.deallocate(this, 1);
+    }
+
+    Alloc allocator;
+};
+
+template<typename T, typename Alloc>
+struct AllocatorDeleter
+{
+    void operator()(T *ptr) noexcept
+    {
+        typename std::allocator_traits<Alloc>::template rebind_alloc<T> value_allocator{allocator};
+        ptr->~T();
+        value_allocator.deallocate(ptr, 1);
+    }
+
+    Alloc allocator;
+};
+
+// Блок для WeakPtr на RefCounted. Объект удаляется вместе со своими счетчиками, этот блок
+// живет, пока на него ссылаются WeakPtr. Мьютекс не дает lock увеличить счетчик объекта,
+// который уже удаляется
+struct IntrusiveWeakBlock : public ControlBlockBase
+{
+    AE_POOL_ALLOCATED
+
+    explicit IntrusiveWeakBlock(ControlBlockBase *n_object) noexcept
+        : object{n_object}
+    {
+        single_thread = n_object->single_thread;
+    }
+
+    void destroyValue() noexcept override {}
+    void *getValue() const noexcept override { return nullptr; }
+
+    ControlBlockBase *lockShared() noexcept override
+    {
+        std::lock_guard lock{mutex};
+        return object ? object->lockShared() : nullptr;
+    }
+
+    // Вызывается объектом, когда его счетчик обнулился
+    void detach() noexcept
+    {
+        {
+            std::lock_guard lock{mutex};
+            object = nullptr;
+        }
+        releaseWeak();
+    }
+
+    std::mutex mutex;
+    ControlBlockBase *object;
+};
+
+// Типы, объявившие AE_POOL_ALLOCATED
+template<typename T>
+inline constexpr bool isPoolAllocatedV = requires { typename T::PoolAllocatedTag; };
+
+// Типы, объявившие AE_SINGLE_THREAD_REF_COUNT
+template<typename T>
+inline constexpr bool isSingleThreadRefCountV = requires {
+    typename T::SingleThreadRefCountTag;
+};
+
 template<typename T>
 struct isAnyEnableSharedFromThisBase
 {
@@ -123,6 +285,65 @@ struct EnableSharedFromThisBase
     virtual void internalAcceptOwnerBase(detail::ControlBlockBase *, void *) noexcept = 0;
 };
 
+// Интрузивный счетчик: счетчики лежат в самом объекте, объект сам служит блоком SharedPtr.
+// createShared выделяет только объект, SharedPtr из сырого указателя на уже принадлежащий
+// SharedPtr объект (например, из this) продолжает тот же счет. Блок для WeakPtr создается
+// при первом обращении. Счетчики атомарные, если тип не объявил AE_SINGLE_THREAD_REF_COUNT
+class RefCounted : private detail::ControlBlockBase
+{
+    template<typename U>
+    friend class SharedPtr;
+
+public:
+    int32_t getRefCount() const noexcept
+    {
+        return shared_count.load(std::memory_order_acquire);
+    }
+
+protected:
+    RefCounted() noexcept = default;
+    RefCounted(const RefCounted &) noexcept {}
+    ~RefCounted() override = default;
+
+    RefCounted &operator=(const RefCounted &) noexcept { return *this; }
+
+private:
+    static detail::ControlBlockBase *getBlock(const RefCounted *object) noexcept
+    {
+        return const_cast<RefCounted *>(object);
+    }
+
+    // Объект удаляется в destroyBlock, когда releaseShared снимет ссылку счетчиков на себя
+    void destroyValue() noexcept override
+    {
+        if (auto *weak_block = m_weak_block.load(std::memory_order_acquire))
+            weak_block->detach();
+    }
+
+    void *getValue() const noexcept override
+    {
+        return dynamic_cast<void *>(const_cast<RefCounted *>(this));
+    }
+
+    ControlBlockBase *getWeakBlock() noexcept override
+    {
+        auto *weak_block = m_weak_block.load(std::memory_order_acquire);
+        if (!weak_block) {
+            auto *created = new detail::IntrusiveWeakBlock{this};
+            if (m_weak_block.compare_exchange_strong(weak_block,
+                                                     created,
+                                                     std::memory_order_acq_rel))
+                weak_block = created;
+            else
+                delete created;
+        }
+        return weak_block;
+    }
+
+private:
+    std::atomic<detail::IntrusiveWeakBlock *> m_weak_block{nullptr};
+};
+
 template<typename T>
 class SharedPtr
 {
@@ -164,19 +385,34 @@ public:
         : m_control_block{nullptr}
         , m_raw{nullptr}
     {
-        if (value) {
-            m_control_block = new detail::ControlBlockRawPtr<U, std::decay_t<Deleter>>(value);
+        if (!value)
+            return;
+
+        if constexpr (std::is_base_of_v<RefCounted, U>) {
+            static_assert(std::is_same_v<Deleter, detail::DefaultDeleter<U>>,
+                          "RefCounted objects are deleted by their own ref count");
+
+            auto *block = RefCounted::getBlock(value);
+            bool owned = block->shared_count.load(std::memory_order_relaxed) > 0;
+            if (!owned)
+                initBlock(block, value);
+
+            m_control_block = block;
             m_control_block->addShared();
             m_raw = value;
 
-            // Найти базовый EnableSharedFromThis<B> и вызвать accept
-            using RawT = std::remove_cv_t<std::remove_reference_t<U>>;
-            if constexpr (detail::isAnyEnableSharedFromThisBaseV<RawT>) {
-                auto *base = static_cast<EnableSharedFromThisBase *>(m_raw);
-                if (base)
-                    base->internalAcceptOwnerBase(m_control_block, m_raw);
-            }
+            if (!owned)
+                acceptOwner(m_control_block, value);
+            return;
         }
+
+        auto *block = new detail::ControlBlockRawPtr<U, std::decay_t<Deleter>>(value);
+        initBlock(block, value);
+        m_control_block = block;
+        m_control_block->addShared();
+        m_raw = value;
+
+        acceptOwner(m_control_block, value);
     }
 
     SharedPtr(const SharedPtr &other) noexcept
@@ -220,6 +456,12 @@ public:
 
     SharedPtr &operator=(const SharedPtr &other) noexcept
     {
+        // Тот же блок: счетчик не меняется
+        if (m_control_block == other.m_control_block) {
+            m_raw = other.m_raw;
+            return *this;
+        }
+
         release();
         if (other.m_control_block) {
             m_control_block = other.m_control_block;
@@ -232,6 +474,12 @@ public:
     template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
     SharedPtr &operator=(const SharedPtr<U> &other) noexcept
     {
+        // Тот же блок: счетчик не меняется
+        if (m_control_block == other.m_control_block) {
+            m_raw = other.m_raw;
+            return *this;
+        }
+
         release();
         if (other.m_control_block) {
             m_control_block = other.m_control_block;
@@ -284,22 +532,63 @@ public:
     template<typename Deleter = detail::InplaceDeleter<T>, typename... Args>
     static SharedPtr create(Args &&...args)
     {
-        using Block = detail::ControlBlockInplace<T, std::decay_t<Deleter>>;
-        auto *block = new Block{std::forward<Args>(args)...};
-        SharedPtr<T> ptr{block, reinterpret_cast<T *>(block->getValue()), true};
+        // RefCounted сам себе блок. Для типов с AE_POOL_ALLOCATED блок вместе с объектом
+        // тоже берется из пула
+        if constexpr (std::is_base_of_v<RefCounted, T>) {
+            static_assert(std::is_same_v<Deleter, detail::InplaceDeleter<T>>,
+                          "RefCounted objects are deleted by their own ref count");
+            return SharedPtr{new T(std::forward<Args>(args)...)};
+        } else if constexpr (detail::isPoolAllocatedV<T>) {
+            return createAllocated<PoolAllocator<T>, Deleter>(PoolAllocator<T>{},
+                                                              std::forward<Args>(args)...);
+        } else {
+            using Block = detail::ControlBlockInplace<T, std::decay_t<Deleter>>;
+            return fromBlock(new Block{std::forward<Args>(args)...});
+        }
+    }
+
+    template<typename Alloc, typename Deleter = detail::InplaceDeleter<T>, typename... Args>
+    static SharedPtr createAllocated(const Alloc &allocator, Args &&...args)
+    {
+        static_assert(!std::is_base_of_v<RefCounted, T>,
+                      "RefCounted objects are allocated with their own operator new");
+
+        using Block = detail::ControlBlockAllocated<T, Alloc, std::decay_t<Deleter>>;
+        typename Block::BlockAllocator block_allocator{allocator};
+        Block *block = block_allocator.allocate(1);
+        ::new (block) Block{allocator, std::forward<Args>(args)...};
+        return fromBlock(block);
+    }
+
+private:
+    static SharedPtr fromBlock(detail::ControlBlockBase *block)
+    {
+        auto *raw = reinterpret_cast<T *>(block->getValue());
+        initBlock(block, raw);
+
+        SharedPtr<T> ptr{block, raw, true};
+        acceptOwner(ptr.m_control_block, ptr.m_raw);
+        return ptr;
+    }
+
+    // Настройка нового блока по типу объекта, до первого addShared
+    template<typename U>
+    static void initBlock(detail::ControlBlockBase *block, U *) noexcept
+    {
+        block->single_thread = detail::isSingleThreadRefCountV<std::remove_cv_t<U>>;
+    }
 
+    template<typename U>
+    static void acceptOwner(detail::ControlBlockBase *block, U *raw) noexcept
+    {
         // Найти базовый EnableSharedFromThis<B> и вызвать accept
-        using RawT = std::remove_cv_t<std::remove_reference_t<T>>;
+        using RawT = std::remove_cv_t<U>;
         if constexpr (detail::isAnyEnableSharedFromThisBaseV<RawT>) {
-            auto *base = static_cast<EnableSharedFromThisBase *>(ptr.m_raw);
-            if (base)
-                base->internalAcceptOwnerBase(ptr.m_control_block, ptr.m_raw);
+            auto *base = static_cast<EnableSharedFromThisBase *>(const_cast<RawT *>(raw));
+            base->internalAcceptOwnerBase(block, const_cast<RawT *>(raw));
         }
-
-        return ptr;
     }
 
-private:
     SharedPtr(detail::ControlBlockBase *control_block, T *raw, bool add_ref = true)
         : m_control_block{nullptr}
         , m_raw{nullptr}
@@ -371,14 +660,17 @@ class WeakPtr
 public:
     WeakPtr() noexcept
         : m_control_block{nullptr}
+        , m_raw{nullptr}
     {}
 
     WeakPtr(std::nullptr_t) noexcept
         : m_control_block{nullptr}
+        , m_raw{nullptr}
     {}
 
     WeakPtr(const WeakPtr &other) noexcept
         : m_control_block{other.m_control_block}
+        , m_raw{other.m_raw}
     {
         if (m_control_block)
             m_control_block->addWeak();
@@ -386,10 +678,10 @@ public:
 
     template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
     WeakPtr(const SharedPtr<U> &other) noexcept
-        : m_control_block{other.m_control_block}
+        : m_control_block{nullptr}
+        , m_raw{nullptr}
     {
-        if (other.m_control_block)
-            m_control_block->addWeak();
+        assign(other);
     }
 
     ~WeakPtr() noexcept { release(); }
@@ -402,8 +694,12 @@ public:
 
     WeakPtr &operator=(const WeakPtr &ptr) noexcept
     {
+        if (this == &ptr)
+            return *this;
+
         release();
         m_control_block = ptr.m_control_block;
+        m_raw = ptr.m_raw;
         if (ptr.m_control_block)
             m_control_block->addWeak();
         return *this;
@@ -413,9 +709,7 @@ public:
     WeakPtr &operator=(const SharedPtr<U> &ptr) noexcept
     {
         release();
-        m_control_block = ptr.m_control_block;
-        if (ptr.m_control_block)
-            m_control_block->addWeak();
+        assign(ptr);
         return *this;
     }
 
@@ -426,34 +720,40 @@ public:
         if (!m_control_block)
             return SharedPtr<T>{};
 
-        size_t count = m_control_block->shared_count.load(std::memory_order_acquire);
-        while (count != 0) {
-            if (m_control_block->shared_count.compare_exchange_weak(count,
-                                                                    count + 1,
-                                                                    std::memory_order_acq_rel,
-                                                                    std::memory_order_relaxed)) {
-                return SharedPtr<T>{m_control_block,
-                                    reinterpret_cast<T *>(m_control_block->getValue()),
-                                    false};
-            }
-        }
+        // У RefCounted блок WeakPtr отдельный, SharedPtr получает блок самого объекта
+        auto *shared_block = m_control_block->lockShared();
+        if (!shared_block)
+            return SharedPtr<T>{};
 
-        return SharedPtr<T>{};
+        return SharedPtr<T>{shared_block, m_raw, false};
     }
 
     void reset() noexcept { release(); }
 
 private:
+    template<typename U>
+    void assign(const SharedPtr<U> &ptr) noexcept
+    {
+        if (ptr.m_control_block) {
+            m_control_block = ptr.m_control_block->getWeakBlock();
+            m_control_block->addWeak();
+            m_raw = ptr.m_raw;
+        }
+    }
+
     void release() noexcept
     {
         if (m_control_block) {
             m_control_block->releaseWeak();
             m_control_block = nullptr;
         }
+        m_raw = nullptr;
     }
 
 private:
     detail::ControlBlockBase *m_control_block;
+    // Указатель с поправкой на базовый класс, действителен, пока lock находит объект
+    T *m_raw;
 };
 
 template<typename T>
@@ -522,7 +822,7 @@ public:
 
     UniquePtr(UniquePtr &&other) noexcept
         : m_value(other.release())
-        , m_deleter(Deleter{})
+        , m_deleter(std::move(other.m_deleter))
     {}
 
     template<typename U, typename = std::enable_if_t<std::is_convertible_v<U *, T *>>>
@@ -540,7 +840,7 @@ public:
         if (this != &other) {
             reset();
             m_value = other.release();
-            m_deleter = Deleter{};
+            m_deleter = std::move(other.m_deleter);
         }
         return *this;
     }
@@ -624,6 +924,28 @@ inline UniquePtr<T, Deleter> createUnique(Args &&...args)
     return UniquePtr<T, Deleter>{new T(std::forward<Args>(args)...)};
 }
 
+// То же, что createShared, но блок с объектом выделяется переданным аллокатором
+template<typename T,
+         typename Alloc,
+         typename Deleter = detail::InplaceDeleter<T>,
+         typename... Args>
+inline SharedPtr<T> allocateShared(const Alloc &allocator, Args &&...args)
+{
+    return SharedPtr<T>::template createAllocated<Alloc, Deleter>(allocator,
+                                                                  std::forward<Args>(args)...);
+}
+
+template<typename T, typename Alloc, typename... Args>
+inline auto allocateUnique(const Alloc &allocator, Args &&...args)
+{
+    using Deleter = detail::AllocatorDeleter<T, Alloc>;
+
+    typename std::allocator_traits<Alloc>::template rebind_alloc<T> value_allocator{allocator};
+    T *value = value_allocator.allocate(1);
+    ::new (value) T(std::forward<Args>(args)...);
+    return UniquePtr<T, Deleter>{value, Deleter{allocator}};
+}
+
 template<typename T>
 using s_ptr = SharedPtr<T>;
 
@@ -635,4 +957,9 @@ using u_ptr = UniquePtr<T, Deleter>;
 
 } // namespace ae
 
+// Объявляется в теле класса: счетчики SharedPtr и WeakPtr объектов этого типа и наследников
+// меняются без атомарных операций. Только для объектов, которые не покидают создавший их
+// поток, в отладочной сборке обращение к счетчикам из другого потока ловится assert'ом
+#define AE_SINGLE_THREAD_REF_COUNT using SingleThreadRefCountTag = void;
+
 #endif // AE_MEMORY_H
@@ -0,0 +1,288 @@
+#include "pack_file.h"
+#include "log.h"
+#include "lz4.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace ae {
+
+using namespace pack;
+
+PackFile::PackFile()
+    : m_header{nullptr}
+{}
+
+bool PackFile::open(const std::filesystem::path &path)
+{
+    m_path = path;
+    m_header = nullptr;
+
+    if (!m_file.open(path))
+        return false;
+
+    auto headers = m_file.getSpan<Header>(0, 1);
+    if (headers.empty() || std::memcmp(headers[0].magic, MAGIC, sizeof(MAGIC)) != 0) {
+        l_error("Not a pack file: {}", path.string());
+        m_file.close();
+        return false;
+    }
+
+    const Header *header = headers.data();
+    if (header->version != VERSION || header->chunk_size == 0) {
+        l_error("Unsupported pack version {}: {}", header->version, path.string());
+        m_file.close();
+        return false;
+    }
+
+    m_chunks = m_file.getSpan<ChunkRecord>(header->chunks_offset, header->chunk_count);
+    m_entries = m_file.getSpan<EntryRecord>(header->entries_offset, header->entry_count);
+    m_names = m_file.getSpan<char>(header->names_offset, header->names_size);
+
+    bool valid = m_chunks.size() == header->chunk_count
+                 && m_entries.size() == header->entry_count
+                 && m_names.size() == header->names_size;
+
+    // Все чанки, кроме последнего, полного размера: номер чанка = смещение / chunk_size
+    uint64_t stream_size = 0;
+    for (uint32_t i = 0; valid && i < m_chunks.size(); ++i) {
+        const auto &chunk = m_chunks[i];
+        valid = chunk.size <= header->chunk_size
+                && (chunk.size == header->chunk_size || i + 1 == m_chunks.size())
+                && chunk.compressed_size <= lz4::getCompressBound(chunk.size)
+                && !m_file.getSpan<uint8_t>(chunk.offset, chunk.compressed_size).empty();
+        stream_size += chunk.size;
+    }
+
+    for (const auto &entry : m_entries) {
+        if (!valid)
+            break;
+        valid = entry.offset <= stream_size && entry.size <= stream_size - entry.offset
+                && entry.name <= m_names.size() && entry.name_size <= m_names.size() - entry.name;
+    }
+
+    // find ищет двоичным поиском: имена должны быть строго по возрастанию
+    for (uint32_t i = 1; valid && i < m_entries.size(); ++i)
+        valid = getName(m_entries[i - 1]) < getName(m_entries[i]);
+
+    if (!valid) {
+        l_error("Corrupted pack file: {}", path.string());
+        m_file.close();
+        return false;
+    }
+
+    m_header = header;
+
+    return true;
+}
+
+bool PackFile::isOpen() const
+{
+    return m_header != nullptr;
+}
+
+const std::filesystem::path &PackFile::getPath() const
+{
+    return m_path;
+}
+
+const EntryRecord *PackFile::find(std::string_view name) const
+{
+    auto found = std::lower_bound(m_entries.begin(),
+                                  m_entries.end(),
+                                  name,
+                                  [this](const EntryRecord &entry, std::string_view value) {
+                                      return getName(entry) < value;
+                                  });
+
+    if (found == m_entries.end() || getName(*found) != name)
+        return nullptr;
+
+    return &*found;
+}
+
+std::string_view PackFile::getName(const EntryRecord &entry) const
+{
+    return {m_names.data() + entry.name, entry.name_size};
+}
+
+std::span<const EntryRecord> PackFile::getEntries() const
+{
+    return m_entries;
+}
+
+std::span<const ChunkRecord> PackFile::getChunks() const
+{
+    return m_chunks;
+}
+
+uint32_t PackFile::getChunkSize() const
+{
+    return m_header ? m_header->chunk_size : 0;
+}
+
+bool PackFile::readChunk(uint32_t index, uint8_t *destination) const
+{
+    if (index >= m_chunks.size())
+        return false;
+
+    const auto &chunk = m_chunks[index];
+    const uint8_t *source = m_file.getData() + chunk.offset;
+
+    if (chunk.compressed_size == chunk.size) {
+        std::memcpy(destination, source, chunk.size);
+        return true;
+    }
+
+    int32_t size = lz4::decompress(source, chunk.compressed_size, destination, chunk.size);
+    if (size != static_cast<int32_t>(chunk.size)) {
+        l_error("Failed to decompress chunk {}: {}", index, m_path.string());
+        return false;
+    }
+
+    return true;
+}
+
+std::string PackFile::normalizePath(const std::filesystem::path &path)
+{
+    return path.lexically_normal().generic_string();
+}
+
+bool PackFile::write(const std::filesystem::path &destination,
+                     const std::vector<std::pair<std::string, std::filesystem::path>> &files)
+{
+    std::vector<std::pair<std::string, std::filesystem::path>> sorted_files;
+    sorted_files.reserve(files.size());
+    for (const auto &[name, source] : files)
+        sorted_files.emplace_back(normalizePath(name), source);
+
+    std::sort(sorted_files.begin(), sorted_files.end());
+
+    for (int32_t i = 1; i < sorted_files.size(); ++i) {
+        if (sorted_files[i].first == sorted_files[i - 1].first) {
+            l_error("Duplicate file in pack: {}", sorted_files[i].first);
+            return false;
+        }
+    }
+
+    std::ofstream out(destination, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        l_error("Failed to create pack file: {}", destination.string());
+        return false;
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.chunk_size = CHUNK_SIZE;
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::vector<ChunkRecord> chunks;
+    std::vector<EntryRecord> entries;
+    std::string names;
+
+    std::vector<uint8_t> chunk;
+    chunk.reserve(CHUNK_SIZE);
+    std::vector<uint8_t> compressed(lz4::getCompressBound(CHUNK_SIZE));
+
+    uint64_t stream_offset = 0;
+    uint64_t file_offset = sizeof(Header);
+
+    auto flush_chunk = [&]() {
+        if (chunk.empty())
+            return;
+
+        int32_t size = chunk.size();
+        int32_t compressed_size = lz4::compress(chunk.data(),
+                                                size,
+                                                compressed.data(),
+                                                compressed.size());
+        const uint8_t *data = compressed.data();
+
+        // Несжимаемые данные хранятся как есть
+        if (compressed_size <= 0 || compressed_size >= size) {
+            compressed_size = size;
+            data = chunk.data();
+        }
+
+        out.write(reinterpret_cast<const char *>(data), compressed_size);
+        chunks.push_back({file_offset,
+                          static_cast<uint32_t>(compressed_size),
+                          static_cast<uint32_t>(size)});
+        file_offset += compressed_size;
+        chunk.clear();
+    };
+
+    for (const auto &[name, source] : sorted_files) {
+        std::ifstream in(source, std::ios::binary);
+        if (!in) {
+            l_error("Failed to read file for pack: {}", source.string());
+            return false;
+        }
+
+        std::vector<uint8_t> content((std::istreambuf_iterator<char>(in)), {});
+
+        entries.push_back({stream_offset,
+                           content.size(),
+                           static_cast<uint32_t>(names.size()),
+                           static_cast<uint32_t>(name.size())});
+        names += name;
+
+        for (size_t position = 0; position < content.size();) {
+            size_t count = std::min<size_t>(CHUNK_SIZE - chunk.size(), content.size() - position);
+            auto begin = content.begin() + position;
+            chunk.insert(chunk.end(), begin, begin + count);
+            position += count;
+
+            if (chunk.size() == CHUNK_SIZE)
+                flush_chunk();
+        }
+
+        stream_offset += content.size();
+    }
+
+    flush_chunk();
+
+    auto align = [&]() {
+        while (file_offset % alignof(uint64_t) != 0) {
+            out.put(0);
+            ++file_offset;
+        }
+    };
+
+    align();
+    header.chunks_offset = file_offset;
+    header.chunk_count = chunks.size();
+    out.write(reinterpret_cast<const char *>(chunks.data()), chunks.size() * sizeof(ChunkRecord));
+    file_offset += chunks.size() * sizeof(ChunkRecord);
+
+    align();
+    header.entries_offset = file_offset;
+    header.entry_count = entries.size();
+    out.write(reinterpret_cast<const char *>(entries.data()), entries.size() * sizeof(EntryRecord));
+    file_offset += entries.size() * sizeof(EntryRecord);
+
+    header.names_offset = file_offset;
+    header.names_size = names.size();
+    out.write(names.data(), names.size());
+    file_offset += names.size();
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    if (!out) {
+        l_error("Failed to write pack file: {}", destination.string());
+        return false;
+    }
+
+    l_info("Packed {} files into {}: {} KiB -> {} KiB",
+           entries.size(),
+           destination.string(),
+           stream_offset / 1024,
+           file_offset / 1024);
+
+    return true;
+}
+
+} // namespace ae
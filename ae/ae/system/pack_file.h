@@ -0,0 +1,101 @@
+#ifndef AE_PACK_FILE_H
+#define AE_PACK_FILE_H
+
+#include "mapped_file.h"
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ae {
+
+// Формат .aepack: заголовок, сжатые чанки, таблица чанков, отсортированный по имени
+// каталог файлов и блок имен. Содержимое всех файлов записано подряд в один поток,
+// который разбит на чанки по CHUNK_SIZE байт и сжат LZ4 независимо друг от друга.
+// Порядок байт - little-endian
+namespace pack {
+
+constexpr const char *EXTENSION = ".aepack";
+constexpr char MAGIC[4] = {'A', 'E', 'P', 'K'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t CHUNK_SIZE = 64 * 1024;
+
+struct Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t chunk_size;
+    uint32_t entry_count;
+    uint32_t chunk_count;
+    uint32_t padding;
+    uint64_t chunks_offset;
+    uint64_t entries_offset;
+    uint64_t names_offset;
+    uint64_t names_size;
+};
+
+// offset - смещение файла в несжатом потоке
+struct EntryRecord
+{
+    uint64_t offset;
+    uint64_t size;
+    uint32_t name;
+    uint32_t name_size;
+};
+
+// Чанк записан без сжатия, если compressed_size == size
+struct ChunkRecord
+{
+    uint64_t offset;
+    uint32_t compressed_size;
+    uint32_t size;
+};
+
+} // namespace pack
+
+// Пакет, отображенный в память. Поиск файла - двоичный поиск по каталогу
+class PackFile
+{
+public:
+    PackFile();
+    PackFile(const PackFile &) = delete;
+    PackFile &operator=(const PackFile &) = delete;
+    ~PackFile() = default;
+
+    bool open(const std::filesystem::path &path);
+    bool isOpen() const;
+    const std::filesystem::path &getPath() const;
+
+    // Имя должно быть нормализовано через normalizePath
+    const pack::EntryRecord *find(std::string_view name) const;
+    std::string_view getName(const pack::EntryRecord &entry) const;
+
+    std::span<const pack::EntryRecord> getEntries() const;
+    std::span<const pack::ChunkRecord> getChunks() const;
+    uint32_t getChunkSize() const;
+
+    // Распаковывает чанк в destination размером не меньше chunk.size
+    bool readChunk(uint32_t index, uint8_t *destination) const;
+
+    // Путь к файлу в виде имени в каталоге: без "." и "..", с разделителями '/'
+    static std::string normalizePath(const std::filesystem::path &path);
+
+    // Запись пакета из пар {имя в пакете, путь к файлу на диске}
+    static bool write(const std::filesystem::path &destination,
+                      const std::vector<std::pair<std::string, std::filesystem::path>> &files);
+
+private:
+    std::filesystem::path m_path;
+    MappedFile m_file;
+    const pack::Header *m_header;
+    std::span<const pack::EntryRecord> m_entries;
+    std::span<const pack::ChunkRecord> m_chunks;
+    std::span<const char> m_names;
+};
+
+} // namespace ae
+
+#endif // AE_PACK_FILE_H
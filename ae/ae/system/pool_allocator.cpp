@@ -0,0 +1,193 @@
+#include "pool_allocator.h"
+
+#include <mutex>
+#include <new>
+
+namespace ae {
+
+// Свободные блоки связаны через свое же содержимое
+struct FreeBlock
+{
+    FreeBlock *next;
+};
+
+struct Pool::SizeClass
+{
+    std::mutex mutex;
+    FreeBlock *free_list = nullptr;
+    size_t block_size = 0;
+
+    std::atomic<int64_t> chunks{0};
+    std::atomic<int64_t> refills{0};
+};
+
+// Тривиальный тип, поэтому доступен и при завершении потока, когда деструкторы
+// thread_local объектов уже вызваны
+struct Pool::ThreadCache
+{
+    void *blocks[SIZE_CLASSES_COUNT][THREAD_CACHE_SIZE * 2];
+    int32_t counts[SIZE_CLASSES_COUNT];
+    bool registered;
+    bool disabled;
+};
+
+std::atomic<int64_t> Pool::m_fallback_allocations{0};
+
+void *Pool::allocate(size_t size)
+{
+    int32_t size_class = getSizeClass(size);
+    if (size_class < 0) {
+        m_fallback_allocations.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+
+    auto &cache = getThreadCache();
+    if (cache.counts[size_class] == 0)
+        refill(cache, size_class);
+
+    return cache.blocks[size_class][--cache.counts[size_class]];
+}
+
+void Pool::deallocate(void *ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    int32_t size_class = getSizeClass(size);
+    if (size_class < 0) {
+        ::operator delete(ptr, size);
+        return;
+    }
+
+    auto &cache = getThreadCache();
+    cache.blocks[size_class][cache.counts[size_class]++] = ptr;
+
+    // Половина кэша возвращается в общий список, чтобы блоки не копились в одном потоке.
+    // После завершения потока кэш не используется
+    if (cache.disabled)
+        flush(cache, size_class, cache.counts[size_class]);
+    else if (cache.counts[size_class] == THREAD_CACHE_SIZE * 2)
+        flush(cache, size_class, THREAD_CACHE_SIZE);
+}
+
+Pool::Stats Pool::getStats()
+{
+    Stats stats;
+    stats.fallback_allocations = m_fallback_allocations.load();
+
+    SizeClass *size_classes = getSizeClasses();
+    for (int32_t i = 0; i < SIZE_CLASSES_COUNT; ++i) {
+        int64_t chunks = size_classes[i].chunks.load();
+        stats.chunks += chunks;
+        stats.reserved_bytes += chunks * CHUNK_SIZE;
+        stats.refills += size_classes[i].refills.load();
+    }
+
+    return stats;
+}
+
+int32_t Pool::getSizeClass(size_t size)
+{
+    // Шаг 16 байт до 128, затем 32 до 256, 64 до 512 и 128 до 1024
+    if (size == 0)
+        return 0;
+    if (size <= 128)
+        return static_cast<int32_t>((size + 15) / 16) - 1;
+    if (size <= 256)
+        return 8 + static_cast<int32_t>((size - 129) / 32);
+    if (size <= 512)
+        return 12 + static_cast<int32_t>((size - 257) / 64);
+    if (size <= MAX_BLOCK_SIZE)
+        return 16 + static_cast<int32_t>((size - 513) / 128);
+    return -1;
+}
+
+size_t Pool::getBlockSize(int32_t size_class)
+{
+    if (size_class < 8)
+        return (size_class + 1) * 16;
+    if (size_class < 12)
+        return 128 + (size_class - 7) * 32;
+    if (size_class < 16)
+        return 256 + (size_class - 11) * 64;
+    return 512 + (size_class - 15) * 128;
+}
+
+Pool::SizeClass *Pool::getSizeClasses()
+{
+    // Не удаляются: объекты в пулах могут освобождаться деструкторами статических объектов
+    static SizeClass *size_classes = []() {
+        auto *result = new SizeClass[SIZE_CLASSES_COUNT];
+        for (int32_t i = 0; i < SIZE_CLASSES_COUNT; ++i)
+            result[i].block_size = getBlockSize(i);
+        return result;
+    }();
+    return size_classes;
+}
+
+Pool::ThreadCache &Pool::getThreadCache()
+{
+    // Возвращает блоки потока в общий список при его завершении
+    struct Flusher
+    {
+        ThreadCache &cache;
+
+        ~Flusher()
+        {
+            for (int32_t i = 0; i < SIZE_CLASSES_COUNT; ++i)
+                flush(cache, i, cache.counts[i]);
+            cache.disabled = true;
+        }
+    };
+
+    thread_local ThreadCache cache{};
+    if (!cache.registered) {
+        cache.registered = true;
+        thread_local Flusher flusher{cache};
+    }
+
+    return cache;
+}
+
+void Pool::refill(ThreadCache &cache, int32_t size_class)
+{
+    auto &pool = getSizeClasses()[size_class];
+    pool.refills.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(pool.mutex);
+
+    if (!pool.free_list) {
+        auto *chunk = static_cast<std::byte *>(::operator new(CHUNK_SIZE));
+        pool.chunks.fetch_add(1, std::memory_order_relaxed);
+
+        size_t blocks_count = CHUNK_SIZE / pool.block_size;
+        for (size_t i = blocks_count; i > 0; --i) {
+            auto *block = reinterpret_cast<FreeBlock *>(chunk + (i - 1) * pool.block_size);
+            block->next = pool.free_list;
+            pool.free_list = block;
+        }
+    }
+
+    int32_t count = cache.disabled ? 1 : THREAD_CACHE_SIZE;
+    while (cache.counts[size_class] < count && pool.free_list) {
+        cache.blocks[size_class][cache.counts[size_class]++] = pool.free_list;
+        pool.free_list = pool.free_list->next;
+    }
+}
+
+void Pool::flush(ThreadCache &cache, int32_t size_class, int32_t count)
+{
+    if (count <= 0)
+        return;
+
+    auto &pool = getSizeClasses()[size_class];
+    std::lock_guard<std::mutex> lock(pool.mutex);
+
+    for (int32_t i = 0; i < count; ++i) {
+        auto *block = static_cast<FreeBlock *>(cache.blocks[size_class][--cache.counts[size_class]]);
+        block->next = pool.free_list;
+        pool.free_list = block;
+    }
+}
+
+} // namespace ae
@@ -0,0 +1,105 @@
+#ifndef AE_POOL_ALLOCATOR_H
+#define AE_POOL_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace ae {
+
+// Пулы блоков фиксированного размера по классам размеров до MAX_BLOCK_SIZE. Блоки нарезаются
+// из больших кусков, поэтому объекты одного класса лежат рядом. У каждого потока свой кэш
+// свободных блоков, общий список под мьютексом трогается только пачками. Память пулов
+// не возвращается системе
+class Pool
+{
+public:
+    struct Stats
+    {
+        size_t reserved_bytes = 0;
+        int64_t chunks = 0;
+        // Обращения потоков к общему списку
+        int64_t refills = 0;
+        // Слишком большие блоки, выделенные через operator new
+        int64_t fallback_allocations = 0;
+    };
+
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t MAX_BLOCK_SIZE = 1024;
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr int32_t THREAD_CACHE_SIZE = 32;
+
+    static void *allocate(size_t size);
+    // Размер должен совпадать с переданным в allocate
+    static void deallocate(void *ptr, size_t size);
+
+    static Stats getStats();
+
+private:
+    struct SizeClass;
+    struct ThreadCache;
+
+    static constexpr int32_t SIZE_CLASSES_COUNT = 20;
+
+    static int32_t getSizeClass(size_t size);
+    static size_t getBlockSize(int32_t size_class);
+    static SizeClass *getSizeClasses();
+    static ThreadCache &getThreadCache();
+
+    static void refill(ThreadCache &cache, int32_t size_class);
+    static void flush(ThreadCache &cache, int32_t size_class, int32_t count);
+
+    static std::atomic<int64_t> m_fallback_allocations;
+};
+
+// Аллокатор для STL контейнеров и allocateShared/allocateUnique
+template<typename T>
+class PoolAllocator
+{
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U> &)
+    {}
+
+    T *allocate(size_t count)
+    {
+        static_assert(alignof(T) <= Pool::ALIGNMENT, "Over-aligned types are not supported");
+        return static_cast<T *>(Pool::allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T *ptr, size_t count) { Pool::deallocate(ptr, count * sizeof(T)); }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U> &) const
+    {
+        return true;
+    }
+
+    template<typename U>
+    bool operator!=(const PoolAllocator<U> &) const
+    {
+        return false;
+    }
+};
+
+} // namespace ae
+
+// Объявляется в теле класса: new/delete и createShared/createUnique берут память из пулов.
+// Наследники тоже попадают в пулы, удаление через базовый класс требует виртуального
+// деструктора
+#define AE_POOL_ALLOCATED \
+    using PoolAllocatedTag = void; \
+    static void *operator new(size_t size) \
+    { \
+        return ::ae::Pool::allocate(size); \
+    } \
+    static void operator delete(void *ptr, size_t size) \
+    { \
+        ::ae::Pool::deallocate(ptr, size); \
+    }
+
+#endif // AE_POOL_ALLOCATOR_H
@@ -0,0 +1,77 @@
+#include "signal.h"
+
+#include <algorithm>
+
+namespace ae {
+
+namespace {
+
+struct ScheduledSignal
+{
+    void *signal;
+    int64_t (*dispatch)(void *);
+};
+
+std::mutex s_mutex;
+std::vector<ScheduledSignal> s_scheduled;
+// Пачка, которую сейчас вызывает dispatch. Удаленный во время вызова сигнал обнуляется
+std::vector<ScheduledSignal> s_dispatching;
+std::atomic<int64_t> s_last_dispatched_count{0};
+
+} // namespace
+
+void SignalQueue::dispatch()
+{
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_dispatching.swap(s_scheduled);
+    }
+
+    int64_t dispatched_count = 0;
+
+    for (size_t i = 0;; ++i) {
+        ScheduledSignal scheduled;
+        {
+            std::lock_guard<std::mutex> lock(s_mutex);
+            if (i == s_dispatching.size())
+                break;
+            scheduled = s_dispatching[i];
+        }
+
+        if (scheduled.signal)
+            dispatched_count += scheduled.dispatch(scheduled.signal);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        s_dispatching.clear();
+    }
+
+    s_last_dispatched_count.store(dispatched_count, std::memory_order_relaxed);
+}
+
+int64_t SignalQueue::getLastDispatchedCount()
+{
+    return s_last_dispatched_count.load(std::memory_order_relaxed);
+}
+
+void SignalQueue::schedule(void *signal, DispatchFunc func)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_scheduled.push_back({signal, func});
+}
+
+void SignalQueue::cancel(void *signal)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+
+    std::erase_if(s_scheduled,
+                  [signal](const ScheduledSignal &scheduled) { return scheduled.signal == signal; });
+
+    for (auto &scheduled : s_dispatching) {
+        if (scheduled.signal == signal)
+            scheduled.signal = nullptr;
+    }
+}
+
+} // namespace ae
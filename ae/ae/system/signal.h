@@ -1,24 +1,60 @@
 #ifndef AE_SIGNAL_H
 #define AE_SIGNAL_H
 
+#include "delegate.h"
 #include "memory.h"
 
-#include <functional>
+#include <atomic>
 #include <mutex>
+#include <tuple>
+#include <vector>
 
 namespace ae {
 
+enum class SignalMode {
+    DIRECT, // слоты вызываются внутри emit
+    QUEUED  // emit сохраняет аргументы, слоты вызываются пачкой в SignalQueue::dispatch
+};
+
+// Очередь сигналов в режиме QUEUED, которым есть что вызвать. Движок вызывает dispatch
+// на главном потоке один раз за тик
+class SignalQueue
+{
+    template<typename... Args>
+    friend class Signal;
+
+public:
+    static void dispatch();
+
+    // Сколько отложенных вызовов было выполнено последним dispatch
+    static int64_t getLastDispatchedCount();
+
+private:
+    using DispatchFunc = int64_t (*)(void *);
+
+    static void schedule(void *signal, DispatchFunc func);
+    static void cancel(void *signal);
+};
+
 template<typename... Args>
 class Signal
 {
 public:
-    using SlotFunc = std::function<void(Args...)>;
+    using SlotFunc = Delegate<void(Args...)>;
 
     struct Connection
     {
+        AE_POOL_ALLOCATED
+
+        Connection(SlotFunc &&n_func, void *n_object = nullptr)
+            : func{std::move(n_func)}
+            , object{n_object}
+            , active{true}
+        {}
+
         SlotFunc func;
-        void *object = nullptr;
-        bool active = true;
+        void *object;
+        std::atomic<bool> active;
     };
 
     class ConnectionHandle
@@ -38,24 +74,45 @@ public:
                 m_owner->disconnect(conn);
         }
 
-        bool isValid() const { return !m_conn.expired(); }
+        bool isValid() const
+        {
+            auto conn = m_conn.lock();
+            return conn && conn->active.load(std::memory_order_relaxed);
+        }
 
     private:
         w_ptr<Connection> m_conn;
         Signal *m_owner;
     };
 
-    Signal() = default;
-    ~Signal() = default;
+    explicit Signal(SignalMode mode = SignalMode::DIRECT)
+        : m_mode{mode}
+        , m_slots{nullptr}
+        , m_readers{0}
+        , m_has_retired{false}
+        , m_scheduled{false}
+    {}
+
+    ~Signal()
+    {
+        if (m_mode == SignalMode::QUEUED)
+            SignalQueue::cancel(this);
+
+        delete m_slots.load(std::memory_order_relaxed);
+        for (auto *slots : m_retired)
+            delete slots;
+    }
+
+    Signal(const Signal &) = delete;
+    Signal &operator=(const Signal &) = delete;
+
+    SignalMode getMode() const { return m_mode; }
 
     // Лямбда или свободная функция
     ConnectionHandle connect(SlotFunc slot)
     {
-        auto conn = createShared<Connection>(Connection{std::move(slot)});
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_slots.push_back(conn);
-        }
+        auto conn = createShared<Connection>(std::move(slot));
+        addConnection(conn);
         return ConnectionHandle{conn, this};
     }
 
@@ -66,12 +123,8 @@ public:
         SlotFunc wrapper = [obj, method](Args... args) {
             (obj->*method)(std::forward<Args>(args)...);
         };
-        auto conn = createShared<Connection>(
-            Connection{std::move(wrapper), static_cast<void *>(obj)});
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_slots.push_back(conn);
-        }
+        auto conn = createShared<Connection>(std::move(wrapper), static_cast<void *>(obj));
+        addConnection(conn);
         return ConnectionHandle{conn, this};
     }
 
@@ -80,55 +133,175 @@ public:
         requires(!std::is_member_function_pointer_v<T>)
     ConnectionHandle connect(SlotFunc func, T *obj)
     {
-        auto conn = createShared<Connection>(Connection{std::move(func), static_cast<void *>(obj)});
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_slots.push_back(conn);
-        }
+        auto conn = createShared<Connection>(std::move(func), static_cast<void *>(obj));
+        addConnection(conn);
         return ConnectionHandle{conn, this};
     }
 
     void emit(Args... args)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        for (auto &conn : m_slots) {
-            if (conn->active && conn->func) {
-                conn->func(args...);
-            }
+        if (m_mode == SignalMode::QUEUED) {
+            enqueue(args...);
+            return;
         }
 
-        // Очистка "мёртвых" после вызова
-        m_slots.erase(std::remove_if(m_slots.begin(),
-                                     m_slots.end(),
-                                     [](const s_ptr<Connection> &conn) { return !conn->active; }),
-                      m_slots.end());
+        invoke(args...);
     }
 
     // Удалить по объекту
     void disconnect(void *object)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        for (auto &conn : m_slots) {
-            if (conn->object == object)
-                conn->active = false;
-        }
+        removeConnections([object](const Connection &conn) { return conn.object == object; });
     }
 
     void disconnect(const s_ptr<Connection> &conn)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        conn->active = false;
+        removeConnections([&conn](const Connection &other) { return &other == conn.get(); });
     }
 
     void disconnect()
+    {
+        removeConnections([](const Connection &) { return true; });
+    }
+
+private:
+    // Список слотов не меняется после публикации. connect и disconnect публикуют новый,
+    // а старый освобождается, когда его не читает ни один emit
+    struct SlotList
+    {
+        std::vector<s_ptr<Connection>> slots;
+    };
+
+    void invoke(Args &...args)
+    {
+        m_readers.fetch_add(1);
+
+        if (const SlotList *list = m_slots.load()) {
+            for (const auto &conn : list->slots) {
+                // Слот мог быть отключен предыдущим слотом этого же emit
+                if (conn->active.load(std::memory_order_acquire) && conn->func)
+                    conn->func(args...);
+            }
+        }
+
+        if (m_readers.fetch_sub(1) == 1 && m_has_retired.load()) {
+            std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+            if (lock.owns_lock())
+                reclaim();
+        }
+    }
+
+    void addConnection(const s_ptr<Connection> &conn)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto *list = new SlotList;
+        if (const SlotList *current = m_slots.load(std::memory_order_relaxed)) {
+            list->slots.reserve(current->slots.size() + 1);
+            list->slots.insert(list->slots.end(), current->slots.begin(), current->slots.end());
+        }
+        list->slots.push_back(conn);
+
+        publish(list);
+    }
+
+    template<typename Pred>
+    void removeConnections(Pred pred)
     {
         std::lock_guard<std::mutex> lock(m_mutex);
-        m_slots.clear();
+
+        const SlotList *current = m_slots.load(std::memory_order_relaxed);
+        if (!current)
+            return;
+
+        auto *list = new SlotList;
+        list->slots.reserve(current->slots.size());
+        for (const auto &conn : current->slots) {
+            if (pred(*conn))
+                conn->active.store(false, std::memory_order_release);
+            else
+                list->slots.push_back(conn);
+        }
+
+        if (list->slots.empty()) {
+            delete list;
+            list = nullptr;
+        }
+
+        publish(list);
+    }
+
+    // Вызывается под m_mutex
+    void publish(const SlotList *list)
+    {
+        const SlotList *previous = m_slots.exchange(list);
+        if (previous) {
+            m_retired.push_back(previous);
+            m_has_retired.store(true);
+        }
+
+        reclaim();
+    }
+
+    // Вызывается под m_mutex. Emit, начавшийся после публикации, уже видит новый список,
+    // поэтому при нуле читателей старые списки никому не нужны
+    void reclaim()
+    {
+        if (m_retired.empty() || m_readers.load() != 0)
+            return;
+
+        for (auto *slots : m_retired)
+            delete slots;
+        m_retired.clear();
+        m_has_retired.store(false, std::memory_order_relaxed);
+    }
+
+    void enqueue(Args &...args)
+    {
+        bool schedule = false;
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            m_queue.emplace_back(args...);
+            if (!m_scheduled) {
+                m_scheduled = true;
+                schedule = true;
+            }
+        }
+
+        if (schedule)
+            SignalQueue::schedule(this, &Signal::dispatchQueued);
+    }
+
+    static int64_t dispatchQueued(void *signal)
+    {
+        auto *self = static_cast<Signal *>(signal);
+
+        std::vector<std::tuple<std::decay_t<Args>...>> queue;
+        {
+            std::lock_guard<std::mutex> lock(self->m_queue_mutex);
+            queue.swap(self->m_queue);
+            self->m_scheduled = false;
+        }
+
+        for (auto &args : queue)
+            std::apply([self](auto &...values) { self->invoke(values...); }, args);
+
+        return static_cast<int64_t>(queue.size());
     }
 
 private:
-    std::vector<s_ptr<Connection>> m_slots;
+    SignalMode m_mode;
+
+    std::atomic<const SlotList *> m_slots;
+    std::atomic<int32_t> m_readers;
+    std::atomic<bool> m_has_retired;
+    std::vector<const SlotList *> m_retired;
+    // Только для connect и disconnect, emit его не берет
     std::mutex m_mutex;
+
+    std::vector<std::tuple<std::decay_t<Args>...>> m_queue;
+    bool m_scheduled;
+    std::mutex m_queue_mutex;
 };
 
 } // namespace ae
@@ -104,6 +104,16 @@ String &String::operator+=(const char *ansi)
     return *this;
 }
 
+bool String::operator==(const String &right) const
+{
+    return m_string == right.m_string;
+}
+
+bool String::operator!=(const String &right) const
+{
+    return m_string != right.m_string;
+}
+
 void String::clear()
 {
     m_string.clear();
@@ -40,6 +40,9 @@ public:
     String &operator+=(const std::string &ansi);
     String &operator+=(const char *ansi);
 
+    bool operator==(const String &right) const;
+    bool operator!=(const String &right) const;
+
     void erase(int32_t pos, int32_t npos = -1);
     void clear();
 
@@ -0,0 +1,75 @@
+#include "string_id.h"
+#include "log.h"
+
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace ae {
+
+struct StringId::Table
+{
+    std::mutex mutex;
+    // deque не перемещает элементы при добавлении, ссылки на строки остаются валидными
+    std::deque<std::string> strings;
+    std::unordered_map<uint64_t, const std::string *> by_hash;
+};
+
+StringId::Table &StringId::getTable()
+{
+    static Table table;
+    return table;
+}
+
+StringId StringId::intern(std::string_view str)
+{
+    StringId string_id{str};
+    if (string_id.isEmpty())
+        return string_id;
+
+    auto &string_table = getTable();
+    std::lock_guard lock{string_table.mutex};
+
+    auto found = string_table.by_hash.find(string_id.m_hash);
+    if (found != string_table.by_hash.end()) {
+        if (*found->second != str) {
+            l_error("StringId hash collision: \"{}\" and \"{}\"", *found->second, str);
+            return {};
+        }
+        return string_id;
+    }
+
+    const auto &interned = string_table.strings.emplace_back(str);
+    string_table.by_hash.emplace(string_id.m_hash, &interned);
+
+    return string_id;
+}
+
+#ifndef NDEBUG
+void StringId::checkCollision(uint64_t hash, std::string_view str)
+{
+    if (hash == 0)
+        return;
+
+    auto &string_table = getTable();
+    std::lock_guard lock{string_table.mutex};
+
+    auto found = string_table.by_hash.find(hash);
+    assert((found == string_table.by_hash.end() || *found->second == str)
+           && "StringId hash collision");
+}
+#endif
+
+const std::string &StringId::getString() const
+{
+    static const std::string empty;
+
+    auto &string_table = getTable();
+    std::lock_guard lock{string_table.mutex};
+
+    auto found = string_table.by_hash.find(m_hash);
+    return found != string_table.by_hash.end() ? *found->second : empty;
+}
+
+} // namespace ae
@@ -0,0 +1,86 @@
+#ifndef AE_STRING_ID_H
+#define AE_STRING_ID_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ae {
+
+// Имя в виде 64-битного хеша (FNV-1a). Создание и сравнение не обращаются к общей таблице
+// и не берут блокировок, хеш можно посчитать заранее, в том числе на этапе компиляции.
+// Сама строка нужна только для логов: она попадает в таблицу через intern при регистрации
+// имени, поиск по имени таблицу не меняет. Имена с одинаковым хешем неразличимы, поэтому
+// intern отклоняет совпадение, а в отладочной сборке каждый StringId из строки сверяется
+// с интернированной строкой того же хеша
+class StringId
+{
+public:
+    constexpr StringId()
+        : m_hash{0}
+    {}
+    constexpr explicit StringId(std::string_view str)
+        : m_hash{hash(str)}
+    {
+#ifndef NDEBUG
+        if (!std::is_constant_evaluated())
+            checkCollision(m_hash, str);
+#endif
+    }
+    ~StringId() = default;
+
+    // Хеш и запись строки в таблицу. Если хеш уже занят другой строкой, возвращает
+    // пустой StringId: такое имя нельзя использовать как ключ
+    static StringId intern(std::string_view str);
+
+    static constexpr uint64_t hash(std::string_view str)
+    {
+        if (str.empty())
+            return 0;
+
+        uint64_t result = 14695981039346656037ull;
+        for (char c : str) {
+            result ^= static_cast<uint8_t>(c);
+            result *= 1099511628211ull;
+        }
+
+        // 0 зарезервирован за пустым именем
+        return result != 0 ? result : 1;
+    }
+
+    constexpr uint64_t getHash() const { return m_hash; }
+    // Пустая строка, если имя не было интернировано
+    const std::string &getString() const;
+
+    constexpr bool isEmpty() const { return m_hash == 0; }
+
+    constexpr bool operator==(const StringId &other) const { return m_hash == other.m_hash; }
+    constexpr bool operator!=(const StringId &other) const { return m_hash != other.m_hash; }
+    constexpr bool operator<(const StringId &other) const { return m_hash < other.m_hash; }
+
+private:
+    struct Table;
+    static Table &getTable();
+
+#ifndef NDEBUG
+    static void checkCollision(uint64_t hash, std::string_view str);
+#endif
+
+private:
+    uint64_t m_hash;
+};
+
+} // namespace ae
+
+template<>
+struct std::hash<ae::StringId>
+{
+    size_t operator()(const ae::StringId &string_id) const noexcept
+    {
+        return static_cast<size_t>(string_id.getHash());
+    }
+};
+
+#endif // AE_STRING_ID_H
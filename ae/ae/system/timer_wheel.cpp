@@ -0,0 +1,202 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+namespace ae {
+
+TimerWheel::Handle::Handle()
+    : m_wheel{nullptr}
+    , m_index{NONE}
+    , m_generation{0}
+{}
+
+TimerWheel::Handle::Handle(TimerWheel *wheel, uint32_t index, uint32_t generation)
+    : m_wheel{wheel}
+    , m_index{index}
+    , m_generation{generation}
+{}
+
+void TimerWheel::Handle::cancel()
+{
+    if (!isPending())
+        return;
+
+    m_wheel->unlink(m_index);
+    m_wheel->release(m_index);
+    --m_wheel->m_pending_count;
+}
+
+bool TimerWheel::Handle::isPending() const
+{
+    return m_wheel && m_wheel->isPending(m_index, m_generation);
+}
+
+TimerWheel::TimerWheel(const Time &resolution)
+    : m_resolution{resolution}
+    , m_now{0}
+    , m_free{NONE}
+    , m_fired_count{0}
+    , m_pending_count{0}
+{
+    std::fill(std::begin(m_slots), std::end(m_slots), NONE);
+}
+
+const Time &TimerWheel::getResolution() const
+{
+    return m_resolution;
+}
+
+uint64_t TimerWheel::getTicks(const Time &delay) const
+{
+    int64_t resolution = std::max<int64_t>(m_resolution.asMicroseconds(), 1);
+    int64_t ticks = (delay.asMicroseconds() + resolution - 1) / resolution;
+    return static_cast<uint64_t>(std::max<int64_t>(ticks, 1));
+}
+
+TimerWheel::Handle TimerWheel::schedule(const Time &delay, const Callback &callback)
+{
+    return scheduleTicks(getTicks(delay), callback);
+}
+
+TimerWheel::Handle TimerWheel::scheduleTicks(uint64_t ticks, const Callback &callback)
+{
+    uint32_t index;
+    if (m_free != NONE) {
+        index = m_free;
+        m_free = m_timers[index].next;
+    } else {
+        index = static_cast<uint32_t>(m_timers.size());
+        m_timers.emplace_back();
+    }
+
+    auto &timer = m_timers[index];
+    timer.callback = callback;
+    timer.expires = m_now + std::max<uint64_t>(ticks, 1);
+
+    insert(index);
+    ++m_pending_count;
+
+    return Handle{this, index, timer.generation};
+}
+
+void TimerWheel::update(const Time &dt)
+{
+    m_fired_count = 0;
+    m_accumulator += dt;
+
+    while (m_accumulator >= m_resolution) {
+        m_accumulator -= m_resolution;
+        advance();
+    }
+}
+
+void TimerWheel::advance()
+{
+    ++m_now;
+
+    // Сначала верхние уровни: их таймеры могут попасть в ячейку уровня ниже, которую
+    // нужно разобрать на этом же шаге
+    for (uint32_t level = LEVELS - 1; level > 0; --level) {
+        if ((m_now & ((uint64_t{1} << (level * SLOT_BITS)) - 1)) == 0)
+            cascade(level);
+    }
+
+    // На нулевом уровне в ячейке лежат только таймеры этого шага. Колбэк может отменять и
+    // добавлять таймеры, новые попадают в другие ячейки
+    uint32_t &head = m_slots[m_now & SLOT_MASK];
+    while (head != NONE) {
+        uint32_t index = head;
+        unlink(index);
+
+        Callback callback = std::move(m_timers[index].callback);
+        release(index);
+        --m_pending_count;
+        ++m_fired_count;
+
+        if (callback)
+            callback();
+    }
+}
+
+int32_t TimerWheel::getFiredCount() const
+{
+    return m_fired_count;
+}
+
+int32_t TimerWheel::getPendingCount() const
+{
+    return m_pending_count;
+}
+
+void TimerWheel::insert(uint32_t index)
+{
+    auto &timer = m_timers[index];
+
+    // Слишком дальний таймер ставится в последнюю ячейку и переносится при ее разборе
+    uint64_t expires = std::min(timer.expires, m_now + MAX_TICKS);
+    uint64_t delta = expires - m_now;
+
+    uint32_t level = 0;
+    while (level + 1 < LEVELS && delta >= (uint64_t{1} << ((level + 1) * SLOT_BITS)))
+        ++level;
+
+    uint32_t slot = level * SLOTS
+                    + static_cast<uint32_t>((expires >> (level * SLOT_BITS)) & SLOT_MASK);
+
+    timer.slot = slot;
+    timer.prev = NONE;
+    timer.next = m_slots[slot];
+    if (timer.next != NONE)
+        m_timers[timer.next].prev = index;
+    m_slots[slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index)
+{
+    auto &timer = m_timers[index];
+
+    if (timer.prev != NONE)
+        m_timers[timer.prev].next = timer.next;
+    else
+        m_slots[timer.slot] = timer.next;
+
+    if (timer.next != NONE)
+        m_timers[timer.next].prev = timer.prev;
+
+    timer.prev = NONE;
+    timer.next = NONE;
+}
+
+void TimerWheel::release(uint32_t index)
+{
+    auto &timer = m_timers[index];
+    timer.callback = nullptr;
+    timer.slot = NONE;
+    ++timer.generation;
+
+    timer.next = m_free;
+    m_free = index;
+}
+
+void TimerWheel::cascade(uint32_t level)
+{
+    uint32_t slot = level * SLOTS
+                    + static_cast<uint32_t>((m_now >> (level * SLOT_BITS)) & SLOT_MASK);
+
+    uint32_t index = m_slots[slot];
+    m_slots[slot] = NONE;
+
+    while (index != NONE) {
+        uint32_t next = m_timers[index].next;
+        insert(index);
+        index = next;
+    }
+}
+
+bool TimerWheel::isPending(uint32_t index, uint32_t generation) const
+{
+    return index < m_timers.size() && m_timers[index].generation == generation
+           && m_timers[index].slot != NONE;
+}
+
+} // namespace ae
@@ -0,0 +1,102 @@
+#ifndef AE_TIMER_WHEEL_H
+#define AE_TIMER_WHEEL_H
+
+#include "time.h"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace ae {
+
+// Иерархическое колесо таймеров с шагом resolution. Четыре уровня по 64 ячейки покрывают
+// 2^24 шагов, более дальние таймеры переносятся на нижние уровни по мере приближения.
+// advance стоит O(1) плюс амортизированный перенос, ожидающие таймеры на тик не влияют
+class TimerWheel
+{
+public:
+    using Callback = std::function<void()>;
+
+    // Ссылка на таймер для отмены. Становится недействительной после срабатывания
+    class Handle
+    {
+        friend class TimerWheel;
+
+    public:
+        Handle();
+
+        void cancel();
+        bool isPending() const;
+
+    private:
+        Handle(TimerWheel *wheel, uint32_t index, uint32_t generation);
+
+    private:
+        TimerWheel *m_wheel;
+        uint32_t m_index;
+        uint32_t m_generation;
+    };
+
+    explicit TimerWheel(const Time &resolution);
+    ~TimerWheel() = default;
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    const Time &getResolution() const;
+    // Число шагов до срабатывания, не меньше одного
+    uint64_t getTicks(const Time &delay) const;
+
+    Handle schedule(const Time &delay, const Callback &callback);
+    Handle scheduleTicks(uint64_t ticks, const Callback &callback);
+
+    // Продвигает колесо на dt, вызывает наступившие таймеры
+    void update(const Time &dt);
+    // Один шаг колеса
+    void advance();
+
+    // Сработавшие за последний update
+    int32_t getFiredCount() const;
+    int32_t getPendingCount() const;
+
+private:
+    static constexpr uint32_t LEVELS = 4;
+    static constexpr uint32_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1 << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint64_t MAX_TICKS = (uint64_t{1} << (LEVELS * SLOT_BITS)) - 1;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Timer
+    {
+        Callback callback;
+        uint64_t expires = 0;
+        uint32_t prev = NONE;
+        uint32_t next = NONE;
+        uint32_t generation = 0;
+        uint32_t slot = NONE; // уровень * SLOTS + ячейка, NONE для свободного
+    };
+
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(uint32_t level);
+    bool isPending(uint32_t index, uint32_t generation) const;
+
+private:
+    Time m_resolution;
+    Time m_accumulator;
+    uint64_t m_now;
+
+    // Таймеры хранятся подряд, ячейки связывают их по индексам
+    std::vector<Timer> m_timers;
+    uint32_t m_free;
+    uint32_t m_slots[LEVELS * SLOTS];
+
+    int32_t m_fired_count;
+    int32_t m_pending_count;
+};
+
+} // namespace ae
+
+#endif // AE_TIMER_WHEEL_H
@@ -0,0 +1,292 @@
+#include "vfs.h"
+#include "job_system.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ae {
+
+VfsFile::VfsFile(std::vector<uint8_t> &&data)
+    : m_buffer{std::move(data)}
+    , m_data{m_buffer}
+{}
+
+VfsFile::VfsFile(u_ptr<MappedFile> &&mapped_file)
+    : m_mapped_file{std::move(mapped_file)}
+    , m_data{m_mapped_file->getData(), m_mapped_file->getSize()}
+{}
+
+s_ptr<VfsFile> VfsFile::openFile(const std::filesystem::path &path)
+{
+    // Пустой файл нельзя отобразить в память
+    std::error_code error;
+    if (std::filesystem::is_regular_file(path, error)
+        && std::filesystem::file_size(path, error) == 0)
+        return createShared<VfsFile>(std::vector<uint8_t>{});
+
+    auto mapped_file = createUnique<MappedFile>();
+    if (!mapped_file->open(path))
+        return nullptr;
+
+    return createShared<VfsFile>(std::move(mapped_file));
+}
+
+std::span<const uint8_t> VfsFile::getData() const
+{
+    return m_data;
+}
+
+size_t VfsFile::getSize() const
+{
+    return m_data.size();
+}
+
+std::string VfsFile::getString() const
+{
+    return {reinterpret_cast<const char *>(m_data.data()), m_data.size()};
+}
+
+Vfs::Vfs()
+    : m_chunk_cache_size{0}
+    , m_chunk_cache_capacity{DEFAULT_CHUNK_CACHE_CAPACITY}
+    , m_files_opened{0}
+    , m_pack_files_opened{0}
+    , m_chunk_hits{0}
+    , m_chunk_misses{0}
+    , m_decompressed_bytes{0}
+{}
+
+bool Vfs::mount(const std::filesystem::path &path)
+{
+    auto pack_file = createUnique<PackFile>();
+    if (!pack_file->open(path))
+        return false;
+
+    l_info("Mounted pack {}: {} files, {} chunks",
+           path.string(),
+           pack_file->getEntries().size(),
+           pack_file->getChunks().size());
+
+    m_packs.push_back(std::move(pack_file));
+
+    return true;
+}
+
+void Vfs::unmountAll()
+{
+    clearChunkCache();
+    m_packs.clear();
+}
+
+int32_t Vfs::getMountedCount() const
+{
+    return m_packs.size();
+}
+
+bool Vfs::exists(const std::filesystem::path &path) const
+{
+    const PackFile *pack_file;
+    const pack::EntryRecord *entry;
+    uint32_t pack_index;
+    if (find(path, pack_file, entry, pack_index))
+        return true;
+
+    std::error_code error;
+    return std::filesystem::is_regular_file(path, error);
+}
+
+s_ptr<VfsFile> Vfs::open(const std::filesystem::path &path)
+{
+    ++m_files_opened;
+
+    const PackFile *pack_file;
+    const pack::EntryRecord *entry;
+    uint32_t pack_index;
+    if (find(path, pack_file, entry, pack_index))
+        return readEntry(*pack_file, *entry, pack_index);
+
+    return VfsFile::openFile(path);
+}
+
+void Vfs::setChunkCacheCapacity(size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    m_chunk_cache_capacity = capacity;
+    trimChunkCache();
+}
+
+size_t Vfs::getChunkCacheSize() const
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    return m_chunk_cache_size;
+}
+
+void Vfs::clearChunkCache()
+{
+    std::lock_guard<std::mutex> lock(m_cache_mutex);
+    m_chunk_lru.clear();
+    m_chunk_index.clear();
+    m_chunk_cache_size = 0;
+}
+
+Vfs::Stats Vfs::getStats() const
+{
+    Stats stats;
+    stats.files_opened = m_files_opened.load();
+    stats.pack_files_opened = m_pack_files_opened.load();
+    stats.chunk_hits = m_chunk_hits.load();
+    stats.chunk_misses = m_chunk_misses.load();
+    stats.decompressed_bytes = m_decompressed_bytes.load();
+    return stats;
+}
+
+void Vfs::resetStats()
+{
+    m_files_opened = 0;
+    m_pack_files_opened = 0;
+    m_chunk_hits = 0;
+    m_chunk_misses = 0;
+    m_decompressed_bytes = 0;
+}
+
+bool Vfs::find(const std::filesystem::path &path,
+               const PackFile *&pack_file,
+               const pack::EntryRecord *&entry,
+               uint32_t &pack_index) const
+{
+    if (m_packs.empty())
+        return false;
+
+    std::string name = PackFile::normalizePath(path);
+
+    for (uint32_t i = m_packs.size(); i-- > 0;) {
+        entry = m_packs[i]->find(name);
+        if (entry) {
+            pack_file = m_packs[i].get();
+            pack_index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+s_ptr<VfsFile> Vfs::readEntry(const PackFile &pack_file,
+                              const pack::EntryRecord &entry,
+                              uint32_t pack_index)
+{
+    ++m_pack_files_opened;
+
+    std::vector<uint8_t> data(entry.size);
+    if (entry.size == 0)
+        return createShared<VfsFile>(std::move(data));
+
+    uint64_t chunk_size = pack_file.getChunkSize();
+    uint32_t first_chunk = entry.offset / chunk_size;
+    uint32_t chunks_count = (entry.offset + entry.size - 1) / chunk_size - first_chunk + 1;
+
+    auto get_key = [&](uint32_t i) {
+        return (static_cast<uint64_t>(pack_index) << 32) | (first_chunk + i);
+    };
+
+    std::vector<Chunk> chunks(chunks_count);
+    std::vector<uint32_t> missing;
+    {
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+        for (uint32_t i = 0; i < chunks_count; ++i) {
+            chunks[i] = findChunk(get_key(i));
+            if (!chunks[i])
+                missing.push_back(i);
+        }
+    }
+
+    m_chunk_hits += chunks_count - missing.size();
+    m_chunk_misses += missing.size();
+
+    std::atomic<bool> failed{false};
+    auto decompress = [&](int32_t k) {
+        if (failed)
+            return;
+
+        uint32_t index = first_chunk + missing[k];
+        auto chunk = createShared<std::vector<uint8_t>>(pack_file.getChunks()[index].size);
+        if (!pack_file.readChunk(index, chunk->data())) {
+            failed = true;
+            return;
+        }
+        chunks[missing[k]] = chunk;
+    };
+
+    uint64_t missing_size = 0;
+    for (uint32_t i : missing)
+        missing_size += pack_file.getChunks()[first_chunk + i].size;
+
+    // Большие файлы распаковываются по чанку на задачу в общем пуле потоков
+    if (missing.size() > 1 && missing_size >= PARALLEL_DECOMPRESS_SIZE) {
+        JobSystem::getDefault().parallelFor(missing.size(), decompress);
+    } else {
+        for (int32_t k = 0; k < missing.size(); ++k)
+            decompress(k);
+    }
+
+    if (failed)
+        return nullptr;
+
+    if (!missing.empty()) {
+        uint64_t decompressed_bytes = 0;
+        std::lock_guard<std::mutex> lock(m_cache_mutex);
+        for (uint32_t i : missing) {
+            addChunk(get_key(i), chunks[i]);
+            decompressed_bytes += chunks[i]->size();
+        }
+        trimChunkCache();
+        m_decompressed_bytes += decompressed_bytes;
+    }
+
+    uint64_t position = entry.offset;
+    uint64_t end = entry.offset + entry.size;
+    uint8_t *output = data.data();
+    for (uint32_t i = 0; i < chunks_count; ++i) {
+        uint64_t offset = position - static_cast<uint64_t>(first_chunk + i) * chunk_size;
+        uint64_t count = std::min<uint64_t>(chunks[i]->size() - offset, end - position);
+        std::memcpy(output, chunks[i]->data() + offset, count);
+        output += count;
+        position += count;
+    }
+
+    return createShared<VfsFile>(std::move(data));
+}
+
+Vfs::Chunk Vfs::findChunk(uint64_t key)
+{
+    auto found = m_chunk_index.find(key);
+    if (found == m_chunk_index.end())
+        return nullptr;
+
+    m_chunk_lru.splice(m_chunk_lru.begin(), m_chunk_lru, found->second);
+    return found->second->data;
+}
+
+void Vfs::addChunk(uint64_t key, const Chunk &chunk)
+{
+    // Чанк мог распаковать параллельно другой поток
+    if (findChunk(key))
+        return;
+
+    m_chunk_lru.push_front({key, chunk});
+    m_chunk_index.emplace(key, m_chunk_lru.begin());
+    m_chunk_cache_size += chunk->size();
+}
+
+void Vfs::trimChunkCache()
+{
+    while (m_chunk_cache_size > m_chunk_cache_capacity && !m_chunk_lru.empty()) {
+        const auto &oldest = m_chunk_lru.back();
+        m_chunk_cache_size -= oldest.data->size();
+        m_chunk_index.erase(oldest.key);
+        m_chunk_lru.pop_back();
+    }
+}
+
+} // namespace ae
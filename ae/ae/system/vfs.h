@@ -0,0 +1,129 @@
+#ifndef AE_VFS_H
+#define AE_VFS_H
+
+#include "mapped_file.h"
+#include "memory.h"
+#include "pack_file.h"
+
+#include <atomic>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ae {
+
+// Содержимое файла: собранное из чанков пакета или отображенный в память файл с диска
+class VfsFile
+{
+public:
+    explicit VfsFile(std::vector<uint8_t> &&data);
+    explicit VfsFile(u_ptr<MappedFile> &&mapped_file);
+    ~VfsFile() = default;
+
+    // Файл с диска без обращения к пакетам
+    static s_ptr<VfsFile> openFile(const std::filesystem::path &path);
+
+    std::span<const uint8_t> getData() const;
+    size_t getSize() const;
+    std::string getString() const;
+
+    // Массив из count элементов T по смещению offset, пустой при выходе за границы
+    template<typename T>
+    std::span<const T> getSpan(uint64_t offset, uint64_t count) const
+    {
+        if (offset > m_data.size() || count > (m_data.size() - offset) / sizeof(T)
+            || reinterpret_cast<uintptr_t>(m_data.data() + offset) % alignof(T) != 0)
+            return {};
+        return {reinterpret_cast<const T *>(m_data.data() + offset), static_cast<size_t>(count)};
+    }
+
+private:
+    std::vector<uint8_t> m_buffer;
+    u_ptr<MappedFile> m_mapped_file;
+    std::span<const uint8_t> m_data;
+};
+
+// Виртуальная файловая система: файлы ищутся в смонтированных пакетах, затем на диске.
+// Распакованные чанки хранятся в LRU кэше. open потокобезопасен, mount и unmountAll
+// вызываются, когда нет загрузок в других потоках
+class Vfs
+{
+public:
+    struct Stats
+    {
+        int32_t files_opened = 0;
+        int32_t pack_files_opened = 0;
+        int32_t chunk_hits = 0;
+        int32_t chunk_misses = 0;
+        uint64_t decompressed_bytes = 0;
+    };
+
+    static constexpr size_t DEFAULT_CHUNK_CACHE_CAPACITY = 32 * 1024 * 1024;
+    // Меньший объем недостающих чанков распаковывается в вызывающем потоке
+    static constexpr uint64_t PARALLEL_DECOMPRESS_SIZE = 512 * 1024;
+
+    Vfs();
+    Vfs(const Vfs &) = delete;
+    Vfs &operator=(const Vfs &) = delete;
+    ~Vfs() = default;
+
+    // Файлы пакета, смонтированного позже, перекрывают файлы более ранних
+    bool mount(const std::filesystem::path &path);
+    void unmountAll();
+    int32_t getMountedCount() const;
+
+    bool exists(const std::filesystem::path &path) const;
+    s_ptr<VfsFile> open(const std::filesystem::path &path);
+
+    void setChunkCacheCapacity(size_t capacity);
+    size_t getChunkCacheSize() const;
+    void clearChunkCache();
+
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    using Chunk = s_ptr<std::vector<uint8_t>>;
+
+    struct CachedChunk
+    {
+        uint64_t key;
+        Chunk data;
+    };
+
+    bool find(const std::filesystem::path &path,
+              const PackFile *&pack_file,
+              const pack::EntryRecord *&entry,
+              uint32_t &pack_index) const;
+    s_ptr<VfsFile> readEntry(const PackFile &pack_file,
+                             const pack::EntryRecord &entry,
+                             uint32_t pack_index);
+
+    // Вызываются под m_cache_mutex
+    Chunk findChunk(uint64_t key);
+    void addChunk(uint64_t key, const Chunk &chunk);
+    void trimChunkCache();
+
+private:
+    std::vector<u_ptr<PackFile>> m_packs;
+
+    mutable std::mutex m_cache_mutex;
+    std::list<CachedChunk> m_chunk_lru; // В начале - последние использованные
+    std::unordered_map<uint64_t, std::list<CachedChunk>::iterator> m_chunk_index;
+    size_t m_chunk_cache_size;
+    size_t m_chunk_cache_capacity;
+
+    std::atomic<int32_t> m_files_opened;
+    std::atomic<int32_t> m_pack_files_opened;
+    std::atomic<int32_t> m_chunk_hits;
+    std::atomic<int32_t> m_chunk_misses;
+    std::atomic<uint64_t> m_decompressed_bytes;
+};
+
+} // namespace ae
+
+#endif // AE_VFS_H
@@ -3,16 +3,34 @@
 
 namespace ae {
 
+Time Task::takeSuspendTime()
+{
+    Time suspend_time = m_suspend_time;
+    m_suspend_time = Time{};
+    return suspend_time;
+}
+
+void Task::suspend(const Time &delay)
+{
+    m_suspend_time = delay;
+}
+
 DelayTask::DelayTask(const Time &delay)
     : m_remaining{delay}
+    , m_started{false}
 {}
 
 bool DelayTask::update(const Time &dt)
 {
-    if (m_remaining <= dt)
-        return true;
-    m_remaining -= dt;
-    return false;
+    // Оставшееся время задача ждет в колесе таймеров и завершается при пробуждении
+    if (!m_started) {
+        m_started = true;
+        if (m_remaining > dt) {
+            suspend(m_remaining - dt);
+            return false;
+        }
+    }
+    return true;
 }
 
 CallbackTask::CallbackTask(const std::function<void()> &callback)
@@ -29,6 +47,15 @@ bool CallbackTask::update(const Time &)
     return true;
 }
 
+WaitTask::WaitTask(const std::function<bool()> &predicate)
+    : m_predicate{predicate}
+{}
+
+bool WaitTask::update(const Time &)
+{
+    return m_predicate();
+}
+
 void TaskChain::addTask(const s_ptr<Task> &task)
 {
     m_tasks.push(task);
@@ -39,6 +66,8 @@ bool TaskChain::update(const Time &dt)
     if (!m_tasks.empty()) {
         if (m_tasks.front()->update(dt))
             m_tasks.pop();
+        else
+            suspend(m_tasks.front()->takeSuspendTime());
     }
     return m_tasks.empty() ? true : false;
 }
@@ -61,6 +90,8 @@ bool NotifyTaskChain::update(const Time &dt)
             taskFinished.emit(m_current_task, m_total_task);
             ++m_current_task;
             m_tasks.pop();
+        } else {
+            suspend(m_tasks.front()->takeSuspendTime());
         }
     }
     return m_tasks.empty() ? true : false;
@@ -14,10 +14,23 @@ namespace ae {
 class Task : public EnableSharedFromThis<Task>
 {
 public:
+    AE_POOL_ALLOCATED
+
     Task() = default;
     virtual ~Task() = default;
 
     virtual bool update(const Time &dt) = 0; // true = завершена
+
+    // Время, на которое задача просит не вызывать update, и сброс запроса
+    Time takeSuspendTime();
+
+protected:
+    // Вызывается из update: TaskManager уберет задачу в колесо таймеров и вернет через delay,
+    // пока она ждет, update не вызывается
+    void suspend(const Time &delay);
+
+private:
+    Time m_suspend_time;
 };
 
 class DelayTask : public Task
@@ -30,6 +43,7 @@ public:
 
 private:
     Time m_remaining;
+    bool m_started;
 };
 
 class CallbackTask : public Task
@@ -44,6 +58,18 @@ private:
     bool m_done;
 };
 
+// Завершается, когда predicate вернет true
+class WaitTask : public Task
+{
+public:
+    WaitTask(const std::function<bool()> &predicate);
+
+    bool update(const Time &);
+
+private:
+    std::function<bool()> m_predicate;
+};
+
 class TaskChain : public Task
 {
 public:
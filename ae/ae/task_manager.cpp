@@ -2,7 +2,8 @@
 
 namespace ae {
 
-TaskManager::TaskManager()
+TaskManager::TaskManager(const Time &timer_resolution)
+    : m_timers{timer_resolution}
 {
     // Зарезервируем входящий буффер и текущий для задач
     int32_t reserve_tasks_count = 20;
@@ -15,8 +16,18 @@ void TaskManager::run(const s_ptr<Task> &task)
     m_pending_tasks.push_back(task);
 }
 
+TimerWheel::Handle TaskManager::runAfter(const Time &delay,
+                                         const std::function<void()> &callback)
+{
+    return m_timers.schedule(delay, callback);
+}
+
 void TaskManager::update(const Time &dt)
 {
+    // Сработавшие таймеры возвращают приостановленные задачи в m_pending_tasks,
+    // и они обновляются уже в этом тике
+    m_timers.update(dt);
+
     // Добавим новые задачи к текущим
     if (!m_pending_tasks.empty()) {
         if (m_tasks.empty())
@@ -32,9 +43,36 @@ void TaskManager::update(const Time &dt)
     if (!m_tasks.empty()) {
         m_tasks.erase(std::remove_if(m_tasks.begin(),
                                      m_tasks.end(),
-                                     [&](auto &task) { return task->update(dt); }),
+                                     [&](auto &task) {
+                                         if (task->update(dt))
+                                             return true;
+
+                                         Time suspend_time = task->takeSuspendTime();
+                                         if (suspend_time <= Time{})
+                                             return false;
+
+                                         m_timers.schedule(suspend_time, [this, task]() {
+                                             m_pending_tasks.push_back(task);
+                                         });
+                                         return true;
+                                     }),
                       m_tasks.end());
     }
 }
 
+int32_t TaskManager::getTasksCount() const
+{
+    return static_cast<int32_t>(m_tasks.size() + m_pending_tasks.size());
+}
+
+int32_t TaskManager::getFiredTimersCount() const
+{
+    return m_timers.getFiredCount();
+}
+
+int32_t TaskManager::getPendingTimersCount() const
+{
+    return m_timers.getPendingCount();
+}
+
 } // namespace ae
@@ -2,6 +2,7 @@
 #define AE_TASK_MANAGER_H
 
 #include "system/time.h"
+#include "system/timer_wheel.h"
 #include "task.h"
 
 #include <vector>
@@ -11,15 +12,25 @@ namespace ae {
 class TaskManager
 {
 public:
-    TaskManager();
+    // resolution - шаг колеса таймеров, движок передает время тика
+    explicit TaskManager(const Time &timer_resolution);
     ~TaskManager() = default;
 
     void run(const s_ptr<Task> &task);
+    // Вызывает callback через delay. Ожидающие таймеры не стоят ничего на тик
+    TimerWheel::Handle runAfter(const Time &delay, const std::function<void()> &callback);
+
     void update(const Time &dt);
 
+    int32_t getTasksCount() const;
+    // Таймеры, сработавшие за последний update, и ожидающие, включая приостановленные задачи
+    int32_t getFiredTimersCount() const;
+    int32_t getPendingTimersCount() const;
+
 private:
     std::vector<s_ptr<Task>> m_pending_tasks;
     std::vector<s_ptr<Task>> m_tasks;
+    TimerWheel m_timers;
 };
 
 } // namespace ae
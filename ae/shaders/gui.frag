@@ -6,10 +6,18 @@ in VS_OUT {
 } fs_in;
 
 uniform sampler2D u_texture;
+uniform bool u_sdf; // в альфа-канале поле расстояний, граница глифа на 0.5
 
 out vec4 fragColor;
 
 void main()
 {
-    fragColor = fs_in.color * texture(u_texture, fs_in.texCoords);
+    vec4 texel = texture(u_texture, fs_in.texCoords);
+
+    if (u_sdf) {
+        float width = fwidth(texel.a);
+        texel.a = smoothstep(0.5 - width, 0.5 + width, texel.a);
+    }
+
+    fragColor = fs_in.color * texel;
 }
@@ -0,0 +1,228 @@
+#include <ae/graphics/scene/mesh_optimizer.h>
+
+#include "test.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+using namespace ae;
+
+namespace {
+
+using TrianglePositions = std::array<float, 9>;
+
+// Сетка size x size квадратов без общих вершин: у каждого треугольника свои три вершины
+void makeGridSoup(int32_t size, std::vector<Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+    vertices.clear();
+    indices.clear();
+
+    auto add_vertex = [&](int32_t x, int32_t y) {
+        Vertex vertex;
+        vertex.position = vec3{static_cast<float>(x), static_cast<float>(y), 0.0f};
+        vertex.normal = vec3{0.0f, 0.0f, 1.0f};
+        vertex.tex_coords = vec2{static_cast<float>(x) / size, static_cast<float>(y) / size};
+        indices.push_back(vertices.size());
+        vertices.push_back(vertex);
+    };
+
+    for (int32_t y = 0; y < size; ++y) {
+        for (int32_t x = 0; x < size; ++x) {
+            add_vertex(x, y);
+            add_vertex(x + 1, y);
+            add_vertex(x + 1, y + 1);
+
+            add_vertex(x, y);
+            add_vertex(x + 1, y + 1);
+            add_vertex(x, y + 1);
+        }
+    }
+}
+
+// Перемешивает треугольники детерминированно, чтобы кэшу вершин было что улучшать
+void shuffleTriangles(std::vector<uint32_t> &indices)
+{
+    uint32_t state = 12345;
+    int32_t triangle_count = indices.size() / 3;
+    for (int32_t t = triangle_count - 1; t > 0; --t) {
+        state = state * 1664525u + 1013904223u;
+        int32_t other = state % (t + 1);
+        for (int32_t k = 0; k < 3; ++k)
+            std::swap(indices[t * 3 + k], indices[other * 3 + k]);
+    }
+}
+
+// Треугольники как позиции вершин, начиная с наименьшей (обход сохраняется), в порядке сортировки
+std::vector<TrianglePositions> getTriangles(const std::vector<Vertex> &vertices,
+                                            const std::vector<uint32_t> &indices)
+{
+    std::vector<TrianglePositions> triangles;
+    for (int32_t t = 0; t < indices.size() / 3; ++t) {
+        std::array<std::array<float, 3>, 3> corners;
+        for (int32_t k = 0; k < 3; ++k) {
+            const auto &position = vertices[indices[t * 3 + k]].position;
+            corners[k] = {position.x, position.y, position.z};
+        }
+
+        auto first = std::min_element(corners.begin(), corners.end()) - corners.begin();
+        TrianglePositions triangle;
+        for (int32_t k = 0; k < 3; ++k)
+            std::copy(corners[(first + k) % 3].begin(),
+                      corners[(first + k) % 3].end(),
+                      triangle.begin() + k * 3);
+        triangles.push_back(triangle);
+    }
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+bool indicesValid(const std::vector<uint32_t> &indices, size_t vertex_count)
+{
+    return std::all_of(indices.begin(), indices.end(), [&](uint32_t index) {
+        return index < vertex_count;
+    });
+}
+
+void testWeldExact()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    makeGridSoup(8, vertices, indices);
+    auto triangles = getTriangles(vertices, indices);
+
+    int32_t count = mesh_optimizer::weldVertices(vertices, indices);
+
+    AE_CHECK(count == 9 * 9);
+    AE_CHECK(vertices.size() == 9 * 9);
+    AE_CHECK(indicesValid(indices, vertices.size()));
+    AE_CHECK(getTriangles(vertices, indices) == triangles);
+}
+
+void testWeldEpsilon()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    makeGridSoup(8, vertices, indices);
+
+    // Копии одной вершины расходятся меньше чем на epsilon / 2
+    for (int32_t i = 0; i < vertices.size(); ++i)
+        vertices[i].position.z += (i % 3) * 1e-5f;
+
+    auto exact_vertices = vertices;
+    auto exact_indices = indices;
+    mesh_optimizer::weldVertices(exact_vertices, exact_indices);
+    AE_CHECK(exact_vertices.size() > 9 * 9);
+
+    mesh_optimizer::weldVertices(vertices, indices, 1e-3f);
+    AE_CHECK(vertices.size() == 9 * 9);
+    AE_CHECK(indicesValid(indices, vertices.size()));
+}
+
+void testVertexCache()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    makeGridSoup(32, vertices, indices);
+    mesh_optimizer::weldVertices(vertices, indices);
+    shuffleTriangles(indices);
+
+    auto triangles = getTriangles(vertices, indices);
+    float acmr_before = mesh_optimizer::calculateACMR(indices, vertices.size());
+
+    std::vector<uint32_t> clusters;
+    mesh_optimizer::optimizeVertexCache(indices,
+                                        vertices.size(),
+                                        mesh_optimizer::DEFAULT_CACHE_SIZE,
+                                        &clusters);
+
+    AE_CHECK(indices.size() == triangles.size() * 3);
+    AE_CHECK(getTriangles(vertices, indices) == triangles);
+    AE_CHECK(mesh_optimizer::calculateACMR(indices, vertices.size()) <= acmr_before);
+    AE_CHECK(!clusters.empty() && clusters.front() == 0);
+}
+
+void testVertexFetch()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    makeGridSoup(8, vertices, indices);
+    mesh_optimizer::weldVertices(vertices, indices);
+    shuffleTriangles(indices);
+
+    // Вершины, на которые не ссылается ни один индекс
+    size_t used_count = vertices.size();
+    std::vector<Vertex> with_unused;
+    std::vector<uint32_t> remap(vertices.size());
+    for (int32_t i = 0; i < vertices.size(); ++i) {
+        if (i % 8 == 0) {
+            Vertex unused;
+            unused.position = vec3{100.0f + i};
+            with_unused.push_back(unused);
+        }
+        remap[i] = with_unused.size();
+        with_unused.push_back(vertices[i]);
+    }
+    vertices = std::move(with_unused);
+    for (auto &index : indices)
+        index = remap[index];
+
+    auto triangles = getTriangles(vertices, indices);
+
+    int32_t count = mesh_optimizer::optimizeVertexFetch(vertices, indices);
+
+    AE_CHECK(count == used_count);
+    AE_CHECK(vertices.size() == used_count);
+    AE_CHECK(indicesValid(indices, vertices.size()));
+    AE_CHECK(getTriangles(vertices, indices) == triangles);
+
+    // Вершины идут в порядке первого обращения
+    uint32_t next = 0;
+    bool ordered = true;
+    for (uint32_t index : indices) {
+        if (index > next)
+            ordered = false;
+        if (index == next)
+            ++next;
+    }
+    AE_CHECK(ordered);
+}
+
+void testDeterministic()
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    makeGridSoup(24, vertices, indices);
+    shuffleTriangles(indices);
+
+    auto first_vertices = vertices;
+    auto first_indices = indices;
+    auto first_stats = mesh_optimizer::optimize(first_vertices, first_indices);
+
+    auto second_vertices = vertices;
+    auto second_indices = indices;
+    auto second_stats = mesh_optimizer::optimize(second_vertices, second_indices);
+
+    AE_CHECK(first_indices == second_indices);
+    AE_CHECK(first_vertices.size() == second_vertices.size());
+    AE_CHECK(std::memcmp(first_vertices.data(),
+                         second_vertices.data(),
+                         first_vertices.size() * sizeof(Vertex))
+             == 0);
+    AE_CHECK(first_stats.acmr_after == second_stats.acmr_after);
+    AE_CHECK(first_stats.acmr_after <= first_stats.acmr_before);
+}
+
+} // namespace
+
+int main()
+{
+    testWeldExact();
+    testWeldEpsilon();
+    testVertexCache();
+    testVertexFetch();
+    testDeterministic();
+
+    return test::result();
+}
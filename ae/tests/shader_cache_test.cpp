@@ -0,0 +1,260 @@
+#include <ae/graphics/core/default_shaders.h>
+#include <ae/graphics/core/shader.h>
+#include <ae/graphics/core/shader_cache.h>
+
+#include "test.h"
+
+#include <algorithm>
+#include <map>
+
+using namespace ae;
+
+namespace {
+
+// Драйвер без GL: "программа" - номер, ее образ - байты, из которых она собрана.
+// Состояние общее, чтобы тест мог менять драйвер после передачи бэкенда в кэш
+struct MockDriver
+{
+    std::string info = "vendor|renderer|1.0";
+    bool reject_binaries = false;
+    uint32_t next_program = 1;
+    std::map<uint32_t, std::vector<uint8_t>> programs;
+    int32_t created_from_binary = 0;
+
+    uint32_t compile(const std::string &source)
+    {
+        uint32_t program = next_program++;
+        programs[program] = std::vector<uint8_t>(source.begin(), source.end());
+        return program;
+    }
+};
+
+class MockBackend : public ShaderCache::Backend
+{
+public:
+    static constexpr uint32_t FORMAT = 42;
+
+    explicit MockBackend(MockDriver &driver)
+        : m_driver{driver}
+    {}
+
+    bool isSupported() const override { return true; }
+
+    std::string getDriverInfo() const override { return m_driver.info; }
+
+    void setRetrievable(uint32_t) const override {}
+
+    bool getProgramBinary(uint32_t program,
+                          uint32_t &format,
+                          std::vector<uint8_t> &binary) const override
+    {
+        auto found = m_driver.programs.find(program);
+        if (found == m_driver.programs.end())
+            return false;
+
+        format = FORMAT;
+        binary = found->second;
+        return true;
+    }
+
+    uint32_t createProgram(uint32_t format, std::span<const uint8_t> binary) const override
+    {
+        if (m_driver.reject_binaries || format != FORMAT)
+            return 0;
+
+        uint32_t program = m_driver.next_program++;
+        m_driver.programs[program] = std::vector<uint8_t>(binary.begin(), binary.end());
+        ++m_driver.created_from_binary;
+        return program;
+    }
+
+private:
+    MockDriver &m_driver;
+};
+
+// Отдельный каталог на каждый тест, удаляется в деструкторе
+struct TempDirectory
+{
+    std::filesystem::path path;
+
+    explicit TempDirectory(const std::string &name)
+        : path{std::filesystem::temp_directory_path() / ("ae_shader_cache_test_" + name)}
+    {
+        std::filesystem::remove_all(path);
+    }
+
+    ~TempDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(path, error);
+    }
+};
+
+int32_t countFiles(const std::filesystem::path &directory)
+{
+    auto iterator = std::filesystem::directory_iterator(directory);
+    return std::distance(begin(iterator), end(iterator));
+}
+
+// Как Shader::loadProgram: программа из кэша, иначе сборка из исходников и сохранение
+uint32_t loadOrCompile(ShaderCache &cache, MockDriver &driver, const std::vector<std::string> &sources)
+{
+    uint64_t key = cache.getKey(sources);
+
+    uint32_t program = cache.load(key);
+    if (program != 0)
+        return program;
+
+    std::string source;
+    for (const auto &stage : sources)
+        source += stage;
+
+    program = driver.compile(source);
+    cache.store(key, program);
+    return program;
+}
+
+void testHitAfterStore()
+{
+    TempDirectory directory("hit");
+    MockDriver driver;
+    ShaderCache cache(createUnique<MockBackend>(driver));
+    AE_CHECK(cache.open(directory.path));
+
+    std::vector<std::string> sources = {"0", "void main() {}"};
+    uint32_t compiled = loadOrCompile(cache, driver, sources);
+    uint32_t loaded = loadOrCompile(cache, driver, sources);
+
+    AE_CHECK(compiled != 0 && loaded != 0 && compiled != loaded);
+    AE_CHECK(driver.programs[compiled] == driver.programs[loaded]);
+    AE_CHECK(cache.getStats().misses == 1);
+    AE_CHECK(cache.getStats().hits == 1);
+    AE_CHECK(cache.getStats().stored == 1);
+    AE_CHECK(driver.created_from_binary == 1);
+}
+
+void testIncludeChange()
+{
+    // Ключ считается по исходнику после подстановки #include, поэтому он
+    // зависит от текста включаемого файла, а не только от его имени
+    std::string fragment = DefaultShaders::getShaderSource("shaders/main.frag");
+    std::string light = DefaultShaders::getShaderSource("shaders/light.inc");
+    AE_CHECK(!fragment.empty() && !light.empty());
+
+    std::string preprocessed = Shader::preprocessor(fragment);
+    AE_CHECK(preprocessed.find("#include") == std::string::npos);
+    AE_CHECK(preprocessed.find(light) != std::string::npos);
+
+    std::string changed = preprocessed;
+    changed.replace(changed.find(light), light.size(), light + "\n// changed\n");
+
+    TempDirectory directory("include");
+    MockDriver driver;
+    ShaderCache cache(createUnique<MockBackend>(driver));
+    AE_CHECK(cache.open(directory.path));
+
+    std::vector<std::string> before = {"1", preprocessed};
+    std::vector<std::string> after = {"1", changed};
+    AE_CHECK(cache.getKey(before) == cache.getKey(before));
+    AE_CHECK(cache.getKey(before) != cache.getKey(after));
+
+    loadOrCompile(cache, driver, before);
+    loadOrCompile(cache, driver, after);
+    AE_CHECK(cache.getStats().hits == 0);
+    AE_CHECK(cache.getStats().misses == 2);
+
+    // Границы стадий тоже входят в ключ
+    AE_CHECK(cache.getKey(std::vector<std::string>{"ab", "c"})
+             != cache.getKey(std::vector<std::string>{"a", "bc"}));
+}
+
+void testDriverChange()
+{
+    TempDirectory directory("driver");
+    MockDriver driver;
+    std::vector<std::string> sources = {"0", "void main() {}"};
+
+    uint64_t old_key = 0;
+    {
+        ShaderCache cache(createUnique<MockBackend>(driver));
+        AE_CHECK(cache.open(directory.path));
+        old_key = cache.getKey(sources);
+        loadOrCompile(cache, driver, sources);
+        AE_CHECK(cache.getStats().stored == 1);
+    }
+
+    driver.info = "vendor|renderer|2.0";
+
+    ShaderCache cache(createUnique<MockBackend>(driver));
+    AE_CHECK(cache.open(directory.path));
+    AE_CHECK(cache.getKey(sources) != old_key);
+
+    loadOrCompile(cache, driver, sources);
+    AE_CHECK(cache.getStats().hits == 0);
+    AE_CHECK(cache.getStats().misses == 1);
+    AE_CHECK(driver.created_from_binary == 0);
+
+    // Образ старого драйвера не трогается, рядом появляется новый
+    AE_CHECK(countFiles(directory.path) == 2);
+}
+
+void testRejectedBinary()
+{
+    TempDirectory directory("rejected");
+    MockDriver driver;
+    ShaderCache cache(createUnique<MockBackend>(driver));
+    AE_CHECK(cache.open(directory.path));
+
+    std::vector<std::string> sources = {"0", "void main() {}"};
+    uint32_t first = loadOrCompile(cache, driver, sources);
+    AE_CHECK(countFiles(directory.path) == 1);
+
+    // Драйвер не принимает образ: программа собирается из исходников, файл перезаписывается
+    driver.reject_binaries = true;
+    uint32_t second = loadOrCompile(cache, driver, sources);
+    AE_CHECK(second != 0 && second != first);
+    AE_CHECK(cache.getStats().rejected == 1);
+    AE_CHECK(cache.getStats().hits == 0);
+    AE_CHECK(cache.getStats().stored == 2);
+    AE_CHECK(driver.created_from_binary == 0);
+    AE_CHECK(countFiles(directory.path) == 1);
+
+    driver.reject_binaries = false;
+    uint32_t third = loadOrCompile(cache, driver, sources);
+    AE_CHECK(third != 0);
+    AE_CHECK(cache.getStats().hits == 1);
+    AE_CHECK(driver.created_from_binary == 1);
+}
+
+void testCorruptedFile()
+{
+    TempDirectory directory("corrupted");
+    MockDriver driver;
+    ShaderCache cache(createUnique<MockBackend>(driver));
+    AE_CHECK(cache.open(directory.path));
+
+    std::vector<std::string> sources = {"0", "void main() {}"};
+    loadOrCompile(cache, driver, sources);
+
+    // Обрезанный файл не доходит до драйвера
+    for (const auto &entry : std::filesystem::directory_iterator(directory.path))
+        std::filesystem::resize_file(entry.path(), 8);
+
+    AE_CHECK(cache.load(cache.getKey(sources)) == 0);
+    AE_CHECK(cache.getStats().rejected == 1);
+    AE_CHECK(driver.created_from_binary == 0);
+    AE_CHECK(countFiles(directory.path) == 0);
+}
+
+} // namespace
+
+int main()
+{
+    testHitAfterStore();
+    testIncludeChange();
+    testDriverChange();
+    testRejectedBinary();
+    testCorruptedFile();
+
+    return test::result();
+}
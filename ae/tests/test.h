@@ -0,0 +1,29 @@
+#ifndef AE_TESTS_TEST_H
+#define AE_TESTS_TEST_H
+
+#include <cstdio>
+
+// Проверки без фреймворка: тест - отдельная программа, провал печатается
+// и дает ненулевой код возврата для ctest
+namespace ae::test {
+
+inline int failures = 0;
+
+inline int result()
+{
+    if (failures > 0)
+        std::printf("%d check(s) failed\n", failures);
+    return failures > 0 ? 1 : 0;
+}
+
+} // namespace ae::test
+
+#define AE_CHECK(expr)                                                                   \
+    do {                                                                                 \
+        if (!(expr)) {                                                                   \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr);        \
+            ++ae::test::failures;                                                        \
+        }                                                                                \
+    } while (false)
+
+#endif // AE_TESTS_TEST_H
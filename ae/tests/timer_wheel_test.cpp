@@ -0,0 +1,201 @@
+#include <ae/system/timer_wheel.h>
+
+#include "test.h"
+
+#include <random>
+#include <vector>
+
+using namespace ae;
+
+namespace {
+
+// Таймер, который запоминает шаг срабатывания
+struct Record
+{
+    uint64_t expected = 0;
+    uint64_t fired_at = 0;
+    int32_t fired = 0;
+    bool cancelled = false;
+};
+
+void testExactTicks()
+{
+    TimerWheel wheel(milliseconds(1));
+    uint64_t now = 0;
+
+    // Задержки на всех уровнях, на границах ячеек и дальше 2^24 шагов
+    std::vector<uint64_t> delays = {1, 2, 63, 64, 65, 4095, 4096, 4097, 262143, 262144,
+                                    (1 << 24) - 1, 1 << 24, (1 << 24) + 1, (1 << 25) + 12345};
+    std::mt19937_64 random{3};
+    for (int32_t i = 0; i < 2000; ++i)
+        delays.push_back(1 + random() % (i % 4 == 0 ? (1 << 20) : 5000));
+
+    std::vector<Record> records(delays.size());
+    for (size_t i = 0; i < delays.size(); ++i) {
+        records[i].expected = delays[i];
+        wheel.scheduleTicks(delays[i], [&, i]() {
+            records[i].fired_at = now;
+            ++records[i].fired;
+        });
+    }
+    AE_CHECK(wheel.getPendingCount() == static_cast<int32_t>(delays.size()));
+
+    uint64_t last = (1 << 25) + 12345;
+    while (now < last) {
+        ++now;
+        wheel.advance();
+    }
+
+    int32_t wrong = 0;
+    for (const auto &record : records) {
+        if (record.fired != 1 || record.fired_at != record.expected)
+            ++wrong;
+    }
+    AE_CHECK(wrong == 0);
+    AE_CHECK(wheel.getPendingCount() == 0);
+}
+
+void testCancel()
+{
+    TimerWheel wheel(milliseconds(1));
+    uint64_t now = 0;
+
+    std::mt19937_64 random{5};
+    std::vector<Record> records(5000);
+    std::vector<TimerWheel::Handle> handles;
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].expected = 1 + random() % 20000;
+        handles.push_back(wheel.scheduleTicks(records[i].expected, [&, i]() {
+            records[i].fired_at = now;
+            ++records[i].fired;
+        }));
+    }
+
+    for (size_t i = 0; i < records.size(); i += 3) {
+        AE_CHECK(handles[i].isPending());
+        handles[i].cancel();
+        records[i].cancelled = true;
+        AE_CHECK(!handles[i].isPending());
+    }
+    // Повторная отмена ничего не делает
+    handles[0].cancel();
+    AE_CHECK(wheel.getPendingCount() == static_cast<int32_t>(records.size() - (records.size() + 2) / 3));
+
+    // Новые таймеры занимают освобожденные места, но старые ссылки не оживляют
+    std::vector<TimerWheel::Handle> reused;
+    for (size_t i = 0; i < records.size(); ++i)
+        reused.push_back(wheel.scheduleTicks(10, []() {}));
+    for (size_t i = 0; i < records.size(); i += 3) {
+        AE_CHECK(!handles[i].isPending());
+        handles[i].cancel();
+    }
+    for (auto &handle : reused) {
+        AE_CHECK(handle.isPending());
+        handle.cancel();
+    }
+
+    while (now < 20000) {
+        ++now;
+        wheel.advance();
+    }
+    AE_CHECK(wheel.getPendingCount() == 0);
+
+    int32_t wrong = 0;
+    for (size_t i = 0; i < records.size(); ++i) {
+        const auto &record = records[i];
+        if (record.cancelled ? record.fired != 0
+                             : record.fired != 1 || record.fired_at != record.expected)
+            ++wrong;
+
+        // После срабатывания ссылка недействительна, отмена безопасна
+        AE_CHECK(!handles[i].isPending());
+        handles[i].cancel();
+    }
+    AE_CHECK(wrong == 0);
+
+    AE_CHECK(!TimerWheel::Handle{}.isPending());
+}
+
+void testCallbackChanges()
+{
+    TimerWheel wheel(milliseconds(1));
+    uint64_t now = 0;
+
+    // Порядок таймеров одного шага не задан: оба пытаются отменить друг друга,
+    // срабатывает ровно один
+    TimerWheel::Handle first;
+    TimerWheel::Handle second;
+    TimerWheel::Handle later;
+    int32_t same_tick_fired = 0;
+    int32_t later_fired = 0;
+    std::vector<uint64_t> chain;
+
+    // Колбэк отменяет таймеры и ставит новые, в том числе на следующий шаг
+    auto cancel_others = [&]() {
+        ++same_tick_fired;
+        first.cancel();
+        second.cancel();
+        later.cancel();
+        wheel.scheduleTicks(1, [&]() {
+            chain.push_back(now);
+            wheel.scheduleTicks(5000, [&]() { chain.push_back(now); });
+        });
+    };
+    first = wheel.scheduleTicks(100, cancel_others);
+    second = wheel.scheduleTicks(100, cancel_others);
+    later = wheel.scheduleTicks(200, [&]() { ++later_fired; });
+
+    for (int32_t i = 0; i < 6000; ++i) {
+        ++now;
+        wheel.advance();
+    }
+
+    AE_CHECK(same_tick_fired == 1);
+    AE_CHECK(later_fired == 0);
+    AE_CHECK(chain.size() == 2 && chain[0] == 101 && chain[1] == 5101);
+    AE_CHECK(wheel.getPendingCount() == 0);
+}
+
+void testUpdate()
+{
+    TimerWheel wheel(milliseconds(10));
+
+    // Задержка округляется вверх до шага, нулевая - до одного шага
+    AE_CHECK(wheel.getTicks(Time{}) == 1);
+    AE_CHECK(wheel.getTicks(milliseconds(10)) == 1);
+    AE_CHECK(wheel.getTicks(milliseconds(11)) == 2);
+    AE_CHECK(wheel.getTicks(seconds(1.0f)) == 100);
+
+    int32_t next_tick = 0;
+    wheel.scheduleTicks(0, [&]() { ++next_tick; });
+    wheel.advance();
+    AE_CHECK(next_tick == 1);
+
+    int32_t fired = 0;
+    wheel.schedule(milliseconds(25), [&]() { ++fired; });
+    wheel.schedule(milliseconds(30), [&]() { ++fired; });
+    wheel.schedule(milliseconds(100), [&]() { ++fired; });
+
+    // Остаток dt копится между вызовами
+    wheel.update(milliseconds(15));
+    AE_CHECK(fired == 0 && wheel.getFiredCount() == 0);
+    wheel.update(milliseconds(15));
+    AE_CHECK(fired == 2 && wheel.getFiredCount() == 2);
+    wheel.update(milliseconds(5));
+    AE_CHECK(wheel.getFiredCount() == 0);
+    wheel.update(milliseconds(65));
+    AE_CHECK(fired == 3 && wheel.getFiredCount() == 1);
+    AE_CHECK(wheel.getPendingCount() == 0);
+}
+
+} // namespace
+
+int main()
+{
+    testExactTicks();
+    testCancel();
+    testCallbackChanges();
+    testUpdate();
+
+    return test::result();
+}
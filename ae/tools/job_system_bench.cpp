@@ -0,0 +1,165 @@
+#include <ae/system/clock.h>
+#include <ae/system/job_system.h>
+#include <ae/system/log.h>
+
+#include <algorithm>
+#include <cmath>
+#include <execution>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace ae;
+
+// Сравнение JobSystem::parallelFor с std::execution на одинаковой работе
+//
+//   ae_job_system_bench [threads]
+//
+// flat   - крупные итерации, где решает только распределение по ядрам
+// fine   - мелкие итерации: видно цену std::function на итерацию и пользу grain_size
+// nested - внешний параллельный цикл с внутренним: std::execution раздает вложенные
+//          циклы своему пулу, JobSystem выполняет их теми же потоками
+//
+// На каждый вариант - лучшее время из нескольких повторов. Результаты сверяются
+// с последовательным проходом. libstdc++ выполняет политики std::execution
+// параллельно только с TBB, без нее строка par_unseq показывает последовательное время
+
+namespace {
+
+constexpr int32_t REPEATS = 5;
+
+struct Workload
+{
+    const char *name;
+    int32_t outer;
+    int32_t inner;
+    int32_t iterations;
+    int32_t grain_size;
+};
+
+float work(int32_t index, int32_t iterations)
+{
+    float value = static_cast<float>(index % 1024);
+    for (int32_t i = 0; i < iterations; ++i)
+        value = std::sqrt(value * value + 1.0f) * 0.5f;
+    return value;
+}
+
+template<typename Func>
+Time best(Func func)
+{
+    Time result;
+    for (int32_t i = 0; i < REPEATS; ++i) {
+        Clock clock;
+        func();
+        Time time = clock.getElapsedTime();
+        if (i == 0 || time < result)
+            result = time;
+    }
+    return result;
+}
+
+double checksum(const std::vector<float> &values)
+{
+    return std::accumulate(values.begin(), values.end(), 0.0);
+}
+
+bool runWorkload(JobSystem &job_system, const Workload &workload)
+{
+    int32_t count = workload.outer * workload.inner;
+    std::vector<float> values(count);
+    std::vector<int32_t> outer_indices(workload.outer);
+    std::vector<int32_t> inner_indices(workload.inner);
+    std::iota(outer_indices.begin(), outer_indices.end(), 0);
+    std::iota(inner_indices.begin(), inner_indices.end(), 0);
+
+    auto store = [&](int32_t outer, int32_t inner) {
+        int32_t index = outer * workload.inner + inner;
+        values[index] = work(index, workload.iterations);
+    };
+
+    Time sequential = best([&]() {
+        for (int32_t outer = 0; outer < workload.outer; ++outer) {
+            for (int32_t inner = 0; inner < workload.inner; ++inner)
+                store(outer, inner);
+        }
+    });
+    double expected = checksum(values);
+
+    bool valid = true;
+    auto report = [&](const char *variant, Time time) {
+        double sum = checksum(values);
+        if (sum != expected) {
+            l_error("{} {}: checksum {} != {}", workload.name, variant, sum, expected);
+            valid = false;
+        }
+        l_info("{:<7} {:<24} {:>9.2f} ms  x{:.2f}",
+               workload.name,
+               variant,
+               time.asMicroseconds() / 1000.0f,
+               time.asMicroseconds() > 0 ? sequential / time : 0.0f);
+        std::fill(values.begin(), values.end(), 0.0f);
+    };
+
+    report("sequential", sequential);
+
+    report("std::execution::par_unseq", best([&]() {
+               std::for_each(std::execution::par_unseq,
+                             outer_indices.begin(),
+                             outer_indices.end(),
+                             [&](int32_t outer) {
+                                 std::for_each(std::execution::par_unseq,
+                                               inner_indices.begin(),
+                                               inner_indices.end(),
+                                               [&](int32_t inner) { store(outer, inner); });
+                             });
+           }));
+
+    report("JobSystem grain 1", best([&]() {
+               job_system.parallelFor(workload.outer, [&](int32_t outer) {
+                   job_system.parallelFor(workload.inner,
+                                          [&](int32_t inner) { store(outer, inner); });
+               });
+           }));
+
+    std::string grain_name = "JobSystem grain " + std::to_string(workload.grain_size);
+    report(grain_name.c_str(), best([&]() {
+               job_system.parallelFor(workload.outer, [&](int32_t outer) {
+                   job_system.parallelFor(workload.inner,
+                                          workload.grain_size,
+                                          [&](int32_t inner) { store(outer, inner); });
+               });
+           }));
+
+    return valid;
+}
+
+} // namespace
+
+int32_t main(int32_t argc, char *argv[])
+{
+    int32_t threads_count = argc > 1 ? std::stoi(argv[1]) : 0;
+    JobSystem job_system(threads_count);
+
+    l_info("JobSystem: {} worker threads, {} repeats", job_system.getThreadsCount(), REPEATS);
+
+    // outer = 1 - одиночный цикл, внешний parallelFor выполняется в вызывающем потоке
+    const Workload workloads[] = {{"flat", 1, 1 << 16, 512, 64},
+                                  {"fine", 1, 1 << 22, 1, 4096},
+                                  {"nested", 64, 1 << 14, 16, 256}};
+
+    bool valid = true;
+    for (const auto &workload : workloads) {
+        job_system.resetStats();
+        valid = runWorkload(job_system, workload) && valid;
+
+        auto stats = job_system.getStats();
+        l_info("{:<7} jobs {}, steals {}, idle {:.2f} ms",
+               workload.name,
+               stats.jobs_run,
+               stats.steals,
+               stats.idle_time_us / 1000.0f);
+    }
+
+    return valid ? 0 : 1;
+}
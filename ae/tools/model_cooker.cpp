@@ -0,0 +1,87 @@
+#include <ae/graphics/scene/assimp_helper.h>
+#include <ae/graphics/scene/cooked_model_helper.h>
+#include <ae/system/clock.h>
+#include <ae/system/log.h>
+
+#include <string_view>
+
+using namespace ae;
+
+// Конвертер моделей в формат .aemodel
+//
+//   ae_model_cooker <source> [destination] [--compare]
+//
+// --compare: после записи сравнивает время загрузки исходной модели через assimp
+// и приготовленной модели (без учета загрузки в GL)
+
+namespace {
+
+template<typename Helper>
+Time measureLoad(const std::filesystem::path &path, int32_t count)
+{
+    Time total;
+
+    for (int32_t i = 0; i < count; ++i) {
+        Clock clock;
+
+        Helper helper{path};
+        helper.defer_upload = true;
+        helper.default_diffuse_texture = createShared<Texture>();
+        helper.default_specular_texture = createShared<Texture>();
+
+        Model model;
+        if (!helper.load(&model))
+            return Time{};
+
+        total += clock.getElapsedTime();
+    }
+
+    return total / static_cast<int64_t>(count);
+}
+
+} // namespace
+
+int32_t main(int32_t argc, char *argv[])
+{
+    std::filesystem::path source;
+    std::filesystem::path destination;
+    bool compare = false;
+
+    for (int32_t i = 1; i < argc; ++i) {
+        std::string_view arg{argv[i]};
+        if (arg == "--compare")
+            compare = true;
+        else if (source.empty())
+            source = arg;
+        else if (destination.empty())
+            destination = arg;
+    }
+
+    if (source.empty()) {
+        l_error("Usage: ae_model_cooker <source> [destination] [--compare]");
+        return 1;
+    }
+
+    if (destination.empty()) {
+        destination = source;
+        destination.replace_extension(cooked_model::EXTENSION);
+    }
+
+    if (!CookedModelHelper::cook(source, destination))
+        return 1;
+
+    if (compare) {
+        constexpr int32_t count = 5;
+
+        Time assimp_time = measureLoad<AssimpHelper>(source, count);
+        Time cooked_time = measureLoad<CookedModelHelper>(destination, count);
+
+        l_info("Load time (average of {}): assimp {} ms, cooked {} ms, x{:.1f}",
+               count,
+               assimp_time.asMicroseconds() / 1000.0f,
+               cooked_time.asMicroseconds() / 1000.0f,
+               cooked_time.asMicroseconds() > 0 ? assimp_time / cooked_time : 0.0f);
+    }
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <ae/system/clock.h>
+#include <ae/system/log.h>
+#include <ae/system/vfs.h>
+
+#include <string_view>
+
+using namespace ae;
+
+// Упаковка файлов в .aepack и замер скорости чтения
+//
+//   ae_packer <destination.aepack> <file or directory>...
+//   ae_packer --bench <pack.aepack>
+//
+// Имена файлов в пакете - пути в том виде, в котором они переданы (относительно
+// текущей директории), поэтому упаковывать нужно из той же директории, из которой
+// запускается игра.
+//
+// --bench: чтение всех файлов пакета с пустым кэшем чанков (cold), повторное чтение
+// с заполненным кэшем (warm) и чтение тех же файлов с диска, если они есть (loose).
+// Страничный кэш ОС не сбрасывается, для честного холодного замера его нужно
+// очистить вручную
+
+namespace {
+
+struct BenchResult
+{
+    Time time;
+    uint64_t bytes = 0;
+    int32_t files = 0;
+    uint8_t checksum = 0;
+};
+
+template<typename Open>
+BenchResult readAll(const PackFile &pack_file, Open open)
+{
+    BenchResult result;
+    Clock clock;
+
+    for (const auto &entry : pack_file.getEntries()) {
+        auto file = open(std::string{pack_file.getName(entry)});
+        if (!file)
+            continue;
+
+        // Обращение ко всем байтам, чтобы отображенные файлы действительно прочитались
+        for (uint8_t value : file->getData())
+            result.checksum ^= value;
+
+        result.bytes += file->getSize();
+        ++result.files;
+    }
+
+    result.time = clock.getElapsedTime();
+    return result;
+}
+
+void logResult(const char *name, const BenchResult &result)
+{
+    float seconds = result.time.asSeconds();
+    l_info("{:>5}: {} files, {} KiB in {:.2f} ms, {:.1f} MiB/s",
+           name,
+           result.files,
+           result.bytes / 1024,
+           result.time.asMicroseconds() / 1000.0f,
+           seconds > 0.0f ? result.bytes / (1024.0f * 1024.0f) / seconds : 0.0f);
+}
+
+int32_t bench(const std::filesystem::path &path)
+{
+    Clock clock;
+    Vfs vfs;
+    if (!vfs.mount(path))
+        return 1;
+    Time mount_time = clock.getElapsedTime();
+
+    PackFile pack_file;
+    if (!pack_file.open(path))
+        return 1;
+
+    // Кэш вмещает весь пакет, чтобы второй проход не распаковывал ничего
+    uint64_t stream_size = 0;
+    for (const auto &chunk : pack_file.getChunks())
+        stream_size += chunk.size;
+    vfs.setChunkCacheCapacity(stream_size);
+
+    auto open_vfs = [&](const std::string &name) { return vfs.open(name); };
+
+    l_info("Mount: {:.2f} ms", mount_time.asMicroseconds() / 1000.0f);
+
+    auto cold = readAll(pack_file, open_vfs);
+    logResult("cold", cold);
+
+    auto warm = readAll(pack_file, open_vfs);
+    logResult("warm", warm);
+
+    auto stats = vfs.getStats();
+    l_info("Chunks: {} hits, {} misses, {} KiB decompressed",
+           stats.chunk_hits,
+           stats.chunk_misses,
+           stats.decompressed_bytes / 1024);
+
+    auto loose = readAll(pack_file, [](const std::string &name) -> s_ptr<VfsFile> {
+        std::error_code error;
+        if (!std::filesystem::is_regular_file(name, error))
+            return nullptr;
+        return VfsFile::openFile(name);
+    });
+    if (loose.files > 0)
+        logResult("loose", loose);
+
+    return 0;
+}
+
+} // namespace
+
+int32_t main(int32_t argc, char *argv[])
+{
+    if (argc == 3 && std::string_view{argv[1]} == "--bench")
+        return bench(argv[2]);
+
+    if (argc < 3) {
+        l_error("Usage: ae_packer <destination{}> <file or directory>...", pack::EXTENSION);
+        l_error("       ae_packer --bench <pack{}>", pack::EXTENSION);
+        return 1;
+    }
+
+    std::vector<std::pair<std::string, std::filesystem::path>> files;
+
+    for (int32_t i = 2; i < argc; ++i) {
+        std::filesystem::path input{argv[i]};
+
+        if (std::filesystem::is_directory(input)) {
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(input)) {
+                if (entry.is_regular_file())
+                    files.emplace_back(entry.path().string(), entry.path());
+            }
+        } else if (std::filesystem::is_regular_file(input)) {
+            files.emplace_back(input.string(), input);
+        } else {
+            l_error("File not found: {}", input.string());
+            return 1;
+        }
+    }
+
+    return PackFile::write(argv[1], files) ? 0 : 1;
+}
@@ -0,0 +1,287 @@
+#include <ae/geometry/primitives.h>
+#include <ae/system/clock.h>
+#include <ae/system/log.h>
+#include <ae/system/memory.h>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ae;
+
+// Пулы против обычного new на узлах BVH
+//
+//   ae_pool_bench [leaves] [queries]
+//
+// locality - дерево с той же вставкой, что в BVH (scene/bvh.h), строится в случайном
+//            порядке, а между вставками выделяется и освобождается посторонняя память,
+//            как это делают остальные системы движка. Затем замеряются запросы по AABB
+//            и доля потомков, лежащих в пределах страницы от родителя
+// alloc    - создание и удаление узлов через createUnique в одном и в нескольких потоках.
+//            После него дерево в пуле строится еще раз, уже из перемешанных свободных блоков
+//
+// Узлы отличаются только AE_POOL_ALLOCATED, деревья и запросы одинаковые,
+// число найденных листьев сверяется
+
+namespace {
+
+constexpr int32_t REPEATS = 5;
+constexpr uint32_t INVALID_VALUE = ~0u;
+constexpr uintptr_t PAGE_SIZE = 4096;
+
+struct HeapNode
+{
+    AABB aabb;
+    uint32_t value = INVALID_VALUE;
+    u_ptr<HeapNode> left;
+    u_ptr<HeapNode> right;
+
+    bool isLeaf() const { return value != INVALID_VALUE; }
+};
+
+struct PoolNode
+{
+    AE_POOL_ALLOCATED
+
+    AABB aabb;
+    uint32_t value = INVALID_VALUE;
+    u_ptr<PoolNode> left;
+    u_ptr<PoolNode> right;
+
+    bool isLeaf() const { return value != INVALID_VALUE; }
+};
+
+template<typename Func>
+Time best(Func func)
+{
+    Time result;
+    for (int32_t i = 0; i < REPEATS; ++i) {
+        Clock clock;
+        func();
+        Time time = clock.getElapsedTime();
+        if (i == 0 || time < result)
+            result = time;
+    }
+    return result;
+}
+
+float computeGrowth(const AABB &aabb, const AABB &new_aabb)
+{
+    AABB merged_aabb = aabb.merge(new_aabb);
+    return glm::length(merged_aabb.max - merged_aabb.min) - glm::length(aabb.max - aabb.min);
+}
+
+// Вставка и запрос повторяют BVH::insertRecursive и BVH::queryRecursive
+template<typename Node>
+void insert(u_ptr<Node> &node, uint32_t value, const AABB &aabb)
+{
+    if (!node) {
+        node = createUnique<Node>();
+        node->aabb = aabb;
+        node->value = value;
+        return;
+    }
+
+    if (node->isLeaf()) {
+        node->left = createUnique<Node>();
+        node->right = createUnique<Node>();
+
+        node->left->aabb = node->aabb;
+        node->left->value = node->value;
+        node->right->aabb = aabb;
+        node->right->value = value;
+
+        node->value = INVALID_VALUE;
+    } else if (computeGrowth(node->left->aabb, aabb) < computeGrowth(node->right->aabb, aabb)) {
+        insert(node->left, value, aabb);
+    } else {
+        insert(node->right, value, aabb);
+    }
+
+    node->aabb = node->left->aabb.merge(node->right->aabb);
+}
+
+template<typename Node>
+int64_t query(const u_ptr<Node> &node, const AABB &aabb)
+{
+    if (!node || !node->aabb.intersects(aabb))
+        return 0;
+
+    if (node->isLeaf())
+        return 1;
+
+    return query(node->left, aabb) + query(node->right, aabb);
+}
+
+// Пары родитель - потомок и те из них, что лежат в пределах страницы памяти
+template<typename Node>
+void countNearChildren(const Node &node, int64_t &near, int64_t &pairs)
+{
+    for (const auto *child : {node.left.get(), node.right.get()}) {
+        if (!child)
+            continue;
+
+        auto parent_address = reinterpret_cast<uintptr_t>(&node);
+        auto child_address = reinterpret_cast<uintptr_t>(child);
+        uintptr_t distance = parent_address > child_address ? parent_address - child_address
+                                                            : child_address - parent_address;
+        if (distance < PAGE_SIZE)
+            ++near;
+        ++pairs;
+
+        countNearChildren(*child, near, pairs);
+    }
+}
+
+AABB randomAABB(std::mt19937 &random, float world_size, float max_size)
+{
+    std::uniform_real_distribution<float> position(0.0f, world_size);
+    std::uniform_real_distribution<float> size(max_size * 0.1f, max_size);
+
+    vec3 min{position(random), position(random), position(random)};
+    return {min, min + vec3{size(random), size(random), size(random)}};
+}
+
+template<typename Node>
+Time allocate(int32_t threads_count, int32_t count)
+{
+    return best([&]() {
+        std::vector<std::thread> threads;
+        for (int32_t t = 0; t < threads_count; ++t) {
+            threads.emplace_back([count]() {
+                std::vector<u_ptr<Node>> nodes;
+                nodes.reserve(count);
+                for (int32_t i = 0; i < count; ++i)
+                    nodes.push_back(createUnique<Node>());
+
+                // Удаление через одного, затем повторное заполнение: свободные блоки
+                // переиспользуются вперемешку
+                for (int32_t i = 0; i < count; i += 2)
+                    nodes[i].reset();
+                for (int32_t i = 0; i < count; i += 2)
+                    nodes[i] = createUnique<Node>();
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+    });
+}
+
+struct LocalityResult
+{
+    Time build_time;
+    Time query_time;
+    int64_t found = 0;
+    float near_children = 0.0f;
+};
+
+template<typename Node>
+LocalityResult measureLocality(const std::vector<AABB> &leaves, const std::vector<AABB> &queries)
+{
+    LocalityResult result;
+
+    // Посторонние выделения с тем же зерном для обоих вариантов
+    std::mt19937 random{7};
+    std::uniform_int_distribution<int32_t> noise_size(16, 512);
+    std::vector<std::vector<uint8_t>> noise;
+
+    u_ptr<Node> root;
+    Clock build_clock;
+    for (uint32_t i = 0; i < leaves.size(); ++i) {
+        insert(root, i, leaves[i]);
+
+        noise.emplace_back(noise_size(random));
+        if (noise.size() > 256) {
+            std::swap(noise[random() % noise.size()], noise.back());
+            noise.pop_back();
+        }
+    }
+    result.build_time = build_clock.getElapsedTime();
+
+    result.query_time = best([&]() {
+        result.found = 0;
+        for (const auto &aabb : queries)
+            result.found += query(root, aabb);
+    });
+
+    int64_t near = 0;
+    int64_t pairs = 0;
+    countNearChildren(*root, near, pairs);
+    result.near_children = float(near) / std::max<int64_t>(pairs, 1);
+
+    return result;
+}
+
+void logLocality(const char *name, const LocalityResult &result, int32_t queries_count)
+{
+    l_info("{:<16} build {:>8.2f} ms, {} queries {:>8.2f} ms ({:.2f} us each), "
+           "found {}, children within {} B of parent {:.1f}%",
+           name,
+           result.build_time.asMicroseconds() / 1000.0f,
+           queries_count,
+           result.query_time.asMicroseconds() / 1000.0f,
+           float(result.query_time.asMicroseconds()) / std::max(queries_count, 1),
+           result.found,
+           PAGE_SIZE,
+           result.near_children * 100.0f);
+}
+
+} // namespace
+
+int32_t main(int32_t argc, char *argv[])
+{
+    int32_t leaves_count = argc > 1 ? std::stoi(argv[1]) : 100000;
+    int32_t queries_count = argc > 2 ? std::stoi(argv[2]) : 20000;
+
+    std::mt19937 random{1};
+    std::vector<AABB> leaves(leaves_count);
+    for (auto &aabb : leaves)
+        aabb = randomAABB(random, 1000.0f, 5.0f);
+    std::vector<AABB> queries(queries_count);
+    for (auto &aabb : queries)
+        aabb = randomAABB(random, 1000.0f, 40.0f);
+
+    auto heap = measureLocality<HeapNode>(leaves, queries);
+    logLocality("heap", heap, queries_count);
+    auto pool = measureLocality<PoolNode>(leaves, queries);
+    logLocality("pool", pool, queries_count);
+
+    constexpr int32_t ALLOCATIONS = 1 << 20;
+    int32_t threads_count = std::max<int32_t>(std::thread::hardware_concurrency(), 2);
+
+    for (int32_t threads : {1, threads_count}) {
+        Time heap_time = allocate<HeapNode>(threads, ALLOCATIONS / threads);
+        Time pool_time = allocate<PoolNode>(threads, ALLOCATIONS / threads);
+        l_info("alloc {} nodes, {} threads: heap {:.2f} ms, pool {:.2f} ms",
+               ALLOCATIONS,
+               threads,
+               heap_time.asMicroseconds() / 1000.0f,
+               pool_time.asMicroseconds() / 1000.0f);
+    }
+
+    // Свободные блоки после alloc идут вперемешку, новые деревья ложатся в них
+    auto heap_churned = measureLocality<HeapNode>(leaves, queries);
+    logLocality("heap after churn", heap_churned, queries_count);
+    auto churned = measureLocality<PoolNode>(leaves, queries);
+    logLocality("pool after churn", churned, queries_count);
+
+    auto stats = Pool::getStats();
+    l_info("pool: {} KiB reserved in {} chunks, {} refills, {} fallback allocations",
+           stats.reserved_bytes / 1024,
+           stats.chunks,
+           stats.refills,
+           stats.fallback_allocations);
+
+    if (heap.found != pool.found || heap.found != heap_churned.found
+        || heap.found != churned.found) {
+        l_error("Query results differ: heap {}, pool {}, after churn heap {}, pool {}",
+                heap.found,
+                pool.found,
+                heap_churned.found,
+                churned.found);
+        return 1;
+    }
+
+    return 0;
+}
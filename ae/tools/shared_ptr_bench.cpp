@@ -0,0 +1,159 @@
+#include <ae/system/clock.h>
+#include <ae/system/log.h>
+#include <ae/system/memory.h>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace ae;
+
+// ae::SharedPtr в разных режимах счетчика против std::shared_ptr
+//
+//   ae_shared_ptr_bench [objects] [threads]
+//
+// create - создание и удаление объектов (createShared, std::make_shared)
+// copy   - копирующее присваивание из перемешанного массива, как при сборке списков
+//          отрисовки в главном потоке
+// shared - те же копирования одного объекта из нескольких потоков одновременно,
+//          только для атомарных счетчиков
+//
+// Режимы: block - счетчики в блоке рядом с объектом, intrusive - объект наследует
+// RefCounted, single - AE_SINGLE_THREAD_REF_COUNT
+
+namespace {
+
+constexpr int32_t REPEATS = 5;
+constexpr int32_t COPY_PASSES = 50;
+constexpr int32_t SHARED_COPIES = 1 << 20;
+
+// Размер примерно как у Material
+struct Payload
+{
+    float data[16] = {};
+};
+
+struct BlockObject : public Payload
+{};
+
+struct SingleObject : public Payload
+{
+    AE_SINGLE_THREAD_REF_COUNT
+};
+
+struct IntrusiveObject : public Payload, public RefCounted
+{};
+
+struct IntrusiveSingleObject : public Payload, public RefCounted
+{
+    AE_SINGLE_THREAD_REF_COUNT
+};
+
+template<typename Func>
+Time best(Func func)
+{
+    Time result;
+    for (int32_t i = 0; i < REPEATS; ++i) {
+        Clock clock;
+        func();
+        Time time = clock.getElapsedTime();
+        if (i == 0 || time < result)
+            result = time;
+    }
+    return result;
+}
+
+template<typename Ptr, typename Create>
+void run(const char *name, int32_t objects_count, int32_t threads_count, Create create)
+{
+    Time create_time = best([&]() {
+        std::vector<Ptr> objects;
+        objects.reserve(objects_count);
+        for (int32_t i = 0; i < objects_count; ++i)
+            objects.push_back(create());
+    });
+
+    std::vector<Ptr> objects;
+    for (int32_t i = 0; i < objects_count; ++i)
+        objects.push_back(create());
+
+    // Шаг, взаимно простой с размером, обходит объекты вразброс
+    std::vector<Ptr> copies(objects_count);
+    Time copy_time = best([&]() {
+        for (int32_t pass = 0; pass < COPY_PASSES; ++pass) {
+            for (int32_t i = 0; i < objects_count; ++i)
+                copies[i] = objects[(int64_t(i) * 7919 + pass) % objects_count];
+        }
+    });
+    copies.clear();
+
+    float create_ns = create_time.asMicroseconds() * 1000.0f / objects_count;
+    float copy_ns = copy_time.asMicroseconds() * 1000.0f / (int64_t(objects_count) * COPY_PASSES);
+
+    if (threads_count <= 1) {
+        l_info("{:<18} sizeof {:>2}, create {:>6.2f} ns, copy {:>6.2f} ns",
+               name,
+               sizeof(Ptr),
+               create_ns,
+               copy_ns);
+        return;
+    }
+
+    const Ptr &shared = objects.front();
+    Time shared_time = best([&]() {
+        std::vector<std::thread> threads;
+        for (int32_t t = 0; t < threads_count; ++t) {
+            threads.emplace_back([&shared]() {
+                Ptr local;
+                for (int32_t i = 0; i < SHARED_COPIES; ++i) {
+                    local = shared;
+                    local = nullptr;
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+    });
+
+    l_info("{:<18} sizeof {:>2}, create {:>6.2f} ns, copy {:>6.2f} ns, shared {:>6.2f} ns",
+           name,
+           sizeof(Ptr),
+           create_ns,
+           copy_ns,
+           shared_time.asMicroseconds() * 1000.0f / (int64_t(SHARED_COPIES) * threads_count));
+}
+
+} // namespace
+
+int32_t main(int32_t argc, char *argv[])
+{
+    int32_t objects_count = argc > 1 ? std::stoi(argv[1]) : 1 << 16;
+    int32_t threads_count = argc > 2
+                                ? std::stoi(argv[2])
+                                : std::max<int32_t>(std::thread::hardware_concurrency(), 2);
+
+    // libstdc++ не использует атомарные счетчики shared_ptr, пока в процессе не было
+    // второго потока. В движке потоки есть всегда
+    std::thread{[]() {}}.join();
+
+    l_info("{} objects, {} threads for shared copies", objects_count, threads_count);
+
+    run<std::shared_ptr<BlockObject>>("std::shared_ptr", objects_count, threads_count, []() {
+        return std::make_shared<BlockObject>();
+    });
+    run<s_ptr<BlockObject>>("block", objects_count, threads_count, []() {
+        return createShared<BlockObject>();
+    });
+    run<s_ptr<IntrusiveObject>>("intrusive", objects_count, threads_count, []() {
+        return createShared<IntrusiveObject>();
+    });
+    run<s_ptr<SingleObject>>("block single", objects_count, 1, []() {
+        return createShared<SingleObject>();
+    });
+    run<s_ptr<IntrusiveSingleObject>>("intrusive single", objects_count, 1, []() {
+        return createShared<IntrusiveSingleObject>();
+    });
+
+    return 0;
+}
@@ -0,0 +1,386 @@
+#include <ae/system/clock.h>
+#include <ae/system/log.h>
+#include <ae/system/signal.h>
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace ae;
+
+// Signal против прежней реализации на мьютексе и std::function
+//
+//   ae_signal_bench [emits] [threads]
+//
+// direct     - emit в одном потоке, слоты - методы объекта
+// concurrent - emit из нескольких потоков в один сигнал
+// churn      - то же, пока отдельный поток подключает и отключает слоты
+// capture    - подключение и emit слота-лямбды с захватом в 24 и 72 байта: Delegate
+//              хранит первый внутри, std::function выделяет память для обоих
+// queued     - emit из нескольких потоков в режиме QUEUED и доставка через
+//              SignalQueue::dispatch
+//
+// Число вызовов слотов сверяется с ожидаемым
+
+namespace {
+
+constexpr int32_t REPEATS = 5;
+constexpr int32_t SLOTS = 4;
+
+// Signal до перехода на неизменяемые списки слотов: мьютекс на emit, std::function
+// и удаление отключенных слотов после каждого вызова
+template<typename... Args>
+class LockedSignal
+{
+public:
+    using SlotFunc = std::function<void(Args...)>;
+
+    struct Connection
+    {
+        SlotFunc func;
+        void *object = nullptr;
+        bool active = true;
+    };
+
+    void connect(SlotFunc slot, void *object = nullptr)
+    {
+        auto conn = createShared<Connection>(Connection{std::move(slot), object});
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_slots.push_back(conn);
+    }
+
+    template<typename TMethod, typename TObject>
+        requires std::is_member_function_pointer_v<TMethod>
+    void connect(TMethod method, TObject *obj)
+    {
+        connect([obj, method](Args... args) { (obj->*method)(std::forward<Args>(args)...); }, obj);
+    }
+
+    void emit(Args... args)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &conn : m_slots) {
+            if (conn->active && conn->func)
+                conn->func(args...);
+        }
+
+        m_slots.erase(std::remove_if(m_slots.begin(),
+                                     m_slots.end(),
+                                     [](const s_ptr<Connection> &conn) { return !conn->active; }),
+                      m_slots.end());
+    }
+
+    void disconnect(void *object)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &conn : m_slots) {
+            if (conn->object == object)
+                conn->active = false;
+        }
+    }
+
+private:
+    std::vector<s_ptr<Connection>> m_slots;
+    std::mutex m_mutex;
+};
+
+struct Receiver
+{
+    std::atomic<int64_t> calls{0};
+
+    void onValue(int32_t value) { calls.fetch_add(value, std::memory_order_relaxed); }
+};
+
+template<typename Func>
+Time best(Func func)
+{
+    Time result;
+    for (int32_t i = 0; i < REPEATS; ++i) {
+        Clock clock;
+        func();
+        Time time = clock.getElapsedTime();
+        if (i == 0 || time < result)
+            result = time;
+    }
+    return result;
+}
+
+// Каждый поток делает emits вызовов emit(1)
+template<typename TSignal>
+Time emitFromThreads(TSignal &signal, int32_t threads_count, int32_t emits)
+{
+    return best([&]() {
+        std::vector<std::thread> threads;
+        for (int32_t t = 0; t < threads_count; ++t) {
+            threads.emplace_back([&signal, emits]() {
+                for (int32_t i = 0; i < emits; ++i)
+                    signal.emit(1);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+    });
+}
+
+bool check(const char *name, int64_t calls, int64_t expected)
+{
+    if (calls == expected)
+        return true;
+
+    l_error("{}: {} slot calls, expected {}", name, calls, expected);
+    return false;
+}
+
+void logPair(const char *name, int64_t emits, Time locked, Time signal)
+{
+    l_info("{:<11} locked {:>8.2f} ms ({:>6.1f} ns/emit), signal {:>8.2f} ms ({:>6.1f} ns/emit)",
+           name,
+           locked.asMicroseconds() / 1000.0f,
+           locked.asMicroseconds() * 1000.0f / emits,
+           signal.asMicroseconds() / 1000.0f,
+           signal.asMicroseconds() * 1000.0f / emits);
+}
+
+template<typename TSignal>
+void connectReceivers(TSignal &signal, std::vector<Receiver> &receivers)
+{
+    for (auto &receiver : receivers)
+        signal.connect(&Receiver::onValue, &receiver);
+}
+
+int64_t collect(std::vector<Receiver> &receivers)
+{
+    int64_t calls = 0;
+    for (auto &receiver : receivers)
+        calls += receiver.calls.exchange(0);
+    return calls;
+}
+
+bool runDirect(int32_t emits, int32_t threads_count)
+{
+    bool valid = true;
+
+    std::vector<Receiver> locked_receivers(SLOTS);
+    std::vector<Receiver> receivers(SLOTS);
+    LockedSignal<int32_t> locked;
+    Signal<int32_t> signal;
+    connectReceivers(locked, locked_receivers);
+    connectReceivers(signal, receivers);
+
+    for (int32_t threads : {1, threads_count}) {
+        Time locked_time = emitFromThreads(locked, threads, emits / threads);
+        Time signal_time = emitFromThreads(signal, threads, emits / threads);
+
+        int64_t expected = int64_t(emits / threads) * threads * SLOTS * REPEATS;
+        valid = check("locked", collect(locked_receivers), expected) && valid;
+        valid = check("signal", collect(receivers), expected) && valid;
+
+        std::string name = threads == 1 ? "direct" : "concurrent";
+        logPair(name.c_str(), int64_t(emits / threads) * threads, locked_time, signal_time);
+    }
+
+    return valid;
+}
+
+// Поток подключает и отключает слот, пока остальные вызывают emit. Постоянные
+// слоты должны получить каждый вызов
+template<typename TSignal>
+Time emitWithChurn(TSignal &signal, int32_t threads_count, int32_t emits, int64_t &reconnects)
+{
+    Receiver transient;
+    std::atomic<bool> done{false};
+
+    std::thread writer([&]() {
+        while (!done.load(std::memory_order_relaxed)) {
+            signal.connect(&Receiver::onValue, &transient);
+            signal.disconnect(&transient);
+            ++reconnects;
+        }
+    });
+
+    Time time = emitFromThreads(signal, threads_count, emits);
+
+    done = true;
+    writer.join();
+    return time;
+}
+
+bool runChurn(int32_t emits, int32_t threads_count)
+{
+    std::vector<Receiver> locked_receivers(SLOTS);
+    std::vector<Receiver> receivers(SLOTS);
+    LockedSignal<int32_t> locked;
+    Signal<int32_t> signal;
+    connectReceivers(locked, locked_receivers);
+    connectReceivers(signal, receivers);
+
+    int32_t per_thread = emits / threads_count;
+    int64_t locked_reconnects = 0;
+    int64_t reconnects = 0;
+    Time locked_time = emitWithChurn(locked, threads_count, per_thread, locked_reconnects);
+    Time signal_time = emitWithChurn(signal, threads_count, per_thread, reconnects);
+
+    int64_t expected = int64_t(per_thread) * threads_count * SLOTS * REPEATS;
+    bool valid = check("locked churn", collect(locked_receivers), expected);
+    valid = check("signal churn", collect(receivers), expected) && valid;
+
+    logPair("churn", int64_t(per_thread) * threads_count, locked_time, signal_time);
+    l_info("{:<11} reconnects: locked {}, signal {}", "", locked_reconnects, reconnects);
+
+    return valid;
+}
+
+bool runCapture(int32_t emits)
+{
+    bool valid = true;
+    int64_t sum = 0;
+
+    // 24 байта помещаются в Delegate::INLINE_SIZE, но не в буфер std::function,
+    // 72 байта не помещаются никуда
+    struct Medium
+    {
+        int64_t *sum;
+        int64_t padding[2];
+    };
+    struct Large
+    {
+        int64_t *sum;
+        int64_t padding[8];
+    };
+    static_assert(sizeof(Medium) <= Delegate<void(int32_t)>::INLINE_SIZE);
+    static_assert(sizeof(Large) > Delegate<void(int32_t)>::INLINE_SIZE);
+
+    auto medium = [medium = Medium{&sum, {}}](int32_t value) {
+        *medium.sum += value + medium.padding[0];
+    };
+    auto large = [large = Large{&sum, {}}](int32_t value) {
+        *large.sum += value + large.padding[0];
+    };
+
+    auto measure = [&](const char *name, auto slot) {
+        // Подключение: здесь выделяется память под функтор
+        int32_t signals_count = std::max(emits / 64, 1);
+        Time locked_connect = best([&]() {
+            for (int32_t i = 0; i < signals_count; ++i) {
+                LockedSignal<int32_t> locked;
+                for (int32_t s = 0; s < SLOTS; ++s)
+                    locked.connect(slot);
+            }
+        });
+        Time signal_connect = best([&]() {
+            for (int32_t i = 0; i < signals_count; ++i) {
+                Signal<int32_t> signal;
+                for (int32_t s = 0; s < SLOTS; ++s)
+                    signal.connect(slot);
+            }
+        });
+
+        LockedSignal<int32_t> locked;
+        Signal<int32_t> signal;
+        for (int32_t i = 0; i < SLOTS; ++i) {
+            locked.connect(slot);
+            signal.connect(slot);
+        }
+
+        sum = 0;
+        Time locked_time = best([&]() {
+            for (int32_t i = 0; i < emits; ++i)
+                locked.emit(1);
+        });
+        valid = check(name, sum, int64_t(emits) * SLOTS * REPEATS) && valid;
+
+        sum = 0;
+        Time signal_time = best([&]() {
+            for (int32_t i = 0; i < emits; ++i)
+                signal.emit(1);
+        });
+        valid = check(name, sum, int64_t(emits) * SLOTS * REPEATS) && valid;
+
+        logPair(name, emits, locked_time, signal_time);
+        l_info("{:<11} connect: locked {:>6.1f} ns/slot, signal {:>6.1f} ns/slot",
+               "",
+               locked_connect.asMicroseconds() * 1000.0f / (int64_t(signals_count) * SLOTS),
+               signal_connect.asMicroseconds() * 1000.0f / (int64_t(signals_count) * SLOTS));
+    };
+
+    measure("capture 24", medium);
+    measure("capture 72", large);
+
+    return valid;
+}
+
+// Режим QUEUED: emit только сохраняет аргументы, доставка - одним dispatch на главном потоке
+bool runQueued(int32_t emits, int32_t threads_count)
+{
+    std::vector<Receiver> receivers(SLOTS);
+    Signal<int32_t> signal(SignalMode::QUEUED);
+    connectReceivers(signal, receivers);
+
+    bool valid = true;
+    int32_t per_thread = emits / threads_count;
+    Time emit_time;
+    Time dispatch_time;
+
+    for (int32_t i = 0; i < REPEATS; ++i) {
+        Clock emit_clock;
+        std::vector<std::thread> threads;
+        for (int32_t t = 0; t < threads_count; ++t) {
+            threads.emplace_back([&signal, per_thread]() {
+                for (int32_t e = 0; e < per_thread; ++e)
+                    signal.emit(1);
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        Time emitted = emit_clock.getElapsedTime();
+
+        // До dispatch слоты не вызываются
+        valid = check("queued before dispatch", collect(receivers), 0) && valid;
+
+        Clock dispatch_clock;
+        SignalQueue::dispatch();
+        Time dispatched = dispatch_clock.getElapsedTime();
+
+        int64_t expected = int64_t(per_thread) * threads_count;
+        valid = check("queued dispatch", SignalQueue::getLastDispatchedCount(), expected) && valid;
+        valid = check("queued slots", collect(receivers), expected * SLOTS) && valid;
+
+        if (i == 0 || emitted < emit_time)
+            emit_time = emitted;
+        if (i == 0 || dispatched < dispatch_time)
+            dispatch_time = dispatched;
+    }
+
+    int64_t total = int64_t(per_thread) * threads_count;
+    l_info("{:<11} {} threads: emit {:>8.2f} ms ({:>6.1f} ns/emit), "
+           "dispatch {:>8.2f} ms ({:>6.1f} ns/emit)",
+           "queued",
+           threads_count,
+           emit_time.asMicroseconds() / 1000.0f,
+           emit_time.asMicroseconds() * 1000.0f / total,
+           dispatch_time.asMicroseconds() / 1000.0f,
+           dispatch_time.asMicroseconds() * 1000.0f / total);
+
+    return valid;
+}
+
+} // namespace
+
+int32_t main(int32_t argc, char *argv[])
+{
+    int32_t emits = argc > 1 ? std::stoi(argv[1]) : 1 << 20;
+    int32_t threads_count = argc > 2
+                                ? std::stoi(argv[2])
+                                : std::max<int32_t>(std::thread::hardware_concurrency(), 2);
+
+    l_info("{} emits, {} slots, {} threads", emits, SLOTS, threads_count);
+
+    bool valid = runDirect(emits, threads_count);
+    valid = runChurn(emits, threads_count) && valid;
+    valid = runCapture(emits) && valid;
+    valid = runQueued(emits, threads_count) && valid;
+
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,187 @@
+#include <ae/system/clock.h>
+#include <ae/system/log.h>
+#include <ae/system/memory.h>
+#include <ae/system/timer_wheel.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace ae;
+
+// TimerWheel против обновления каждого таймера на каждом тике, как TaskManager
+// обновлял DelayTask до колеса
+//
+//   ae_timer_wheel_bench [ticks]
+//
+// Для 1k, 10k и 100k таймеров с задержками от 1 до 60 секунд при тике 60 Гц:
+// schedule - постановка всех таймеров
+// ticks    - время на тик, пока таймеры ждут и срабатывают
+// cancel   - отмена половины таймеров через Handle
+//
+// Шаг срабатывания каждого таймера сверяется между колесом и опросом
+
+namespace {
+
+constexpr int32_t REPEATS = 3;
+
+// Задача с обратным отсчетом, как прежний DelayTask в TaskManager
+class Countdown
+{
+public:
+    AE_POOL_ALLOCATED
+
+    Countdown(const Time &delay, int32_t id)
+        : m_remaining{delay}
+        , m_id{id}
+    {}
+    virtual ~Countdown() = default;
+
+    virtual bool update(const Time &dt)
+    {
+        m_remaining -= dt;
+        return m_remaining <= Time{};
+    }
+
+    int32_t getId() const { return m_id; }
+
+private:
+    Time m_remaining;
+    int32_t m_id;
+};
+
+struct Result
+{
+    Time schedule_time;
+    Time ticks_time;
+    Time cancel_time;
+    std::vector<int32_t> fired_at;
+};
+
+template<typename Func>
+Time best(Func func)
+{
+    Time result;
+    for (int32_t i = 0; i < REPEATS; ++i) {
+        Clock clock;
+        func();
+        Time time = clock.getElapsedTime();
+        if (i == 0 || time < result)
+            result = time;
+    }
+    return result;
+}
+
+Result runPolling(const std::vector<Time> &delays, const Time &dt, int32_t ticks)
+{
+    Result result;
+    result.fired_at.assign(delays.size(), 0);
+
+    std::vector<u_ptr<Countdown>> tasks;
+    result.schedule_time = best([&]() {
+        tasks.clear();
+        for (size_t i = 0; i < delays.size(); ++i)
+            tasks.push_back(createUnique<Countdown>(delays[i], static_cast<int32_t>(i)));
+    });
+
+    Clock clock;
+    for (int32_t tick = 1; tick <= ticks; ++tick) {
+        tasks.erase(std::remove_if(tasks.begin(),
+                                   tasks.end(),
+                                   [&](const u_ptr<Countdown> &task) {
+                                       if (!task->update(dt))
+                                           return false;
+                                       result.fired_at[task->getId()] = tick;
+                                       return true;
+                                   }),
+                    tasks.end());
+    }
+    result.ticks_time = clock.getElapsedTime();
+
+    return result;
+}
+
+Result runWheel(const std::vector<Time> &delays, const Time &dt, int32_t ticks)
+{
+    Result result;
+    result.fired_at.assign(delays.size(), 0);
+
+    int32_t tick = 0;
+    u_ptr<TimerWheel> wheel;
+    std::vector<TimerWheel::Handle> handles(delays.size());
+    result.schedule_time = best([&]() {
+        wheel = createUnique<TimerWheel>(dt);
+        for (size_t i = 0; i < delays.size(); ++i) {
+            handles[i] = wheel->schedule(delays[i],
+                                         [&result, &tick, i]() { result.fired_at[i] = tick; });
+        }
+    });
+
+    Clock clock;
+    for (tick = 1; tick <= ticks; ++tick)
+        wheel->update(dt);
+    result.ticks_time = clock.getElapsedTime();
+
+    // Отмена на отдельном колесе, чтобы не трогать сверяемые результаты
+    for (int32_t i = 0; i < REPEATS; ++i) {
+        TimerWheel cancel_wheel(dt);
+        std::vector<TimerWheel::Handle> cancel_handles(delays.size());
+        for (size_t t = 0; t < delays.size(); ++t)
+            cancel_handles[t] = cancel_wheel.schedule(delays[t], []() {});
+
+        Clock cancel_clock;
+        for (size_t t = 0; t < delays.size(); t += 2)
+            cancel_handles[t].cancel();
+        Time time = cancel_clock.getElapsedTime();
+
+        if (i == 0 || time < result.cancel_time)
+            result.cancel_time = time;
+    }
+
+    return result;
+}
+
+} // namespace
+
+int32_t main(int32_t argc, char *argv[])
+{
+    // 10 секунд при 60 Гц по умолчанию: срабатывает примерно шестая часть таймеров
+    int32_t ticks = argc > 1 ? std::stoi(argv[1]) : 600;
+    Time dt = microseconds(16666);
+
+    l_info("{} ticks of {} us", ticks, dt.asMicroseconds());
+
+    bool valid = true;
+    for (int32_t count : {1000, 10000, 100000}) {
+        std::mt19937 random{static_cast<uint32_t>(count)};
+        std::uniform_int_distribution<int32_t> delay_ms(1000, 60000);
+        std::vector<Time> delays(count);
+        for (auto &delay : delays)
+            delay = milliseconds(delay_ms(random));
+
+        Result polling = runPolling(delays, dt, ticks);
+        Result wheel = runWheel(delays, dt, ticks);
+
+        int32_t fired = static_cast<int32_t>(
+            std::count_if(wheel.fired_at.begin(), wheel.fired_at.end(), [](int32_t tick) {
+                return tick != 0;
+            }));
+
+        if (polling.fired_at != wheel.fired_at) {
+            l_error("{} timers: wheel and polling fired on different ticks", count);
+            valid = false;
+        }
+
+        l_info("{:>6} timers, {:>6} fired | schedule: polling {:>6.1f} ns, wheel {:>6.1f} ns"
+               " | tick: polling {:>9.2f} us, wheel {:>7.2f} us | cancel {:>5.1f} ns",
+               count,
+               fired,
+               polling.schedule_time.asMicroseconds() * 1000.0f / count,
+               wheel.schedule_time.asMicroseconds() * 1000.0f / count,
+               float(polling.ticks_time.asMicroseconds()) / ticks,
+               float(wheel.ticks_time.asMicroseconds()) / ticks,
+               wheel.cancel_time.asMicroseconds() * 1000.0f / ((count + 1) / 2));
+    }
+
+    return valid ? 0 : 1;
+}
@@ -30,6 +30,7 @@ void GameplayState::onExit()
     ctx.getWindow()->setMouseEnabled(true);
 
     // Clear assets
+    ctx.getAssets()->logResidencyStats();
     ctx.getAssets()->clear();
     // Clear scene
     ctx.getScene()->clear();
@@ -8,12 +8,13 @@ Dialog::Dialog(EngineContext &engine_context)
     , m_center{0.0f}
 {
     setFontPixelHeight(GuiTheme::metrics.dialog_font_pixel_size);
+    setChildrenAffectLayout(true);
 }
 
 void Dialog::setCenter(const vec2 &center)
 {
     m_center = center;
-    updateGeometry();
+    invalidateLayout();
 }
 
 const String &Dialog::getString() const
@@ -24,19 +25,20 @@ const String &Dialog::getString() const
 void Dialog::setString(const String &string)
 {
     m_string = string;
-    updateGeometry();
+    invalidateImplicitSize();
+    repaint();
 }
 
 void Dialog::setAcceptString(const String &string)
 {
     m_accept_button->setString(string);
-    updateGeometry();
+    invalidateLayout();
 }
 
 void Dialog::setCancelString(const String &string)
 {
     m_cancel_button->setString(string);
-    updateGeometry();
+    invalidateLayout();
 }
 
 void Dialog::onCreated()
@@ -60,7 +62,7 @@ void Dialog::drawControl(Batch2D &batch_2d)
                       getFontPixelHeight());
 }
 
-void Dialog::updateGeometry()
+void Dialog::updateImplicitSize()
 {
     auto text_size = getFont()->getFontPage(getFontPixelHeight())->getTextSize(m_string);
     text_size.x += GuiTheme::metrics.dialog_text_padding * 2.0f;
@@ -68,7 +70,15 @@ void Dialog::updateGeometry()
                    + GuiTheme::metrics.dialog_button_height
                    + GuiTheme::metrics.dialog_buttons_bottom_offset;
 
-    setSize(text_size);
+    setImplicitSize(text_size);
+}
+
+void Dialog::arrange()
+{
+    if (!m_accept_button || !m_cancel_button)
+        return;
+
+    setSize(getImplicitSize());
     setPosition(m_center - getSize() / 2.0f);
 
     vec2 button_padding = GuiTheme::metrics.dialog_button_padding;
@@ -99,6 +109,4 @@ void Dialog::updateGeometry()
                                           + GuiTheme::metrics.dialog_buttons_spacing,
                                       getSize().y - m_cancel_button->getSize().y
                                           - GuiTheme::metrics.dialog_buttons_bottom_offset});
-
-    repaint();
 }
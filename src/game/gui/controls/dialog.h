@@ -25,9 +25,8 @@ public:
 
 protected:
     void drawControl(Batch2D &batch_2d);
-
-private:
-    void updateGeometry();
+    void updateImplicitSize();
+    void arrange();
 
 public:
     Signal<> accepted;
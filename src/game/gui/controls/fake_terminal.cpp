@@ -19,6 +19,8 @@ void FakeTerminal::pop()
 
     if (!m_pages_stack.empty())
         m_pages_stack.back().page_control->setParent(sharedFromThis());
+
+    invalidateLayout();
 }
 
 int32_t FakeTerminal::getPageCount() const
@@ -30,7 +32,7 @@ String FakeTerminal::getTopCmdOutputString() const
 {
     if (m_pages_stack.empty())
         return {};
-    return m_pages_stack.back().cmd_output_label->getString();
+    return m_pages_stack.back().cmd_output_log->getString();
 }
 
 void FakeTerminal::setTopCmdOutputString(const String &string)
@@ -40,12 +42,11 @@ void FakeTerminal::setTopCmdOutputString(const String &string)
 
     auto &page = m_pages_stack.back();
 
-    page.cmd_output_label->setString(string);
-
-    page.cmd_output_label->setSize(page.cmd_output_label->getImplicitSize());
+    page.cmd_output_log->clear();
+    if (!string.isEmpty())
+        page.cmd_output_log->append(string);
 
-    updatePageSize(page);
-    updatePagePosition(page);
+    invalidateLayout();
 }
 
 void FakeTerminal::appendStringToTopCmdOutput(const String &string)
@@ -55,21 +56,17 @@ void FakeTerminal::appendStringToTopCmdOutput(const String &string)
 
     auto &page = m_pages_stack.back();
 
-    if (!page.cmd_output_label->getString().isEmpty())
-        page.cmd_output_label->appendString("\n");
-    page.cmd_output_label->appendString(string);
+    // Добавление строки не зависит от объема уже выведенного текста, страница
+    // перестраивается один раз за кадр при разметке
+    page.cmd_output_log->append(string);
 
-    page.cmd_output_label->setSize(page.cmd_output_label->getImplicitSize());
-
-    updatePageSize(page);
-    updatePagePosition(page);
+    invalidateLayout();
 }
 
-void FakeTerminal::onSizeChanged(const vec2 &)
+void FakeTerminal::arrange()
 {
     for (auto &page : m_pages_stack) {
-        if (page.control_fill_width)
-            updatePageSize(page);
+        updatePageSize(page);
         updatePagePosition(page);
     }
 }
@@ -84,14 +81,28 @@ void FakeTerminal::updatePageSize(Page &page)
 
     float spacing = getFontPixelHeight() * 0.5;
 
+    // Вывод команды занимает место, оставшееся от остальных элементов страницы,
+    // и прокручивается внутри него
+    if (page.cmd_output_log) {
+        float other_height = children.front()->getSize().y;
+        for (const auto &control : children | std::views::drop(1)) {
+            if (control != page.cmd_output_log)
+                other_height += spacing + control->getSize().y;
+        }
+
+        float output_height = std::min(page.cmd_output_log->getImplicitSize().y,
+                                       std::max(getSize().y - other_height, 0.0f));
+        page.cmd_output_log->setSize(vec2{getSize().x, output_height});
+    }
+
     size = children.front()->getSize();
 
     for (const auto &control : children | std::views::drop(1)) {
-        if (control != page.cmd_output_label)
+        if (control != page.cmd_output_log)
             size.y += spacing;
 
-        if (control == page.cmd_output_label && page.cmd_output_label
-            && page.cmd_output_label->getString().isEmpty())
+        if (control == page.cmd_output_log && page.cmd_output_log
+            && page.cmd_output_log->getLineCount() == 0)
             continue;
 
         if (control == page.control) {
@@ -8,6 +8,7 @@
 #include <ae/engine.h>
 #include <ae/gui/control.h>
 #include <ae/gui/label.h>
+#include <ae/gui/text_log.h>
 #include <ae/system/log.h>
 #include <ae/system/string.h>
 
@@ -49,14 +50,15 @@ public:
     void setTopCmdOutputString(const String &string);
     void appendStringToTopCmdOutput(const String &string);
 
-    void onSizeChanged(const vec2 &);
+protected:
+    void arrange();
 
 private:
     struct Page
     {
         s_ptr<gui::Control> page_control;
         s_ptr<gui::Control> control;
-        s_ptr<gui::Label> cmd_output_label;
+        s_ptr<gui::TextLog> cmd_output_log;
         bool control_fill_width = false;
     };
 
@@ -97,15 +99,16 @@ inline void FakeTerminal::push(const String &cmd,
     cmd_label->setString("> " + cmd);
     cmd_label->setSize(cmd_label->getImplicitSize());
 
-    auto cmd_output_label = gui::Control::create<gui::Label>(ctx);
-    cmd_output_label->setParent(page_control);
-    page.cmd_output_label = cmd_output_label;
+    // Вывод команды может быть длинным, поэтому рисуются только видимые строки
+    auto cmd_output_log = gui::Control::create<gui::TextLog>(ctx);
+    cmd_output_log->setParent(page_control);
+    page.cmd_output_log = cmd_output_log;
 
-    cmd_output_label->setColor(Style::Palette::getInverseOn(m_color));
-    cmd_label->setFont(getFont());
-    cmd_output_label->setFontPixelHeight(getFontPixelHeight());
-    cmd_output_label->setString(cmd_output);
-    cmd_output_label->setSize(cmd_output_label->getImplicitSize());
+    cmd_output_log->setColor(Style::Palette::getInverseOn(m_color));
+    cmd_output_log->setFont(getFont());
+    cmd_output_log->setFontPixelHeight(getFontPixelHeight());
+    if (!cmd_output.isEmpty())
+        cmd_output_log->append(cmd_output);
 
     if (control) {
         control->setParent(page_control);
@@ -124,13 +127,12 @@ inline void FakeTerminal::push(const String &cmd,
         buttons_container->setParent(page_control);
     }
 
-    updatePageSize(page);
-    updatePagePosition(page);
-
     if (!m_pages_stack.empty())
         m_pages_stack.back().page_control->setParent(nullptr);
     m_pages_stack.push_back(page);
     m_pages_stack.back().page_control->setParent(sharedFromThis());
+
+    invalidateLayout();
 }
 
 template<std::ranges::range Range>
@@ -142,7 +144,7 @@ inline s_ptr<gui::Control> FakeTerminal::createButtonsContainer(const Range &but
 
     float button_width = 1.0f;
 
-    auto click_sound_buffer = ctx.getAssets()->get<SoundBuffer>("ft_btn");
+    auto click_sound_buffer = ctx.getAssets()->require<SoundBuffer>("ft_btn");
 
     for (const auto &button : buttons) {
         auto button_control = gui::Control::create<FakeTerminalButton>(ctx);
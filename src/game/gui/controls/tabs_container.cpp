@@ -6,6 +6,7 @@ TabsContainer::TabsContainer(EngineContext &engine_context)
 {
     m_buttons_group.checked.connect(
         [this](int32_t current, int32_t) { tabActivated.emit(current); });
+    setChildrenAffectLayout(true);
 }
 
 void TabsContainer::setColor(const Color &color)
@@ -34,8 +35,6 @@ void TabsContainer::setTabs(const std::vector<String> &tabs)
         m_tab_buttons.push_back(tab_button);
         m_buttons_group.addButton(tab_button);
     }
-
-    updateGeometry();
 }
 
 void TabsContainer::clear()
@@ -46,12 +45,18 @@ void TabsContainer::clear()
     m_buttons_group.clear();
 }
 
-void TabsContainer::onSizeChanged(const vec2 &)
+void TabsContainer::updateImplicitSize()
 {
-    updateGeometry();
+    float width = 0.0f;
+    float button_spacing = getFontPixelHeight() * 0.6f;
+
+    for (auto &tab_button : m_tab_buttons)
+        width += tab_button->getImplicitSize().x + button_spacing;
+
+    setImplicitSize(vec2{width, getFontPixelHeight() * 1.2f});
 }
 
-void TabsContainer::updateGeometry()
+void TabsContainer::arrange()
 {
     float x_offset = 0.0f;
 
@@ -65,6 +70,4 @@ void TabsContainer::updateGeometry()
         tab_button->setPosition(vec2{x_offset, 0.0f});
         x_offset += size.x + button_spacing;
     }
-
-    setImplicitSize(vec2{x_offset, button_height});
 }
@@ -21,10 +21,9 @@ public:
     void setTabs(const std::vector<String> &tabs);
     void clear();
 
-    void onSizeChanged(const vec2 &);
-
-private:
-    void updateGeometry();
+protected:
+    void updateImplicitSize();
+    void arrange();
 
 public:
     Signal<int32_t> tabActivated;
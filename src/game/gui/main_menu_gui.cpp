@@ -51,7 +51,7 @@ void MainMenuGui::back()
 void MainMenuGui::onCreated()
 {
     auto &ctx = getEngineContext();
-    m_splash_texture = ctx.getAssets()->get<Texture>("splash");
+    m_splash_texture = ctx.getAssets()->require<Texture>("splash");
 
     m_fake_terminal = gui::Control::create<FakeTerminal>(getEngineContext());
     m_fake_terminal->setParent(sharedFromThis());
@@ -5,7 +5,9 @@
 
 SettingsDialog::SettingsDialog(EngineContext &engine_context)
     : gui::Control{engine_context}
-{}
+{
+    setChildrenAffectLayout(true);
+}
 
 void SettingsDialog::onCreated()
 {
@@ -22,14 +24,8 @@ void SettingsDialog::onCreated()
     m_tabs.push_back(createControlsTab());
 
     m_tabs_container->setTabs({"Video", "Audio", "Controls"});
-    m_tabs_container->setSize(m_tabs_container->getImplicitSize());
-
-    updateGeometry();
-}
 
-void SettingsDialog::onSizeChanged(const vec2 &)
-{
-    updateGeometry();
+    invalidateLayout();
 }
 
 void SettingsDialog::drawControl(Batch2D &batch_2d)
@@ -51,8 +47,13 @@ void SettingsDialog::setActiveTab(int32_t index)
     m_tabs[index]->setParent(sharedFromThis());
 }
 
-void SettingsDialog::updateGeometry()
+void SettingsDialog::arrange()
 {
+    if (!m_tabs_container)
+        return;
+
+    m_tabs_container->setSize(m_tabs_container->getImplicitSize());
+
     auto size = getSize();
     size.y -= m_tabs_container->getSize().y;
 
@@ -14,14 +14,13 @@ public:
     ~SettingsDialog() = default;
 
     void onCreated();
-    void onSizeChanged(const vec2 &);
 
 protected:
     void drawControl(Batch2D &batch_2d);
+    void arrange();
 
 private:
     void setActiveTab(int32_t index);
-    void updateGeometry();
 
     s_ptr<gui::Control> createVideoTab();
     s_ptr<gui::Control> createAudioTab();
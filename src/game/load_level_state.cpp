@@ -1,6 +1,7 @@
 #include "load_level_state.h"
 #include "gameplay_state.h"
 
+#include <ae/assets/asset_loaders.h>
 #include <ae/engine_context.h>
 #include <ae/game_state_stack.h>
 #include <ae/graphics/core/default_shaders.h>
@@ -13,8 +14,6 @@
 
 LoadLevelState::LoadLevelState(EngineContext &engine_context)
     : GameState{engine_context}
-    , m_current_task{0}
-    , m_total_tasks{0}
 {
     m_render_quad.create();
 }
@@ -90,16 +89,6 @@ void LoadLevelState::loadTestScene()
                                           "skyboxes/StandardCubeMap.png",
                                           TextureType::CUBE_MAP}};
 
-    auto load_textures_task_chain = createShared<TaskChain>();
-
-    for (const auto &texture : textures) {
-        load_textures_task_chain->addTask(createShared<CallbackTask>([&, texture]() {
-            l_debug("Load texture: {}, {}", texture.name, texture.path);
-            updateOutput(fmt::format("Load texture: {}, {}", texture.name, texture.path));
-            ctx.getAssets()->loadFromFile<Texture>(texture.name, texture.path, texture.type);
-        }));
-    }
-
     // Load models
     struct ModelInfo
     {
@@ -110,18 +99,53 @@ void LoadLevelState::loadTestScene()
     std::vector<ModelInfo> models = {{"player", "walking_girl_cat_walk/scene.gltf"},
                                      {"level_model", "model3/1/untitled.gltf"}};
 
-    auto load_models_task_chain = createShared<TaskChain>();
+    // Все ресурсы загружаются в фоне одновременно
+    updateOutput("\n### Load assets ###");
+
+    m_loading_jobs.clear();
+
+    for (const auto &texture : textures) {
+        l_debug("Load texture: {}, {}", texture.name, texture.path);
+        updateOutput(fmt::format("Load texture: {}, {}", texture.name, texture.path));
+        auto handle = ctx.getAssets()->loadFromFileAsync<Texture>(texture.name,
+                                                                  texture.path,
+                                                                  texture.type);
+        m_loading_jobs.push_back({texture.name, handle.getJob()});
+    }
 
     for (const auto &model : models) {
-        load_models_task_chain->addTask(createShared<CallbackTask>([&, model]() {
-            l_debug("Load model: {}, {}", model.name, model.path);
-            updateOutput(fmt::format("Load model: {}, {}", model.name, model.path));
-            ctx.getAssets()->loadFromFile<Model>(model.name, model.path);
-        }));
+        l_debug("Load model: {}, {}", model.name, model.path);
+        updateOutput(fmt::format("Load model: {}, {}", model.name, model.path));
+        auto handle = ctx.getAssets()->loadFromFileAsync<Model>(model.name, model.path);
+        m_loading_jobs.push_back({model.name, handle.getJob()});
     }
 
+    // Коллайдеры уровня строятся в фоне после загрузки модели
+    mat4 level_trasform{1.0f};
+    level_trasform = glm::scale(level_trasform, vec3{1.5f});
+
+    auto level_colliders = createShared<AssetHandle<std::vector<s_ptr<MeshCollider>>>>();
+
+    auto build_colliders_task = createShared<CallbackTask>([&, level_trasform, level_colliders]() {
+        updateOutput("\n### Build colliders ###");
+
+        auto level_model = ctx.getAssets()->require<Model>("level_model");
+        if (!level_model)
+            return;
+
+        auto root_node = level_model->getRootNode();
+        *level_colliders = AssetHandle<std::vector<s_ptr<MeshCollider>>>::run(
+            ctx.getAssets()->getAsyncLoader(), [root_node, level_trasform]() {
+                return createShared<std::vector<s_ptr<MeshCollider>>>(
+                    SceneContext::buildMeshColliders(root_node, level_trasform));
+            });
+
+        m_loading_jobs.clear();
+        m_loading_jobs.push_back({"level colliders", level_colliders->getJob()});
+    });
+
     // Create level
-    auto create_level_task = createShared<CallbackTask>([&]() {
+    auto create_level_task = createShared<CallbackTask>([&, level_trasform, level_colliders]() {
         l_debug("Create level");
         updateOutput("\n### Create level ###");
 
@@ -135,30 +159,34 @@ void LoadLevelState::loadTestScene()
                                             glm::radians(90.0f),
                                             vec3{1.0f, 0.0f, 0.0f});
 
-        auto player_model = ctx.getAssets()->get<Model>("player");
+        auto player_model = ctx.getAssets()->require<Model>("player");
         ctx.getScene()->createPlayer(player_model, player_trasform, player_model_trasform);
 
         // Create level
-        mat4 level_trasform{1.0f};
-        level_trasform = glm::scale(level_trasform, vec3{1.5f});
-        auto level_model = ctx.getAssets()->get<Model>("level_model");
-        ctx.getScene()->createMeshNodeEntities(level_model->getRootNode(), level_trasform);
+        auto level_model = ctx.getAssets()->require<Model>("level_model");
+        if (auto colliders = level_colliders->get())
+            ctx.getScene()->createMeshNodeEntities(level_model->getRootNode(),
+                                                   level_trasform,
+                                                   *colliders);
+        else
+            ctx.getScene()->createMeshNodeEntities(level_model->getRootNode(), level_trasform);
 
         // Create skybox
         auto skybox = createShared<Skybox>();
-        auto skybox_texture = ctx.getAssets()->get<Texture>("skybox");
+        auto skybox_texture = ctx.getAssets()->require<Texture>("skybox");
         skybox->create(skybox_texture);
         auto skybox_entity = ctx.getScene()->createSkybox(skybox);
         ctx.getScene()->setActiveSkybox(skybox_entity);
+
+        m_load_level_gui->setProgress(1.0f);
     });
 
-    auto final_task_chain = createShared<NotifyTaskChain>();
+    auto final_task_chain = createShared<TaskChain>();
     final_task_chain->addTask(
-        createShared<CallbackTask>([&]() { updateOutput("\n### Load textures ###"); }));
-    final_task_chain->addTask(load_textures_task_chain);
+        createShared<WaitTask>([this]() { return waitLoadingJobs(0.0f, 0.8f); }));
+    final_task_chain->addTask(build_colliders_task);
     final_task_chain->addTask(
-        createShared<CallbackTask>([&]() { updateOutput("\n### Load models ###"); }));
-    final_task_chain->addTask(load_models_task_chain);
+        createShared<WaitTask>([this]() { return waitLoadingJobs(0.8f, 0.95f); }));
     final_task_chain->addTask(create_level_task);
     final_task_chain->addTask(createShared<DelayTask>(seconds(0.2f)));
 
@@ -166,10 +194,40 @@ void LoadLevelState::loadTestScene()
         ctx.runLater([&]() { ctx.getGameStateStack()->replace(createShared<GameplayState>(ctx)); });
     }));
 
-    final_task_chain->taskFinished.connect([this](int32_t finished_task, int32_t total_task) {
-        float progress = static_cast<float>(finished_task + 1) / total_task;
-        m_load_level_gui->setProgress(progress);
-    });
-
     ctx.getTaskManager()->run(final_task_chain);
 }
+
+bool LoadLevelState::waitLoadingJobs(float progress_from, float progress_to)
+{
+    float progress = 0.0f;
+    bool done = true;
+
+    for (auto &loading_job : m_loading_jobs) {
+        if (!loading_job.job) {
+            progress += 1.0f;
+            continue;
+        }
+
+        progress += loading_job.job->getProgress();
+
+        auto status = loading_job.job->status.load();
+        if (status == AssetStatus::LOADING) {
+            done = false;
+        } else if (!loading_job.reported) {
+            loading_job.reported = true;
+            if (status == AssetStatus::READY)
+                updateOutput(fmt::format("Loaded: {}", loading_job.name));
+            else {
+                l_error("Failed to load: {}", loading_job.name);
+                updateOutput(fmt::format("Failed: {}", loading_job.name));
+            }
+        }
+    }
+
+    if (!m_loading_jobs.empty())
+        progress /= m_loading_jobs.size();
+
+    m_load_level_gui->setProgress(progress_from + (progress_to - progress_from) * progress);
+
+    return done;
+}
@@ -3,6 +3,7 @@
 
 #include "gui/load_level_gui.h"
 
+#include <ae/assets/async_loader.h>
 #include <ae/game_state.h>
 #include <ae/graphics/core/quad.h>
 
@@ -25,11 +26,20 @@ private:
     void updateOutput(const String &string);
     void loadTestScene();
 
+    // Ждет фоновые загрузки и обновляет прогресс в диапазоне [progress_from, progress_to]
+    bool waitLoadingJobs(float progress_from, float progress_to);
+
 private:
+    struct LoadingJob
+    {
+        std::string name;
+        s_ptr<AsyncLoader::Job> job;
+        bool reported = false;
+    };
+
     s_ptr<LoadLevelGui> m_load_level_gui;
 
-    int32_t m_current_task;
-    int32_t m_total_tasks;
+    std::vector<LoadingJob> m_loading_jobs;
 
     Quad m_render_quad;
 };